@@ -250,6 +250,12 @@ static const uint PLUGIN_OPTION_SEND_ALL_SOUND_OFF = 0x100;
  */
 static const uint PLUGIN_OPTION_SEND_PROGRAM_CHANGES = 0x200;
 
+/*!
+ * Run one block behind the engine, in parallel with the rest of the audio cycle.
+ * Adds one block of latency. Only available for plugin bridges.
+ */
+static const uint PLUGIN_OPTION_PIPELINED = 0x400;
+
 /** @} */
 
 /* ------------------------------------------------------------------------------------------------------------
@@ -958,7 +964,17 @@ typedef enum {
     /*!
      * The engine has crashed or malfunctioned and will no longer work.
      */
-    ENGINE_CALLBACK_QUIT = 40
+    ENGINE_CALLBACK_QUIT = 40,
+
+    /*!
+     * Engine process statistics have been updated.
+     * Sent once per second while ENGINE_OPTION_PROCESS_STATS is enabled.
+     * @a value1 Number of xruns reported by the audio driver
+     * @a value2 Number of cycles that took longer than their period
+     * @a value3 DSP load, in percent
+     * @see carla_get_runtime_engine_info() and carla_get_plugin_process_stats()
+     */
+    ENGINE_CALLBACK_PROCESS_STATS = 41
 
 } EngineCallbackOpcode;
 
@@ -1117,7 +1133,64 @@ typedef enum {
     /*!
      * Capture console output into debug callbacks.
      */
-    ENGINE_OPTION_DEBUG_CONSOLE_OUTPUT = 24
+    ENGINE_OPTION_DEBUG_CONSOLE_OUTPUT = 24,
+
+    /*!
+     * Number of extra realtime threads used to process independent plugins in parallel.
+     * Used in patchbay mode, and in rack mode together with ENGINE_OPTION_RACK_LANES.
+     * Takes effect when the engine is (re)started.
+     * Values above the number of CPU cores minus one are clamped to it.
+     * Default is 0, meaning everything is processed serially in the audio thread.
+     */
+    ENGINE_OPTION_AUDIO_WORKER_THREADS = 25,
+
+    /*!
+     * Split the rack into independent lanes that are processed in parallel and summed at the end.
+     * @a valueStr is a comma-separated list of rack slots where each lane starts, for example "0,4,8".
+     * Every lane receives the rack audio and MIDI input, and plugins within a lane run in series.
+     * While any plugin has more than one MIDI/event input or output port the whole rack is processed serially.
+     * Only used in rack mode, takes effect when the engine is (re)started.
+     * Default is empty, meaning the whole rack is a single serial chain.
+     */
+    ENGINE_OPTION_RACK_LANES = 26,
+
+    /*!
+     * Maximum time in microseconds the engine busy-waits for a plugin bridge before sleeping.
+     * The actual spin time adapts to how long each bridge usually takes to process.
+     * Only affects bridges loaded after the change.
+     * Default is 0, meaning the engine always sleeps while waiting for bridges.
+     */
+    ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME = 27,
+
+    /*!
+     * Maximum time in milliseconds between engine idle passes over all plugins.
+     * Plugins with pending realtime events are handled right away, regardless of this value.
+     * Output parameters, peaks and plugins that need polling are only refreshed at this interval.
+     * Default is 25.
+     */
+    ENGINE_OPTION_IDLE_MAX_INTERVAL = 28,
+
+    /*!
+     * Number of threads used to create plugins and restore their state when loading a project.
+     * Plugins that need the main thread (native VST2, internal, LinuxSampler and JACK applications) are always loaded there.
+     * Only used in rack and patchbay modes, other modes always load plugins one at a time.
+     * Default is 1, loading plugins one at a time. Set to 0 to use one thread per CPU core.
+     */
+    ENGINE_OPTION_PROJECT_LOAD_THREADS = 29,
+
+    /*!
+     * Store plugin chunks as raw binary in a side-car file when saving a project, instead of base64 inside the xml.
+     * The side-car file is the project filename plus ".chunks", and must be kept next to the project.
+     * Default is false.
+     */
+    ENGINE_OPTION_PROJECT_CHUNK_FILES = 30,
+
+    /*!
+     * Measure the engine DSP load, xruns and the time each plugin takes to process.
+     * Adds two clock reads per plugin per cycle while enabled.
+     * Default is false.
+     */
+    ENGINE_OPTION_PROCESS_STATS = 31
 
 } EngineOption;
 
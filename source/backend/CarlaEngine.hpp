@@ -26,7 +26,9 @@ struct CarlaOscData;
 
 namespace water {
 class MemoryOutputStream;
+class OutputStream;
 class XmlDocument;
+class XmlElement;
 }
 
 CARLA_BACKEND_START_NAMESPACE
@@ -68,7 +70,12 @@ enum EngineType {
     /*!
      * Bridge engine type, used in BridgePlugin class.
      */
-    kEngineTypeBridge = 4
+    kEngineTypeBridge = 4,
+
+    /*!
+     * Offline engine type, renders to audio files faster than realtime.
+     */
+    kEngineTypeOffline = 5
 };
 
 /*!
@@ -212,6 +219,76 @@ struct CARLA_API EngineEvent {
     void fillFromMidiData(const uint8_t size, const uint8_t* const data, const uint8_t midiPortOffset) noexcept;
 };
 
+/*!
+ * Engine event buffer.
+ * Fixed-size event storage plus the number of events in use, only the first @a count events are valid.
+ * Clearing it is constant-time, and copies only touch the events present.
+ */
+struct CARLA_API EngineEventBuffer {
+    EngineEvent* data;  //!< Event storage, allocated with the engine internal maximum size
+    uint32_t     count; //!< Number of valid events
+
+    /*!
+     * Allocate event storage, if needed.
+     */
+    void allocate();
+
+    /*!
+     * Free event storage.
+     */
+    void deallocate() noexcept;
+
+    /*!
+     * Remove all events.
+     */
+    void clear() noexcept
+    {
+        count = 0;
+    }
+
+    /*!
+     * Check if there is room for more events.
+     */
+    bool isFull() const noexcept;
+
+    /*!
+     * Replace the contents of this buffer with the events from @a other.
+     */
+    void copyFrom(const EngineEventBuffer& other) noexcept;
+
+    /*!
+     * Swap storage and events with @a other, without copying.
+     */
+    void swapWith(EngineEventBuffer& other) noexcept;
+};
+
+// -----------------------------------------------------------------------
+
+/*!
+ * Engine process statistics.
+ * Summary of the time spent in each process call, for a plugin or for the whole engine cycle.
+ * All times are in microseconds, percentiles are an upper bound, accurate to within 25%.
+ * @see ENGINE_OPTION_PROCESS_STATS
+ */
+struct CARLA_API EngineProcessStats {
+    uint32_t count;   //!< Number of measured calls
+    float    minTime; //!< Minimum time
+    float    avgTime; //!< Average time
+    float    maxTime; //!< Maximum time
+    float    p50Time; //!< Median
+    float    p90Time; //!< 90th percentile
+    float    p99Time; //!< 99th percentile
+
+    /*!
+     * Clear all values.
+     */
+    void clear() noexcept;
+
+#ifndef DOXYGEN
+    EngineProcessStats() noexcept;
+#endif
+};
+
 // -----------------------------------------------------------------------
 
 /*!
@@ -226,13 +303,20 @@ struct CARLA_API EngineOptions {
     bool preferPluginBridges;
     bool preferUiBridges;
     bool uisAlwaysOnTop;
+    bool projectChunkFiles;
+    bool processStats;
 
     uint maxParameters;
     uint uiBridgesTimeout;
     uint audioNumPeriods;
     uint audioBufferSize;
     uint audioSampleRate;
+    uint audioWorkerThreads;
+    uint pluginBridgesSpinTime;
+    uint idleMaxInterval;
+    uint projectLoadThreads;
     const char* audioDevice;
+    const char* rackLanes;
 
     const char* pathLADSPA;
     const char* pathDSSI;
@@ -548,9 +632,10 @@ public:
 
 #ifndef DOXYGEN
 protected:
-    EngineEvent* fBuffer;
+    EngineEventBuffer* fBuffer;
     const EngineProcessMode kProcessMode;
     friend class CarlaPluginInstance;
+    friend struct RackGraph;
 
     CARLA_DECLARE_NON_COPY_CLASS(CarlaEngineEventPort)
 #endif
@@ -643,6 +728,27 @@ public:
      */
     const char* getEventPortName(const bool isInput, const uint index) const noexcept;
 
+    /*!
+     * Get the number of event ports.
+     */
+    uint getEventPortCount(const bool isInput) const noexcept;
+
+    /*!
+     * Add the time, in nanoseconds, this client's plugin took to process one block.
+     * @note RT call, only one thread may add times at once
+     */
+    void addProcessTime(const uint64_t nanoseconds) noexcept;
+
+    /*!
+     * Get the process time statistics of this client's plugin.
+     */
+    void getProcessStats(EngineProcessStats& stats) const noexcept;
+
+    /*!
+     * Clear the process time statistics, the next process call does the actual clearing.
+     */
+    void clearProcessStats() noexcept;
+
 #ifndef DOXYGEN
 protected:
     /*!
@@ -845,6 +951,20 @@ public:
      * Switch plugins with id @a idA and @a idB.
      */
     bool switchPlugins(const uint idA, const uint idB) noexcept;
+
+    /*!
+     * Start a plugin transaction.
+     * Until commitPluginTransaction() is called, addPlugin(), removePlugin(), removeAllPlugins() and switchPlugins()
+     * only change a pending plugin list, and the plugin ids given to them refer to that list.
+     * The current plugins keep running untouched in the meantime.
+     * @note Cloning, replacing and renaming plugins is not possible during a transaction.
+     */
+    bool beginPluginTransaction();
+
+    /*!
+     * Apply all plugin changes made since beginPluginTransaction() in a single audio cycle.
+     */
+    bool commitPluginTransaction();
 #endif
 
     /*!
@@ -881,9 +1001,16 @@ public:
 
     /*!
      * Save current project to a file.
+     * @see ENGINE_OPTION_PROJECT_CHUNK_FILES
      */
     bool saveProject(const char* const filename);
 
+    /*!
+     * Get the filename of the last project loaded or saved, if any.
+     * Used to find side-car files relative to the project.
+     */
+    const char* getCurrentProjectFilename() const noexcept;
+
     // -------------------------------------------------------------------
     // Information (base)
 
@@ -936,6 +1063,41 @@ public:
      */
     float getOutputPeak(const uint pluginId, const bool isLeft) const noexcept;
 
+    // -------------------------------------------------------------------
+    // Information (process statistics)
+
+    /*!
+     * Get the current DSP load, as the smoothed percentage of each cycle period spent processing.
+     * @see ENGINE_OPTION_PROCESS_STATS
+     */
+    float getDSPLoad() const noexcept;
+
+    /*!
+     * Get the number of xruns reported by the audio driver.
+     */
+    uint32_t getXrunCount() const noexcept;
+
+    /*!
+     * Get the number of cycles that took longer than their period.
+     */
+    uint32_t getOverrunCount() const noexcept;
+
+    /*!
+     * Get the time statistics of whole engine cycles.
+     */
+    void getCycleProcessStats(EngineProcessStats& stats) const noexcept;
+
+    /*!
+     * Get the process time statistics of plugin @a id.
+     * Returns false if the plugin does not exist.
+     */
+    bool getPluginProcessStats(const uint id, EngineProcessStats& stats) const noexcept;
+
+    /*!
+     * Clear the DSP load, xrun counters and all process time statistics.
+     */
+    void clearProcessStats() noexcept;
+
     // -------------------------------------------------------------------
     // Callback
 
@@ -1007,6 +1169,18 @@ public:
      */
     virtual void transportRelocate(const uint64_t frame) noexcept;
 
+#ifndef BUILD_BRIDGE
+    // -------------------------------------------------------------------
+    // Offline rendering
+
+    /*!
+     * Render @a frames of audio from the start of the transport into @a filename, as fast as possible.
+     * The file format is taken from the extension, either WAV or FLAC.
+     * Only the offline engine supports this.
+     */
+    virtual bool renderToFile(const char* const filename, const uint64_t frames);
+#endif
+
     // -------------------------------------------------------------------
     // Error handling
 
@@ -1075,7 +1249,13 @@ public:
      * Return internal data, needed for EventPorts when used in Rack, Patchbay and Bridge modes.
      * @note RT call
      */
-    EngineEvent* getInternalEventBuffer(const bool isInput) const noexcept;
+    EngineEventBuffer* getInternalEventBuffer(const bool isInput) const noexcept;
+
+    /*!
+     * Flag plugin @a id as having pending non-realtime work and wake up the engine idle thread.
+     * @note RT call
+     */
+    void markPluginDirty(const uint id) const noexcept;
 
 #ifndef BUILD_BRIDGE
     /*!
@@ -1105,6 +1285,9 @@ protected:
     friend class ScopedThreadStopper;
     friend class PatchbayGraph;
     friend struct RackGraph;
+#ifndef BUILD_BRIDGE
+    friend class ProjectLoadThread;
+#endif
 
     // -------------------------------------------------------------------
     // Internal stuff
@@ -1133,14 +1316,33 @@ protected:
 
     /*!
      * Common save project function for main engine and plugin.
+     * If @a chunkStream is set, plugin chunks are written into it as raw binary and referenced by @a chunkFile.
+     * Returns false if writing to @a chunkStream failed.
      */
-    void saveProjectInternal(water::MemoryOutputStream& outStrm) const;
+    bool saveProjectInternal(water::MemoryOutputStream& outStrm,
+                             water::OutputStream* const chunkStream = nullptr, const char* const chunkFile = nullptr) const;
 
     /*!
      * Common load project function for main engine and plugin.
      */
     bool loadProjectInternal(water::XmlDocument& xmlDoc);
 
+    /*!
+     * Create a new plugin for slot @a id and reload it, without adding it to the engine.
+     * Used by addPlugin() and by the parallel project loader.
+     */
+    CarlaPlugin* createPlugin(const uint id, const BinaryType btype, const PluginType ptype,
+                              const char* const filename, const char* const name, const char* const label, const int64_t uniqueId,
+                              const void* const extra, const uint options);
+
+#ifndef BUILD_BRIDGE
+    /*!
+     * Load all plugins of a project using @a numThreads threads, then add them to the engine in one go.
+     * Returns false if the engine started closing in the meantime.
+     */
+    bool loadProjectPluginsInParallel(water::XmlElement* const xmlElement, const uint numThreads);
+#endif
+
 #ifndef BUILD_BRIDGE
     // -------------------------------------------------------------------
     // Patchbay stuff
@@ -1191,6 +1393,11 @@ public:
     static const char*        getRtAudioApiName(const uint index);
     static const char* const* getRtAudioApiDeviceNames(const uint index);
     static const EngineDriverDeviceInfo* getRtAudioDeviceInfo(const uint index, const char* const deviceName);
+
+    // Offline
+    static CarlaEngine*       newOffline();
+    static const char* const* getOfflineDeviceNames();
+    static const EngineDriverDeviceInfo* getOfflineDeviceInfo();
 #endif
 
 #ifndef BUILD_BRIDGE
@@ -1221,6 +1428,8 @@ public:
     void oscSend_control_note_on(const uint pluginId, const uint8_t channel, const uint8_t note, const uint8_t velo) const noexcept;
     void oscSend_control_note_off(const uint pluginId, const uint8_t channel, const uint8_t note) const noexcept;
     void oscSend_control_set_peaks(const uint pluginId) const noexcept;
+    void oscSend_control_set_engine_stats() const noexcept;
+    void oscSend_control_set_process_stats(const uint pluginId) const noexcept;
     void oscSend_control_exit() const noexcept;
 #endif
 
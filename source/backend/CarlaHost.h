@@ -268,6 +268,135 @@ typedef struct _CarlaTransportInfo {
 
 } CarlaTransportInfo;
 
+/*!
+ * Runtime engine information.
+ * Only updated while ENGINE_OPTION_PROCESS_STATS is enabled.
+ * @see carla_get_runtime_engine_info()
+ */
+typedef struct _CarlaRuntimeEngineInfo {
+    /*!
+     * DSP load, in percent.
+     */
+    float load;
+
+    /*!
+     * Number of xruns reported by the audio driver.
+     */
+    uint32_t xruns;
+
+    /*!
+     * Number of cycles that took longer than the buffer period.
+     */
+    uint32_t overruns;
+
+#ifdef __cplusplus
+    /*!
+     * C++ constructor.
+     */
+    CARLA_API _CarlaRuntimeEngineInfo() noexcept;
+#endif
+
+} CarlaRuntimeEngineInfo;
+
+/*!
+ * Plugin process time statistics, all times are in microseconds.
+ * Only updated while ENGINE_OPTION_PROCESS_STATS is enabled.
+ * @see carla_get_plugin_process_stats()
+ */
+typedef struct _CarlaPluginProcessStats {
+    /*!
+     * Number of measured process calls.
+     */
+    uint32_t count;
+
+    /*!
+     * Minimum, average and maximum process time.
+     */
+    float minTime, avgTime, maxTime;
+
+    /*!
+     * Process time percentiles (50th, 90th and 99th).
+     */
+    float p50Time, p90Time, p99Time;
+
+#ifdef __cplusplus
+    /*!
+     * C++ constructor.
+     */
+    CARLA_API _CarlaPluginProcessStats() noexcept;
+#endif
+
+} CarlaPluginProcessStats;
+
+/*!
+ * Plugin sample-accurate block splitting stats.
+ * @see carla_get_plugin_block_split_stats()
+ */
+typedef struct _CarlaPluginBlockSplitStats {
+    /*!
+     * Current minimum number of frames between splits.
+     */
+    uint32_t minimumFrames;
+
+    /*!
+     * Number of processed blocks that received events.
+     */
+    uint64_t cycles;
+
+    /*!
+     * Number of extra sub-blocks created for events.
+     */
+    uint64_t splits;
+
+    /*!
+     * Number of events merged into a previous sub-block instead of splitting.
+     */
+    uint64_t coalesced;
+
+#ifdef __cplusplus
+    /*!
+     * C++ constructor.
+     */
+    CARLA_API _CarlaPluginBlockSplitStats() noexcept;
+#endif
+
+} CarlaPluginBlockSplitStats;
+
+/*!
+ * Plugin worker stats, only used by LV2 plugins with the worker extension.
+ * All times are in microseconds.
+ * @see carla_get_plugin_worker_stats()
+ */
+typedef struct _CarlaPluginWorkerStats {
+    /*!
+     * Number of work requests run so far.
+     */
+    uint32_t requests;
+
+    /*!
+     * Average and maximum time between a request being scheduled and the worker running it.
+     */
+    uint64_t requestAvgTime, requestMaxTime;
+
+    /*!
+     * Number of worker responses delivered so far.
+     */
+    uint32_t responses;
+
+    /*!
+     * Average and maximum time between a response and the plugin receiving it.
+     */
+    uint64_t responseAvgTime, responseMaxTime;
+
+#ifdef __cplusplus
+    /*!
+     * C++ constructor.
+     */
+    CARLA_API _CarlaPluginWorkerStats() noexcept;
+#endif
+
+} CarlaPluginWorkerStats;
+
 /*!
  * Image data for LV2 inline display API.
  * raw image pixmap format is ARGB32,
@@ -452,6 +581,23 @@ CARLA_EXPORT uint64_t carla_get_current_transport_frame();
  * Get the engine transport information.
  */
 CARLA_EXPORT const CarlaTransportInfo* carla_get_transport_info();
+
+/*!
+ * Get the engine DSP load and xrun counts.
+ */
+CARLA_EXPORT const CarlaRuntimeEngineInfo* carla_get_runtime_engine_info();
+
+/*!
+ * Reset the xrun counts and all process time statistics, including the ones of each plugin.
+ */
+CARLA_EXPORT void carla_clear_process_stats();
+
+/*!
+ * Render the current project into an audio file, as fast as possible.
+ * Starts from frame 0 and renders @a frames of audio, the file format is taken from the extension (WAV or FLAC).
+ * Requires the engine to be running with the "Offline" driver.
+ */
+CARLA_EXPORT bool carla_render_to_file(const char* filename, uint64_t frames);
 #endif
 
 /*!
@@ -521,6 +667,20 @@ CARLA_EXPORT bool carla_replace_plugin(uint pluginId);
  * @param pluginIdB Plugin B
  */
 CARLA_EXPORT bool carla_switch_plugins(uint pluginIdA, uint pluginIdB);
+
+/*!
+ * Start a plugin transaction.
+ * Until carla_commit_plugin_transaction() is called, carla_add_plugin(), carla_remove_plugin(),
+ * carla_remove_all_plugins() and carla_switch_plugins() only change a pending plugin list,
+ * and plugin ids given to them refer to that list.
+ * Plugins cannot be cloned, replaced or renamed while a transaction is in progress.
+ */
+CARLA_EXPORT bool carla_begin_plugin_transaction();
+
+/*!
+ * Apply all plugin changes made since carla_begin_plugin_transaction() at once.
+ */
+CARLA_EXPORT bool carla_commit_plugin_transaction();
 #endif
 
 /*!
@@ -732,6 +892,35 @@ CARLA_EXPORT float carla_get_input_peak_value(uint pluginId, bool isLeft);
  */
 CARLA_EXPORT float carla_get_output_peak_value(uint pluginId, bool isLeft);
 
+/*!
+ * Get a bridged plugin's processing round trip time, in milliseconds.
+ * Returns 0 for non-bridged plugins.
+ * @param pluginId Plugin
+ * @param maximum  Get the maximum time seen so far, otherwise the running average.
+ */
+CARLA_EXPORT float carla_get_plugin_round_trip_time(uint pluginId, bool maximum);
+
+/*!
+ * Get a plugin's process time statistics.
+ * Bridged plugins are measured on the host side, so the time includes the round trip.
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT const CarlaPluginProcessStats* carla_get_plugin_process_stats(uint pluginId);
+
+/*!
+ * Get a plugin's sample-accurate block splitting stats.
+ * Counters restart when the minimum split size changes.
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT const CarlaPluginBlockSplitStats* carla_get_plugin_block_split_stats(uint pluginId);
+
+/*!
+ * Get a plugin's worker stats.
+ * Everything is 0 for plugins that do not use a worker.
+ * @param pluginId Plugin
+ */
+CARLA_EXPORT const CarlaPluginWorkerStats* carla_get_plugin_worker_stats(uint pluginId);
+
 /*!
  * Render a plugin's inline display.
  * @param pluginId Plugin
@@ -788,6 +977,16 @@ CARLA_EXPORT void carla_set_panning(uint pluginId, float value);
  */
 CARLA_EXPORT void carla_set_ctrl_channel(uint pluginId, int8_t channel);
 
+/*!
+ * Change the minimum number of frames between a plugin's sample-accurate block splits.
+ * Control events arriving sooner are applied at the start of the current sub-block, MIDI events keep their exact time.
+ * The default of 0 splits the block at every new event time.
+ * Bridged plugins do not support this and always keep 0.
+ * @param pluginId Plugin
+ * @param frames   Minimum number of frames
+ */
+CARLA_EXPORT void carla_set_plugin_minimum_split_frames(uint pluginId, uint32_t frames);
+
 /*!
  * Enable a plugin's option.
  * @param pluginId Plugin
@@ -96,6 +96,34 @@ _CarlaTransportInfo::_CarlaTransportInfo() noexcept
       tick(0),
       bpm(0.0) {}
 
+_CarlaRuntimeEngineInfo::_CarlaRuntimeEngineInfo() noexcept
+    : load(0.0f),
+      xruns(0),
+      overruns(0) {}
+
+_CarlaPluginProcessStats::_CarlaPluginProcessStats() noexcept
+    : count(0),
+      minTime(0.0f),
+      avgTime(0.0f),
+      maxTime(0.0f),
+      p50Time(0.0f),
+      p90Time(0.0f),
+      p99Time(0.0f) {}
+
+_CarlaPluginBlockSplitStats::_CarlaPluginBlockSplitStats() noexcept
+    : minimumFrames(0),
+      cycles(0),
+      splits(0),
+      coalesced(0) {}
+
+_CarlaPluginWorkerStats::_CarlaPluginWorkerStats() noexcept
+    : requests(0),
+      requestAvgTime(0),
+      requestMaxTime(0),
+      responses(0),
+      responseAvgTime(0),
+      responseMaxTime(0) {}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 const char* carla_get_library_filename()
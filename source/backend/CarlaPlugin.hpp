@@ -156,6 +156,22 @@ public:
      */
     virtual uint32_t getLatencyInFrames() const noexcept;
 
+    /*!
+     * Get the time the plugin bridge takes to process a block, measured as a full round trip, in milliseconds.
+     * Returns the running average, or the maximum seen so far if @a maximum is true.
+     * Returns 0 for non-bridged plugins.
+     */
+    virtual float getBridgeRoundTripTime(const bool maximum) const noexcept;
+
+    /*!
+     * Get the plugin worker stats, in microseconds.
+     * Request times go from scheduling some work until the worker runs it,
+     * response times from the worker responding until the plugin receives it.
+     * Everything is 0 for plugins without a worker.
+     */
+    virtual void getWorkerStats(uint32_t& requests, uint64_t& requestAvgTime, uint64_t& requestMaxTime,
+                                uint32_t& responses, uint64_t& responseAvgTime, uint64_t& responseMaxTime) const noexcept;
+
     // -------------------------------------------------------------------
     // Information (count)
 
@@ -369,6 +385,20 @@ public:
      */
     void getParameterCountInfo(uint32_t& ins, uint32_t& outs) const noexcept;
 
+    /*!
+     * Get the minimum number of frames between sample-accurate block splits.
+     *
+     * @see setMinimumSplitFrames()
+     */
+    uint32_t getMinimumSplitFrames() const noexcept;
+
+    /*!
+     * Get the sample-accurate block splitting stats.
+     * @a cycles is the number of processed blocks that received events, @a splits the number of extra
+     * sub-blocks created for events and @a coalesced the number of events merged into a previous sub-block.
+     */
+    void getBlockSplitStats(uint64_t& cycles, uint64_t& splits, uint64_t& coalesced) const noexcept;
+
     // -------------------------------------------------------------------
     // Set data (state)
 
@@ -390,10 +420,11 @@ public:
     /*!
      * Get the plugin's save state.
      * The plugin will automatically call prepareForSave() if requested.
+     * If @a rawChunk is true the chunk is not base64 encoded, see CarlaStateSave::rawChunk.
      *
      * @see loadStateSave()
      */
-    const CarlaStateSave& getStateSave(const bool callPrepareForSave = true);
+    const CarlaStateSave& getStateSave(const bool callPrepareForSave = true, const bool rawChunk = false);
 
     /*!
      * Get the plugin's save state.
@@ -523,6 +554,17 @@ public:
      */
     virtual void setCtrlChannel(const int8_t channel, const bool sendOsc, const bool sendCallback) noexcept;
 
+    /*!
+     * Set the minimum number of frames between sample-accurate block splits.
+     * Events arriving sooner after the last split are processed together with the current sub-block,
+     * control changes are applied at its start while MIDI events keep their exact offset.
+     * The default of 0 splits the block at every new event time.
+     * Has no effect when PLUGIN_OPTION_FIXED_BUFFERS is set, and is refused for bridged plugins.
+     *
+     * @note This also clears the block splitting stats.
+     */
+    void setMinimumSplitFrames(const uint32_t frames) noexcept;
+
     // -------------------------------------------------------------------
     // Set data (plugin-specific stuff)
 
@@ -677,6 +719,13 @@ public:
      */
     virtual void idle();
 
+    /*!
+     * Send output parameter values to OSC and/or the custom UI.
+     * Only values that changed since the last call are sent, unless @a forceSend is true.
+     * @note: This function is NOT called from the main thread.
+     */
+    void idleParameterOutputs(const bool sendOsc, const bool sendUi, const bool forceSend);
+
     /*!
      * Try to lock the plugin's master mutex.
      * @param forcedOffline When true, always locks and returns true
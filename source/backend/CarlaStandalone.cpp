@@ -215,10 +215,19 @@ static void carla_engine_init_common()
     gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_SAMPLE_RATE,     static_cast<int>(gStandalone.engineOptions.audioSampleRate),  nullptr);
 
     gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_SAMPLE_RATE,     static_cast<int>(gStandalone.engineOptions.audioSampleRate),  nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_WORKER_THREADS,  static_cast<int>(gStandalone.engineOptions.audioWorkerThreads), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME, static_cast<int>(gStandalone.engineOptions.pluginBridgesSpinTime), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_IDLE_MAX_INTERVAL,     static_cast<int>(gStandalone.engineOptions.idleMaxInterval),  nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PROJECT_LOAD_THREADS,  static_cast<int>(gStandalone.engineOptions.projectLoadThreads), nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PROJECT_CHUNK_FILES,   gStandalone.engineOptions.projectChunkFiles ? 1 : 0, nullptr);
+    gStandalone.engine->setOption(CB::ENGINE_OPTION_PROCESS_STATS,         gStandalone.engineOptions.processStats ? 1 : 0, nullptr);
 
     if (gStandalone.engineOptions.audioDevice != nullptr)
         gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_DEVICE,      0, gStandalone.engineOptions.audioDevice);
 
+    if (gStandalone.engineOptions.rackLanes != nullptr)
+        gStandalone.engine->setOption(CB::ENGINE_OPTION_RACK_LANES,        0, gStandalone.engineOptions.rackLanes);
+
     if (gStandalone.engineOptions.pathLADSPA != nullptr)
         gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_LADSPA, gStandalone.engineOptions.pathLADSPA);
 
@@ -645,6 +654,46 @@ void carla_set_engine_option(EngineOption option, int value, const char* valueSt
     case CB::ENGINE_OPTION_DEBUG_CONSOLE_OUTPUT:
         gStandalone.logThreadEnabled = (value != 0);
         break;
+
+    case CB::ENGINE_OPTION_AUDIO_WORKER_THREADS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.audioWorkerThreads = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_RACK_LANES:
+        if (gStandalone.engineOptions.rackLanes != nullptr)
+            delete[] gStandalone.engineOptions.rackLanes;
+
+        if (valueStr != nullptr && valueStr[0] != '\0')
+            gStandalone.engineOptions.rackLanes = carla_strdup_safe(valueStr);
+        else
+            gStandalone.engineOptions.rackLanes = nullptr;
+        break;
+
+    case CB::ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.pluginBridgesSpinTime = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_IDLE_MAX_INTERVAL:
+        CARLA_SAFE_ASSERT_RETURN(value >= 10 && value <= 1000,);
+        gStandalone.engineOptions.idleMaxInterval = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_PROJECT_LOAD_THREADS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 64,);
+        gStandalone.engineOptions.projectLoadThreads = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_PROJECT_CHUNK_FILES:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        gStandalone.engineOptions.projectChunkFiles = (value != 0);
+        break;
+
+    case CB::ENGINE_OPTION_PROCESS_STATS:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        gStandalone.engineOptions.processStats = (value != 0);
+        break;
     }
 
     if (gStandalone.engine != nullptr)
@@ -814,6 +863,45 @@ const CarlaTransportInfo* carla_get_transport_info()
 
     return &retInfo;
 }
+
+const CarlaRuntimeEngineInfo* carla_get_runtime_engine_info()
+{
+    static CarlaRuntimeEngineInfo retInfo;
+
+    // reset
+    retInfo.load     = 0.0f;
+    retInfo.xruns    = 0;
+    retInfo.overruns = 0;
+
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, &retInfo);
+
+    retInfo.load     = gStandalone.engine->getDSPLoad();
+    retInfo.xruns    = gStandalone.engine->getXrunCount();
+    retInfo.overruns = gStandalone.engine->getOverrunCount();
+
+    return &retInfo;
+}
+
+void carla_clear_process_stats()
+{
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr,);
+    carla_debug("carla_clear_process_stats()");
+
+    gStandalone.engine->clearProcessStats();
+}
+
+bool carla_render_to_file(const char* filename, uint64_t frames)
+{
+    CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+    carla_debug("carla_render_to_file(\"%s\", " P_UINT64 ")", filename, frames);
+
+    if (gStandalone.engine != nullptr && gStandalone.engine->isRunning())
+        return gStandalone.engine->renderToFile(filename, frames);
+
+    carla_stderr2("Engine is not running");
+    gStandalone.lastError = "Engine is not running";
+    return false;
+}
 #endif
 
 // -------------------------------------------------------------------------------------------------------------------
@@ -922,6 +1010,30 @@ bool carla_switch_plugins(uint pluginIdA, uint pluginIdB)
     gStandalone.lastError = "Engine is not running";
     return false;
 }
+
+bool carla_begin_plugin_transaction()
+{
+    carla_debug("carla_begin_plugin_transaction()");
+
+    if (gStandalone.engine != nullptr)
+        return gStandalone.engine->beginPluginTransaction();
+
+    carla_stderr2("Engine is not running");
+    gStandalone.lastError = "Engine is not running";
+    return false;
+}
+
+bool carla_commit_plugin_transaction()
+{
+    carla_debug("carla_commit_plugin_transaction()");
+
+    if (gStandalone.engine != nullptr)
+        return gStandalone.engine->commitPluginTransaction();
+
+    carla_stderr2("Engine is not running");
+    gStandalone.lastError = "Engine is not running";
+    return false;
+}
 #endif
 
 // -------------------------------------------------------------------------------------------------------------------
@@ -1632,6 +1744,90 @@ float carla_get_output_peak_value(uint pluginId, bool isLeft)
     return gStandalone.engine->getOutputPeak(pluginId, isLeft);
 }
 
+float carla_get_plugin_round_trip_time(uint pluginId, bool maximum)
+{
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, 0.0f);
+
+    if (CarlaPlugin* const plugin = gStandalone.engine->getPlugin(pluginId))
+        return plugin->getBridgeRoundTripTime(maximum);
+
+    carla_stderr2("carla_get_plugin_round_trip_time(%i, %s) - could not find plugin", pluginId, bool2str(maximum));
+    return 0.0f;
+}
+
+const CarlaPluginProcessStats* carla_get_plugin_process_stats(uint pluginId)
+{
+    static CarlaPluginProcessStats retStats;
+
+    // reset
+    retStats.count   = 0;
+    retStats.minTime = retStats.avgTime = retStats.maxTime = 0.0f;
+    retStats.p50Time = retStats.p90Time = retStats.p99Time = 0.0f;
+
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, &retStats);
+
+    CB::EngineProcessStats stats;
+
+    if (! gStandalone.engine->getPluginProcessStats(pluginId, stats))
+    {
+        carla_stderr2("carla_get_plugin_process_stats(%i) - could not find plugin", pluginId);
+        return &retStats;
+    }
+
+    retStats.count   = stats.count;
+    retStats.minTime = stats.minTime;
+    retStats.avgTime = stats.avgTime;
+    retStats.maxTime = stats.maxTime;
+    retStats.p50Time = stats.p50Time;
+    retStats.p90Time = stats.p90Time;
+    retStats.p99Time = stats.p99Time;
+
+    return &retStats;
+}
+
+const CarlaPluginBlockSplitStats* carla_get_plugin_block_split_stats(uint pluginId)
+{
+    static CarlaPluginBlockSplitStats retStats;
+
+    // reset
+    retStats.minimumFrames = 0;
+    retStats.cycles = retStats.splits = retStats.coalesced = 0;
+
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, &retStats);
+
+    if (CarlaPlugin* const plugin = gStandalone.engine->getPlugin(pluginId))
+    {
+        retStats.minimumFrames = plugin->getMinimumSplitFrames();
+        plugin->getBlockSplitStats(retStats.cycles, retStats.splits, retStats.coalesced);
+        return &retStats;
+    }
+
+    carla_stderr2("carla_get_plugin_block_split_stats(%i) - could not find plugin", pluginId);
+    return &retStats;
+}
+
+const CarlaPluginWorkerStats* carla_get_plugin_worker_stats(uint pluginId)
+{
+    static CarlaPluginWorkerStats retStats;
+
+    // reset
+    retStats.requests  = retStats.responses = 0;
+    retStats.requestAvgTime  = retStats.requestMaxTime  = 0;
+    retStats.responseAvgTime = retStats.responseMaxTime = 0;
+
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, &retStats);
+
+    if (CarlaPlugin* const plugin = gStandalone.engine->getPlugin(pluginId))
+    {
+        plugin->getWorkerStats(retStats.requests, retStats.requestAvgTime, retStats.requestMaxTime,
+                               retStats.responses, retStats.responseAvgTime, retStats.responseMaxTime);
+        return &retStats;
+    }
+
+    carla_stderr2("carla_get_plugin_worker_stats(%i) - could not find plugin", pluginId);
+    return &retStats;
+}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 CARLA_BACKEND_START_NAMESPACE
@@ -1736,6 +1932,17 @@ void carla_set_ctrl_channel(uint pluginId, int8_t channel)
     carla_stderr2("carla_set_ctrl_channel(%i, %i) - could not find plugin", pluginId, channel);
 }
 
+void carla_set_plugin_minimum_split_frames(uint pluginId, uint32_t frames)
+{
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr,);
+    carla_debug("carla_set_plugin_minimum_split_frames(%i, %u)", pluginId, frames);
+
+    if (CarlaPlugin* const plugin = gStandalone.engine->getPlugin(pluginId))
+        return plugin->setMinimumSplitFrames(frames);
+
+    carla_stderr2("carla_set_plugin_minimum_split_frames(%i, %u) - could not find plugin", pluginId, frames);
+}
+
 void carla_set_option(uint pluginId, uint option, bool yesNo)
 {
     CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr,);
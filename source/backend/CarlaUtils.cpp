@@ -20,6 +20,7 @@
 #include "CarlaNative.h"
 
 #include "CarlaBackendUtils.hpp"
+#include "CarlaLv2CacheUtils.hpp"
 #include "CarlaLv2Utils.hpp"
 #include "CarlaPipeUtils.hpp"
 #include "CarlaThread.hpp"
@@ -59,6 +60,358 @@ _CarlaCachedPluginInfo::_CarlaCachedPluginInfo() noexcept
 
 // -------------------------------------------------------------------------------------------------------------------
 
+static bool carla_fill_lv2_cached_plugin_info(CarlaCachedPluginInfo& info, const LilvPlugin* const cPlugin)
+{
+    CARLA_SAFE_ASSERT_RETURN(cPlugin != nullptr, false);
+
+    Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
+
+    Lilv::Plugin lilvPlugin(cPlugin);
+    CARLA_SAFE_ASSERT_RETURN(lilvPlugin.get_uri().is_uri(), false);
+
+    carla_stdout("Filling info for LV2 with URI '%s'", lilvPlugin.get_uri().as_uri());
+
+    // features
+    info.hints = 0x0;
+
+    if (lilvPlugin.get_uis().size() > 0)
+        info.hints |= CB::PLUGIN_HAS_CUSTOM_UI;
+
+    {
+        Lilv::Nodes lilvFeatureNodes(lilvPlugin.get_supported_features());
+
+        LILV_FOREACH(nodes, it, lilvFeatureNodes)
+        {
+            Lilv::Node lilvFeatureNode(lilvFeatureNodes.get(it));
+            const char* const featureURI(lilvFeatureNode.as_uri());
+            CARLA_SAFE_ASSERT_CONTINUE(featureURI != nullptr);
+
+            if (std::strcmp(featureURI, LV2_CORE__hardRTCapable) == 0)
+                info.hints |= CB::PLUGIN_IS_RTSAFE;
+        }
+
+        lilv_nodes_free(const_cast<LilvNodes*>(lilvFeatureNodes.me));
+    }
+
+    // category
+    info.category = CB::PLUGIN_CATEGORY_NONE;
+
+    {
+        Lilv::Nodes typeNodes(lilvPlugin.get_value(lv2World.rdf_type));
+
+        if (typeNodes.size() > 0)
+        {
+            if (typeNodes.contains(lv2World.class_allpass))
+                info.category = CB::PLUGIN_CATEGORY_FILTER;
+            if (typeNodes.contains(lv2World.class_amplifier))
+                info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
+            if (typeNodes.contains(lv2World.class_analyzer))
+                info.category = CB::PLUGIN_CATEGORY_UTILITY;
+            if (typeNodes.contains(lv2World.class_bandpass))
+                info.category = CB::PLUGIN_CATEGORY_FILTER;
+            if (typeNodes.contains(lv2World.class_chorus))
+                info.category = CB::PLUGIN_CATEGORY_MODULATOR;
+            if (typeNodes.contains(lv2World.class_comb))
+                info.category = CB::PLUGIN_CATEGORY_FILTER;
+            if (typeNodes.contains(lv2World.class_compressor))
+                info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
+            if (typeNodes.contains(lv2World.class_constant))
+                info.category = CB::PLUGIN_CATEGORY_OTHER;
+            if (typeNodes.contains(lv2World.class_converter))
+                info.category = CB::PLUGIN_CATEGORY_UTILITY;
+            if (typeNodes.contains(lv2World.class_delay))
+                info.category = CB::PLUGIN_CATEGORY_DELAY;
+            if (typeNodes.contains(lv2World.class_distortion))
+                info.category = CB::PLUGIN_CATEGORY_DISTORTION;
+            if (typeNodes.contains(lv2World.class_dynamics))
+                info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
+            if (typeNodes.contains(lv2World.class_eq))
+                info.category = CB::PLUGIN_CATEGORY_EQ;
+            if (typeNodes.contains(lv2World.class_envelope))
+                info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
+            if (typeNodes.contains(lv2World.class_expander))
+                info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
+            if (typeNodes.contains(lv2World.class_filter))
+                info.category = CB::PLUGIN_CATEGORY_FILTER;
+            if (typeNodes.contains(lv2World.class_flanger))
+                info.category = CB::PLUGIN_CATEGORY_MODULATOR;
+            if (typeNodes.contains(lv2World.class_function))
+                info.category = CB::PLUGIN_CATEGORY_UTILITY;
+            if (typeNodes.contains(lv2World.class_gate))
+                info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
+            if (typeNodes.contains(lv2World.class_generator))
+                info.category = CB::PLUGIN_CATEGORY_OTHER;
+            if (typeNodes.contains(lv2World.class_highpass))
+                info.category = CB::PLUGIN_CATEGORY_FILTER;
+            if (typeNodes.contains(lv2World.class_limiter))
+                info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
+            if (typeNodes.contains(lv2World.class_lowpass))
+                info.category = CB::PLUGIN_CATEGORY_FILTER;
+            if (typeNodes.contains(lv2World.class_mixer))
+                info.category = CB::PLUGIN_CATEGORY_UTILITY;
+            if (typeNodes.contains(lv2World.class_modulator))
+                info.category = CB::PLUGIN_CATEGORY_MODULATOR;
+            if (typeNodes.contains(lv2World.class_multiEQ))
+                info.category = CB::PLUGIN_CATEGORY_EQ;
+            if (typeNodes.contains(lv2World.class_oscillator))
+                info.category = CB::PLUGIN_CATEGORY_OTHER;
+            if (typeNodes.contains(lv2World.class_paraEQ))
+                info.category = CB::PLUGIN_CATEGORY_EQ;
+            if (typeNodes.contains(lv2World.class_phaser))
+                info.category = CB::PLUGIN_CATEGORY_MODULATOR;
+            if (typeNodes.contains(lv2World.class_pitch))
+                info.category = CB::PLUGIN_CATEGORY_OTHER;
+            if (typeNodes.contains(lv2World.class_reverb))
+                info.category = CB::PLUGIN_CATEGORY_DELAY;
+            if (typeNodes.contains(lv2World.class_simulator))
+                info.category = CB::PLUGIN_CATEGORY_OTHER;
+            if (typeNodes.contains(lv2World.class_spatial))
+                info.category = CB::PLUGIN_CATEGORY_OTHER;
+            if (typeNodes.contains(lv2World.class_spectral))
+                info.category = CB::PLUGIN_CATEGORY_OTHER;
+            if (typeNodes.contains(lv2World.class_utility))
+                info.category = CB::PLUGIN_CATEGORY_UTILITY;
+            if (typeNodes.contains(lv2World.class_waveshaper))
+                info.category = CB::PLUGIN_CATEGORY_DISTORTION;
+            if (typeNodes.contains(lv2World.class_instrument))
+            {
+                info.category = CB::PLUGIN_CATEGORY_SYNTH;
+                info.hints |= CB::PLUGIN_IS_SYNTH;
+            }
+        }
+
+        lilv_nodes_free(const_cast<LilvNodes*>(typeNodes.me));
+    }
+
+    // number data
+    info.audioIns      = 0;
+    info.audioOuts     = 0;
+    info.midiIns       = 0;
+    info.midiOuts      = 0;
+    info.parameterIns  = 0;
+    info.parameterOuts = 0;
+
+    for (uint i=0, count=lilvPlugin.get_num_ports(); i<count; ++i)
+    {
+        Lilv::Port lilvPort(lilvPlugin.get_port_by_index(i));
+
+        bool isInput;
+
+        /**/ if (lilvPort.is_a(lv2World.port_input))
+            isInput = true;
+        else if (lilvPort.is_a(lv2World.port_output))
+            isInput = false;
+        else
+            continue;
+
+        /**/ if (lilvPort.is_a(lv2World.port_control))
+        {
+            // skip some control ports
+            if (lilvPort.has_property(lv2World.reportsLatency))
+                continue;
+
+            if (LilvNode* const designationNode = lilv_port_get(lilvPort.parent, lilvPort.me, lv2World.designation.me))
+            {
+                bool skip = false;
+
+                if (const char* const designation = lilv_node_as_string(designationNode))
+                {
+                    /**/ if (std::strcmp(designation, LV2_CORE__control) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_CORE__freeWheeling) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_CORE__latency) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_PARAMETERS__sampleRate) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__bar) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__barBeat) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__beat) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__beatUnit) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__beatsPerBar) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__beatsPerMinute) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__frame) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__framesPerSecond) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_TIME__speed) == 0)
+                        skip = true;
+                    else if (std::strcmp(designation, LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat) == 0)
+                        skip = true;
+                }
+
+                lilv_node_free(designationNode);
+
+                if (skip)
+                    continue;
+            }
+
+            if (isInput)
+                ++(info.parameterIns);
+            else
+                ++(info.parameterOuts);
+        }
+        else if (lilvPort.is_a(lv2World.port_audio))
+        {
+            if (isInput)
+                ++(info.audioIns);
+            else
+                ++(info.audioOuts);
+        }
+        else if (lilvPort.is_a(lv2World.port_cv))
+        {
+        }
+        else if (lilvPort.is_a(lv2World.port_atom))
+        {
+            Lilv::Nodes supportNodes(lilvPort.get_value(lv2World.atom_supports));
+
+            for (LilvIter *it = lilv_nodes_begin(supportNodes.me); ! lilv_nodes_is_end(supportNodes.me, it); it = lilv_nodes_next(supportNodes.me, it))
+            {
+                const Lilv::Node node(lilv_nodes_get(supportNodes.me, it));
+                CARLA_SAFE_ASSERT_CONTINUE(node.is_uri());
+
+                if (node.equals(lv2World.midi_event))
+                {
+                    if (isInput)
+                        ++(info.midiIns);
+                    else
+                        ++(info.midiOuts);
+                }
+            }
+
+            lilv_nodes_free(const_cast<LilvNodes*>(supportNodes.me));
+        }
+        else if (lilvPort.is_a(lv2World.port_event))
+        {
+            if (lilvPort.supports_event(lv2World.midi_event))
+            {
+                if (isInput)
+                    ++(info.midiIns);
+                else
+                    ++(info.midiOuts);
+            }
+        }
+        else if (lilvPort.is_a(lv2World.port_midi))
+        {
+            if (isInput)
+                ++(info.midiIns);
+            else
+                ++(info.midiOuts);
+        }
+    }
+
+    // text data
+    static CarlaString suri, sname, smaker, slicense;
+    suri.clear(); sname.clear(); smaker.clear(); slicense.clear();
+
+    suri = lilvPlugin.get_uri().as_uri();
+
+    if (LilvNode* const nameNode = lilv_plugin_get_name(lilvPlugin.me))
+    {
+        if (const char* const name = lilv_node_as_string(nameNode))
+            sname = name;
+        lilv_node_free(nameNode);
+    }
+
+    if (const char* const author = lilvPlugin.get_author_name().as_string())
+        smaker = author;
+
+    Lilv::Nodes licenseNodes(lilvPlugin.get_value(lv2World.doap_license));
+
+    if (licenseNodes.size() > 0)
+    {
+        if (const char* const license = licenseNodes.get_first().as_string())
+            slicense = license;
+    }
+
+    lilv_nodes_free(const_cast<LilvNodes*>(licenseNodes.me));
+
+    info.name      = sname;
+    info.label     = suri;
+    info.maker     = smaker;
+    info.copyright = slicense;
+
+    return true;
+}
+
+// Rebuild the LV2 metadata cache if any bundle in LV2_PATH was added, removed or modified.
+// Returns true if plugins can be served from the cache.
+static bool carla_update_lv2_cache(const char* const LV2_PATH)
+{
+    CARLA_SAFE_ASSERT_RETURN(LV2_PATH != nullptr, false);
+
+    Lv2MetadataCache& lv2Cache(Lv2MetadataCache::getInstance());
+
+    std::vector<Lv2CacheBundle> bundles;
+    lv2_cache_scan_bundles(LV2_PATH, bundles);
+
+    if (lv2Cache.loadAndCheck(LV2_PATH, bundles))
+        return true;
+
+    carla_stdout("LV2 metadata cache is missing or outdated, rebuilding it...");
+
+    // plugin data can be spread across bundles, so a full world is needed for rebuilding
+    Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
+    lv2World.initIfNeeded(LV2_PATH);
+
+    Lv2MetadataCacheBuilder builder(LV2_PATH, bundles);
+    CarlaCachedPluginInfo info;
+
+    for (uint i=0, count=lv2World.getPluginCount(); i<count; ++i)
+    {
+        const LilvPlugin* const cPlugin(lv2World.getPluginFromIndex(i));
+        CARLA_SAFE_ASSERT_CONTINUE(cPlugin != nullptr);
+
+        if (! carla_fill_lv2_cached_plugin_info(info, cPlugin))
+            continue;
+
+        const LV2_RDF_Descriptor* const rdfDescriptor(lv2_rdf_new(info.label, true));
+        CARLA_SAFE_ASSERT_CONTINUE(rdfDescriptor != nullptr);
+        CARLA_SAFE_ASSERT_CONTINUE(rdfDescriptor->Bundle != nullptr);
+
+        // water paths have no trailing separator, same as the scanned bundles
+        const CarlaString bundle(water::File(rdfDescriptor->Bundle).getFullPathName().toRawUTF8());
+
+        Lv2CachePluginInfo cacheInfo;
+        cacheInfo.bundle        = bundle;
+        cacheInfo.uri           = info.label;
+        cacheInfo.category      = static_cast<uint32_t>(info.category);
+        cacheInfo.hints         = info.hints;
+        cacheInfo.audioIns      = info.audioIns;
+        cacheInfo.audioOuts     = info.audioOuts;
+        cacheInfo.midiIns       = info.midiIns;
+        cacheInfo.midiOuts      = info.midiOuts;
+        cacheInfo.parameterIns  = info.parameterIns;
+        cacheInfo.parameterOuts = info.parameterOuts;
+        cacheInfo.name          = info.name;
+        cacheInfo.maker         = info.maker;
+        cacheInfo.copyright     = info.copyright;
+        cacheInfo.rdfData       = nullptr;
+        cacheInfo.rdfSize       = 0;
+
+        builder.addPlugin(cacheInfo, rdfDescriptor);
+        delete rdfDescriptor;
+    }
+
+    const CarlaString filename(Lv2MetadataCache::getDefaultFilename());
+
+    if (! builder.save(filename))
+    {
+        carla_stderr("Failed to write LV2 metadata cache to '%s'", filename.buffer());
+        return false;
+    }
+
+    return lv2Cache.loadAndCheck(LV2_PATH, bundles);
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+
 uint carla_get_cached_plugin_count(CB::PluginType ptype, const char* pluginPath)
 {
     CARLA_SAFE_ASSERT_RETURN(ptype == CB::PLUGIN_INTERNAL || ptype == CB::PLUGIN_LV2, 0);
@@ -73,6 +426,9 @@ uint carla_get_cached_plugin_count(CB::PluginType ptype, const char* pluginPath)
     }
 
     case CB::PLUGIN_LV2: {
+        if (carla_update_lv2_cache(pluginPath))
+            return Lv2MetadataCache::getInstance().getPluginCount();
+
         Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
         lv2World.initIfNeeded(pluginPath);
         return lv2World.getPluginCount();
@@ -129,281 +485,35 @@ const CarlaCachedPluginInfo* carla_get_cached_plugin_info(CB::PluginType ptype,
     }
 
     case CB::PLUGIN_LV2: {
-        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
-
-        const LilvPlugin* const cPlugin(lv2World.getPluginFromIndex(index));
-        CARLA_SAFE_ASSERT_BREAK(cPlugin != nullptr);
-
-        Lilv::Plugin lilvPlugin(cPlugin);
-        CARLA_SAFE_ASSERT_BREAK(lilvPlugin.get_uri().is_uri());
-
-        carla_stdout("Filling info for LV2 with URI '%s'", lilvPlugin.get_uri().as_uri());
-
-        // features
-        info.hints = 0x0;
-
-        if (lilvPlugin.get_uis().size() > 0)
-            info.hints |= CB::PLUGIN_HAS_CUSTOM_UI;
-
-        {
-            Lilv::Nodes lilvFeatureNodes(lilvPlugin.get_supported_features());
-
-            LILV_FOREACH(nodes, it, lilvFeatureNodes)
-            {
-                Lilv::Node lilvFeatureNode(lilvFeatureNodes.get(it));
-                const char* const featureURI(lilvFeatureNode.as_uri());
-                CARLA_SAFE_ASSERT_CONTINUE(featureURI != nullptr);
-
-                if (std::strcmp(featureURI, LV2_CORE__hardRTCapable) == 0)
-                    info.hints |= CB::PLUGIN_IS_RTSAFE;
-            }
-
-            lilv_nodes_free(const_cast<LilvNodes*>(lilvFeatureNodes.me));
-        }
-
-        // category
-        info.category = CB::PLUGIN_CATEGORY_NONE;
-
-        {
-            Lilv::Nodes typeNodes(lilvPlugin.get_value(lv2World.rdf_type));
-
-            if (typeNodes.size() > 0)
-            {
-                if (typeNodes.contains(lv2World.class_allpass))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_amplifier))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_analyzer))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_bandpass))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_chorus))
-                    info.category = CB::PLUGIN_CATEGORY_MODULATOR;
-                if (typeNodes.contains(lv2World.class_comb))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_compressor))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_constant))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_converter))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_delay))
-                    info.category = CB::PLUGIN_CATEGORY_DELAY;
-                if (typeNodes.contains(lv2World.class_distortion))
-                    info.category = CB::PLUGIN_CATEGORY_DISTORTION;
-                if (typeNodes.contains(lv2World.class_dynamics))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_eq))
-                    info.category = CB::PLUGIN_CATEGORY_EQ;
-                if (typeNodes.contains(lv2World.class_envelope))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_expander))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_filter))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_flanger))
-                    info.category = CB::PLUGIN_CATEGORY_MODULATOR;
-                if (typeNodes.contains(lv2World.class_function))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_gate))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_generator))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_highpass))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_limiter))
-                    info.category = CB::PLUGIN_CATEGORY_DYNAMICS;
-                if (typeNodes.contains(lv2World.class_lowpass))
-                    info.category = CB::PLUGIN_CATEGORY_FILTER;
-                if (typeNodes.contains(lv2World.class_mixer))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_modulator))
-                    info.category = CB::PLUGIN_CATEGORY_MODULATOR;
-                if (typeNodes.contains(lv2World.class_multiEQ))
-                    info.category = CB::PLUGIN_CATEGORY_EQ;
-                if (typeNodes.contains(lv2World.class_oscillator))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_paraEQ))
-                    info.category = CB::PLUGIN_CATEGORY_EQ;
-                if (typeNodes.contains(lv2World.class_phaser))
-                    info.category = CB::PLUGIN_CATEGORY_MODULATOR;
-                if (typeNodes.contains(lv2World.class_pitch))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_reverb))
-                    info.category = CB::PLUGIN_CATEGORY_DELAY;
-                if (typeNodes.contains(lv2World.class_simulator))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_spatial))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_spectral))
-                    info.category = CB::PLUGIN_CATEGORY_OTHER;
-                if (typeNodes.contains(lv2World.class_utility))
-                    info.category = CB::PLUGIN_CATEGORY_UTILITY;
-                if (typeNodes.contains(lv2World.class_waveshaper))
-                    info.category = CB::PLUGIN_CATEGORY_DISTORTION;
-                if (typeNodes.contains(lv2World.class_instrument))
-                {
-                    info.category = CB::PLUGIN_CATEGORY_SYNTH;
-                    info.hints |= CB::PLUGIN_IS_SYNTH;
-                }
-            }
-
-            lilv_nodes_free(const_cast<LilvNodes*>(typeNodes.me));
-        }
-
-        // number data
-        info.audioIns      = 0;
-        info.audioOuts     = 0;
-        info.midiIns       = 0;
-        info.midiOuts      = 0;
-        info.parameterIns  = 0;
-        info.parameterOuts = 0;
-
-        for (uint i=0, count=lilvPlugin.get_num_ports(); i<count; ++i)
-        {
-            Lilv::Port lilvPort(lilvPlugin.get_port_by_index(i));
-
-            bool isInput;
+        const Lv2MetadataCache& lv2Cache(Lv2MetadataCache::getInstance());
 
-            /**/ if (lilvPort.is_a(lv2World.port_input))
-                isInput = true;
-            else if (lilvPort.is_a(lv2World.port_output))
-                isInput = false;
-            else
-                continue;
-
-            /**/ if (lilvPort.is_a(lv2World.port_control))
-            {
-                // skip some control ports
-                if (lilvPort.has_property(lv2World.reportsLatency))
-                    continue;
-
-                if (LilvNode* const designationNode = lilv_port_get(lilvPort.parent, lilvPort.me, lv2World.designation.me))
-                {
-                    bool skip = false;
-
-                    if (const char* const designation = lilv_node_as_string(designationNode))
-                    {
-                        /**/ if (std::strcmp(designation, LV2_CORE__control) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_CORE__freeWheeling) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_CORE__latency) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_PARAMETERS__sampleRate) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__bar) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__barBeat) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__beat) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__beatUnit) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__beatsPerBar) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__beatsPerMinute) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__frame) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__framesPerSecond) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_TIME__speed) == 0)
-                            skip = true;
-                        else if (std::strcmp(designation, LV2_KXSTUDIO_PROPERTIES__TimePositionTicksPerBeat) == 0)
-                            skip = true;
-                    }
-
-                    lilv_node_free(designationNode);
-
-                    if (skip)
-                        continue;
-                }
-
-                if (isInput)
-                    ++(info.parameterIns);
-                else
-                    ++(info.parameterOuts);
-            }
-            else if (lilvPort.is_a(lv2World.port_audio))
-            {
-                if (isInput)
-                    ++(info.audioIns);
-                else
-                    ++(info.audioOuts);
-            }
-            else if (lilvPort.is_a(lv2World.port_cv))
-            {
-            }
-            else if (lilvPort.is_a(lv2World.port_atom))
-            {
-                Lilv::Nodes supportNodes(lilvPort.get_value(lv2World.atom_supports));
-
-                for (LilvIter *it = lilv_nodes_begin(supportNodes.me); ! lilv_nodes_is_end(supportNodes.me, it); it = lilv_nodes_next(supportNodes.me, it))
-                {
-                    const Lilv::Node node(lilv_nodes_get(supportNodes.me, it));
-                    CARLA_SAFE_ASSERT_CONTINUE(node.is_uri());
-
-                    if (node.equals(lv2World.midi_event))
-                    {
-                        if (isInput)
-                            ++(info.midiIns);
-                        else
-                            ++(info.midiOuts);
-                    }
-                }
-
-                lilv_nodes_free(const_cast<LilvNodes*>(supportNodes.me));
-            }
-            else if (lilvPort.is_a(lv2World.port_event))
-            {
-                if (lilvPort.supports_event(lv2World.midi_event))
-                {
-                    if (isInput)
-                        ++(info.midiIns);
-                    else
-                        ++(info.midiOuts);
-                }
-            }
-            else if (lilvPort.is_a(lv2World.port_midi))
-            {
-                if (isInput)
-                    ++(info.midiIns);
-                else
-                    ++(info.midiOuts);
-            }
-        }
-
-        // text data
-        static CarlaString suri, sname, smaker, slicense;
-        suri.clear(); sname.clear(); smaker.clear(); slicense.clear();
-
-        suri = lilvPlugin.get_uri().as_uri();
-
-        if (LilvNode* const nameNode = lilv_plugin_get_name(lilvPlugin.me))
+        if (lv2Cache.isUpToDate())
         {
-            if (const char* const name = lilv_node_as_string(nameNode))
-                sname = name;
-            lilv_node_free(nameNode);
+            const Lv2CachePluginInfo* const cacheInfo(lv2Cache.getPluginFromIndex(index));
+            CARLA_SAFE_ASSERT_BREAK(cacheInfo != nullptr);
+
+            info.category      = static_cast<CB::PluginCategory>(cacheInfo->category);
+            info.hints         = cacheInfo->hints;
+            info.audioIns      = cacheInfo->audioIns;
+            info.audioOuts     = cacheInfo->audioOuts;
+            info.midiIns       = cacheInfo->midiIns;
+            info.midiOuts      = cacheInfo->midiOuts;
+            info.parameterIns  = cacheInfo->parameterIns;
+            info.parameterOuts = cacheInfo->parameterOuts;
+            info.name          = cacheInfo->name != nullptr ? cacheInfo->name : gNullCharPtr;
+            info.label         = cacheInfo->uri;
+            info.maker         = cacheInfo->maker != nullptr ? cacheInfo->maker : gNullCharPtr;
+            info.copyright     = cacheInfo->copyright != nullptr ? cacheInfo->copyright : gNullCharPtr;
+            return &info;
         }
 
-        if (const char* const author = lilvPlugin.get_author_name().as_string())
-            smaker = author;
-
-        Lilv::Nodes licenseNodes(lilvPlugin.get_value(lv2World.doap_license));
-
-        if (licenseNodes.size() > 0)
-        {
-            if (const char* const license = licenseNodes.get_first().as_string())
-                slicense = license;
-        }
+        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
 
-        lilv_nodes_free(const_cast<LilvNodes*>(licenseNodes.me));
+        const LilvPlugin* const cPlugin(lv2World.getPluginFromIndex(index));
+        CARLA_SAFE_ASSERT_BREAK(cPlugin != nullptr);
 
-        info.name      = sname;
-        info.label     = suri;
-        info.maker     = smaker;
-        info.copyright = slicense;
+        if (! carla_fill_lv2_cached_plugin_info(info, cPlugin))
+            break;
 
         return &info;
     }
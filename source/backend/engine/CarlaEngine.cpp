@@ -31,11 +31,14 @@
 #include "CarlaMathUtils.hpp"
 #include "CarlaPipeUtils.hpp"
 #include "CarlaStateUtils.hpp"
+#include "CarlaThread.hpp"
 #include "CarlaMIDI.h"
 
 #include "jackbridge/JackBridge.hpp"
 
 #include "water/files/File.h"
+#include "water/files/FileOutputStream.h"
+#include "water/files/TemporaryFile.h"
 #include "water/streams/MemoryOutputStream.h"
 #include "water/xml/XmlDocument.h"
 #include "water/xml/XmlElement.h"
@@ -43,9 +46,11 @@
 using water::Array;
 using water::CharPointer_UTF8;
 using water::File;
+using water::FileOutputStream;
 using water::MemoryOutputStream;
 using water::String;
 using water::StringArray;
+using water::TemporaryFile;
 using water::XmlDocument;
 using water::XmlElement;
 
@@ -81,6 +86,7 @@ uint CarlaEngine::getDriverCount()
 
 #ifndef BUILD_BRIDGE
     count += getRtAudioApiCount();
+    count += 1; // offline
 #endif
 
     return count;
@@ -102,6 +108,9 @@ const char* CarlaEngine::getDriverName(const uint index2)
             return getRtAudioApiName(index);
         index -= count;
     }
+
+    if (index-- == 0)
+        return "Offline";
 #endif
 
     carla_stderr("CarlaEngine::getDriverName(%i) - invalid index", index2);
@@ -127,6 +136,9 @@ const char* const* CarlaEngine::getDriverDeviceNames(const uint index2)
             return getRtAudioApiDeviceNames(index);
         index -= count;
     }
+
+    if (index-- == 0)
+        return getOfflineDeviceNames();
 #endif
 
     carla_stderr("CarlaEngine::getDriverDeviceNames(%i) - invalid index", index2);
@@ -156,6 +168,9 @@ const EngineDriverDeviceInfo* CarlaEngine::getDriverDeviceInfo(const uint index2
             return getRtAudioDeviceInfo(index, deviceName);
         index -= count;
     }
+
+    if (index-- == 0)
+        return getOfflineDeviceInfo();
 #endif
 
     carla_stderr("CarlaEngine::getDriverDeviceNames(%i, \"%s\") - invalid index", index2, deviceName);
@@ -204,6 +219,12 @@ CarlaEngine* CarlaEngine::newDriverByName(const char* const driverName)
         return newRtAudio(AUDIO_API_DIRECTSOUND);
     if (std::strcmp(driverName, "WASAPI") == 0)
         return newRtAudio(AUDIO_API_WASAPI);
+
+    // -------------------------------------------------------------------
+    // offline
+
+    if (std::strcmp(driverName, "Offline") == 0)
+        return newOffline();
 #endif
 
     carla_stderr("CarlaEngine::newDriverByName(\"%s\") - invalid driver name", driverName);
@@ -240,6 +261,10 @@ bool CarlaEngine::close()
 {
     carla_debug("CarlaEngine::close()");
 
+#ifndef BUILD_BRIDGE
+    pData->clearPluginTransaction();
+#endif
+
     if (pData->curPluginCount != 0)
     {
         pData->aboutToClose = true;
@@ -313,6 +338,29 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
     CARLA_SAFE_ASSERT_RETURN_ERR((filename != nullptr && filename[0] != '\0') || (label != nullptr && label[0] != '\0'), "Invalid plugin filename and label");
     carla_debug("CarlaEngine::addPlugin(%i:%s, %i:%s, \"%s\", \"%s\", \"%s\", " P_INT64 ", %p, %u)", btype, BinaryType2Str(btype), ptype, PluginType2Str(ptype), filename, name, label, uniqueId, extra, options);
 
+#ifndef BUILD_BRIDGE
+    if (pData->transaction.active)
+    {
+        EnginePluginTransaction& transaction(pData->transaction);
+
+        CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextPluginId == pData->maxPluginNumber, "Cannot replace plugins during a transaction");
+
+        if (transaction.count == pData->maxPluginNumber)
+        {
+            setLastError("Maximum number of plugins reached");
+            return false;
+        }
+
+        CarlaPlugin* const plugin = createPlugin(transaction.count, btype, ptype, filename, name, label, uniqueId, extra, options);
+
+        if (plugin == nullptr)
+            return false;
+
+        transaction.plugins[transaction.count++] = plugin;
+        return true;
+    }
+#endif
+
     uint id;
 
 #ifndef BUILD_BRIDGE
@@ -343,6 +391,71 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
 #endif
     }
 
+    CarlaPlugin* const plugin = createPlugin(id, btype, ptype, filename, name, label, uniqueId, extra, options);
+
+    if (plugin == nullptr)
+        return false;
+
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+    plugin->registerToOscClient();
+#endif
+
+    EnginePluginData& pluginData(pData->plugins[id]);
+    pluginData.plugin      = plugin;
+    pluginData.insPeak[0]  = 0.0f;
+    pluginData.insPeak[1]  = 0.0f;
+    pluginData.outsPeak[0] = 0.0f;
+    pluginData.outsPeak[1] = 0.0f;
+
+#ifndef BUILD_BRIDGE
+    if (oldPlugin != nullptr)
+    {
+        CARLA_SAFE_ASSERT(! pData->loadingProject);
+
+        const ScopedThreadStopper sts(this);
+
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+            pData->graph.replacePlugin(oldPlugin, plugin);
+
+        const bool  wasActive = oldPlugin->getInternalParameterValue(PARAMETER_ACTIVE) >= 0.5f;
+        const float oldDryWet = oldPlugin->getInternalParameterValue(PARAMETER_DRYWET);
+        const float oldVolume = oldPlugin->getInternalParameterValue(PARAMETER_VOLUME);
+
+        delete oldPlugin;
+
+        if (plugin->getHints() & PLUGIN_CAN_DRYWET)
+            plugin->setDryWet(oldDryWet, true, true);
+
+        if (plugin->getHints() & PLUGIN_CAN_VOLUME)
+            plugin->setVolume(oldVolume, true, true);
+
+        plugin->setActive(wasActive, true, true);
+        plugin->setEnabled(true);
+
+        callback(ENGINE_CALLBACK_RELOAD_ALL, id, 0, 0, 0.0f, nullptr);
+    }
+    else if (! pData->loadingProject)
+#endif
+    {
+        plugin->setActive(true, true, false);
+        plugin->setEnabled(true);
+
+        ++pData->curPluginCount;
+        callback(ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0.0f, plugin->getName());
+
+#ifndef BUILD_BRIDGE
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+            pData->graph.addPlugin(plugin);
+#endif
+    }
+
+    return true;
+}
+
+CarlaPlugin* CarlaEngine::createPlugin(const uint id, const BinaryType btype, const PluginType ptype,
+                                       const char* const filename, const char* const name, const char* const label, const int64_t uniqueId,
+                                       const void* const extra, const uint options)
+{
     CarlaPlugin::Initializer initializer = {
         this,
         id,
@@ -505,7 +618,7 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
         else
         {
             setLastError("This Carla build cannot handle this binary");
-            return false;
+            return nullptr;
         }
     }
     else
@@ -579,7 +692,7 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
     }
 
     if (plugin == nullptr)
-        return false;
+        return nullptr;
 
     plugin->reload();
 
@@ -616,75 +729,46 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
     if (! canRun)
     {
         delete plugin;
-        return false;
+        return nullptr;
     }
-
-# ifdef HAVE_LIBLO
-    plugin->registerToOscClient();
-# endif
 #endif
 
-    EnginePluginData& pluginData(pData->plugins[id]);
-    pluginData.plugin      = plugin;
-    pluginData.insPeak[0]  = 0.0f;
-    pluginData.insPeak[1]  = 0.0f;
-    pluginData.outsPeak[0] = 0.0f;
-    pluginData.outsPeak[1] = 0.0f;
+    return plugin;
+}
 
+bool CarlaEngine::addPlugin(const PluginType ptype, const char* const filename, const char* const name, const char* const label, const int64_t uniqueId, const void* const extra)
+{
+    return addPlugin(BINARY_NATIVE, ptype, filename, name, label, uniqueId, extra, 0x0);
+}
+
+bool CarlaEngine::removePlugin(const uint id)
+{
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->isIdling == 0, "An operation is still being processed, please wait for it to finish");
 #ifndef BUILD_BRIDGE
-    if (oldPlugin != nullptr)
+    if (pData->transaction.active)
     {
-        CARLA_SAFE_ASSERT(! pData->loadingProject);
+        EnginePluginTransaction& transaction(pData->transaction);
 
-        const ScopedThreadStopper sts(this);
+        CARLA_SAFE_ASSERT_RETURN_ERR(id < transaction.count, "Invalid plugin Id");
+        carla_debug("CarlaEngine::removePlugin(%i) - transaction", id);
 
-        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
-            pData->graph.replacePlugin(oldPlugin, plugin);
+        CarlaPlugin* const plugin(transaction.plugins[id]);
+        CARLA_SAFE_ASSERT_RETURN_ERR(plugin != nullptr, "Could not find plugin to remove");
 
-        const bool  wasActive = oldPlugin->getInternalParameterValue(PARAMETER_ACTIVE) >= 0.5f;
-        const float oldDryWet = oldPlugin->getInternalParameterValue(PARAMETER_DRYWET);
-        const float oldVolume = oldPlugin->getInternalParameterValue(PARAMETER_VOLUME);
-
-        delete oldPlugin;
+        --transaction.count;
 
-        if (plugin->getHints() & PLUGIN_CAN_DRYWET)
-            plugin->setDryWet(oldDryWet, true, true);
-
-        if (plugin->getHints() & PLUGIN_CAN_VOLUME)
-            plugin->setVolume(oldVolume, true, true);
-
-        plugin->setActive(wasActive, true, true);
-        plugin->setEnabled(true);
+        for (uint i=id; i < transaction.count; ++i)
+            transaction.plugins[i] = transaction.plugins[i+1];
 
-        callback(ENGINE_CALLBACK_RELOAD_ALL, id, 0, 0, 0.0f, nullptr);
-    }
-    else if (! pData->loadingProject)
-#endif
-    {
-        plugin->setActive(true, true, false);
-        plugin->setEnabled(true);
+        transaction.plugins[transaction.count] = nullptr;
 
-        ++pData->curPluginCount;
-        callback(ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0.0f, plugin->getName());
+        // plugins added during this transaction are not known to the audio thread yet
+        if (! pData->isCurrentPlugin(plugin))
+            delete plugin;
 
-#ifndef BUILD_BRIDGE
-        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
-            pData->graph.addPlugin(plugin);
-#endif
+        return true;
     }
 
-    return true;
-}
-
-bool CarlaEngine::addPlugin(const PluginType ptype, const char* const filename, const char* const name, const char* const label, const int64_t uniqueId, const void* const extra)
-{
-    return addPlugin(BINARY_NATIVE, ptype, filename, name, label, uniqueId, extra, 0x0);
-}
-
-bool CarlaEngine::removePlugin(const uint id)
-{
-    CARLA_SAFE_ASSERT_RETURN_ERR(pData->isIdling == 0, "An operation is still being processed, please wait for it to finish");
-#ifndef BUILD_BRIDGE
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->plugins != nullptr, "Invalid engine internal data");
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->curPluginCount != 0, "Invalid engine internal data");
 #endif
@@ -740,6 +824,26 @@ bool CarlaEngine::removeAllPlugins()
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextAction.opcode == kEnginePostActionNull, "Invalid engine internal data");
     carla_debug("CarlaEngine::removeAllPlugins()");
 
+#ifndef BUILD_BRIDGE
+    if (pData->transaction.active)
+    {
+        EnginePluginTransaction& transaction(pData->transaction);
+
+        for (uint i=0; i < transaction.count; ++i)
+        {
+            CarlaPlugin* const plugin(transaction.plugins[i]);
+
+            if (plugin != nullptr && ! pData->isCurrentPlugin(plugin))
+                delete plugin;
+
+            transaction.plugins[i] = nullptr;
+        }
+
+        transaction.count = 0;
+        return true;
+    }
+#endif
+
     if (pData->curPluginCount == 0)
         return true;
 
@@ -795,6 +899,7 @@ const char* CarlaEngine::renamePlugin(const uint id, const char* const newName)
     CARLA_SAFE_ASSERT_RETURN_ERRN(pData->nextAction.opcode == kEnginePostActionNull, "Invalid engine internal data");
     CARLA_SAFE_ASSERT_RETURN_ERRN(id < pData->curPluginCount, "Invalid plugin Id");
     CARLA_SAFE_ASSERT_RETURN_ERRN(newName != nullptr && newName[0] != '\0', "Invalid plugin name");
+    CARLA_SAFE_ASSERT_RETURN_ERRN(! pData->transaction.active, "Cannot rename plugins during a transaction");
     carla_debug("CarlaEngine::renamePlugin(%i, \"%s\")", id, newName);
 
     CarlaPlugin* const plugin(pData->plugins[id].plugin);
@@ -820,6 +925,7 @@ bool CarlaEngine::clonePlugin(const uint id)
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->curPluginCount != 0, "Invalid engine internal data");
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextAction.opcode == kEnginePostActionNull, "Invalid engine internal data");
     CARLA_SAFE_ASSERT_RETURN_ERR(id < pData->curPluginCount, "Invalid plugin Id");
+    CARLA_SAFE_ASSERT_RETURN_ERR(! pData->transaction.active, "Cannot clone plugins during a transaction");
     carla_debug("CarlaEngine::clonePlugin(%i)", id);
 
     CarlaPlugin* const plugin(pData->plugins[id].plugin);
@@ -862,6 +968,7 @@ bool CarlaEngine::replacePlugin(const uint id) noexcept
     }
 
     CARLA_SAFE_ASSERT_RETURN_ERR(id < pData->curPluginCount, "Invalid plugin Id");
+    CARLA_SAFE_ASSERT_RETURN_ERR(! pData->transaction.active, "Cannot replace plugins during a transaction");
 
     CarlaPlugin* const plugin(pData->plugins[id].plugin);
 
@@ -876,6 +983,23 @@ bool CarlaEngine::replacePlugin(const uint id) noexcept
 bool CarlaEngine::switchPlugins(const uint idA, const uint idB) noexcept
 {
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->isIdling == 0, "An operation is still being processed, please wait for it to finish");
+
+    if (pData->transaction.active)
+    {
+        EnginePluginTransaction& transaction(pData->transaction);
+
+        CARLA_SAFE_ASSERT_RETURN_ERR(idA != idB, "Invalid operation, cannot switch plugin with itself");
+        CARLA_SAFE_ASSERT_RETURN_ERR(idA < transaction.count, "Invalid plugin Id");
+        CARLA_SAFE_ASSERT_RETURN_ERR(idB < transaction.count, "Invalid plugin Id");
+        carla_debug("CarlaEngine::switchPlugins(%i, %i) - transaction", idA, idB);
+
+        CarlaPlugin* const tmp(transaction.plugins[idA]);
+
+        transaction.plugins[idA] = transaction.plugins[idB];
+        transaction.plugins[idB] = tmp;
+        return true;
+    }
+
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->plugins != nullptr, "Invalid engine internal data");
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->curPluginCount >= 2, "Invalid engine internal data");
     CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextAction.opcode == kEnginePostActionNull, "Invalid engine internal data");
@@ -911,6 +1035,195 @@ bool CarlaEngine::switchPlugins(const uint idA, const uint idB) noexcept
 
     return true;
 }
+
+bool CarlaEngine::beginPluginTransaction()
+{
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->isIdling == 0, "An operation is still being processed, please wait for it to finish");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->plugins != nullptr, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->transaction.plugins != nullptr, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextPluginId == pData->maxPluginNumber, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(! pData->transaction.active, "A plugin transaction is already in progress");
+    carla_debug("CarlaEngine::beginPluginTransaction()");
+
+    EnginePluginTransaction& transaction(pData->transaction);
+
+    transaction.active = true;
+    transaction.count  = pData->curPluginCount;
+
+    for (uint i=0; i < pData->curPluginCount; ++i)
+        transaction.plugins[i] = pData->plugins[i].plugin;
+
+    return true;
+}
+
+bool CarlaEngine::commitPluginTransaction()
+{
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->isIdling == 0, "An operation is still being processed, please wait for it to finish");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextPlugins != nullptr, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextAction.opcode == kEnginePostActionNull, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->transaction.active, "No plugin transaction in progress");
+    carla_debug("CarlaEngine::commitPluginTransaction()");
+
+    EnginePluginTransaction& transaction(pData->transaction);
+
+    const uint oldCount(pData->curPluginCount);
+    const uint newCount(transaction.count);
+
+    // Hosts track plugins by id. If the kept plugins are still in the same order and all new plugins come last,
+    // plain remove and add callbacks describe the change. Otherwise everything after the first changed slot
+    // is reported as removed and added again.
+    bool simpleChange = true;
+    uint firstChange  = 0;
+
+    {
+        bool seenNew    = false;
+        uint lastKeptId = 0;
+
+        for (uint i=0; i < newCount; ++i)
+        {
+            CarlaPlugin* const plugin(transaction.plugins[i]);
+
+            if (pData->isCurrentPlugin(plugin))
+            {
+                if (seenNew || plugin->getId() < lastKeptId)
+                    simpleChange = false;
+
+                lastKeptId = plugin->getId();
+            }
+            else
+            {
+                seenNew = true;
+            }
+        }
+    }
+
+    for (; firstChange < oldCount && firstChange < newCount; ++firstChange)
+    {
+        if (pData->plugins[firstChange].plugin != transaction.plugins[firstChange])
+            break;
+    }
+
+    if (firstChange == oldCount && firstChange == newCount)
+    {
+        transaction.active = false;
+        return true;
+    }
+
+    // find out which plugins are gone and which ones are new
+    bool* const removed(new bool[oldCount+1]);
+    bool* const added(new bool[newCount+1]);
+
+    for (uint i=0; i < oldCount; ++i)
+    {
+        removed[i] = true;
+
+        for (uint j=0; j < newCount; ++j)
+        {
+            if (transaction.plugins[j] == pData->plugins[i].plugin)
+            {
+                removed[i] = false;
+                break;
+            }
+        }
+    }
+
+    for (uint i=0; i < newCount; ++i)
+        added[i] = ! pData->isCurrentPlugin(transaction.plugins[i]);
+
+    const ScopedThreadStopper sts(this);
+
+    if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+    {
+        for (uint i=oldCount; i-- > 0;)
+        {
+            if (removed[i])
+                pData->graph.removePlugin(pData->plugins[i].plugin);
+        }
+    }
+
+    // prepare the new plugin list
+    for (uint i=0; i < pData->maxPluginNumber; ++i)
+    {
+        EnginePluginData& pluginData(pData->nextPlugins[i]);
+        pluginData.plugin      = i < newCount ? transaction.plugins[i] : nullptr;
+        pluginData.insPeak[0]  = 0.0f;
+        pluginData.insPeak[1]  = 0.0f;
+        pluginData.outsPeak[0] = 0.0f;
+        pluginData.outsPeak[1] = 0.0f;
+    }
+
+    for (uint i=0; i < newCount; ++i)
+    {
+        if (! added[i])
+            continue;
+
+        CarlaPlugin* const plugin(transaction.plugins[i]);
+
+        plugin->setActive(true, true, false);
+        plugin->setEnabled(true);
+    }
+
+    transaction.active = false;
+    transaction.count  = 0;
+    carla_zeroPointers(transaction.plugins, pData->maxPluginNumber);
+
+    // the audio thread picks up the whole new list at once
+    {
+        const bool lockWait(isRunning());
+        const ScopedActionLock sal(this, kEnginePostActionSwapPlugins, 0, newCount, lockWait);
+    }
+
+    // nextPlugins now holds the old list
+    EnginePluginData* const oldPlugins(pData->nextPlugins);
+
+    for (uint i=oldCount; i-- > firstChange;)
+    {
+        if (removed[i])
+            delete oldPlugins[i].plugin;
+        else if (simpleChange)
+            continue;
+
+# ifdef HAVE_LIBLO
+        if (isOscControlRegistered())
+            oscSend_control_remove_plugin(i);
+# endif
+
+        callback(ENGINE_CALLBACK_PLUGIN_REMOVED, i, 0, 0, 0.0f, nullptr);
+    }
+
+    carla_zeroStructs(oldPlugins, pData->maxPluginNumber);
+
+    for (uint i=firstChange; i < newCount; ++i)
+    {
+        if (simpleChange && ! added[i])
+            continue;
+
+        CarlaPlugin* const plugin(pData->plugins[i].plugin);
+        CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
+
+# ifdef HAVE_LIBLO
+        plugin->registerToOscClient();
+# endif
+
+        callback(ENGINE_CALLBACK_PLUGIN_ADDED, i, 0, 0, 0.0f, plugin->getName());
+    }
+
+    if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+    {
+        for (uint i=0; i < newCount; ++i)
+        {
+            if (added[i])
+                pData->graph.addPlugin(pData->plugins[i].plugin);
+        }
+
+        pData->graph.updatePluginIds();
+    }
+
+    delete[] removed;
+    delete[] added;
+
+    return true;
+}
 #endif
 
 CarlaPlugin* CarlaEngine::getPlugin(const uint id) const noexcept
@@ -1132,6 +1445,9 @@ bool CarlaEngine::loadProject(const char* const filename)
     File file(jfilename);
     CARLA_SAFE_ASSERT_RETURN_ERR(file.existsAsFile(), "Requested file does not exist or is not a readable file");
 
+    // needed to find side-car chunk files
+    pData->currentProjectFilename = filename;
+
     XmlDocument xml(file);
     return loadProjectInternal(xml);
 }
@@ -1141,17 +1457,81 @@ bool CarlaEngine::saveProject(const char* const filename)
     CARLA_SAFE_ASSERT_RETURN_ERR(filename != nullptr && filename[0] != '\0', "Invalid filename");
     carla_debug("CarlaEngine::saveProject(\"%s\")", filename);
 
-    MemoryOutputStream out;
-    saveProjectInternal(out);
-
     const String jfilename = String(CharPointer_UTF8(filename));
     File file(jfilename);
 
-    if (file.replaceWithData(out.getData(), out.getDataSize()))
-        return true;
+    MemoryOutputStream out;
 
-    setLastError("Failed to write file");
-    return false;
+    // everything is written next to the old files first, so a failed save keeps the previous project intact
+    const File chunkFile(jfilename + ".chunks");
+    const TemporaryFile tmpChunkFile(chunkFile);
+    water::int64 chunkFileSize = 0;
+
+    if (pData->options.projectChunkFiles)
+    {
+        bool chunksWritten;
+
+        {
+            FileOutputStream chunkStream(tmpChunkFile.getFile());
+            CARLA_SAFE_ASSERT_RETURN_ERR(chunkStream.openedOk(), "Failed to write chunk file");
+
+            chunksWritten = saveProjectInternal(out, &chunkStream, chunkFile.getFileName().toRawUTF8());
+
+            chunkStream.flush();
+            chunkFileSize = chunkStream.getPosition();
+
+            if (chunkStream.getStatus().failed())
+                chunksWritten = false;
+        }
+
+        // buffered writes only fail when flushed, make sure everything reached the disk
+        if (! chunksWritten || tmpChunkFile.getFile().getSize() != chunkFileSize)
+        {
+            setLastError("Failed to write chunk file");
+            return false;
+        }
+    }
+    else
+    {
+        saveProjectInternal(out);
+    }
+
+    const TemporaryFile tmpFile(file);
+
+    if (! tmpFile.getFile().appendData(out.getData(), out.getDataSize()))
+    {
+        setLastError("Failed to write file");
+        return false;
+    }
+
+    // the side-car is only touched once the new project file is ready to replace the old one
+    if (pData->options.projectChunkFiles)
+    {
+        if (chunkFileSize == 0)
+        {
+            // no chunks, remove any stale side-car from a previous save
+            chunkFile.deleteFile();
+        }
+        else if (! tmpChunkFile.overwriteTargetFileWithTemporary())
+        {
+            setLastError("Failed to write chunk file");
+            return false;
+        }
+    }
+
+    if (! tmpFile.overwriteTargetFileWithTemporary())
+    {
+        setLastError("Failed to write file");
+        return false;
+    }
+
+    pData->currentProjectFilename = filename;
+    return true;
+}
+
+const char* CarlaEngine::getCurrentProjectFilename() const noexcept
+{
+    return pData->currentProjectFilename.isNotEmpty() ? pData->currentProjectFilename.buffer() : nullptr;
 }
 
 // -----------------------------------------------------------------------
@@ -1225,6 +1605,62 @@ float CarlaEngine::getOutputPeak(const uint pluginId, const bool isLeft) const n
     return pData->plugins[pluginId].outsPeak[isLeft ? 0 : 1];
 }
 
+// -----------------------------------------------------------------------
+// Information (process statistics)
+
+float CarlaEngine::getDSPLoad() const noexcept
+{
+    return pData->stats.load * 100.0f;
+}
+
+uint32_t CarlaEngine::getXrunCount() const noexcept
+{
+    return pData->stats.xruns;
+}
+
+uint32_t CarlaEngine::getOverrunCount() const noexcept
+{
+    return pData->stats.overruns;
+}
+
+void CarlaEngine::getCycleProcessStats(EngineProcessStats& stats) const noexcept
+{
+    pData->stats.cycle.fill(stats);
+}
+
+bool CarlaEngine::getPluginProcessStats(const uint id, EngineProcessStats& stats) const noexcept
+{
+    stats.clear();
+
+    CARLA_SAFE_ASSERT_RETURN(id < pData->curPluginCount, false);
+
+    CarlaPlugin* const plugin(pData->plugins[id].plugin);
+    CARLA_SAFE_ASSERT_RETURN(plugin != nullptr, false);
+
+    if (CarlaEngineClient* const client = plugin->getEngineClient())
+        client->getProcessStats(stats);
+
+    return true;
+}
+
+void CarlaEngine::clearProcessStats() noexcept
+{
+    carla_debug("CarlaEngine::clearProcessStats()");
+
+    pData->stats.requestClear();
+
+    for (uint i=0; i < pData->curPluginCount; ++i)
+    {
+        CarlaPlugin* const plugin(pData->plugins[i].plugin);
+
+        if (plugin == nullptr)
+            continue;
+
+        if (CarlaEngineClient* const client = plugin->getEngineClient())
+            client->clearProcessStats();
+    }
+}
+
 // -----------------------------------------------------------------------
 // Callback
 
@@ -1235,6 +1671,19 @@ void CarlaEngine::callback(const EngineCallbackOpcode action, const uint pluginI
         carla_debug("CarlaEngine::callback(%i:%s, %i, %i, %i, %f, \"%s\")", action, EngineCallbackOpcode2Str(action), pluginId, value1, value2, value3, valueStr);
 #endif
 
+#ifndef BUILD_BRIDGE
+    if (pData->projectLoad.active)
+    {
+        // plugins loaded in parallel are not known to the host until the whole project is in, see loadProjectPluginsInParallel()
+        if (pluginId >= pData->curPluginCount && action >= ENGINE_CALLBACK_PLUGIN_RENAMED && action <= ENGINE_CALLBACK_RELOAD_ALL)
+            return;
+
+        // the host only gets callbacks from the main thread
+        if (pData->projectLoad.deferCallback(action, pluginId, value1, value2, value3, valueStr))
+            return;
+    }
+#endif
+
 #ifdef BUILD_BRIDGE
     if (pData->isIdling)
 #else
@@ -1329,6 +1778,19 @@ void CarlaEngine::transportRelocate(const uint64_t frame) noexcept
     pData->time.relocate(frame);
 }
 
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// Offline rendering
+
+bool CarlaEngine::renderToFile(const char* const filename, const uint64_t)
+{
+    CARLA_SAFE_ASSERT_RETURN_ERR(filename != nullptr && filename[0] != '\0', "Invalid filename");
+
+    setLastError("Rendering to a file requires the offline engine driver");
+    return false;
+}
+#endif
+
 // -----------------------------------------------------------------------
 // Error handling
 
@@ -1339,6 +1801,12 @@ const char* CarlaEngine::getLastError() const noexcept
 
 void CarlaEngine::setLastError(const char* const error) const noexcept
 {
+#ifndef BUILD_BRIDGE
+    // each project load thread has its own error slot
+    if (pData->projectLoad.active && pData->projectLoad.setThreadError(error))
+        return;
+#endif
+
     pData->lastError = error;
 }
 
@@ -1359,6 +1827,22 @@ bool CarlaEngine::setAboutToClose() noexcept
     return (pData->isIdling == 0);
 }
 
+// -----------------------------------------------------------------------
+// Helpers
+
+static uint getNumberOfCpus() noexcept
+{
+#ifdef CARLA_OS_WIN
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const long numCpus = static_cast<long>(info.dwNumberOfProcessors);
+#else
+    const long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return numCpus > 1 ? static_cast<uint>(numCpus) : 1;
+}
+
 // -----------------------------------------------------------------------
 // Global options
 
@@ -1613,6 +2097,58 @@ void CarlaEngine::setOption(const EngineOption option, const int value, const ch
 
     case ENGINE_OPTION_DEBUG_CONSOLE_OUTPUT:
         break;
+
+    case ENGINE_OPTION_AUDIO_WORKER_THREADS: {
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+
+        // the audio thread takes part in processing, more workers than the remaining cores only adds contention
+        const uint maxWorkers = getNumberOfCpus() - 1;
+
+        if (static_cast<uint>(value) > maxWorkers)
+        {
+            carla_stderr("CarlaEngine::setOption() - %i audio worker threads requested, limiting to %u", value, maxWorkers);
+            pData->options.audioWorkerThreads = maxWorkers;
+        }
+        else
+        {
+            pData->options.audioWorkerThreads = static_cast<uint>(value);
+        }
+    }   break;
+
+    case ENGINE_OPTION_RACK_LANES:
+        if (pData->options.rackLanes != nullptr)
+            delete[] pData->options.rackLanes;
+
+        if (valueStr != nullptr && valueStr[0] != '\0')
+            pData->options.rackLanes = carla_strdup_safe(valueStr);
+        else
+            pData->options.rackLanes = nullptr;
+        break;
+
+    case ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.pluginBridgesSpinTime = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_IDLE_MAX_INTERVAL:
+        CARLA_SAFE_ASSERT_RETURN(value >= 10 && value <= 1000,);
+        pData->options.idleMaxInterval = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_PROJECT_LOAD_THREADS:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0 && value <= 64,);
+        pData->options.projectLoadThreads = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_PROJECT_CHUNK_FILES:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        pData->options.projectChunkFiles = (value != 0);
+        break;
+
+    case ENGINE_OPTION_PROCESS_STATS:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        pData->options.processStats = (value != 0);
+        break;
     }
 }
 
@@ -1646,9 +2182,14 @@ const char* CarlaEngine::getOscServerPathUDP() const noexcept
 // -----------------------------------------------------------------------
 // Helper functions
 
-EngineEvent* CarlaEngine::getInternalEventBuffer(const bool isInput) const noexcept
+EngineEventBuffer* CarlaEngine::getInternalEventBuffer(const bool isInput) const noexcept
+{
+    return isInput ? &pData->events.in : &pData->events.out;
+}
+
+void CarlaEngine::markPluginDirty(const uint id) const noexcept
 {
-    return isInput ? pData->events.in : pData->events.out;
+    pData->thread.markPluginDirty(id);
 }
 
 // -----------------------------------------------------------------------
@@ -1735,8 +2276,11 @@ void CarlaEngine::setPluginPeaks(const uint pluginId, float const inPeaks[2], fl
     pluginData.outsPeak[1] = outPeaks[1];
 }
 
-void CarlaEngine::saveProjectInternal(water::MemoryOutputStream& outStream) const
+bool CarlaEngine::saveProjectInternal(water::MemoryOutputStream& outStream,
+                                      water::OutputStream* const chunkStream, const char* const chunkFile) const
 {
+    bool chunksWritten = true;
+
     // send initial prepareForSave first, giving time for bridges to act
     for (uint i=0; i < pData->curPluginCount; ++i)
     {
@@ -1799,7 +2343,8 @@ void CarlaEngine::saveProjectInternal(water::MemoryOutputStream& outStream) cons
         if (plugin != nullptr && plugin->isEnabled())
         {
             MemoryOutputStream outPlugin(4096), streamPlugin;
-            plugin->getStateSave(false).dumpToMemoryStream(streamPlugin);
+            if (! plugin->getStateSave(false, chunkStream != nullptr).dumpToMemoryStream(streamPlugin, chunkStream, chunkFile))
+                chunksWritten = false;
 
             outPlugin << "\n";
 
@@ -1899,6 +2444,8 @@ void CarlaEngine::saveProjectInternal(water::MemoryOutputStream& outStream) cons
 #endif
 
     outStream << "</CARLA-PROJECT>\n";
+
+    return chunksWritten;
 }
 
 static String findBinaryInCustomPath(const char* const searchPath, const char* const binary)
@@ -1965,6 +2512,383 @@ static String findBinaryInCustomPath(const char* const searchPath, const char* c
     return String();
 }
 
+// Look for plugin binaries that are not where the project says they are, and get the extra data for addPlugin().
+static const void* prepareProjectPluginLoad(CarlaStateSave& stateSave, const PluginType ptype, const EngineOptions& options)
+{
+    const void* extraStuff    = nullptr;
+    static const char kTrue[] = "true";
+
+    switch (ptype)
+    {
+    case PLUGIN_GIG:
+    case PLUGIN_SF2:
+        if (CarlaString(stateSave.label).endsWith(" (16 outs)"))
+            extraStuff = kTrue;
+        // fall through
+    case PLUGIN_LADSPA:
+    case PLUGIN_DSSI:
+    case PLUGIN_VST2:
+    case PLUGIN_SFZ:
+        if (stateSave.binary != nullptr && stateSave.binary[0] != '\0' &&
+            ! (File::isAbsolutePath(stateSave.binary) && File(stateSave.binary).exists()))
+        {
+            const char* searchPath;
+
+            switch (ptype)
+            {
+            case PLUGIN_LADSPA: searchPath = options.pathLADSPA; break;
+            case PLUGIN_DSSI:   searchPath = options.pathDSSI;   break;
+            case PLUGIN_VST2:   searchPath = options.pathVST2;   break;
+            case PLUGIN_GIG:    searchPath = options.pathGIG;    break;
+            case PLUGIN_SF2:    searchPath = options.pathSF2;    break;
+            case PLUGIN_SFZ:    searchPath = options.pathSFZ;    break;
+            default:            searchPath = nullptr;            break;
+            }
+
+            if (searchPath != nullptr && searchPath[0] != '\0')
+            {
+                carla_stderr("Plugin binary '%s' doesn't exist on this filesystem, let's look for it...",
+                             stateSave.binary);
+
+                String result = findBinaryInCustomPath(searchPath, stateSave.binary);
+
+                if (result.isEmpty())
+                {
+                    switch (ptype)
+                    {
+                    case PLUGIN_LADSPA: searchPath = std::getenv("LADSPA_PATH"); break;
+                    case PLUGIN_DSSI:   searchPath = std::getenv("DSSI_PATH");   break;
+                    case PLUGIN_VST2:   searchPath = std::getenv("VST_PATH");    break;
+                    case PLUGIN_GIG:    searchPath = std::getenv("GIG_PATH");    break;
+                    case PLUGIN_SF2:    searchPath = std::getenv("SF2_PATH");    break;
+                    case PLUGIN_SFZ:    searchPath = std::getenv("SFZ_PATH");    break;
+                    default:            searchPath = nullptr;                    break;
+                    }
+
+                    if (searchPath != nullptr && searchPath[0] != '\0')
+                        result = findBinaryInCustomPath(searchPath, stateSave.binary);
+                }
+
+                if (result.isNotEmpty())
+                {
+                    delete[] stateSave.binary;
+                    stateSave.binary = carla_strdup(result.toRawUTF8());
+                    carla_stderr("Found it! :)");
+                }
+                else
+                {
+                    carla_stderr("Damn, we failed... :(");
+                }
+            }
+        }
+        break;
+    default:
+        break;
+    }
+
+    return extraStuff;
+}
+
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// Parallel project loading
+
+static const uint kMaxProjectLoadThreads = 16;
+
+static uint getProjectLoadThreadCount(const uint option) noexcept
+{
+    if (option != 0)
+        return carla_minPositive(option, kMaxProjectLoadThreads);
+
+    return carla_minPositive(getNumberOfCpus(), kMaxProjectLoadThreads);
+}
+
+// Native VST2 plugins expect to be created on the host main thread (see CarlaPluginVST2's fMainThread),
+// internal plugins can host whole engines, LinuxSampler kits share a single sampler instance
+// and JACK applications are started by the host. Everything else can be loaded from any thread.
+static bool canLoadPluginInParallel(const BinaryType btype, const PluginType ptype) noexcept
+{
+    switch (ptype)
+    {
+    case PLUGIN_LADSPA:
+    case PLUGIN_DSSI:
+    case PLUGIN_LV2:
+    case PLUGIN_SF2:
+        return true;
+    case PLUGIN_VST2:
+        // always bridged, runs in another process
+        return btype != BINARY_NATIVE;
+    default:
+        return false;
+    }
+}
+
+struct ProjectPluginLoad {
+    CarlaStateSave stateSave;
+    BinaryType     btype;
+    PluginType     ptype;
+    const void*    extra;
+    bool           onMainThread;
+    CarlaPlugin*   plugin;
+    CarlaString    error;
+
+    ProjectPluginLoad() noexcept
+        : stateSave(),
+          btype(BINARY_NONE),
+          ptype(PLUGIN_NONE),
+          extra(nullptr),
+          onMainThread(true),
+          plugin(nullptr),
+          error() {}
+
+    CARLA_DECLARE_NON_COPY_STRUCT(ProjectPluginLoad)
+};
+
+class ProjectLoadThread : public CarlaThread
+{
+public:
+    ProjectLoadThread(CarlaEngine* const engine, ProjectPluginLoad* const loads, const uint count, volatile uint* const nextLoad) noexcept
+        : CarlaThread("CarlaProjectLoad"),
+          kEngine(engine),
+          fLoads(loads),
+          fCount(count),
+          fNextLoad(nextLoad),
+          fError() {}
+
+    // Create plugin for slot @a id and restore its state, used both by the threads and the main thread.
+    // Returns false if the plugin could not be created, leaving the reason in the caller's error slot.
+    static bool loadPlugin(CarlaEngine* const engine, ProjectPluginLoad& load, const uint id)
+    {
+        if (engine->pData->aboutToClose)
+            return true;
+
+        const CarlaStateSave& stateSave(load.stateSave);
+
+        load.plugin = engine->createPlugin(id, load.btype, load.ptype, stateSave.binary,
+                                           stateSave.name, stateSave.label, stateSave.uniqueId, load.extra, stateSave.options);
+
+        if (load.plugin == nullptr)
+            return false;
+
+        // deactivate bridge client-side ping check, since some plugins block during load
+        if ((load.plugin->getHints() & PLUGIN_IS_BRIDGE) != 0)
+            load.plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
+
+        load.plugin->loadStateSave(stateSave);
+        return true;
+    }
+
+protected:
+    void run() override
+    {
+        const uint firstId = kEngine->pData->curPluginCount;
+        EngineProjectLoad& projectLoad(kEngine->pData->projectLoad);
+
+        projectLoad.addThread(&fError);
+
+        for (uint index; (index = __sync_fetch_and_add(fNextLoad, 1)) < fCount;)
+        {
+            ProjectPluginLoad& load(fLoads[index]);
+
+            if (load.onMainThread)
+                continue;
+
+            fError.clear();
+
+            if (! loadPlugin(kEngine, load, firstId + index))
+                load.error = fError;
+        }
+
+        projectLoad.removeThread();
+    }
+
+private:
+    CarlaEngine* const kEngine;
+    ProjectPluginLoad* const fLoads;
+    const uint fCount;
+    volatile uint* const fNextLoad;
+    CarlaString fError;
+
+    CARLA_DECLARE_NON_COPY_CLASS(ProjectLoadThread)
+};
+
+bool CarlaEngine::loadProjectPluginsInParallel(XmlElement* const xmlElement, const uint numThreads)
+{
+    CARLA_SAFE_ASSERT_RETURN(xmlElement != nullptr, true);
+
+    const uint firstId = pData->curPluginCount;
+    uint count = 0;
+
+    for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
+    {
+        if (elem->getTagName().equalsIgnoreCase("plugin"))
+            ++count;
+    }
+
+    if (count == 0)
+        return true;
+
+    ProjectPluginLoad* const loads = new ProjectPluginLoad[count];
+    uint numParallel = 0;
+
+    // parse everything first, on the main thread
+    {
+        uint index = 0;
+
+        for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
+        {
+            if (! elem->getTagName().equalsIgnoreCase("plugin"))
+                continue;
+
+            ProjectPluginLoad& load(loads[index++]);
+            load.stateSave.fillFromXmlElement(elem);
+
+            CARLA_SAFE_ASSERT_CONTINUE(load.stateSave.type != nullptr);
+
+            if (firstId + index > pData->maxPluginNumber)
+            {
+                load.error = "Maximum number of plugins reached";
+                continue;
+            }
+
+            load.ptype = getPluginTypeFromString(load.stateSave.type);
+            load.extra = prepareProjectPluginLoad(load.stateSave, load.ptype, pData->options);
+            load.btype = getBinaryTypeFromFile(load.stateSave.binary);
+
+            if (canLoadPluginInParallel(load.btype, load.ptype))
+            {
+                load.onMainThread = false;
+                ++numParallel;
+            }
+        }
+    }
+
+    const uint numThreadsNeeded = numParallel != 0 ? carla_minPositive(numThreads, numParallel) : 0;
+
+    carla_stdout("Loading %u plugins, %u of them using %u threads", count, numParallel, numThreadsNeeded);
+
+    // plugins that are still loading are not known to the host, skip or defer their callbacks
+    pData->projectLoad.active = true;
+
+    volatile uint nextLoad = 0;
+    LinkedList<ProjectLoadThread*> threads;
+
+    for (uint i=0; i < numThreadsNeeded; ++i)
+    {
+        ProjectLoadThread* const thread(new ProjectLoadThread(this, loads, count, &nextLoad));
+        thread->startThread();
+        threads.append(thread);
+    }
+
+    // plugins that need the main thread, in project order
+    for (uint i=0; i < count; ++i)
+    {
+        ProjectPluginLoad& load(loads[i]);
+
+        if (! load.onMainThread || load.ptype == PLUGIN_NONE)
+            continue;
+
+        callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+
+        if (! ProjectLoadThread::loadPlugin(this, load, firstId + i))
+            load.error = pData->lastError;
+    }
+
+    // keep the host responsive while waiting for the threads
+    for (LinkedList<ProjectLoadThread*>::Itenerator it = threads.begin2(); it.valid(); it.next())
+    {
+        ProjectLoadThread* const thread(it.getValue(nullptr));
+        CARLA_SAFE_ASSERT_CONTINUE(thread != nullptr);
+
+        while (thread->isThreadRunning())
+        {
+            callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+            carla_msleep(10);
+        }
+
+        thread->stopThread(-1);
+        delete thread;
+    }
+
+    threads.clear();
+    pData->projectLoad.active = false;
+
+    // deliver what the threads reported while loading, plugin-specific callbacks were already skipped
+    for (LinkedList<EngineProjectLoad::Callback>::Itenerator it = pData->projectLoad.callbacks.begin2(); it.valid(); it.next())
+    {
+        static const EngineProjectLoad::Callback kCallbackFallback = { ENGINE_CALLBACK_DEBUG, 0, 0, 0, 0.0f, nullptr };
+
+        const EngineProjectLoad::Callback& cb(it.getValue(kCallbackFallback));
+
+        callback(cb.action, cb.pluginId, cb.value1, cb.value2, cb.value3, cb.valueStr);
+
+        delete[] cb.valueStr;
+    }
+
+    pData->projectLoad.callbacks.clear();
+
+    if (pData->aboutToClose)
+    {
+        for (uint i=0; i < count; ++i)
+            delete loads[i].plugin;
+
+        delete[] loads;
+        return false;
+    }
+
+    // add the new plugins to the engine, skipping the ones that failed
+    uint newCount = firstId;
+
+    for (uint i=0; i < count; ++i)
+    {
+        ProjectPluginLoad& load(loads[i]);
+
+        if (load.plugin == nullptr)
+        {
+            if (load.error.isNotEmpty())
+                carla_stderr2("Failed to load a plugin, error was:\n%s", load.error.buffer());
+            continue;
+        }
+
+        const uint id = newCount++;
+
+        if (load.plugin->getId() != id)
+            load.plugin->setId(id);
+
+        EnginePluginData& pluginData(pData->plugins[id]);
+        pluginData.plugin      = load.plugin;
+        pluginData.insPeak[0]  = 0.0f;
+        pluginData.insPeak[1]  = 0.0f;
+        pluginData.outsPeak[0] = 0.0f;
+        pluginData.outsPeak[1] = 0.0f;
+
+        load.plugin->setEnabled(true);
+    }
+
+    // the audio thread sees all of them at once
+    __sync_synchronize();
+    pData->curPluginCount = newCount;
+
+    for (uint id=firstId; id < newCount; ++id)
+    {
+        CarlaPlugin* const plugin(pData->plugins[id].plugin);
+
+# ifdef HAVE_LIBLO
+        plugin->registerToOscClient();
+# endif
+        callback(ENGINE_CALLBACK_PLUGIN_ADDED, id, 0, 0, 0.0f, plugin->getName());
+
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+            pData->graph.addPlugin(plugin);
+    }
+
+    delete[] loads;
+    return true;
+}
+#endif // BUILD_BRIDGE
+
+// -----------------------------------------------------------------------
+
 bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc)
 {
     ScopedPointer<XmlElement> xmlElement(xmlDoc.getDocumentElement(true));
@@ -2101,6 +3025,20 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc)
         return true;
 
     // handle plugins first
+#ifndef BUILD_BRIDGE
+    // in single and multi-client modes every plugin registers its own JACK ports while loading,
+    // which must happen on the main thread
+    const bool canLoadInParallel = !isPreset && (pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK ||
+                                                 pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY);
+    const uint loadThreads = canLoadInParallel ? getProjectLoadThreadCount(pData->options.projectLoadThreads) : 1;
+
+    if (loadThreads > 1)
+    {
+        if (! loadProjectPluginsInParallel(xmlElement.get(), loadThreads))
+            return true;
+    }
+    else
+#endif
     for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
     {
         const String& tagName(elem->getTagName());
@@ -2117,78 +3055,8 @@ bool CarlaEngine::loadProjectInternal(water::XmlDocument& xmlDoc)
 
             CARLA_SAFE_ASSERT_CONTINUE(stateSave.type != nullptr);
 
-            const void* extraStuff    = nullptr;
-            static const char kTrue[] = "true";
-
             const PluginType ptype(getPluginTypeFromString(stateSave.type));
-
-            switch (ptype)
-            {
-            case PLUGIN_GIG:
-            case PLUGIN_SF2:
-                if (CarlaString(stateSave.label).endsWith(" (16 outs)"))
-                    extraStuff = kTrue;
-                // fall through
-            case PLUGIN_LADSPA:
-            case PLUGIN_DSSI:
-            case PLUGIN_VST2:
-            case PLUGIN_SFZ:
-                if (stateSave.binary != nullptr && stateSave.binary[0] != '\0' &&
-                    ! (File::isAbsolutePath(stateSave.binary) && File(stateSave.binary).exists()))
-                {
-                    const char* searchPath;
-
-                    switch (ptype)
-                    {
-                    case PLUGIN_LADSPA: searchPath = pData->options.pathLADSPA; break;
-                    case PLUGIN_DSSI:   searchPath = pData->options.pathDSSI;   break;
-                    case PLUGIN_VST2:   searchPath = pData->options.pathVST2;   break;
-                    case PLUGIN_GIG:    searchPath = pData->options.pathGIG;    break;
-                    case PLUGIN_SF2:    searchPath = pData->options.pathSF2;    break;
-                    case PLUGIN_SFZ:    searchPath = pData->options.pathSFZ;    break;
-                    default:            searchPath = nullptr;                   break;
-                    }
-
-                    if (searchPath != nullptr && searchPath[0] != '\0')
-                    {
-                        carla_stderr("Plugin binary '%s' doesn't exist on this filesystem, let's look for it...",
-                                     stateSave.binary);
-
-                        String result = findBinaryInCustomPath(searchPath, stateSave.binary);
-
-                        if (result.isEmpty())
-                        {
-                            switch (ptype)
-                            {
-                            case PLUGIN_LADSPA: searchPath = std::getenv("LADSPA_PATH"); break;
-                            case PLUGIN_DSSI:   searchPath = std::getenv("DSSI_PATH");   break;
-                            case PLUGIN_VST2:   searchPath = std::getenv("VST_PATH");    break;
-                            case PLUGIN_GIG:    searchPath = std::getenv("GIG_PATH");    break;
-                            case PLUGIN_SF2:    searchPath = std::getenv("SF2_PATH");    break;
-                            case PLUGIN_SFZ:    searchPath = std::getenv("SFZ_PATH");    break;
-                            default:            searchPath = nullptr;                    break;
-                            }
-
-                            if (searchPath != nullptr && searchPath[0] != '\0')
-                                result = findBinaryInCustomPath(searchPath, stateSave.binary);
-                        }
-
-                        if (result.isNotEmpty())
-                        {
-                            delete[] stateSave.binary;
-                            stateSave.binary = carla_strdup(result.toRawUTF8());
-                            carla_stderr("Found it! :)");
-                        }
-                        else
-                        {
-                            carla_stderr("Damn, we failed... :(");
-                        }
-                    }
-                }
-                break;
-            default:
-                break;
-            }
+            const void* const extraStuff = prepareProjectPluginLoad(stateSave, ptype, pData->options);
 
             if (addPlugin(getBinaryTypeFromFile(stateSave.binary), ptype, stateSave.binary,
                           stateSave.name, stateSave.label, stateSave.uniqueId, extraStuff, stateSave.options))
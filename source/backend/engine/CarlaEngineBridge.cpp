@@ -806,6 +806,36 @@ public:
                 break;
             }
 
+            case kPluginBridgeNonRtClientSetChunkDataShm: {
+                const uint32_t size(fShmNonRtClientControl.readUInt());
+                CARLA_SAFE_ASSERT_BREAK(size > 0);
+
+                char basename[size+1];
+                carla_zeroChars(basename, size+1);
+                fShmNonRtClientControl.readCustomData(basename, size);
+
+                const uint64_t dataSize(fShmNonRtClientControl.readULong());
+
+                if (plugin != nullptr && plugin->isEnabled() && dataSize > 0)
+                {
+                    BridgeChunkPool chunkPool;
+
+                    if (chunkPool.attachClient(basename, static_cast<std::size_t>(dataSize)))
+                        plugin->setChunkData(chunkPool.data, chunkPool.dataSize);
+                    else
+                        carla_stderr("Failed to attach to chunk shared memory");
+
+                    chunkPool.clear();
+                }
+
+                // always reply, so the server can reuse its pool
+                const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
+
+                fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerChunkDataShmReleased);
+                fShmNonRtServerControl.commitWrite();
+                break;
+            }
+
             case kPluginBridgeNonRtClientSetCtrlChannel: {
                 const int16_t channel(fShmNonRtClientControl.readShort());
                 CARLA_SAFE_ASSERT_BREAK(channel >= -1 && channel < MAX_MIDI_CHANNELS);
@@ -866,22 +896,20 @@ public:
                     {
                         CARLA_SAFE_ASSERT_BREAK(data != nullptr);
 
-                        CarlaString dataBase64 = CarlaString::asBase64(data, dataSize);
-                        CARLA_SAFE_ASSERT_BREAK(dataBase64.length() > 0);
-
                         String filePath(File::getSpecialLocation(File::tempDirectory).getFullPathName());
 
                         filePath += CARLA_OS_SEP_STR;
                         filePath += ".CarlaChunk_";
                         filePath += fShmNonRtClientControl.filename.buffer() + 24;
 
-                        if (File(filePath).replaceWithText(dataBase64.buffer()))
+                        // raw binary, no need for base64 here
+                        if (File(filePath).replaceWithData(data, dataSize))
                         {
                             const uint32_t ulength(static_cast<uint32_t>(filePath.length()));
 
                             const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
 
-                            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerSetChunkDataFile);
+                            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerSetChunkDataBinaryFile);
                             fShmNonRtServerControl.writeUInt(ulength);
                             fShmNonRtServerControl.writeCustomData(filePath.toRawUTF8(), ulength);
                             fShmNonRtServerControl.commitWrite();
@@ -1209,17 +1237,13 @@ protected:
                     carla_zeroBytes(midiData, kBridgeBaseMidiOutHeaderSize);
                     std::size_t curMidiDataPos = 0;
 
-                    if (pData->events.in[0].type != kEngineEventTypeNull)
-                        carla_zeroStructs(pData->events.in, kMaxEngineEventInternalCount);
+                    pData->events.in.clear();
 
-                    if (pData->events.out[0].type != kEngineEventTypeNull)
+                    if (pData->events.out.count != 0)
                     {
-                        for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+                        for (uint32_t i=0; i < pData->events.out.count; ++i)
                         {
-                            const EngineEvent& event(pData->events.out[i]);
-
-                            if (event.type == kEngineEventTypeNull)
-                                break;
+                            const EngineEvent& event(pData->events.out.data[i]);
 
                             if (event.type == kEngineEventTypeControl)
                             {
@@ -1280,7 +1304,7 @@ protected:
                             curMidiDataPos + kBridgeBaseMidiOutHeaderSize < kBridgeRtClientDataMidiOutSize)
                             carla_zeroBytes(midiData, kBridgeBaseMidiOutHeaderSize);
 
-                        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+                        pData->events.out.clear();
                     }
 
                 }   break;
@@ -1311,14 +1335,12 @@ protected:
     // called from process thread above
     EngineEvent* getNextFreeInputEvent() const noexcept
     {
-        for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
-        {
-            EngineEvent* const event(&pData->events.in[i]);
+        EngineEventBuffer& eventsIn(pData->events.in);
 
-            if (event->type == kEngineEventTypeNull)
-                return event;
-        }
-        return nullptr;
+        if (eventsIn.isFull())
+            return nullptr;
+
+        return &eventsIn.data[eventsIn.count++];
     }
 
     void latencyChanged(const uint32_t samples) noexcept override
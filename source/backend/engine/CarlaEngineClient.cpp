@@ -1,6 +1,6 @@
 /*
  * Carla Plugin Host
- * Copyright (C) 2011-2014 Filipe Coelho <falktx@falktx.com>
+ * Copyright (C) 2011-2018 Filipe Coelho <falktx@falktx.com>
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License as
@@ -38,6 +38,8 @@ struct CarlaEngineClient::ProtectedData {
     CarlaStringList eventInList;
     CarlaStringList eventOutList;
 
+    EngineProcessTimeStats processStats;
+
     ProtectedData(const CarlaEngine& eng) noexcept
         :  engine(eng),
            active(false),
@@ -47,7 +49,8 @@ struct CarlaEngineClient::ProtectedData {
            cvInList(),
            cvOutList(),
            eventInList(),
-           eventOutList() {}
+           eventOutList(),
+           processStats() {}
 
 #ifdef CARLA_PROPER_CPP11_SUPPORT
     ProtectedData() = delete;
@@ -163,6 +166,26 @@ const char* CarlaEngineClient::getEventPortName(const bool isInput, const uint i
     return portList.getAt(index);
 }
 
+uint CarlaEngineClient::getEventPortCount(const bool isInput) const noexcept
+{
+    return static_cast<uint>((isInput ? pData->eventInList : pData->eventOutList).count());
+}
+
+void CarlaEngineClient::addProcessTime(const uint64_t nanoseconds) noexcept
+{
+    pData->processStats.addTime(nanoseconds);
+}
+
+void CarlaEngineClient::getProcessStats(EngineProcessStats& stats) const noexcept
+{
+    pData->processStats.fill(stats);
+}
+
+void CarlaEngineClient::clearProcessStats() noexcept
+{
+    pData->processStats.requestClear();
+}
+
 void CarlaEngineClient::_addAudioPortName(const bool isInput, const char* const name)
 {
     CARLA_SAFE_ASSERT_RETURN(name != nullptr && name[0] != '\0',);
@@ -15,7 +15,7 @@
  * For a full copy of the GNU General Public License see the doc/GPL.txt file.
  */
 
-#include "CarlaEngine.hpp"
+#include "CarlaEngineUtils.hpp"
 #include "CarlaMathUtils.hpp"
 #include "CarlaMIDI.h"
 
@@ -179,6 +179,79 @@ void EngineEvent::fillFromMidiData(const uint8_t size, const uint8_t* const data
     }
 }
 
+// -----------------------------------------------------------------------
+// EngineEventBuffer
+
+void EngineEventBuffer::allocate()
+{
+    count = 0;
+
+    if (data == nullptr)
+        data = new EngineEvent[kMaxEngineEventInternalCount];
+}
+
+void EngineEventBuffer::deallocate() noexcept
+{
+    count = 0;
+
+    if (data != nullptr)
+    {
+        delete[] data;
+        data = nullptr;
+    }
+}
+
+bool EngineEventBuffer::isFull() const noexcept
+{
+    return count >= kMaxEngineEventInternalCount;
+}
+
+void EngineEventBuffer::copyFrom(const EngineEventBuffer& other) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(other.count <= kMaxEngineEventInternalCount,);
+
+    if (other.count != 0)
+        carla_copyStructs(data, other.data, other.count);
+
+    count = other.count;
+}
+
+void EngineEventBuffer::swapWith(EngineEventBuffer& other) noexcept
+{
+    EngineEvent* const tmpData(data);
+    const uint32_t tmpCount(count);
+
+    data  = other.data;
+    count = other.count;
+
+    other.data  = tmpData;
+    other.count = tmpCount;
+}
+
+// -----------------------------------------------------------------------
+// EngineProcessStats
+
+EngineProcessStats::EngineProcessStats() noexcept
+    : count(0),
+      minTime(0.0f),
+      avgTime(0.0f),
+      maxTime(0.0f),
+      p50Time(0.0f),
+      p90Time(0.0f),
+      p99Time(0.0f) {}
+
+void EngineProcessStats::clear() noexcept
+{
+    count   = 0;
+    minTime = 0.0f;
+    avgTime = 0.0f;
+    maxTime = 0.0f;
+    p50Time = 0.0f;
+    p90Time = 0.0f;
+    p99Time = 0.0f;
+}
+
 // -----------------------------------------------------------------------
 // EngineOptions
 
@@ -199,12 +272,19 @@ EngineOptions::EngineOptions() noexcept
       preferUiBridges(true),
 #endif
       uisAlwaysOnTop(true),
+      projectChunkFiles(false),
+      processStats(false),
       maxParameters(MAX_DEFAULT_PARAMETERS),
       uiBridgesTimeout(4000),
       audioNumPeriods(2),
       audioBufferSize(512),
       audioSampleRate(44100),
+      audioWorkerThreads(0),
+      pluginBridgesSpinTime(0),
+      idleMaxInterval(25),
+      projectLoadThreads(1),
       audioDevice(nullptr),
+      rackLanes(nullptr),
       pathLADSPA(nullptr),
       pathDSSI(nullptr),
       pathLV2(nullptr),
@@ -226,6 +306,12 @@ EngineOptions::~EngineOptions() noexcept
         audioDevice = nullptr;
     }
 
+    if (rackLanes != nullptr)
+    {
+        delete[] rackLanes;
+        rackLanes = nullptr;
+    }
+
     if (pathLADSPA != nullptr)
     {
         delete[] pathLADSPA;
@@ -647,6 +647,203 @@ void RackGraph::Buffers::setBufferSize(const uint32_t bufferSize, const bool cre
     }
 }
 
+// -----------------------------------------------------------------------
+// RackGraph Lanes
+
+RackGraph::Lanes::Lanes(RackGraph* const graph) noexcept
+    : kGraph(graph),
+      pool("RackLaneWorker"),
+      jobs(),
+      list(nullptr),
+      count(0),
+      data(nullptr),
+      inBuf(nullptr),
+      frames(0) {}
+
+RackGraph::Lanes::~Lanes() noexcept
+{
+    clear();
+}
+
+bool RackGraph::Lanes::isEnabled() const noexcept
+{
+    return count > 1;
+}
+
+bool RackGraph::Lanes::canProcess(const CarlaEngine::ProtectedData* const data) const noexcept
+{
+    // only the default event ports can be redirected to the lane buffers,
+    // extra ones write to the shared engine buffers and must not run in parallel
+    for (uint i=0; i < data->curPluginCount; ++i)
+    {
+        CarlaPlugin* const plugin = data->plugins[i].plugin;
+
+        if (plugin == nullptr || ! plugin->isEnabled())
+            continue;
+
+        const CarlaEngineClient* const client = plugin->getEngineClient();
+        CARLA_SAFE_ASSERT_CONTINUE(client != nullptr);
+
+        if (client->getEventPortCount(true) > 1 || client->getEventPortCount(false) > 1)
+            return false;
+    }
+
+    return true;
+}
+
+void RackGraph::Lanes::create(const char* const layout, const uint numWorkers) noexcept
+{
+    clear();
+
+    if (layout == nullptr || layout[0] == '\0')
+        return;
+
+    // the first lane always starts at slot 0, ignore it if listed
+    uint starts[MAX_DEFAULT_PLUGINS];
+    uint numLanes = 1;
+    starts[0] = 0;
+
+    for (const char* str = layout; *str != '\0';)
+    {
+        char* end = nullptr;
+        const long slot = std::strtol(str, &end, 10);
+        CARLA_SAFE_ASSERT_RETURN(end != str,);
+
+        if (slot > 0)
+        {
+            CARLA_SAFE_ASSERT_RETURN(slot < MAX_DEFAULT_PLUGINS,);
+            CARLA_SAFE_ASSERT_RETURN(static_cast<uint>(slot) > starts[numLanes-1],);
+            starts[numLanes++] = static_cast<uint>(slot);
+        }
+
+        for (str = end; *str == ',' || *str == ' '; ++str) {}
+    }
+
+    if (numLanes == 1)
+        return;
+
+    try {
+        list = new Lane[numLanes];
+    } CARLA_SAFE_EXCEPTION_RETURN("RackGraph::Lanes::create",);
+
+    for (uint i=0; i < numLanes; ++i)
+    {
+        Lane& lane(list[i]);
+        lane.firstPlugin  = starts[i];
+        lane.inBuf[0]     = lane.inBuf[1]  = nullptr;
+        lane.outBuf[0]    = lane.outBuf[1] = nullptr;
+        lane.eventsOutPos = 0;
+        carla_zeroStruct(lane.eventsIn);
+        carla_zeroStruct(lane.eventsOut);
+    }
+
+    count = numLanes;
+
+    for (uint i=0; i < numLanes; ++i)
+    {
+        Lane& lane(list[i]);
+
+        try {
+            lane.eventsIn.allocate();
+            lane.eventsOut.allocate();
+        } CARLA_SAFE_EXCEPTION_BREAK("RackGraph::Lanes::create");
+    }
+
+    for (uint i=0; i < numLanes; ++i)
+    {
+        if (list[i].eventsIn.data == nullptr || list[i].eventsOut.data == nullptr)
+            return clear();
+    }
+
+    // lanes never depend on each other
+    if (! jobs.create(numLanes, nullptr, nullptr, 0))
+        return clear();
+
+    pool.start(numWorkers);
+
+    carla_stdout("RackGraph: using %u parallel lanes with %u worker threads", numLanes, pool.getNumWorkers());
+}
+
+void RackGraph::Lanes::clear() noexcept
+{
+    pool.stop();
+    jobs.clear();
+
+    if (list == nullptr)
+        return;
+
+    for (uint i=0; i < count; ++i)
+    {
+        Lane& lane(list[i]);
+
+        if (lane.inBuf[0]   != nullptr) delete[] lane.inBuf[0];
+        if (lane.inBuf[1]   != nullptr) delete[] lane.inBuf[1];
+        if (lane.outBuf[0]  != nullptr) delete[] lane.outBuf[0];
+        if (lane.outBuf[1]  != nullptr) delete[] lane.outBuf[1];
+        lane.eventsIn.deallocate();
+        lane.eventsOut.deallocate();
+    }
+
+    delete[] list;
+    list  = nullptr;
+    count = 0;
+}
+
+void RackGraph::Lanes::setBufferSize(const uint32_t bufferSize) noexcept
+{
+    for (uint i=0; i < count; ++i)
+    {
+        Lane& lane(list[i]);
+
+        for (uint j=0; j < 2; ++j)
+        {
+            if (lane.inBuf[j]  != nullptr) { delete[] lane.inBuf[j];  lane.inBuf[j]  = nullptr; }
+            if (lane.outBuf[j] != nullptr) { delete[] lane.outBuf[j]; lane.outBuf[j] = nullptr; }
+        }
+    }
+
+    CARLA_SAFE_ASSERT_RETURN(bufferSize > 0,);
+
+    for (uint i=0; i < count; ++i)
+    {
+        Lane& lane(list[i]);
+
+        for (uint j=0; j < 2; ++j)
+        {
+            try {
+                lane.inBuf[j]  = new float[bufferSize];
+                lane.outBuf[j] = new float[bufferSize];
+            } CARLA_SAFE_EXCEPTION_CONTINUE("RackGraph::Lanes::setBufferSize");
+
+            carla_zeroFloats(lane.inBuf[j],  bufferSize);
+            carla_zeroFloats(lane.outBuf[j], bufferSize);
+        }
+    }
+}
+
+void RackGraph::Lanes::runJob(const uint index)
+{
+    CARLA_SAFE_ASSERT_RETURN(index < count,);
+
+    Lane& lane(list[index]);
+    CARLA_SAFE_ASSERT_RETURN(lane.inBuf[1] != nullptr && lane.outBuf[1] != nullptr,);
+
+    const uint lastPlugin = index+1 < count ? list[index+1].firstPlugin : MAX_DEFAULT_PLUGINS;
+
+    // every lane starts from the rack inputs
+    carla_copyFloats(lane.inBuf[0], inBuf[0], frames);
+    carla_copyFloats(lane.inBuf[1], inBuf[1], frames);
+    carla_zeroFloats(lane.outBuf[0], frames);
+    carla_zeroFloats(lane.outBuf[1], frames);
+
+    lane.eventsIn.copyFrom(data->events.in);
+    lane.eventsOut.clear();
+    lane.eventsOutPos = 0;
+
+    kGraph->processPlugins(data, lane.firstPlugin, jmin(lastPlugin, data->curPluginCount),
+                           lane.inBuf, lane.outBuf, &lane.eventsIn, &lane.eventsOut, frames);
+}
+
 // -----------------------------------------------------------------------
 // RackGraph
 
@@ -656,19 +853,27 @@ RackGraph::RackGraph(CarlaEngine* const engine, const uint32_t ins, const uint32
       outputs(outs),
       isOffline(false),
       audioBuffers(),
+      lanes(this),
       kEngine(engine)
 {
+    const EngineOptions& options(engine->getOptions());
+    lanes.create(options.rackLanes, options.audioWorkerThreads);
+
     setBufferSize(engine->getBufferSize());
 }
 
 RackGraph::~RackGraph() noexcept
 {
+    lanes.clear();
     extGraph.clear();
 }
 
 void RackGraph::setBufferSize(const uint32_t bufferSize) noexcept
 {
+    const CarlaRecursiveMutexLocker cml(audioBuffers.mutex);
+
     audioBuffers.setBufferSize(bufferSize, (inputs > 0 || outputs > 0));
+    lanes.setBufferSize(bufferSize);
 }
 
 void RackGraph::setOffline(const bool offline) noexcept
@@ -774,24 +979,78 @@ bool RackGraph::getGroupAndPortIdFromFullName(const char* const fullPortName, ui
 void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inBufReal[2], float* outBuf[2], const uint32_t frames)
 {
     CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
-    CARLA_SAFE_ASSERT_RETURN(data->events.in != nullptr,);
-    CARLA_SAFE_ASSERT_RETURN(data->events.out != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(data->events.in.data != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(data->events.out.data != nullptr,);
+
+    // initialize audio outputs (zero)
+    carla_zeroFloats(outBuf[0], frames);
+    carla_zeroFloats(outBuf[1], frames);
+
+    // initialize event outputs
+    data->events.out.clear();
+
+    if (lanes.isEnabled() && lanes.canProcess(data))
+    {
+        lanes.data   = data;
+        lanes.inBuf  = inBufReal;
+        lanes.frames = frames;
+
+        lanes.pool.process(lanes.jobs, &lanes);
+
+        // mix lanes audio
+        for (uint i=0; i < lanes.count; ++i)
+        {
+            const Lanes::Lane& lane(lanes.list[i]);
+            CARLA_SAFE_ASSERT_CONTINUE(lane.outBuf[1] != nullptr);
+
+            carla_addFloats(outBuf[0], lane.outBuf[0], frames);
+            carla_addFloats(outBuf[1], lane.outBuf[1], frames);
+        }
+
+        // merge lanes events, sorted by time
+        for (EngineEventBuffer& eventsOut(data->events.out); ! eventsOut.isFull();)
+        {
+            Lanes::Lane* next = nullptr;
+
+            for (uint i=0; i < lanes.count; ++i)
+            {
+                Lanes::Lane& lane(lanes.list[i]);
+
+                if (lane.eventsOutPos >= lane.eventsOut.count)
+                    continue;
+
+                const EngineEvent& event(lane.eventsOut.data[lane.eventsOutPos]);
+
+                if (next == nullptr || event.time < next->eventsOut.data[next->eventsOutPos].time)
+                    next = &lane;
+            }
+
+            if (next == nullptr)
+                break;
+
+            eventsOut.data[eventsOut.count++] = next->eventsOut.data[next->eventsOutPos++];
+        }
+
+        return;
+    }
 
     // safe copy
     float inBuf0[frames];
     float inBuf1[frames];
-    const float* inBuf[2] = { inBuf0, inBuf1 };
+    float* inBuf[2] = { inBuf0, inBuf1 };
 
     // initialize audio inputs
     carla_copyFloats(inBuf0, inBufReal[0], frames);
     carla_copyFloats(inBuf1, inBufReal[1], frames);
 
-    // initialize audio outputs (zero)
-    carla_zeroFloats(outBuf[0], frames);
-    carla_zeroFloats(outBuf[1], frames);
+    processPlugins(data, 0, data->curPluginCount, inBuf, outBuf, &data->events.in, &data->events.out, frames);
+}
 
-    // initialize event outputs (zero)
-    carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
+void RackGraph::processPlugins(CarlaEngine::ProtectedData* const data, const uint firstPlugin, const uint lastPlugin,
+                               float* inBuf[2], float* outBuf[2],
+                               EngineEventBuffer* const eventsIn, EngineEventBuffer* const eventsOut, const uint32_t frames)
+{
+    const float* inBufConst[2] = { inBuf[0], inBuf[1] };
 
     uint32_t oldAudioInCount  = 0;
     uint32_t oldAudioOutCount = 0;
@@ -799,7 +1058,7 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
     bool processed = false;
 
     // process plugins
-    for (uint i=0; i < data->curPluginCount; ++i)
+    for (uint i=firstPlugin; i < lastPlugin; ++i)
     {
         CarlaPlugin* const plugin = data->plugins[i].plugin;
 
@@ -809,17 +1068,17 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
         if (processed)
         {
             // initialize audio inputs (from previous outputs)
-            carla_copyFloats(inBuf0, outBuf[0], frames);
-            carla_copyFloats(inBuf1, outBuf[1], frames);
+            carla_copyFloats(inBuf[0], outBuf[0], frames);
+            carla_copyFloats(inBuf[1], outBuf[1], frames);
 
             // initialize audio outputs (zero)
             carla_zeroFloats(outBuf[0], frames);
             carla_zeroFloats(outBuf[1], frames);
 
             // if plugin has no midi out, add previous events
-            if (oldMidiOutCount == 0 && data->events.in[0].type != kEngineEventTypeNull)
+            if (oldMidiOutCount == 0 && eventsIn->count != 0)
             {
-                if (data->events.out[0].type != kEngineEventTypeNull)
+                if (eventsOut->count != 0)
                 {
                     // TODO: carefully add to input, sorted events
                 }
@@ -827,11 +1086,11 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
             }
             else
             {
-                // initialize event inputs from previous outputs
-                carla_copyStructs(data->events.in, data->events.out, kMaxEngineEventInternalCount);
+                // initialize event inputs from previous outputs, swapping buffers instead of copying
+                eventsIn->swapWith(*eventsOut);
 
-                // initialize event outputs (zero)
-                carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
+                // initialize event outputs
+                eventsOut->clear();
             }
         }
 
@@ -841,14 +1100,27 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
 
         // process
         plugin->initBuffers();
-        plugin->process(inBuf, outBuf, nullptr, nullptr, frames);
+
+        // lanes have their own event buffers, plugins with extra event ports are never processed in lanes
+        if (eventsIn != &data->events.in)
+        {
+            if (CarlaEngineEventPort* const port = plugin->getDefaultEventInPort())
+                port->fBuffer = eventsIn;
+            if (CarlaEngineEventPort* const port = plugin->getDefaultEventOutPort())
+                port->fBuffer = eventsOut;
+        }
+
+        {
+            const ScopedPluginProcessTimer sppt(plugin, data->options.processStats);
+            plugin->process(inBufConst, outBuf, nullptr, nullptr, frames);
+        }
         plugin->unlock();
 
         // if plugin has no audio inputs, add input buffer
         if (oldAudioInCount == 0)
         {
-            carla_addFloats(outBuf[0], inBuf0, frames);
-            carla_addFloats(outBuf[1], inBuf1, frames);
+            carla_addFloats(outBuf[0], inBuf[0], frames);
+            carla_addFloats(outBuf[1], inBuf[1], frames);
         }
 
         // if plugin only has 1 output, copy it to the 2nd
@@ -863,8 +1135,7 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
 
             if (oldAudioInCount > 0)
             {
-                pluginData.insPeak[0] = carla_findMaxNormalizedFloat(inBuf0, frames);
-                pluginData.insPeak[1] = carla_findMaxNormalizedFloat(inBuf1, frames);
+                carla_findMaxNormalizedFloats(pluginData.insPeak, inBuf, 2, frames);
             }
             else
             {
@@ -874,8 +1145,7 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
 
             if (oldAudioOutCount > 0)
             {
-                pluginData.outsPeak[0] = carla_findMaxNormalizedFloat(outBuf[0], frames);
-                pluginData.outsPeak[1] = carla_findMaxNormalizedFloat(outBuf[1], frames);
+                carla_findMaxNormalizedFloats(pluginData.outsPeak, outBuf, 2, frames);
             }
             else
             {
@@ -1164,11 +1434,11 @@ public:
 
         if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventInPort())
         {
-            EngineEvent* const engineEvents(port->fBuffer);
+            EngineEventBuffer* const engineEvents(port->fBuffer);
             CARLA_SAFE_ASSERT_RETURN(engineEvents != nullptr,);
 
-            carla_zeroStructs(engineEvents, kMaxEngineEventInternalCount);
-            fillEngineEventsFromWaterMidiBuffer(engineEvents, midi);
+            engineEvents->clear();
+            fillEngineEventsFromWaterMidiBuffer(*engineEvents, midi);
         }
 
         midi.clear();
@@ -1176,6 +1446,7 @@ public:
         // TODO - CV support
 
         const uint32_t numSamples(static_cast<uint32_t>(audio.getNumSamples()));
+        const bool processStats(kEngine->getOptions().processStats);
 
         if (const int numChan = audio.getNumChannels())
         {
@@ -1190,18 +1461,20 @@ public:
             float inPeaks[2] = { 0.0f };
             float outPeaks[2] = { 0.0f };
 
-            for (uint32_t i=0, count=jmin(fPlugin->getAudioInCount(), 2U); i<count; ++i)
-                inPeaks[i] = carla_findMaxNormalizedFloat(audioBuffers[i], numSamples);
+            carla_findMaxNormalizedFloats(inPeaks, audioBuffers, jmin(fPlugin->getAudioInCount(), 2U), numSamples);
 
-            fPlugin->process(const_cast<const float**>(audioBuffers), audioBuffers, nullptr, nullptr, numSamples);
+            {
+                const ScopedPluginProcessTimer sppt(fPlugin, processStats);
+                fPlugin->process(const_cast<const float**>(audioBuffers), audioBuffers, nullptr, nullptr, numSamples);
+            }
 
-            for (uint32_t i=0, count=jmin(fPlugin->getAudioOutCount(), 2U); i<count; ++i)
-                outPeaks[i] = carla_findMaxNormalizedFloat(audioBuffers[i], numSamples);
+            carla_findMaxNormalizedFloats(outPeaks, audioBuffers, jmin(fPlugin->getAudioOutCount(), 2U), numSamples);
 
             kEngine->setPluginPeaks(fPlugin->getId(), inPeaks, outPeaks);
         }
         else
         {
+            const ScopedPluginProcessTimer sppt(fPlugin, processStats);
             fPlugin->process(nullptr, nullptr, nullptr, nullptr, numSamples);
         }
 
@@ -1209,11 +1482,11 @@ public:
 
         if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventOutPort())
         {
-            /*const*/ EngineEvent* const engineEvents(port->fBuffer);
+            EngineEventBuffer* const engineEvents(port->fBuffer);
             CARLA_SAFE_ASSERT_RETURN(engineEvents != nullptr,);
 
-            fillWaterMidiBufferFromEngineEvents(midi, engineEvents);
-            carla_zeroStructs(engineEvents, kMaxEngineEventInternalCount);
+            fillWaterMidiBufferFromEngineEvents(midi, *engineEvents);
+            engineEvents->clear();
         }
 
         fPlugin->unlock();
@@ -1295,7 +1568,10 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine, const uint32_t ins, cons
       retCon(),
       usingExternal(false),
       extGraph(engine),
-      kEngine(engine)
+      kEngine(engine),
+      fReorderSem(),
+      fReorderSemValid(false),
+      fReorderPending(0)
 {
     const int    bufferSize(static_cast<int>(engine->getBufferSize()));
     const double sampleRate(engine->getSampleRate());
@@ -1308,6 +1584,8 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine, const uint32_t ins, cons
     midiBuffer.ensureSize(kMaxEngineEventInternalCount*2);
     midiBuffer.clear();
 
+    graph.setNumWorkerThreads(static_cast<int>(engine->getOptions().audioWorkerThreads));
+
     StringArray channelNames;
 
     switch (inputs)
@@ -1375,13 +1653,24 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine, const uint32_t ins, cons
         node->properties.set("isOSC", false);
     }
 
+    fReorderSemValid = carla_sem_create2(fReorderSem);
+
     startThread();
+    triggerReorder();
 }
 
 PatchbayGraph::~PatchbayGraph()
 {
+    signalThreadShouldExit();
+    triggerReorder();
     stopThread(-1);
 
+    if (fReorderSemValid)
+    {
+        carla_sem_destroy2(fReorderSem);
+        fReorderSemValid = false;
+    }
+
     connections.clear();
     extGraph.clear();
 
@@ -1426,6 +1715,8 @@ void PatchbayGraph::addPlugin(CarlaPlugin* const plugin)
 
     if (! usingExternal)
         addNodeToPatchbay(plugin->getEngine(), node->nodeId, static_cast<int>(plugin->getId()), instance);
+
+    triggerReorder();
 }
 
 void PatchbayGraph::replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugin* const newPlugin)
@@ -1459,6 +1750,8 @@ void PatchbayGraph::replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugin* con
 
     if (! usingExternal)
         addNodeToPatchbay(newPlugin->getEngine(), node->nodeId, static_cast<int>(newPlugin->getId()), instance);
+
+    triggerReorder();
 }
 
 void PatchbayGraph::renamePlugin(CarlaPlugin* const plugin, const char* const newName)
@@ -1503,6 +1796,8 @@ void PatchbayGraph::removePlugin(CarlaPlugin* const plugin)
     }
 
     CARLA_SAFE_ASSERT_RETURN(graph.removeNode(node->nodeId),);
+
+    triggerReorder();
 }
 
 void PatchbayGraph::removeAllPlugins()
@@ -1527,6 +1822,22 @@ void PatchbayGraph::removeAllPlugins()
 
         graph.removeNode(node->nodeId);
     }
+
+    triggerReorder();
+}
+
+void PatchbayGraph::updatePluginIds()
+{
+    carla_debug("PatchbayGraph::updatePluginIds()");
+
+    for (uint i=0, count=kEngine->getCurrentPluginCount(); i<count; ++i)
+    {
+        CarlaPlugin* const plugin(kEngine->getPlugin(i));
+        CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
+
+        if (AudioProcessorGraph::Node* const node = graph.getNodeForId(plugin->getPatchbayNodeId()))
+            node->properties.set("pluginId", static_cast<int>(i));
+    }
 }
 
 bool PatchbayGraph::connect(const bool external, const uint groupA, const uint portA, const uint groupB, const uint portB, const bool sendCallback)
@@ -1559,6 +1870,7 @@ bool PatchbayGraph::connect(const bool external, const uint groupA, const uint p
         kEngine->callback(ENGINE_CALLBACK_PATCHBAY_CONNECTION_ADDED, connectionToId.id, 0, 0, 0.0f, strBuf);
 
     connections.list.append(connectionToId);
+    triggerReorder();
     return true;
 }
 
@@ -1592,6 +1904,7 @@ bool PatchbayGraph::disconnect(const uint connectionId)
         kEngine->callback(ENGINE_CALLBACK_PATCHBAY_CONNECTION_REMOVED, connectionToId.id, 0, 0, 0.0f, nullptr);
 
         connections.list.remove(it);
+        triggerReorder();
         return true;
     }
 
@@ -1642,6 +1955,7 @@ void PatchbayGraph::refresh(const char* const deviceName)
 
     connections.clear();
     graph.removeIllegalConnections();
+    triggerReorder();
 
     for (int i=0, count=graph.getNumNodes(); i<count; ++i)
     {
@@ -1802,8 +2116,8 @@ bool PatchbayGraph::getGroupAndPortIdFromFullName(const bool external, const cha
 void PatchbayGraph::process(CarlaEngine::ProtectedData* const data, const float* const* const inBuf, float* const* const outBuf, const int frames)
 {
     CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
-    CARLA_SAFE_ASSERT_RETURN(data->events.in != nullptr,);
-    CARLA_SAFE_ASSERT_RETURN(data->events.out != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(data->events.in.data != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(data->events.out.data != nullptr,);
     CARLA_SAFE_ASSERT_RETURN(frames > 0,);
 
     // put events in water buffer
@@ -1834,7 +2148,7 @@ void PatchbayGraph::process(CarlaEngine::ProtectedData* const data, const float*
 
     // put water events in carla buffer
     {
-        carla_zeroStructs(data->events.out, kMaxEngineEventInternalCount);
+        data->events.out.clear();
         fillEngineEventsFromWaterMidiBuffer(data->events.out, midiBuffer);
         midiBuffer.clear();
     }
@@ -1844,11 +2158,37 @@ void PatchbayGraph::run()
 {
     while (! shouldThreadExit())
     {
-        carla_msleep(100);
+        if (! fReorderSemValid)
+        {
+            carla_msleep(100);
+            graph.reorderNowIfNeeded();
+            continue;
+        }
+
+        // sleep until the graph changes, a missed wake-up is still picked up on timeout
+        if (! carla_sem_timedwait(fReorderSem, 1000, true))
+        {
+            graph.reorderNowIfNeeded();
+            continue;
+        }
+
+        __sync_bool_compare_and_swap(&fReorderPending, 1, 0);
+
+        // changes usually come in batches (loading a project, removing a plugin), let them settle first
+        while (! shouldThreadExit() && carla_sem_timedwait(fReorderSem, 10, true))
+            __sync_bool_compare_and_swap(&fReorderPending, 1, 0);
+
         graph.reorderNowIfNeeded();
     }
 }
 
+void PatchbayGraph::triggerReorder() noexcept
+{
+    // post only once until the thread wakes up, the semaphore cannot count past 1
+    if (fReorderSemValid && __sync_bool_compare_and_swap(&fReorderPending, 0, 1))
+        carla_sem_post(fReorderSem, true);
+}
+
 // -----------------------------------------------------------------------
 // InternalGraph
 
@@ -2024,6 +2364,12 @@ void EngineInternalGraph::removeAllPlugins()
     fPatchbay->removeAllPlugins();
 }
 
+void EngineInternalGraph::updatePluginIds()
+{
+    CARLA_SAFE_ASSERT_RETURN(fPatchbay != nullptr,);
+    fPatchbay->updatePluginIds();
+}
+
 bool EngineInternalGraph::isUsingExternal() const noexcept
 {
     if (fIsRack)
@@ -21,6 +21,8 @@
 #include "CarlaEngine.hpp"
 #include "CarlaMutex.hpp"
 #include "CarlaPatchbayUtils.hpp"
+#include "CarlaRtThreadPool.hpp"
+#include "CarlaSemUtils.hpp"
 #include "CarlaStringList.hpp"
 #include "CarlaThread.hpp"
 
@@ -121,6 +123,39 @@ struct RackGraph {
         CARLA_DECLARE_NON_COPY_CLASS(Buffers)
     } audioBuffers;
 
+    // independent groups of rack slots, processed in parallel (see ENGINE_OPTION_RACK_LANES)
+    struct Lanes : public CarlaRtThreadPool::Callback {
+        struct Lane {
+            uint firstPlugin;
+            float* inBuf[2];
+            float* outBuf[2];
+            EngineEventBuffer eventsIn;
+            EngineEventBuffer eventsOut;
+            uint eventsOutPos;
+        };
+
+        RackGraph* const kGraph;
+        CarlaRtThreadPool pool;
+        CarlaRtJobGraph jobs;
+        Lane* list;
+        uint count;
+
+        // current cycle
+        CarlaEngine::ProtectedData* data;
+        const float* const* inBuf;
+        uint32_t frames;
+
+        Lanes(RackGraph* const graph) noexcept;
+        ~Lanes() noexcept;
+        bool isEnabled() const noexcept;
+        bool canProcess(const CarlaEngine::ProtectedData* const data) const noexcept;
+        void create(const char* const layout, const uint numWorkers) noexcept;
+        void clear() noexcept;
+        void setBufferSize(const uint32_t bufferSize) noexcept;
+        void runJob(const uint index) override;
+        CARLA_DECLARE_NON_COPY_STRUCT(Lanes)
+    } lanes;
+
     RackGraph(CarlaEngine* const engine, const uint32_t inputs, const uint32_t outputs) noexcept;
     ~RackGraph() noexcept;
 
@@ -137,6 +172,11 @@ struct RackGraph {
     // the base, where plugins run
     void process(CarlaEngine::ProtectedData* const data, const float* inBufReal[2], float* outBuf[2], const uint32_t frames);
 
+    // process a serial chain of plugins, used by process() for the whole rack or for each lane
+    void processPlugins(CarlaEngine::ProtectedData* const data, const uint firstPlugin, const uint lastPlugin,
+                        float* inBuf[2], float* outBuf[2],
+                        EngineEventBuffer* const eventsIn, EngineEventBuffer* const eventsOut, const uint32_t frames);
+
     // extended, will call process() in the middle
     void processHelper(CarlaEngine::ProtectedData* const data, const float* const* const inBuf, float* const* const outBuf, const uint32_t frames);
 
@@ -172,6 +212,7 @@ public:
     void renamePlugin(CarlaPlugin* const plugin, const char* const newName);
     void removePlugin(CarlaPlugin* const plugin);
     void removeAllPlugins();
+    void updatePluginIds();
 
     bool connect(const bool external, const uint groupA, const uint portA, const uint groupB, const uint portB, const bool sendCallback);
     bool disconnect(const uint connectionId);
@@ -185,8 +226,14 @@ public:
 
 private:
     void run() override;
+    void triggerReorder() noexcept;
 
     CarlaEngine* const kEngine;
+
+    carla_sem_t fReorderSem;
+    bool fReorderSemValid;
+    int fReorderPending;
+
     CARLA_DECLARE_NON_COPY_CLASS(PatchbayGraph)
 };
 
@@ -17,6 +17,7 @@
 
 #include "CarlaEngineInternal.hpp"
 #include "CarlaPlugin.hpp"
+#include "CarlaTimeUtils.hpp"
 
 #include "jackbridge/JackBridge.hpp"
 
@@ -32,28 +33,19 @@ CARLA_BACKEND_START_NAMESPACE
 // InternalEvents
 
 EngineInternalEvents::EngineInternalEvents() noexcept
-    : in(nullptr),
-      out(nullptr) {}
+    : in(),
+      out() {}
 
 EngineInternalEvents::~EngineInternalEvents() noexcept
 {
-    CARLA_SAFE_ASSERT(in == nullptr);
-    CARLA_SAFE_ASSERT(out == nullptr);
+    CARLA_SAFE_ASSERT(in.data == nullptr);
+    CARLA_SAFE_ASSERT(out.data == nullptr);
 }
 
 void EngineInternalEvents::clear() noexcept
 {
-    if (in != nullptr)
-    {
-        delete[] in;
-        in = nullptr;
-    }
-
-    if (out != nullptr)
-    {
-        delete[] out;
-        out = nullptr;
-    }
+    in.deallocate();
+    out.deallocate();
 }
 
 // -----------------------------------------------------------------------
@@ -391,6 +383,164 @@ void EngineNextAction::clearAndReset() noexcept
     mutex.unlock();
 }
 
+// -----------------------------------------------------------------------
+// EngineInternalStats
+
+EngineInternalStats::EngineInternalStats() noexcept
+    : cycle(),
+      load(0.0f),
+      xruns(0),
+      overruns(0),
+      clearPending(0) {}
+
+void EngineInternalStats::clear() noexcept
+{
+    cycle.clear();
+    load     = 0.0f;
+    xruns    = 0;
+    overruns = 0;
+    clearPending = 0;
+}
+
+void EngineInternalStats::requestClear() noexcept
+{
+    __sync_bool_compare_and_swap(&clearPending, 0, 1);
+    cycle.requestClear();
+}
+
+void EngineInternalStats::addCycle(const uint64_t time, const uint64_t period) noexcept
+{
+    if (clearPending != 0 && __sync_bool_compare_and_swap(&clearPending, 1, 0))
+    {
+        load = 0.0f;
+        __sync_and_and_fetch(&xruns, 0);
+        overruns = 0;
+    }
+
+    cycle.addTime(time);
+
+    if (time > period)
+        ++overruns;
+
+    if (period == 0)
+        return;
+
+    // exponential smoothing, about 20 cycles to settle
+    const float cycleLoad = static_cast<float>(static_cast<double>(time) / static_cast<double>(period));
+    load = load + (cycleLoad - load) * 0.05f;
+}
+
+void EngineInternalStats::addXrun() noexcept
+{
+    __sync_add_and_fetch(&xruns, 1);
+}
+
+// -----------------------------------------------------------------------
+// EnginePluginTransaction
+
+#ifndef BUILD_BRIDGE
+EnginePluginTransaction::EnginePluginTransaction() noexcept
+    : active(false),
+      count(0),
+      plugins(nullptr) {}
+
+EnginePluginTransaction::~EnginePluginTransaction() noexcept
+{
+    CARLA_SAFE_ASSERT(! active);
+    CARLA_SAFE_ASSERT(plugins == nullptr);
+}
+
+// -----------------------------------------------------------------------
+// EngineProjectLoad
+
+static const EngineProjectLoad::Thread kProjectLoadThreadFallback = { pthread_t(), nullptr };
+
+EngineProjectLoad::EngineProjectLoad() noexcept
+    : active(false),
+      mutex(),
+      threads(),
+      callbacks() {}
+
+EngineProjectLoad::~EngineProjectLoad() noexcept
+{
+    CARLA_SAFE_ASSERT(! active);
+    CARLA_SAFE_ASSERT(threads.isEmpty());
+    CARLA_SAFE_ASSERT(callbacks.isEmpty());
+}
+
+void EngineProjectLoad::addThread(CarlaString* const error) noexcept
+{
+    const Thread thread = { pthread_self(), error };
+
+    const CarlaMutexLocker cml(mutex);
+    threads.append(thread);
+}
+
+void EngineProjectLoad::removeThread() noexcept
+{
+    const pthread_t self(pthread_self());
+    const CarlaMutexLocker cml(mutex);
+
+    for (LinkedList<Thread>::Itenerator it = threads.begin2(); it.valid(); it.next())
+    {
+        if (pthread_equal(it.getValue(kProjectLoadThreadFallback).thread, self))
+        {
+            threads.remove(it);
+            return;
+        }
+    }
+}
+
+bool EngineProjectLoad::setThreadError(const char* const error) noexcept
+{
+    const pthread_t self(pthread_self());
+    const CarlaMutexLocker cml(mutex);
+
+    for (LinkedList<Thread>::Itenerator it = threads.begin2(); it.valid(); it.next())
+    {
+        const Thread& thread(it.getValue(kProjectLoadThreadFallback));
+
+        if (pthread_equal(thread.thread, self))
+        {
+            CARLA_SAFE_ASSERT_RETURN(thread.error != nullptr, true);
+            *thread.error = error;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool EngineProjectLoad::deferCallback(const EngineCallbackOpcode action, const uint pluginId,
+                                      const int value1, const int value2, const float value3, const char* const valueStr) noexcept
+{
+    const pthread_t self(pthread_self());
+    const CarlaMutexLocker cml(mutex);
+
+    for (LinkedList<Thread>::Itenerator it = threads.begin2(); it.valid(); it.next())
+    {
+        if (! pthread_equal(it.getValue(kProjectLoadThreadFallback).thread, self))
+            continue;
+
+        // the main thread keeps idling by itself
+        if (action == ENGINE_CALLBACK_IDLE)
+            return true;
+
+        const Callback callback = {
+            action, pluginId, value1, value2, value3,
+            valueStr != nullptr ? carla_strdup_safe(valueStr) : nullptr
+        };
+
+        if (! callbacks.append(callback))
+            delete[] callback.valueStr;
+
+        return true;
+    }
+
+    return false;
+}
+#endif
+
 // -----------------------------------------------------------------------
 // CarlaEngine::ProtectedData
 
@@ -419,17 +569,22 @@ CarlaEngine::ProtectedData::ProtectedData(CarlaEngine* const engine) noexcept
       envMutex(),
       lastError(),
       name(),
+      currentProjectFilename(),
       options(),
       timeInfo(),
 #ifndef BUILD_BRIDGE
       plugins(nullptr),
+      nextPlugins(nullptr),
 #endif
       events(),
 #ifndef BUILD_BRIDGE
       graph(engine),
+      transaction(),
+      projectLoad(),
 #endif
       time(timeInfo, options.transportMode),
-      nextAction()
+      nextAction(),
+      stats()
 {
 #ifdef BUILD_BRIDGE
     carla_zeroStructs(plugins, 1);
@@ -444,6 +599,7 @@ CarlaEngine::ProtectedData::~ProtectedData() noexcept
     CARLA_SAFE_ASSERT(isIdling == 0);
 #ifndef BUILD_BRIDGE
     CARLA_SAFE_ASSERT(plugins == nullptr);
+    CARLA_SAFE_ASSERT(nextPlugins == nullptr);
 #endif
 }
 
@@ -455,8 +611,8 @@ bool CarlaEngine::ProtectedData::init(const char* const clientName)
 #ifdef HAVE_LIBLO
     CARLA_SAFE_ASSERT_RETURN_INTERNAL_ERR(oscData == nullptr, "Invalid engine internal data (err #2)");
 #endif
-    CARLA_SAFE_ASSERT_RETURN_INTERNAL_ERR(events.in  == nullptr, "Invalid engine internal data (err #4)");
-    CARLA_SAFE_ASSERT_RETURN_INTERNAL_ERR(events.out == nullptr, "Invalid engine internal data (err #5)");
+    CARLA_SAFE_ASSERT_RETURN_INTERNAL_ERR(events.in.data  == nullptr, "Invalid engine internal data (err #4)");
+    CARLA_SAFE_ASSERT_RETURN_INTERNAL_ERR(events.out.data == nullptr, "Invalid engine internal data (err #5)");
     CARLA_SAFE_ASSERT_RETURN_INTERNAL_ERR(clientName != nullptr && clientName[0] != '\0', "Invalid client name");
 #ifndef BUILD_BRIDGE
     CARLA_SAFE_ASSERT_RETURN_INTERNAL_ERR(plugins == nullptr, "Invalid engine internal data (err #3)");
@@ -488,8 +644,8 @@ bool CarlaEngine::ProtectedData::init(const char* const clientName)
     case ENGINE_PROCESS_MODE_CONTINUOUS_RACK:
     case ENGINE_PROCESS_MODE_PATCHBAY:
     case ENGINE_PROCESS_MODE_BRIDGE:
-        events.in  = new EngineEvent[kMaxEngineEventInternalCount];
-        events.out = new EngineEvent[kMaxEngineEventInternalCount];
+        events.in.allocate();
+        events.out.allocate();
         break;
     default:
         break;
@@ -501,6 +657,7 @@ bool CarlaEngine::ProtectedData::init(const char* const clientName)
     name.toBasic();
 
     timeInfo.clear();
+    stats.clear();
 
 #ifdef HAVE_LIBLO
     osc.init(clientName);
@@ -512,6 +669,12 @@ bool CarlaEngine::ProtectedData::init(const char* const clientName)
 #ifndef BUILD_BRIDGE
     plugins = new EnginePluginData[maxPluginNumber];
     carla_zeroStructs(plugins, maxPluginNumber);
+
+    nextPlugins = new EnginePluginData[maxPluginNumber];
+    carla_zeroStructs(nextPlugins, maxPluginNumber);
+
+    transaction.plugins = new CarlaPlugin*[maxPluginNumber];
+    carla_zeroPointers(transaction.plugins, maxPluginNumber);
 #endif
 
     nextAction.ready();
@@ -544,12 +707,26 @@ void CarlaEngine::ProtectedData::close()
     maxPluginNumber = 0;
     nextPluginId    = 0;
 
+    currentProjectFilename.clear();
+
 #ifndef BUILD_BRIDGE
     if (plugins != nullptr)
     {
         delete[] plugins;
         plugins = nullptr;
     }
+
+    if (nextPlugins != nullptr)
+    {
+        delete[] nextPlugins;
+        nextPlugins = nullptr;
+    }
+
+    if (transaction.plugins != nullptr)
+    {
+        delete[] transaction.plugins;
+        transaction.plugins = nullptr;
+    }
 #endif
 
     events.clear();
@@ -622,6 +799,27 @@ void CarlaEngine::ProtectedData::doPluginsSwitch() noexcept
     plugins[idB].plugin = tmp;
 #endif
 }
+
+void CarlaEngine::ProtectedData::doPluginsSwap() noexcept
+{
+    const uint newCount(nextAction.value);
+    CARLA_SAFE_ASSERT_RETURN(newCount <= maxPluginNumber,);
+
+    EnginePluginData* const oldPlugins(plugins);
+
+    plugins        = nextPlugins;
+    nextPlugins    = oldPlugins;
+    curPluginCount = newCount;
+
+    for (uint i=0; i < newCount; ++i)
+    {
+        CarlaPlugin* const plugin(plugins[i].plugin);
+
+        CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
+
+        plugin->setId(i);
+    }
+}
 #endif
 
 void CarlaEngine::ProtectedData::doNextPluginAction(const bool unlock) noexcept
@@ -640,6 +838,9 @@ void CarlaEngine::ProtectedData::doNextPluginAction(const bool unlock) noexcept
     case kEnginePostActionSwitchPlugins:
         doPluginsSwitch();
         break;
+    case kEnginePostActionSwapPlugins:
+        doPluginsSwap();
+        break;
 #endif
     }
 
@@ -654,11 +855,44 @@ void CarlaEngine::ProtectedData::doNextPluginAction(const bool unlock) noexcept
     }
 }
 
+#ifndef BUILD_BRIDGE
+bool CarlaEngine::ProtectedData::isCurrentPlugin(const CarlaPlugin* const plugin) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(plugin != nullptr, false);
+
+    const uint id(plugin->getId());
+
+    return id < curPluginCount && plugins[id].plugin == plugin;
+}
+
+void CarlaEngine::ProtectedData::clearPluginTransaction()
+{
+    if (! transaction.active)
+        return;
+
+    // delete plugins that were never given to the audio thread
+    for (uint i=0; i < transaction.count; ++i)
+    {
+        CarlaPlugin* const plugin(transaction.plugins[i]);
+
+        if (plugin != nullptr && ! isCurrentPlugin(plugin))
+            delete plugin;
+
+        transaction.plugins[i] = nullptr;
+    }
+
+    transaction.active = false;
+    transaction.count  = 0;
+}
+#endif
+
 // -----------------------------------------------------------------------
 // PendingRtEventsRunner
 
 PendingRtEventsRunner::PendingRtEventsRunner(CarlaEngine* const engine, const uint32_t frames) noexcept
-    : pData(engine->pData)
+    : pData(engine->pData),
+      fNumFrames(frames),
+      fStartTime(pData->options.processStats ? carla_gettime_ns() : 0)
 {
     pData->time.preProcess(frames);
 }
@@ -666,6 +900,25 @@ PendingRtEventsRunner::PendingRtEventsRunner(CarlaEngine* const engine, const ui
 PendingRtEventsRunner::~PendingRtEventsRunner() noexcept
 {
     pData->doNextPluginAction(true);
+
+    if (fStartTime == 0 || pData->sampleRate <= 0.0)
+        return;
+
+    const uint64_t period = static_cast<uint64_t>(fNumFrames * 1000000000.0 / pData->sampleRate);
+    pData->stats.addCycle(carla_gettime_ns() - fStartTime, period);
+}
+
+// -----------------------------------------------------------------------
+// ScopedPluginProcessTimer
+
+ScopedPluginProcessTimer::ScopedPluginProcessTimer(CarlaPlugin* const plugin, const bool enabled) noexcept
+    : fClient(enabled ? plugin->getEngineClient() : nullptr),
+      fStartTime(fClient != nullptr ? carla_gettime_ns() : 0) {}
+
+ScopedPluginProcessTimer::~ScopedPluginProcessTimer() noexcept
+{
+    if (fClient != nullptr)
+        fClient->addProcessTime(carla_gettime_ns() - fStartTime);
 }
 
 // -----------------------------------------------------------------------
@@ -22,6 +22,8 @@
 #include "CarlaEngineThread.hpp"
 #include "CarlaEngineUtils.hpp"
 
+#include "LinkedList.hpp"
+
 #include "hylia/hylia.h"
 
 // FIXME only use CARLA_PREVENT_HEAP_ALLOCATION for structs
@@ -44,8 +46,15 @@ CARLA_BACKEND_START_NAMESPACE
 // InternalEvents
 
 struct EngineInternalEvents {
-    EngineEvent* in;
-    EngineEvent* out;
+    EngineEventBuffer in;
+    EngineEventBuffer out;
+
+    // cheap reset for the start of each cycle, only the counts are touched
+    void reset() noexcept
+    {
+        in.clear();
+        out.clear();
+    }
 
     EngineInternalEvents() noexcept;
     ~EngineInternalEvents() noexcept;
@@ -90,6 +99,7 @@ public:
     void renamePlugin(CarlaPlugin* const plugin, const char* const newName);
     void removePlugin(CarlaPlugin* const plugin);
     void removeAllPlugins();
+    void updatePluginIds();
 
     bool isUsingExternal() const noexcept;
     void setUsingExternal(const bool usingExternal) noexcept;
@@ -168,7 +178,8 @@ enum EnginePostAction {
     kEnginePostActionZeroCount,    // set curPluginCount to 0
 #ifndef BUILD_BRIDGE
     kEnginePostActionRemovePlugin, // remove a plugin
-    kEnginePostActionSwitchPlugins // switch between 2 plugins
+    kEnginePostActionSwitchPlugins, // switch between 2 plugins
+    kEnginePostActionSwapPlugins   // use nextPlugins as the new plugin list, see commitPluginTransaction()
 #endif
 };
 
@@ -186,6 +197,31 @@ struct EngineNextAction {
     CARLA_DECLARE_NON_COPY_STRUCT(EngineNextAction)
 };
 
+// -----------------------------------------------------------------------
+// EngineInternalStats
+
+struct EngineInternalStats {
+    EngineProcessTimeStats cycle; // time of whole engine cycles
+    volatile float    load;       // smoothed DSP load, 0.0 to 1.0
+    volatile uint32_t xruns;      // reported by the audio driver
+    volatile uint32_t overruns;   // cycles that took longer than their period
+    volatile int      clearPending;
+
+    EngineInternalStats() noexcept;
+
+    // only safe while the engine is not processing
+    void clear() noexcept;
+
+    // non-RT, the actual clearing happens on the next cycle
+    void requestClear() noexcept;
+
+    // RT
+    void addCycle(const uint64_t time, const uint64_t period) noexcept;
+    void addXrun() noexcept;
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EngineInternalStats)
+};
+
 // -----------------------------------------------------------------------
 // EnginePluginData
 
@@ -195,6 +231,64 @@ struct EnginePluginData {
     float outsPeak[2];
 };
 
+// -----------------------------------------------------------------------
+// EnginePluginTransaction
+
+#ifndef BUILD_BRIDGE
+struct EnginePluginTransaction {
+    bool active;
+    uint count;            // number of plugins in the pending list
+    CarlaPlugin** plugins; // pending plugin list, allocated with maxPluginNumber size
+
+    EnginePluginTransaction() noexcept;
+    ~EnginePluginTransaction() noexcept;
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EnginePluginTransaction)
+};
+#endif
+
+// -----------------------------------------------------------------------
+// EngineProjectLoad
+
+#ifndef BUILD_BRIDGE
+struct EngineProjectLoad {
+    struct Thread {
+        pthread_t    thread;
+        CarlaString* error; // receives setLastError() calls made from this thread
+    };
+
+    struct Callback {
+        EngineCallbackOpcode action;
+        uint  pluginId;
+        int   value1;
+        int   value2;
+        float value3;
+        const char* valueStr; // owned, freed once delivered
+    };
+
+    volatile bool active; // plugins are being created outside the main thread
+    CarlaMutex mutex;
+    LinkedList<Thread>   threads;   // protected by mutex
+    LinkedList<Callback> callbacks; // protected by mutex, delivered on the main thread once loading is done
+
+    EngineProjectLoad() noexcept;
+    ~EngineProjectLoad() noexcept;
+
+    // register the calling thread, and unregister it when done
+    void addThread(CarlaString* const error) noexcept;
+    void removeThread() noexcept;
+
+    // store the error if called from a registered thread, returns false otherwise
+    bool setThreadError(const char* const error) noexcept;
+
+    // queue the callback if called from a registered thread, returns false otherwise
+    bool deferCallback(const EngineCallbackOpcode action, const uint pluginId,
+                       const int value1, const int value2, const float value3, const char* const valueStr) noexcept;
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EngineProjectLoad)
+};
+#endif
+
 // -----------------------------------------------------------------------
 // CarlaEngineProtectedData
 
@@ -235,6 +329,7 @@ struct CarlaEngine::ProtectedData {
     CarlaMutex     envMutex;
     CarlaString    lastError;
     CarlaString    name;
+    CarlaString    currentProjectFilename;
     EngineOptions  options;
     EngineTimeInfo timeInfo;
 
@@ -242,14 +337,18 @@ struct CarlaEngine::ProtectedData {
     EnginePluginData plugins[1];
 #else
     EnginePluginData* plugins;
+    EnginePluginData* nextPlugins; // swapped with plugins when a transaction is committed
 #endif
 
     EngineInternalEvents events;
 #ifndef BUILD_BRIDGE
     EngineInternalGraph  graph;
+    EnginePluginTransaction transaction;
+    EngineProjectLoad    projectLoad;
 #endif
     EngineInternalTime   time;
     EngineNextAction     nextAction;
+    EngineInternalStats  stats;
 
     // -------------------------------------------------------------------
 
@@ -267,8 +366,16 @@ struct CarlaEngine::ProtectedData {
 
     void doPluginRemove() noexcept;
     void doPluginsSwitch() noexcept;
+    void doPluginsSwap() noexcept;
     void doNextPluginAction(const bool unlock) noexcept;
 
+#ifndef BUILD_BRIDGE
+    // -------------------------------------------------------------------
+
+    bool isCurrentPlugin(const CarlaPlugin* const plugin) const noexcept;
+    void clearPluginTransaction();
+#endif
+
     // -------------------------------------------------------------------
 
 #ifdef CARLA_PROPER_CPP11_SUPPORT
@@ -287,6 +394,8 @@ public:
 
 private:
     CarlaEngine::ProtectedData* const pData;
+    const uint32_t fNumFrames;
+    const uint64_t fStartTime;
 
     CARLA_PREVENT_HEAP_ALLOCATION
     CARLA_DECLARE_NON_COPY_CLASS(PendingRtEventsRunner)
@@ -294,6 +403,22 @@ private:
 
 // -----------------------------------------------------------------------
 
+class ScopedPluginProcessTimer
+{
+public:
+    ScopedPluginProcessTimer(CarlaPlugin* const plugin, const bool enabled) noexcept;
+    ~ScopedPluginProcessTimer() noexcept;
+
+private:
+    CarlaEngineClient* const fClient;
+    const uint64_t fStartTime;
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(ScopedPluginProcessTimer)
+};
+
+// -----------------------------------------------------------------------
+
 class ScopedActionLock
 {
 public:
@@ -947,6 +947,7 @@ public:
         jackbridge_set_freewheel_callback(fClient, carla_jack_freewheel_callback, this);
         jackbridge_set_latency_callback(fClient, carla_jack_latency_callback, this);
         jackbridge_set_process_callback(fClient, carla_jack_process_callback, this);
+        jackbridge_set_xrun_callback(fClient, carla_jack_xrun_callback, this);
         jackbridge_on_shutdown(fClient, carla_jack_shutdown_callback, this);
 
         if (pData->options.transportMode == ENGINE_TRANSPORT_MODE_JACK)
@@ -1553,6 +1554,11 @@ protected:
         offlineModeChanged(isFreewheel);
     }
 
+    void handleJackXrunCallback()
+    {
+        pData->stats.addXrun();
+    }
+
     void saveTransportInfo()
     {
         if (pData->options.transportMode != ENGINE_TRANSPORT_MODE_JACK)
@@ -1665,8 +1671,8 @@ protected:
         else if (pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK ||
                  pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
         {
-            CARLA_SAFE_ASSERT_RETURN(pData->events.in  != nullptr,);
-            CARLA_SAFE_ASSERT_RETURN(pData->events.out != nullptr,);
+            CARLA_SAFE_ASSERT_RETURN(pData->events.in.data  != nullptr,);
+            CARLA_SAFE_ASSERT_RETURN(pData->events.out.data != nullptr,);
 
             // get buffers from jack
             float* const audioIn1  = (float*)jackbridge_port_get_buffer(fRackPorts[kRackPortAudioIn1], nframes);
@@ -1687,30 +1693,29 @@ protected:
             /**/  float* outBuf[2] = { audioOut1, audioOut2 };
 
             // initialize events
-            carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-            carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+            pData->events.reset();
 
             if (eventIn != nullptr)
             {
-                ushort engineEventIndex = 0;
+                EngineEventBuffer& eventsIn(pData->events.in);
 
                 jack_midi_event_t jackEvent;
                 const uint32_t jackEventCount(jackbridge_midi_get_event_count(eventIn));
 
-                for (uint32_t jackEventIndex=0; jackEventIndex < jackEventCount; ++jackEventIndex)
+                for (uint32_t jackEventIndex=0; jackEventIndex < jackEventCount && ! eventsIn.isFull(); ++jackEventIndex)
                 {
                     if (! jackbridge_midi_event_get(&jackEvent, eventIn, jackEventIndex))
                         continue;
 
                     CARLA_SAFE_ASSERT_CONTINUE(jackEvent.size < 0xFF /* uint8_t max */);
 
-                    EngineEvent& engineEvent(pData->events.in[engineEventIndex++]);
+                    EngineEvent& engineEvent(eventsIn.data[eventsIn.count]);
 
                     engineEvent.time = jackEvent.time;
                     engineEvent.fillFromMidiData(static_cast<uint8_t>(jackEvent.size), jackEvent.buffer, 0);
 
-                    if (engineEventIndex >= kMaxEngineEventInternalCount)
-                        break;
+                    if (engineEvent.type != kEngineEventTypeNull)
+                        ++eventsIn.count;
                 }
             }
 
@@ -1728,14 +1733,11 @@ protected:
                 uint8_t        data[3] = { 0, 0, 0 };
                 const uint8_t* dataPtr = data;
 
-                for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+                for (uint32_t i=0; i < pData->events.out.count; ++i)
                 {
-                    const EngineEvent& engineEvent(pData->events.out[i]);
-
-                    if (engineEvent.type == kEngineEventTypeNull)
-                        break;
+                    const EngineEvent& engineEvent(pData->events.out.data[i]);
 
-                    else if (engineEvent.type == kEngineEventTypeControl)
+                    if (engineEvent.type == kEngineEventTypeControl)
                     {
                         const EngineControlEvent& ctrlEvent(engineEvent.ctrl);
                         ctrlEvent.convertToMidiData(engineEvent.channel, size, data);
@@ -2303,7 +2305,10 @@ private:
             }
         }
 
-        plugin->process(audioIn, audioOut, cvIn, cvOut, nframes);
+        {
+            const ScopedPluginProcessTimer sppt(plugin, pData->options.processStats);
+            plugin->process(audioIn, audioOut, cvIn, cvOut, nframes);
+        }
 
         for (uint32_t i=0; i < audioOutCount && i < 2; ++i)
         {
@@ -2463,6 +2468,12 @@ private:
         handlePtr->handleJackFreewheelCallback(bool(starting));
     }
 
+    static int JACKBRIDGE_API carla_jack_xrun_callback(void* arg)
+    {
+        handlePtr->handleJackXrunCallback();
+        return 0;
+    }
+
     static int JACKBRIDGE_API carla_jack_process_callback(jack_nframes_t nframes, void* arg) __attribute__((annotate("realtime")))
     {
         handlePtr->handleJackProcessCallback(nframes);
@@ -188,6 +188,10 @@ protected:
 
             fEngine->transportRelocate(frame);
         }
+        else if (std::strcmp(msg, "clear_process_stats") == 0)
+        {
+            fEngine->clearProcessStats();
+        }
         else if (std::strcmp(msg, "add_plugin") == 0)
         {
             uint32_t btype, ptype;
@@ -276,6 +280,14 @@ protected:
 
             ok = fEngine->switchPlugins(pluginIdA, pluginIdB);
         }
+        else if (std::strcmp(msg, "begin_plugin_transaction") == 0)
+        {
+            ok = fEngine->beginPluginTransaction();
+        }
+        else if (std::strcmp(msg, "commit_plugin_transaction") == 0)
+        {
+            ok = fEngine->commitPluginTransaction();
+        }
         else if (std::strcmp(msg, "load_plugin_state") == 0)
         {
             uint32_t pluginId;
@@ -392,6 +404,16 @@ protected:
             if (CarlaPlugin* const plugin = fEngine->getPlugin(pluginId))
                 plugin->setCtrlChannel(int8_t(channel), true, false);
         }
+        else if (std::strcmp(msg, "set_plugin_minimum_split_frames") == 0)
+        {
+            uint32_t pluginId, frames;
+
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(pluginId), true);
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(frames), true);
+
+            if (CarlaPlugin* const plugin = fEngine->getPlugin(pluginId))
+                plugin->setMinimumSplitFrames(frames);
+        }
         else if (std::strcmp(msg, "set_parameter_value") == 0)
         {
             uint32_t pluginId, parameterId;
@@ -1384,25 +1406,24 @@ protected:
         // ---------------------------------------------------------------
         // initialize events
 
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+        pData->events.reset();
 
         // ---------------------------------------------------------------
         // events input (before processing)
 
         {
-            uint32_t engineEventIndex = 0;
+            EngineEventBuffer& eventsIn(pData->events.in);
 
-            for (uint32_t i=0; i < midiEventCount && engineEventIndex < kMaxEngineEventInternalCount; ++i)
+            for (uint32_t i=0; i < midiEventCount && ! eventsIn.isFull(); ++i)
             {
                 const NativeMidiEvent& midiEvent(midiEvents[i]);
-                EngineEvent&           engineEvent(pData->events.in[engineEventIndex++]);
+                EngineEvent&           engineEvent(eventsIn.data[eventsIn.count]);
 
                 engineEvent.time = midiEvent.time;
                 engineEvent.fillFromMidiData(midiEvent.size, midiEvent.data, 0);
 
-                if (engineEventIndex >= kMaxEngineEventInternalCount)
-                    break;
+                if (engineEvent.type != kEngineEventTypeNull)
+                    ++eventsIn.count;
             }
         }
 
@@ -1430,18 +1451,15 @@ protected:
         // ---------------------------------------------------------------
         // events output (after processing)
 
-        carla_zeroStructs(pData->events.in, kMaxEngineEventInternalCount);
+        pData->events.in.clear();
 
         if (kHasMidiOut)
         {
             NativeMidiEvent midiEvent;
 
-            for (uint32_t i=0; i < kMaxEngineEventInternalCount; ++i)
+            for (uint32_t i=0; i < pData->events.out.count; ++i)
             {
-                const EngineEvent& engineEvent(pData->events.out[i]);
-
-                if (engineEvent.type == kEngineEventTypeNull)
-                    break;
+                const EngineEvent& engineEvent(pData->events.out.data[i]);
 
                 midiEvent.time = engineEvent.time;
 
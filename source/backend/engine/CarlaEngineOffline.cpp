@@ -0,0 +1,574 @@
+/*
+ * Carla Plugin Host
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaEngineGraph.hpp"
+#include "CarlaEngineInternal.hpp"
+#include "CarlaBackendUtils.hpp"
+#include "CarlaEngineUtils.hpp"
+#include "CarlaMathUtils.hpp"
+#include "CarlaThread.hpp"
+#include "CarlaTimeUtils.hpp"
+
+#include "water/files/File.h"
+#include "water/files/FileOutputStream.h"
+
+#ifdef HAVE_SNDFILE
+# include <sndfile.h>
+#endif
+
+using water::File;
+using water::FileOutputStream;
+using water::String;
+
+CARLA_BACKEND_START_NAMESPACE
+
+// -------------------------------------------------------------------------------------------------------------------
+// Global static data
+
+static const char* const kOfflineDriverName = "Offline";
+
+static const char* const kOfflineDeviceNames[] = {
+    "2 channels",
+    "4 channels",
+    "6 channels",
+    "8 channels",
+    "16 channels",
+    nullptr
+};
+
+static const uint kOfflineMaxChannels = 16;
+
+// -------------------------------------------------------------------------------------------------------------------
+// Audio file writer, 32bit float WAV or (with libsndfile) 24bit FLAC
+
+class OfflineAudioFileWriter
+{
+public:
+    OfflineAudioFileWriter() noexcept
+        : fChannels(0),
+          fMaxFrames(0),
+          fSampleRate(0),
+          fFramesWritten(0),
+          fInterleaved(nullptr),
+          fStream(nullptr)
+#ifdef HAVE_SNDFILE
+        , fSndFile(nullptr)
+#endif
+    {
+    }
+
+    ~OfflineAudioFileWriter()
+    {
+        close();
+    }
+
+    bool open(const char* const filename, const uint channels, const uint32_t maxFrames, const double sampleRate, CarlaString& error)
+    {
+        CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+        CARLA_SAFE_ASSERT_RETURN(channels > 0, false);
+        CARLA_SAFE_ASSERT_RETURN(maxFrames > 0, false);
+
+        const File file(File::getCurrentWorkingDirectory().getChildFile(String(water::CharPointer_UTF8(filename))));
+
+        if (file.hasFileExtension("flac"))
+        {
+#ifdef HAVE_SNDFILE
+            SF_INFO info;
+            carla_zeroStruct(info);
+            info.samplerate = static_cast<int>(sampleRate);
+            info.channels   = static_cast<int>(channels);
+            info.format     = SF_FORMAT_FLAC|SF_FORMAT_PCM_24;
+
+            fSndFile = sf_open(file.getFullPathName().toRawUTF8(), SFM_WRITE, &info);
+
+            if (fSndFile == nullptr)
+            {
+                error = sf_strerror(nullptr);
+                return false;
+            }
+#else
+            error = "FLAC output requires Carla to be built with libsndfile";
+            return false;
+#endif
+        }
+        else
+        {
+            if (file.exists() && ! file.deleteFile())
+            {
+                error = "Failed to overwrite existing output file";
+                return false;
+            }
+
+            fStream = file.createOutputStream();
+
+            if (fStream == nullptr || fStream->failedToOpen())
+            {
+                delete fStream;
+                fStream = nullptr;
+                error = "Failed to create output file";
+                return false;
+            }
+
+            fChannels   = channels;
+            fSampleRate = static_cast<uint32_t>(sampleRate);
+            writeWavHeader(0);
+        }
+
+        fChannels      = channels;
+        fMaxFrames     = maxFrames;
+        fFramesWritten = 0;
+        fInterleaved   = new float[channels*maxFrames];
+        return true;
+    }
+
+    bool write(const float* const* const buffers, const uint32_t frames)
+    {
+        CARLA_SAFE_ASSERT_RETURN(fInterleaved != nullptr, false);
+        CARLA_SAFE_ASSERT_RETURN(frames <= fMaxFrames, false);
+
+        for (uint32_t i=0; i < frames; ++i)
+            for (uint j=0; j < fChannels; ++j)
+                fInterleaved[i*fChannels+j] = buffers[j][i];
+
+        fFramesWritten += frames;
+
+#ifdef HAVE_SNDFILE
+        if (fSndFile != nullptr)
+            return sf_writef_float(fSndFile, fInterleaved, frames) == static_cast<sf_count_t>(frames);
+#endif
+
+        // WAV sample data is little-endian, same as all the platforms we run on
+        return fStream->write(fInterleaved, sizeof(float)*fChannels*frames);
+    }
+
+    void close()
+    {
+#ifdef HAVE_SNDFILE
+        if (fSndFile != nullptr)
+        {
+            sf_close(fSndFile);
+            fSndFile = nullptr;
+        }
+#endif
+
+        if (fStream != nullptr)
+        {
+            // now that we know the final size, go back and fix the header
+            fStream->setPosition(0);
+            writeWavHeader(fFramesWritten);
+            fStream->flush();
+
+            delete fStream;
+            fStream = nullptr;
+        }
+
+        if (fInterleaved != nullptr)
+        {
+            delete[] fInterleaved;
+            fInterleaved = nullptr;
+        }
+
+        fChannels   = 0;
+        fMaxFrames  = 0;
+        fSampleRate = 0;
+    }
+
+private:
+    uint      fChannels;
+    uint32_t  fMaxFrames;
+    uint32_t  fSampleRate;
+    uint64_t  fFramesWritten;
+    float*    fInterleaved;
+    FileOutputStream* fStream;
+#ifdef HAVE_SNDFILE
+    SNDFILE* fSndFile;
+#endif
+
+    // written once with empty sizes on open, and again on close
+    void writeWavHeader(const uint64_t frames)
+    {
+        const uint32_t blockAlign = static_cast<uint32_t>(sizeof(float)*fChannels);
+        const uint64_t dataSize64 = frames*blockAlign;
+        const uint32_t dataSize   = dataSize64 > 0xffffffffULL-36 ? 0xffffffffU-36 : static_cast<uint32_t>(dataSize64);
+
+        fStream->write("RIFF", 4);
+        fStream->writeInt(static_cast<int>(36 + dataSize));
+        fStream->write("WAVE", 4);
+
+        fStream->write("fmt ", 4);
+        fStream->writeInt(16);
+        fStream->writeShort(3); // WAVE_FORMAT_IEEE_FLOAT
+        fStream->writeShort(static_cast<short>(fChannels));
+        fStream->writeInt(static_cast<int>(fSampleRate));
+        fStream->writeInt(static_cast<int>(fSampleRate*blockAlign));
+        fStream->writeShort(static_cast<short>(blockAlign));
+        fStream->writeShort(32);
+
+        fStream->write("data", 4);
+        fStream->writeInt(static_cast<int>(dataSize));
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(OfflineAudioFileWriter)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+// Offline Engine
+
+class CarlaEngineOffline : public CarlaEngine,
+                           public CarlaThread
+{
+public:
+    CarlaEngineOffline()
+        : CarlaEngine(),
+          CarlaThread("CarlaEngineOffline"),
+          fIsRunning(false),
+          fAudioOutCount(0),
+          fAudioBufIn(nullptr),
+          fAudioBufOut(nullptr),
+          fRenderMutex()
+    {
+        carla_debug("CarlaEngineOffline::CarlaEngineOffline()");
+
+        // transport is always ours
+        pData->options.transportMode = ENGINE_TRANSPORT_MODE_INTERNAL;
+    }
+
+    ~CarlaEngineOffline() override
+    {
+        CARLA_SAFE_ASSERT(! fIsRunning);
+        CARLA_SAFE_ASSERT(fAudioOutCount == 0);
+        carla_debug("CarlaEngineOffline::~CarlaEngineOffline()");
+    }
+
+    // -------------------------------------
+
+    bool init(const char* const clientName) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(! fIsRunning, false);
+        CARLA_SAFE_ASSERT_RETURN(clientName != nullptr && clientName[0] != '\0', false);
+        carla_debug("CarlaEngineOffline::init(\"%s\")", clientName);
+
+        if (pData->options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK && pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+        {
+            setLastError("Invalid process mode");
+            return false;
+        }
+
+        uint channels = 2;
+
+        // the device name is just the output channel layout, rack mode is always stereo
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY && pData->options.audioDevice != nullptr)
+        {
+            const int deviceChannels = std::atoi(pData->options.audioDevice);
+
+            if (deviceChannels > 0)
+                channels = carla_fixedValue<uint>(1, kOfflineMaxChannels, static_cast<uint>(deviceChannels));
+        }
+
+        // set before internal init, the engine thread checks for it
+        fIsRunning = true;
+
+        if (! pData->init(clientName))
+        {
+            close();
+            setLastError("Failed to init internal data");
+            return false;
+        }
+
+        pData->bufferSize = pData->options.audioBufferSize;
+        pData->sampleRate = pData->options.audioSampleRate;
+        pData->initTime(pData->options.transportExtra);
+
+        fAudioOutCount = channels;
+        fAudioBufIn    = new float[2*pData->bufferSize];
+        fAudioBufOut   = new float[fAudioOutCount*pData->bufferSize];
+        carla_zeroFloats(fAudioBufIn, 2*pData->bufferSize);
+
+        pData->graph.create(0, fAudioOutCount);
+
+        startThread();
+
+        patchbayRefresh(false);
+
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+            refreshExternalGraphPorts<PatchbayGraph>(pData->graph.getPatchbayGraph(), false);
+
+        callback(ENGINE_CALLBACK_ENGINE_STARTED, 0, pData->options.processMode, pData->options.transportMode, 0.0f, getCurrentDriverName());
+        return true;
+    }
+
+    bool close() override
+    {
+        carla_debug("CarlaEngineOffline::close()");
+
+        // clear engine data, our thread still takes care of pending plugin actions
+        CarlaEngine::close();
+
+        fIsRunning = false;
+        stopThread(-1);
+
+        pData->graph.destroy();
+
+        fAudioOutCount = 0;
+
+        if (fAudioBufIn != nullptr)
+        {
+            delete[] fAudioBufIn;
+            fAudioBufIn = nullptr;
+        }
+
+        if (fAudioBufOut != nullptr)
+        {
+            delete[] fAudioBufOut;
+            fAudioBufOut = nullptr;
+        }
+
+        return true;
+    }
+
+    bool isRunning() const noexcept override
+    {
+        return fIsRunning;
+    }
+
+    bool isOffline() const noexcept override
+    {
+        return true;
+    }
+
+    EngineType getType() const noexcept override
+    {
+        return kEngineTypeOffline;
+    }
+
+    const char* getCurrentDriverName() const noexcept override
+    {
+        return kOfflineDriverName;
+    }
+
+    // -------------------------------------------------------------------
+    // Patchbay
+
+    template<class Graph>
+    bool refreshExternalGraphPorts(Graph* const graph, const bool sendCallback)
+    {
+        CARLA_SAFE_ASSERT_RETURN(graph != nullptr, false);
+
+        char strBuf[STR_MAX+1];
+        strBuf[STR_MAX] = '\0';
+
+        ExternalGraph& extGraph(graph->extGraph);
+
+        // ---------------------------------------------------------------
+        // clear last ports
+
+        extGraph.clear();
+
+        // ---------------------------------------------------------------
+        // fill in new ones, there are no inputs or MIDI ports offline
+
+        for (uint i=0; i < fAudioOutCount; ++i)
+        {
+            std::snprintf(strBuf, STR_MAX, "playback_%i", i+1);
+
+            PortNameToId portNameToId;
+            portNameToId.setData(kExternalGraphGroupAudioOut, i+1, strBuf, "");
+
+            extGraph.audioPorts.outs.append(portNameToId);
+        }
+
+        // ---------------------------------------------------------------
+        // now refresh
+
+        if (sendCallback)
+            graph->refresh(kOfflineDriverName);
+
+        return true;
+    }
+
+    bool patchbayRefresh(const bool external) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(pData->graph.isReady(), false);
+
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK)
+            return refreshExternalGraphPorts<RackGraph>(pData->graph.getRackGraph(), true);
+
+        pData->graph.setUsingExternal(external);
+
+        if (external)
+            return refreshExternalGraphPorts<PatchbayGraph>(pData->graph.getPatchbayGraph(), true);
+
+        return CarlaEngine::patchbayRefresh(false);
+    }
+
+    // -------------------------------------------------------------------
+    // Offline rendering
+
+    bool renderToFile(const char* const filename, const uint64_t frames) override
+    {
+        CARLA_SAFE_ASSERT_RETURN_ERR(fIsRunning, "Engine is not running");
+        CARLA_SAFE_ASSERT_RETURN_ERR(filename != nullptr && filename[0] != '\0', "Invalid filename");
+        CARLA_SAFE_ASSERT_RETURN_ERR(frames > 0, "Invalid number of frames");
+        carla_debug("CarlaEngineOffline::renderToFile(\"%s\", " P_UINT64 ")", filename, frames);
+
+        const CarlaMutexLocker cml(fRenderMutex);
+
+        const uint32_t bufferSize(pData->bufferSize);
+
+        OfflineAudioFileWriter writer;
+        CarlaString error;
+
+        if (! writer.open(filename, fAudioOutCount, bufferSize, pData->sampleRate, error))
+        {
+            setLastError(error);
+            return false;
+        }
+
+        float* outBuf[kOfflineMaxChannels];
+
+        for (uint i=0; i < fAudioOutCount; ++i)
+            outBuf[i] = fAudioBufOut + (bufferSize*i);
+
+        const bool isRack(pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK);
+        const uint64_t startTime(carla_gettime_us());
+        uint64_t framesDone = 0;
+        uint lastProgress = 0;
+        bool ok = true;
+
+        transportRelocate(0);
+        transportPlay();
+
+        while (framesDone < frames && ! pData->aboutToClose)
+        {
+            {
+                const PendingRtEventsRunner prt(this, bufferSize);
+
+                carla_zeroFloats(fAudioBufOut, fAudioOutCount*bufferSize);
+
+                // initialize events
+                pData->events.reset();
+
+                if (isRack)
+                {
+                    // always take the main rack output, no need for connections to "playback" ports
+                    const float* inBuf2[2] = { fAudioBufIn, fAudioBufIn + bufferSize };
+                    /* */ float* outBuf2[2] = { outBuf[0], outBuf[1] };
+
+                    pData->graph.processRack(pData, inBuf2, outBuf2, bufferSize);
+                }
+                else
+                {
+                    pData->graph.process(pData, nullptr, outBuf, bufferSize);
+                }
+            }
+
+            // plugins always get full cycles, the last one is trimmed here
+            const uint32_t framesToWrite(static_cast<uint32_t>(std::min<uint64_t>(frames - framesDone, bufferSize)));
+
+            if (! writer.write(outBuf, framesToWrite))
+            {
+                setLastError("Failed to write to output file");
+                ok = false;
+                break;
+            }
+
+            framesDone += framesToWrite;
+
+            const uint progress(static_cast<uint>(framesDone*10/frames));
+
+            if (progress != lastProgress)
+            {
+                lastProgress = progress;
+                carla_stdout("CarlaEngineOffline::renderToFile() - %3u%% done", progress*10);
+            }
+        }
+
+        transportPause();
+        writer.close();
+
+        if (ok)
+        {
+            const uint64_t elapsedTime(carla_gettime_us() - startTime);
+
+            carla_stdout("CarlaEngineOffline::renderToFile() - rendered %.2fs of audio in %.2fs",
+                         static_cast<double>(framesDone)/pData->sampleRate, static_cast<double>(elapsedTime)/1000000.0);
+        }
+
+        return ok;
+    }
+
+    // -------------------------------------------------------------------
+
+protected:
+    void run() override
+    {
+        // nothing drives the graph while idle, so pending plugin actions are handled here instead
+        for (; ! shouldThreadExit();)
+        {
+            if (fRenderMutex.tryLock())
+            {
+                if (pData->nextAction.opcode != kEnginePostActionNull)
+                    pData->doNextPluginAction(true);
+
+                fRenderMutex.unlock();
+            }
+
+            carla_msleep(10);
+        }
+    }
+
+    // -------------------------------------------------------------------
+
+private:
+    volatile bool fIsRunning;
+
+    uint   fAudioOutCount;
+    float* fAudioBufIn;
+    float* fAudioBufOut;
+
+    CarlaMutex fRenderMutex;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaEngineOffline)
+};
+
+// -----------------------------------------
+
+CarlaEngine* CarlaEngine::newOffline()
+{
+    return new CarlaEngineOffline();
+}
+
+const char* const* CarlaEngine::getOfflineDeviceNames()
+{
+    return kOfflineDeviceNames;
+}
+
+const EngineDriverDeviceInfo* CarlaEngine::getOfflineDeviceInfo()
+{
+    static uint32_t bufSizes[] = { 64, 128, 256, 512, 1024, 2048, 4096, 8192, 0 };
+    static double sampleRates[] = { 22050.0, 32000.0, 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0, 0.0 };
+    static EngineDriverDeviceInfo devInfo;
+
+    devInfo.hints       = ENGINE_DRIVER_DEVICE_VARIABLE_BUFFER_SIZE|ENGINE_DRIVER_DEVICE_VARIABLE_SAMPLE_RATE;
+    devInfo.bufferSizes = bufSizes;
+    devInfo.sampleRates = sampleRates;
+    return &devInfo;
+}
+
+// -----------------------------------------
+
+CARLA_BACKEND_END_NAMESPACE
@@ -403,6 +403,38 @@ void CarlaEngine::oscSend_control_set_peaks(const uint pluginId) const noexcept
     try_lo_send(pData->oscData->target, targetPath, "iffff", static_cast<int32_t>(pluginId), epData.insPeak[0], epData.insPeak[1], epData.outsPeak[0], epData.outsPeak[1]);
 }
 
+void CarlaEngine::oscSend_control_set_engine_stats() const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData->path != nullptr && pData->oscData->path[0] != '\0',);
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData->target != nullptr,);
+
+    char targetPath[std::strlen(pData->oscData->path)+18];
+    std::strcpy(targetPath, pData->oscData->path);
+    std::strcat(targetPath, "/set_engine_stats");
+    try_lo_send(pData->oscData->target, targetPath, "fii", getDSPLoad(),
+                static_cast<int32_t>(getXrunCount()), static_cast<int32_t>(getOverrunCount()));
+}
+
+void CarlaEngine::oscSend_control_set_process_stats(const uint pluginId) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData->path != nullptr && pData->oscData->path[0] != '\0',);
+    CARLA_SAFE_ASSERT_RETURN(pData->oscData->target != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(pluginId < pData->curPluginCount,);
+
+    EngineProcessStats stats;
+
+    if (! getPluginProcessStats(pluginId, stats))
+        return;
+
+    char targetPath[std::strlen(pData->oscData->path)+19];
+    std::strcpy(targetPath, pData->oscData->path);
+    std::strcat(targetPath, "/set_process_stats");
+    try_lo_send(pData->oscData->target, targetPath, "iiffffff", static_cast<int32_t>(pluginId), static_cast<int32_t>(stats.count),
+                stats.minTime, stats.avgTime, stats.maxTime, stats.p50Time, stats.p90Time, stats.p99Time);
+}
+
 void CarlaEngine::oscSend_control_exit() const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(pData->oscData != nullptr,);
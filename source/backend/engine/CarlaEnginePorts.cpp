@@ -91,7 +91,10 @@ CarlaEngineEventPort::CarlaEngineEventPort(const CarlaEngineClient& client, cons
     carla_debug("CarlaEngineEventPort::CarlaEngineEventPort(%s)", bool2str(isInputPort));
 
     if (kProcessMode == ENGINE_PROCESS_MODE_PATCHBAY)
-        fBuffer = new EngineEvent[kMaxEngineEventInternalCount];
+    {
+        fBuffer = new EngineEventBuffer();
+        fBuffer->allocate();
+    }
 }
 
 CarlaEngineEventPort::~CarlaEngineEventPort() noexcept
@@ -102,7 +105,8 @@ CarlaEngineEventPort::~CarlaEngineEventPort() noexcept
     {
         CARLA_SAFE_ASSERT_RETURN(fBuffer != nullptr,);
 
-        delete[] fBuffer;
+        fBuffer->deallocate();
+        delete fBuffer;
         fBuffer = nullptr;
     }
 }
@@ -112,7 +116,7 @@ void CarlaEngineEventPort::initBuffer() noexcept
     if (kProcessMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK || kProcessMode == ENGINE_PROCESS_MODE_BRIDGE)
         fBuffer = kClient.getEngine().getInternalEventBuffer(kIsInput);
     else if (kProcessMode == ENGINE_PROCESS_MODE_PATCHBAY && ! kIsInput)
-        carla_zeroStructs(fBuffer, kMaxEngineEventInternalCount);
+        fBuffer->clear();
 }
 
 uint32_t CarlaEngineEventPort::getEventCount() const noexcept
@@ -121,15 +125,7 @@ uint32_t CarlaEngineEventPort::getEventCount() const noexcept
     CARLA_SAFE_ASSERT_RETURN(fBuffer != nullptr, 0);
     CARLA_SAFE_ASSERT_RETURN(kProcessMode != ENGINE_PROCESS_MODE_SINGLE_CLIENT && kProcessMode != ENGINE_PROCESS_MODE_MULTIPLE_CLIENTS, 0);
 
-    uint32_t i=0;
-
-    for (; i < kMaxEngineEventInternalCount; ++i)
-    {
-        if (fBuffer[i].type == kEngineEventTypeNull)
-            break;
-    }
-
-    return i;
+    return fBuffer->count;
 }
 
 const EngineEvent& CarlaEngineEventPort::getEvent(const uint32_t index) const noexcept
@@ -137,14 +133,14 @@ const EngineEvent& CarlaEngineEventPort::getEvent(const uint32_t index) const no
     CARLA_SAFE_ASSERT_RETURN(kIsInput, kFallbackEngineEvent);
     CARLA_SAFE_ASSERT_RETURN(fBuffer != nullptr, kFallbackEngineEvent);
     CARLA_SAFE_ASSERT_RETURN(kProcessMode != ENGINE_PROCESS_MODE_SINGLE_CLIENT && kProcessMode != ENGINE_PROCESS_MODE_MULTIPLE_CLIENTS, kFallbackEngineEvent);
-    CARLA_SAFE_ASSERT_RETURN(index < kMaxEngineEventInternalCount, kFallbackEngineEvent);
+    CARLA_SAFE_ASSERT_RETURN(index < fBuffer->count, kFallbackEngineEvent);
 
-    return fBuffer[index];
+    return fBuffer->data[index];
 }
 
 const EngineEvent& CarlaEngineEventPort::getEventUnchecked(const uint32_t index) const noexcept
 {
-    return fBuffer[index];
+    return fBuffer->data[index];
 }
 
 bool CarlaEngineEventPort::writeControlEvent(const uint32_t time, const uint8_t channel, const EngineControlEvent& ctrl) noexcept
@@ -165,26 +161,23 @@ bool CarlaEngineEventPort::writeControlEvent(const uint32_t time, const uint8_t
         CARLA_SAFE_ASSERT(! MIDI_IS_CONTROL_BANK_SELECT(param));
     }
 
-    for (uint32_t i=0; i < kMaxEngineEventInternalCount; ++i)
+    if (fBuffer->isFull())
     {
-        EngineEvent& event(fBuffer[i]);
-
-        if (event.type != kEngineEventTypeNull)
-            continue;
+        carla_stderr2("CarlaEngineEventPort::writeControlEvent() - buffer full");
+        return false;
+    }
 
-        event.type    = kEngineEventTypeControl;
-        event.time    = time;
-        event.channel = channel;
+    EngineEvent& event(fBuffer->data[fBuffer->count++]);
 
-        event.ctrl.type  = type;
-        event.ctrl.param = param;
-        event.ctrl.value = carla_fixedValue<float>(0.0f, 1.0f, value);
+    event.type    = kEngineEventTypeControl;
+    event.time    = time;
+    event.channel = channel;
 
-        return true;
-    }
+    event.ctrl.type  = type;
+    event.ctrl.param = param;
+    event.ctrl.value = carla_fixedValue<float>(0.0f, 1.0f, value);
 
-    carla_stderr2("CarlaEngineEventPort::writeControlEvent() - buffer full");
-    return false;
+    return true;
 }
 
 bool CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t size, const uint8_t* const data) noexcept
@@ -207,85 +200,88 @@ bool CarlaEngineEventPort::writeMidiEvent(const uint32_t time, const uint8_t cha
     CARLA_SAFE_ASSERT_RETURN(size > 0 && size <= EngineMidiEvent::kDataSize, false);
     CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
 
-    for (uint32_t i=0; i < kMaxEngineEventInternalCount; ++i)
+    if (fBuffer->isFull())
     {
-        EngineEvent& event(fBuffer[i]);
+        carla_stderr2("CarlaEngineEventPort::writeMidiEvent() - buffer full");
+        return false;
+    }
 
-        if (event.type != kEngineEventTypeNull)
-            continue;
+    // only counted once filled in, the early returns below leave it unused
+    EngineEvent& event(fBuffer->data[fBuffer->count]);
 
-        event.time    = time;
-        event.channel = channel;
+    event.time    = time;
+    event.channel = channel;
 
-        const uint8_t status(uint8_t(MIDI_GET_STATUS_FROM_DATA(data)));
+    const uint8_t status(uint8_t(MIDI_GET_STATUS_FROM_DATA(data)));
 
-        if (status == MIDI_STATUS_CONTROL_CHANGE)
-        {
-            CARLA_SAFE_ASSERT_RETURN(size >= 3, true);
-
-            switch (data[1])
-            {
-            case MIDI_CONTROL_BANK_SELECT:
-            case MIDI_CONTROL_BANK_SELECT__LSB:
-                event.type       = kEngineEventTypeControl;
-                event.ctrl.type  = kEngineControlEventTypeMidiBank;
-                event.ctrl.param = data[2];
-                event.ctrl.value = 0.0f;
-                return true;
-
-            case MIDI_CONTROL_ALL_SOUND_OFF:
-                event.type       = kEngineEventTypeControl;
-                event.ctrl.type  = kEngineControlEventTypeAllSoundOff;
-                event.ctrl.param = 0;
-                event.ctrl.value = 0.0f;
-                return true;
-
-            case MIDI_CONTROL_ALL_NOTES_OFF:
-                event.type       = kEngineEventTypeControl;
-                event.ctrl.type  = kEngineControlEventTypeAllNotesOff;
-                event.ctrl.param = 0;
-                event.ctrl.value = 0.0f;
-                return true;
-            }
-        }
+    if (status == MIDI_STATUS_CONTROL_CHANGE)
+    {
+        CARLA_SAFE_ASSERT_RETURN(size >= 3, true);
 
-        if (status == MIDI_STATUS_PROGRAM_CHANGE)
+        switch (data[1])
         {
-            CARLA_SAFE_ASSERT_RETURN(size >= 2, true);
-
+        case MIDI_CONTROL_BANK_SELECT:
+        case MIDI_CONTROL_BANK_SELECT__LSB:
             event.type       = kEngineEventTypeControl;
             event.ctrl.type  = kEngineControlEventTypeMidiBank;
-            event.ctrl.param = data[1];
+            event.ctrl.param = data[2];
             event.ctrl.value = 0.0f;
+            ++fBuffer->count;
             return true;
-        }
 
-        event.type      = kEngineEventTypeMidi;
-        event.midi.size = size;
+        case MIDI_CONTROL_ALL_SOUND_OFF:
+            event.type       = kEngineEventTypeControl;
+            event.ctrl.type  = kEngineControlEventTypeAllSoundOff;
+            event.ctrl.param = 0;
+            event.ctrl.value = 0.0f;
+            ++fBuffer->count;
+            return true;
 
-        if (kIndexOffset < 0xFF /* uint8_t max */)
-        {
-            event.midi.port = static_cast<uint8_t>(kIndexOffset);
-        }
-        else
-        {
-            event.midi.port = 0;
-            carla_safe_assert_uint("kIndexOffset < 0xFF", __FILE__, __LINE__, kIndexOffset);
+        case MIDI_CONTROL_ALL_NOTES_OFF:
+            event.type       = kEngineEventTypeControl;
+            event.ctrl.type  = kEngineControlEventTypeAllNotesOff;
+            event.ctrl.param = 0;
+            event.ctrl.value = 0.0f;
+            ++fBuffer->count;
+            return true;
         }
+    }
 
-        event.midi.data[0] = status;
-
-        uint8_t j=1;
-        for (; j < size; ++j)
-            event.midi.data[j] = data[j];
-        for (; j < EngineMidiEvent::kDataSize; ++j)
-            event.midi.data[j] = 0;
+    if (status == MIDI_STATUS_PROGRAM_CHANGE)
+    {
+        CARLA_SAFE_ASSERT_RETURN(size >= 2, true);
 
+        event.type       = kEngineEventTypeControl;
+        event.ctrl.type  = kEngineControlEventTypeMidiBank;
+        event.ctrl.param = data[1];
+        event.ctrl.value = 0.0f;
+        ++fBuffer->count;
         return true;
     }
 
-    carla_stderr2("CarlaEngineEventPort::writeMidiEvent() - buffer full");
-    return false;
+    event.type      = kEngineEventTypeMidi;
+    event.midi.size = size;
+
+    if (kIndexOffset < 0xFF /* uint8_t max */)
+    {
+        event.midi.port = static_cast<uint8_t>(kIndexOffset);
+    }
+    else
+    {
+        event.midi.port = 0;
+        carla_safe_assert_uint("kIndexOffset < 0xFF", __FILE__, __LINE__, kIndexOffset);
+    }
+
+    event.midi.data[0] = status;
+
+    uint8_t j=1;
+    for (; j < size; ++j)
+        event.midi.data[j] = data[j];
+    for (; j < EngineMidiEvent::kDataSize; ++j)
+        event.midi.data[j] = 0;
+
+    ++fBuffer->count;
+    return true;
 }
 
 // -----------------------------------------------------------------------
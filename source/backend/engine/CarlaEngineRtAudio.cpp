@@ -1,6 +1,6 @@
 /*
  * Carla Plugin Host
- * Copyright (C) 2011-2017 Filipe Coelho <falktx@falktx.com>
+ * Copyright (C) 2011-2018 Filipe Coelho <falktx@falktx.com>
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License as
@@ -19,7 +19,11 @@
 #include "CarlaEngineInternal.hpp"
 #include "CarlaBackendUtils.hpp"
 #include "CarlaMathUtils.hpp"
+#include "CarlaRingBuffer.hpp"
+#include "CarlaSemUtils.hpp"
 #include "CarlaStringList.hpp"
+#include "CarlaThread.hpp"
+#include "CarlaTimeUtils.hpp"
 
 #include "RtLinkedList.hpp"
 
@@ -33,6 +37,9 @@ CARLA_BACKEND_START_NAMESPACE
 // -------------------------------------------------------------------------------------------------------------------
 // Global static data
 
+// size of the queue between the audio thread and the MIDI output thread
+static const uint32_t kMidiOutQueueSize = 65536;
+
 static CharStringListPtr         gDeviceNames;
 static std::vector<RtAudio::Api> gRtAudioApis;
 
@@ -156,16 +163,19 @@ static RtMidi::Api getMatchedAudioMidiAPI(const RtAudio::Api rtApi) noexcept
 // -------------------------------------------------------------------------------------------------------------------
 // RtAudio Engine
 
-class CarlaEngineRtAudio : public CarlaEngine
+class CarlaEngineRtAudio : public CarlaEngine,
+                           public CarlaThread
 {
 public:
     CarlaEngineRtAudio(const RtAudio::Api api)
         : CarlaEngine(),
+          CarlaThread("CarlaEngineRtAudioMidiOut"),
           fAudio(api),
           fAudioInterleaved(false),
           fAudioInCount(0),
           fAudioOutCount(0),
           fLastEventTime(0),
+          fLastCycleTime(0),
           fDeviceName(),
           fAudioIntBufIn(nullptr),
           fAudioIntBufOut(nullptr),
@@ -173,12 +183,17 @@ public:
           fMidiInEvents(),
           fMidiOuts(),
           fMidiOutMutex(),
-          fMidiOutVector(3)
+          fMidiOutQueue(),
+          fMidiOutSem(),
+          fMidiOutWaiting(0)
     {
         carla_debug("CarlaEngineRtAudio::CarlaEngineRtAudio(%i)", api);
 
         // just to make sure
         pData->options.transportMode = ENGINE_TRANSPORT_MODE_INTERNAL;
+
+        fMidiOutQueue.createBuffer(kMidiOutQueueSize);
+        carla_sem_create2(fMidiOutSem);
     }
 
     ~CarlaEngineRtAudio() override
@@ -187,6 +202,8 @@ public:
         CARLA_SAFE_ASSERT(fAudioOutCount == 0);
         CARLA_SAFE_ASSERT(fLastEventTime == 0);
         carla_debug("CarlaEngineRtAudio::~CarlaEngineRtAudio()");
+
+        carla_sem_destroy2(fMidiOutSem);
     }
 
     // -------------------------------------
@@ -307,6 +324,7 @@ public:
         fAudioInCount  = iParams.nChannels;
         fAudioOutCount = oParams.nChannels;
         fLastEventTime = 0;
+        fLastCycleTime = 0;
 
         if (fAudioInCount > 0)
             fAudioIntBufIn = new float[fAudioInCount*bufferFrames];
@@ -316,6 +334,8 @@ public:
 
         pData->graph.create(fAudioInCount, fAudioOutCount);
 
+        startThread();
+
         try {
             fAudio.startStream();
         }
@@ -354,6 +374,11 @@ public:
             }
         }
 
+        // stop MIDI output, the audio thread is not writing to the queue anymore
+        signalThreadShouldExit();
+        wakeUpMidiOutThread();
+        stopThread(-1);
+
         // clear engine data
         CarlaEngine::close();
 
@@ -390,9 +415,12 @@ public:
         fMidiOuts.clear();
         fMidiOutMutex.unlock();
 
+        fMidiOutQueue.clearData();
+
         fAudioInCount  = 0;
         fAudioOutCount = 0;
         fLastEventTime = 0;
+        fLastCycleTime = 0;
         fDeviceName.clear();
 
         if (fAudioIntBufIn != nullptr)
@@ -583,6 +611,13 @@ protected:
     {
         const PendingRtEventsRunner prt(this, nframes);
 
+        if (status != 0)
+            pData->stats.addXrun();
+
+        // wall-clock time of this cycle, used to place MIDI events inside the block
+        const uint64_t cycleTime     = carla_gettime_us();
+        const uint64_t cycleDuration = static_cast<uint64_t>(nframes * 1000000.0 / pData->sampleRate);
+
         // get buffers from RtAudio
         const float* const insPtr  = (const float*)inputBuffer;
         /* */ float* const outsPtr =       (float*)outputBuffer;
@@ -627,12 +662,15 @@ protected:
         }
 
         // initialize events
-        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
-        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+        pData->events.reset();
+
+        // events received during the previous cycle are played back with the same spacing during this one
+        const uint64_t lastCycleTime = fLastCycleTime != 0 ? fLastCycleTime : cycleTime - cycleDuration;
+        fLastCycleTime = cycleTime;
 
         if (fMidiInEvents.mutex.tryLock())
         {
-            uint32_t engineEventIndex = 0;
+            EngineEventBuffer& eventsIn(pData->events.in);
             fMidiInEvents.splice();
 
             for (LinkedList<RtMidiEvent>::Itenerator it = fMidiInEvents.data.begin2(); it.valid(); it.next())
@@ -642,23 +680,25 @@ protected:
                 const RtMidiEvent& midiEvent(it.getValue(fallback));
                 CARLA_SAFE_ASSERT_CONTINUE(midiEvent.size > 0);
 
-                EngineEvent& engineEvent(pData->events.in[engineEventIndex++]);
+                EngineEvent& engineEvent(eventsIn.data[eventsIn.count]);
 
-                if (midiEvent.time < pData->timeInfo.frame)
+                if (midiEvent.time <= lastCycleTime)
                 {
                     engineEvent.time = 0;
                 }
-                else if (midiEvent.time >= pData->timeInfo.frame + nframes)
+                else
                 {
-                    carla_stderr("MIDI Event in the future!, %i vs %i", engineEvent.time, pData->timeInfo.frame);
-                    engineEvent.time = static_cast<uint32_t>(pData->timeInfo.frame) + nframes - 1;
+                    const uint64_t frame = static_cast<uint64_t>(static_cast<double>(midiEvent.time - lastCycleTime)
+                                                                 * pData->sampleRate / 1000000.0);
+                    engineEvent.time = frame < nframes ? static_cast<uint32_t>(frame) : nframes - 1;
                 }
-                else
-                    engineEvent.time = static_cast<uint32_t>(midiEvent.time - pData->timeInfo.frame);
 
                 engineEvent.fillFromMidiData(midiEvent.size, midiEvent.data, 0);
 
-                if (engineEventIndex >= kMaxEngineEventInternalCount)
+                if (engineEvent.type != kEngineEventTypeNull)
+                    ++eventsIn.count;
+
+                if (eventsIn.isFull())
                     break;
             }
 
@@ -668,22 +708,19 @@ protected:
 
         pData->graph.process(pData, inBuf, outBuf, nframes);
 
-        fMidiOutMutex.lock();
-
+        // queue MIDI output for the MIDI thread, events are sent one cycle later, at their position in time
         if (fMidiOuts.count() > 0)
         {
+            bool           queued  = false;
             uint8_t        size    = 0;
             uint8_t        data[3] = { 0, 0, 0 };
             const uint8_t* dataPtr = data;
 
-            for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+            for (uint32_t i=0; i < pData->events.out.count; ++i)
             {
-                const EngineEvent& engineEvent(pData->events.out[i]);
-
-                if (engineEvent.type == kEngineEventTypeNull)
-                    break;
+                const EngineEvent& engineEvent(pData->events.out.data[i]);
 
-                else if (engineEvent.type == kEngineEventTypeControl)
+                if (engineEvent.type == kEngineEventTypeControl)
                 {
                     const EngineControlEvent& ctrlEvent(engineEvent.ctrl);
                     ctrlEvent.convertToMidiData(engineEvent.channel, size, data);
@@ -705,24 +742,25 @@ protected:
                     continue;
                 }
 
-                if (size > 0)
-                {
-                    fMidiOutVector.assign(dataPtr, dataPtr + size);
+                if (size == 0)
+                    continue;
 
-                    for (LinkedList<MidiOutPort>::Itenerator it=fMidiOuts.begin2(); it.valid(); it.next())
-                    {
-                        static MidiOutPort fallback = { nullptr, { '\0' } };
+                const uint64_t time = cycleTime + cycleDuration
+                                    + static_cast<uint64_t>(engineEvent.time * 1000000.0 / pData->sampleRate);
 
-                        MidiOutPort& outPort(it.getValue(fallback));
-                        CARLA_SAFE_ASSERT_CONTINUE(outPort.port != nullptr);
+                fMidiOutQueue.writeULong(time);
+                fMidiOutQueue.writeByte(size);
+                fMidiOutQueue.writeCustomData(dataPtr, size);
 
-                        outPort.port->sendMessage(&fMidiOutVector);
-                    }
-                }
+                if (! fMidiOutQueue.commitWrite())
+                    break;
+
+                queued = true;
             }
-        }
 
-        fMidiOutMutex.unlock();
+            if (queued)
+                wakeUpMidiOutThread();
+        }
 
         if (fAudioInterleaved)
         {
@@ -732,7 +770,7 @@ protected:
         }
 
         return; // unused
-        (void)streamTime; (void)status;
+        (void)streamTime;
     }
 
     void handleMidiCallback(double timeStamp, std::vector<uchar>* const message)
@@ -742,15 +780,9 @@ protected:
         if (messageSize == 0 || messageSize > EngineMidiEvent::kDataSize)
             return;
 
-        timeStamp /= 2;
-
-        if (timeStamp > 0.95)
-            timeStamp = 0.95;
-        else if (timeStamp < 0.0)
-            timeStamp = 0.0;
-
+        // use our own clock, the RtMidi delta time is relative to the previous message and not to the audio cycle
         RtMidiEvent midiEvent;
-        midiEvent.time = pData->timeInfo.frame + uint64_t(timeStamp * (double)pData->bufferSize);
+        midiEvent.time = carla_gettime_us();
 
         if (midiEvent.time < fLastEventTime)
             midiEvent.time = fLastEventTime;
@@ -766,6 +798,9 @@ protected:
             midiEvent.data[i] = 0;
 
         fMidiInEvents.append(midiEvent);
+
+        // unused
+        (void)timeStamp;
     }
 
     // -------------------------------------------------------------------
@@ -941,6 +976,80 @@ protected:
 
     // -------------------------------------------------------------------
 
+    // wakes up the MIDI output thread, only if it is sleeping
+    void wakeUpMidiOutThread() noexcept
+    {
+        if (__sync_bool_compare_and_swap(&fMidiOutWaiting, 1, 0))
+            carla_sem_post(fMidiOutSem, true);
+    }
+
+    // MIDI output thread, sends queued events when their time comes
+    void run() override
+    {
+        std::vector<uint8_t> message;
+        message.reserve(0xff);
+
+        uint8_t  data[0xff];
+        uint8_t  size = 0;
+        uint64_t time = 0;
+
+        for (; ! shouldThreadExit();)
+        {
+            if (size == 0)
+            {
+                if (! fMidiOutQueue.isDataAvailableForReading())
+                {
+                    // sleep until the audio thread queues something (or we are told to stop)
+                    __sync_lock_test_and_set(&fMidiOutWaiting, 1);
+
+                    if (! fMidiOutQueue.isDataAvailableForReading() && ! shouldThreadExit())
+                        if (carla_sem_timedwait(fMidiOutSem, 1000, true))
+                            continue;
+
+                    // we woke up by ourselves, consume the post if it is already on its way
+                    if (! __sync_bool_compare_and_swap(&fMidiOutWaiting, 1, 0))
+                        carla_sem_timedwait(fMidiOutSem, 1000, true);
+
+                    continue;
+                }
+
+                time = fMidiOutQueue.readULong();
+                size = fMidiOutQueue.readByte();
+                CARLA_SAFE_ASSERT_CONTINUE(size != 0);
+
+                fMidiOutQueue.readCustomData(data, size);
+            }
+
+            // wait until the event is due, with millisecond granularity
+            const uint64_t now = carla_gettime_us();
+
+            if (time > now + 1000)
+            {
+                carla_msleep(static_cast<uint>((time - now) / 1000));
+                continue;
+            }
+
+            message.assign(data, data + size);
+            size = 0;
+
+            const CarlaMutexLocker cml(fMidiOutMutex);
+
+            for (LinkedList<MidiOutPort>::Itenerator it=fMidiOuts.begin2(); it.valid(); it.next())
+            {
+                static MidiOutPort fallback = { nullptr, { '\0' } };
+
+                MidiOutPort& outPort(it.getValue(fallback));
+                CARLA_SAFE_ASSERT_CONTINUE(outPort.port != nullptr);
+
+                try {
+                    outPort.port->sendMessage(&message);
+                } CARLA_SAFE_EXCEPTION_CONTINUE("RtMidiOut::sendMessage");
+            }
+        }
+    }
+
+    // -------------------------------------------------------------------
+
 private:
     RtAudio fAudio;
 
@@ -949,6 +1058,7 @@ private:
     uint fAudioInCount;
     uint fAudioOutCount;
     uint64_t fLastEventTime;
+    uint64_t fLastCycleTime;
 
     // current device name
     CarlaString fDeviceName;
@@ -968,7 +1078,7 @@ private:
     };
 
     struct RtMidiEvent {
-        uint64_t time; // needs to compare to internal time
+        uint64_t time; // arrival time, in microseconds
         uint8_t  size;
         uint8_t  data[EngineMidiEvent::kDataSize];
     };
@@ -1017,7 +1127,9 @@ private:
 
     LinkedList<MidiOutPort> fMidiOuts;
     CarlaMutex              fMidiOutMutex;
-    std::vector<uint8_t>    fMidiOutVector;
+    CarlaHeapRingBuffer     fMidiOutQueue;
+    carla_sem_t             fMidiOutSem;
+    volatile int            fMidiOutWaiting;
 
     #define handlePtr ((CarlaEngineRtAudio*)userData)
 
@@ -19,21 +19,65 @@
 #include "CarlaEngineThread.hpp"
 #include "CarlaPlugin.hpp"
 
+#include "CarlaTimeUtils.hpp"
+
 CARLA_BACKEND_START_NAMESPACE
 
 // -----------------------------------------------------------------------
 
+// how often all output parameters are sent even if they did not change, for UIs and OSC clients that appeared later
+static const uint64_t kForceOutputsInterval = 1000;
+
+// -----------------------------------------------------------------------
+
 CarlaEngineThread::CarlaEngineThread(CarlaEngine* const engine) noexcept
     : CarlaThread("CarlaEngineThread"),
-      kEngine(engine)
+      kEngine(engine),
+      fSemaphore(),
+      fSemaphoreValid(false),
+      fWakeUpPending(0)
 {
     CARLA_SAFE_ASSERT(engine != nullptr);
     carla_debug("CarlaEngineThread::CarlaEngineThread(%p)", engine);
+
+    carla_zeroStructs(fDirtyPlugins, kDirtyPluginWords);
+    fSemaphoreValid = carla_sem_create2(fSemaphore);
 }
 
 CarlaEngineThread::~CarlaEngineThread() noexcept
 {
     carla_debug("CarlaEngineThread::~CarlaEngineThread()");
+
+    if (fSemaphoreValid)
+    {
+        carla_sem_destroy2(fSemaphore);
+        fSemaphoreValid = false;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void CarlaEngineThread::markPluginDirty(const uint pluginId) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(pluginId < MAX_PATCHBAY_PLUGINS,);
+
+    __sync_fetch_and_or(&fDirtyPlugins[pluginId / 32], 1U << (pluginId % 32));
+    wakeUp();
+}
+
+void CarlaEngineThread::wakeUp() noexcept
+{
+    // post only once until the thread wakes up, the semaphore cannot count past 1
+    if (fSemaphoreValid && __sync_bool_compare_and_swap(&fWakeUpPending, 0, 1))
+        carla_sem_post(fSemaphore, true);
+}
+
+bool CarlaEngineThread::stopThread(const int timeOutMilliseconds) noexcept
+{
+    signalThreadShouldExit();
+    wakeUp();
+
+    return CarlaThread::stopThread(timeOutMilliseconds);
 }
 
 // -----------------------------------------------------------------------
@@ -49,7 +93,8 @@ void CarlaEngineThread::run() noexcept
 #ifdef HAVE_LIBLO
     const bool isPlugin(kEngine->getType() == kEngineTypePlugin);
 #endif
-    float value;
+    uint32_t dirtyPlugins[kDirtyPluginWords];
+    uint64_t lastFullIdle = 0, lastForcedOutputs = 0;
 
 #ifdef BUILD_BRIDGE
     for (; ! shouldThreadExit();)
@@ -57,12 +102,51 @@ void CarlaEngineThread::run() noexcept
     for (; kEngine->isRunning() && ! shouldThreadExit();)
 #endif
     {
+        const uint64_t maxInterval = kEngine->getOptions().idleMaxInterval;
+        uint64_t now = carla_gettime_us() / 1000;
+
+        // -------------------------------------------------------------------
+        // Sleep until some plugin has pending events or the max interval elapses
+
+        if (now < lastFullIdle + maxInterval)
+        {
+            const uint timeout = static_cast<uint>(lastFullIdle + maxInterval - now);
+
+            if (fSemaphoreValid)
+            {
+                if (carla_sem_timedwait(fSemaphore, timeout, true))
+                    __sync_bool_compare_and_swap(&fWakeUpPending, 1, 0);
+            }
+            else
+            {
+                carla_msleep(timeout);
+            }
+
+            if (shouldThreadExit())
+                break;
+
+            now = carla_gettime_us() / 1000;
+        }
+
+        const bool fullIdle = (now >= lastFullIdle + maxInterval);
+        const bool forceOutputs = fullIdle && (now >= lastForcedOutputs + kForceOutputsInterval);
+
+        if (fullIdle)
+            lastFullIdle = now;
+        if (forceOutputs)
+            lastForcedOutputs = now;
+
+        for (uint i=0; i < kDirtyPluginWords; ++i)
+            dirtyPlugins[i] = __sync_fetch_and_and(&fDirtyPlugins[i], 0U);
+
 #if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
         const bool oscRegisted = kEngine->isOscControlRegistered();
 #else
         const bool oscRegisted = false;
 #endif
 
+        const bool processStats = kEngine->getOptions().processStats;
+
 #ifdef HAVE_LIBLO
         if (isPlugin)
             kEngine->idleOsc();
@@ -70,14 +154,15 @@ void CarlaEngineThread::run() noexcept
 
         for (uint i=0, count = kEngine->getCurrentPluginCount(); i < count; ++i)
         {
+            // in between full passes only plugins flagged from the RT side are handled
+            if (! fullIdle && (i >= MAX_PATCHBAY_PLUGINS || (dirtyPlugins[i / 32] & (1U << (i % 32))) == 0))
+                continue;
+
             CarlaPlugin* const plugin(kEngine->getPluginUnchecked(i));
 
             CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr && plugin->isEnabled());
             CARLA_SAFE_ASSERT_UINT2(i == plugin->getId(), i, plugin->getId());
 
-            const uint hints(plugin->getHints());
-            const bool updateUI((hints & PLUGIN_HAS_CUSTOM_UI) != 0 && (hints & PLUGIN_NEEDS_UI_MAIN_THREAD) == 0);
-
             // -----------------------------------------------------------
             // DSP Idle
 
@@ -85,6 +170,12 @@ void CarlaEngineThread::run() noexcept
                 plugin->idle();
             } CARLA_SAFE_EXCEPTION("idle()")
 
+            if (! fullIdle)
+                continue;
+
+            const uint hints(plugin->getHints());
+            const bool updateUI((hints & PLUGIN_HAS_CUSTOM_UI) != 0 && (hints & PLUGIN_NEEDS_UI_MAIN_THREAD) == 0);
+
             // -----------------------------------------------------------
             // Post-poned events
 
@@ -93,22 +184,9 @@ void CarlaEngineThread::run() noexcept
                 // -------------------------------------------------------
                 // Update parameter outputs
 
-                for (uint32_t j=0, pcount=plugin->getParameterCount(); j < pcount; ++j)
-                {
-                    if (! plugin->isParameterOutput(j))
-                        continue;
-
-                    value = plugin->getParameterValue(j);
-
-#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
-                    // Update OSC engine client
-                    if (oscRegisted)
-                        kEngine->oscSend_control_set_parameter_value(i, static_cast<int32_t>(j), value);
-#endif
-                    // Update UI
-                    if (updateUI)
-                        plugin->uiParameterChange(j, value);
-                }
+                try {
+                    plugin->idleParameterOutputs(oscRegisted, updateUI, forceOutputs);
+                } CARLA_SAFE_EXCEPTION("idleParameterOutputs()")
 
                 if (updateUI)
                 {
@@ -123,11 +201,30 @@ void CarlaEngineThread::run() noexcept
             // Update OSC control client peaks
 
             if (oscRegisted)
+            {
                 kEngine->oscSend_control_set_peaks(i);
+
+                if (forceOutputs && processStats)
+                    kEngine->oscSend_control_set_process_stats(i);
+            }
 #endif
         }
 
-        carla_msleep(25);
+        // -----------------------------------------------------------
+        // Process statistics, once per second
+
+        if (forceOutputs && processStats)
+        {
+            kEngine->callback(ENGINE_CALLBACK_PROCESS_STATS, 0,
+                              static_cast<int>(kEngine->getXrunCount()),
+                              static_cast<int>(kEngine->getOverrunCount()),
+                              kEngine->getDSPLoad(), nullptr);
+
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+            if (oscRegisted)
+                kEngine->oscSend_control_set_engine_stats();
+#endif
+        }
     }
 
     carla_debug("CarlaEngineThread closed");
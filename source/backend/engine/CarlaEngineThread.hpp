@@ -19,6 +19,7 @@
 #define CARLA_ENGINE_THREAD_HPP_INCLUDED
 
 #include "CarlaBackend.h"
+#include "CarlaSemUtils.hpp"
 #include "CarlaThread.hpp"
 
 CARLA_BACKEND_START_NAMESPACE
@@ -32,12 +33,36 @@ public:
     CarlaEngineThread(CarlaEngine* const engine) noexcept;
     ~CarlaEngineThread() noexcept override;
 
+    /*!
+     * Flag a plugin as having pending non-RT work and wake up the thread.
+     * @note RT call
+     */
+    void markPluginDirty(const uint pluginId) noexcept;
+
+    /*!
+     * Wake up the thread so it runs a new idle pass right away.
+     * @note RT call
+     */
+    void wakeUp() noexcept;
+
+    /*!
+     * Stop the thread, waking it up first so it does not finish its current wait.
+     */
+    bool stopThread(const int timeOutMilliseconds) noexcept;
+
 protected:
     void run() noexcept override;
 
 private:
+    static const uint kDirtyPluginWords = (MAX_PATCHBAY_PLUGINS + 31) / 32;
+
     CarlaEngine* const kEngine;
 
+    carla_sem_t fSemaphore;
+    bool fSemaphoreValid;
+    int fWakeUpPending;
+    uint32_t fDirtyPlugins[kDirtyPluginWords];
+
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineThread)
 };
 
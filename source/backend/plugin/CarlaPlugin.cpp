@@ -26,12 +26,14 @@
 #include <ctime>
 
 #include "water/files/File.h"
+#include "water/files/FileInputStream.h"
 #include "water/streams/MemoryOutputStream.h"
 #include "water/xml/XmlDocument.h"
 #include "water/xml/XmlElement.h"
 
 using water::CharPointer_UTF8;
 using water::File;
+using water::FileInputStream;
 using water::MemoryOutputStream;
 using water::Result;
 using water::String;
@@ -76,6 +78,49 @@ struct ParamSymbol {
 #endif
 };
 
+// -------------------------------------------------------------------
+// Read a chunk stored in a side-car file, needed for CarlaPlugin::loadStateSave()
+
+static bool readChunkFile(const CarlaStateSave& stateSave, const char* const projectFilename, std::vector<uint8_t>& chunk)
+{
+    CARLA_SAFE_ASSERT_RETURN(stateSave.chunkFileSize > 0, false);
+    CARLA_SAFE_ASSERT_RETURN(stateSave.chunkFileSize < 0x7fffffff, false);
+
+    const String chunkFilename(CharPointer_UTF8(stateSave.chunkFile));
+    File file;
+
+    if (File::isAbsolutePath(chunkFilename))
+        file = File(chunkFilename);
+    else if (projectFilename != nullptr)
+        file = File(CharPointer_UTF8(projectFilename)).getSiblingFile(chunkFilename);
+
+    if (! file.existsAsFile())
+    {
+        carla_stderr2("Chunk file '%s' not found", stateSave.chunkFile);
+        return false;
+    }
+
+    FileInputStream stream(file);
+    CARLA_SAFE_ASSERT_RETURN(stream.openedOk(), false);
+    CARLA_SAFE_ASSERT_RETURN(stream.setPosition(static_cast<water::int64>(stateSave.chunkFileOffset)), false);
+
+    const int size = static_cast<int>(stateSave.chunkFileSize);
+
+    try {
+        chunk.resize(static_cast<std::size_t>(size));
+    } CARLA_SAFE_EXCEPTION_RETURN("readChunkFile", false);
+
+#ifdef CARLA_PROPER_CPP11_SUPPORT
+    if (stream.read(chunk.data(), size) == size)
+#else
+    if (stream.read(&chunk.front(), size) == size)
+#endif
+        return true;
+
+    carla_stderr2("Chunk file '%s' is too short", stateSave.chunkFile);
+    return false;
+}
+
 // -------------------------------------------------------------------
 // Constructor and destructor
 
@@ -167,6 +212,19 @@ uint32_t CarlaPlugin::getLatencyInFrames() const noexcept
     return 0;
 }
 
+float CarlaPlugin::getBridgeRoundTripTime(const bool) const noexcept
+{
+    return 0.0f;
+}
+
+void CarlaPlugin::getWorkerStats(uint32_t& requests, uint64_t& requestAvgTime, uint64_t& requestMaxTime,
+                                 uint32_t& responses, uint64_t& responseAvgTime, uint64_t& responseMaxTime) const noexcept
+{
+    requests  = responses = 0;
+    requestAvgTime  = requestMaxTime  = 0;
+    responseAvgTime = responseMaxTime = 0;
+}
+
 // -------------------------------------------------------------------
 // Information (count)
 
@@ -409,6 +467,18 @@ void CarlaPlugin::getParameterCountInfo(uint32_t& ins, uint32_t& outs) const noe
     }
 }
 
+uint32_t CarlaPlugin::getMinimumSplitFrames() const noexcept
+{
+    return pData->blockSplit.minFrames;
+}
+
+void CarlaPlugin::getBlockSplitStats(uint64_t& cycles, uint64_t& splits, uint64_t& coalesced) const noexcept
+{
+    cycles    = pData->blockSplit.cycles;
+    splits    = pData->blockSplit.splits;
+    coalesced = pData->blockSplit.coalesced;
+}
+
 // -------------------------------------------------------------------
 // Set data (state)
 
@@ -477,7 +547,7 @@ void CarlaPlugin::randomizeParameters() noexcept
     }
 }
 
-const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
+const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave, const bool rawChunk)
 {
     if (callPrepareForSave)
         prepareForSave();
@@ -515,6 +585,7 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
     pData->stateSave.balanceRight = pData->postProc.balanceRight;
     pData->stateSave.panning      = pData->postProc.panning;
     pData->stateSave.ctrlChannel  = pData->ctrlChannel;
+    pData->stateSave.minSplitFrames = pData->blockSplit.minFrames;
 #endif
 
     bool usingChunk = false;
@@ -529,7 +600,15 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
 
         if (data != nullptr && dataSize > 0)
         {
-            pData->stateSave.chunk = CarlaString::asBase64(data, dataSize).dup();
+            if (rawChunk)
+            {
+                pData->stateSave.rawChunk     = data;
+                pData->stateSave.rawChunkSize = dataSize;
+            }
+            else
+            {
+                pData->stateSave.chunk = CarlaString::asBase64(data, dataSize).dup();
+            }
 
             if (pluginType != PLUGIN_INTERNAL)
                 usingChunk = true;
@@ -835,7 +914,20 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
     // ---------------------------------------------------------------
     // Part 6 - set chunk
 
-    if (stateSave.chunk != nullptr && (pData->options & PLUGIN_OPTION_USE_CHUNKS) != 0)
+    if (stateSave.chunkFile != nullptr && (pData->options & PLUGIN_OPTION_USE_CHUNKS) != 0)
+    {
+        std::vector<uint8_t> chunk;
+
+        if (readChunkFile(stateSave, pData->engine->getCurrentProjectFilename(), chunk))
+        {
+#ifdef CARLA_PROPER_CPP11_SUPPORT
+            setChunkData(chunk.data(), chunk.size());
+#else
+            setChunkData(&chunk.front(), chunk.size());
+#endif
+        }
+    }
+    else if (stateSave.chunk != nullptr && (pData->options & PLUGIN_OPTION_USE_CHUNKS) != 0)
     {
         std::vector<uint8_t> chunk(carla_getChunkFromBase64String(stateSave.chunk));
 #ifdef CARLA_PROPER_CPP11_SUPPORT
@@ -851,7 +943,7 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
 
     const uint availOptions(getOptionsAvailable());
 
-    for (uint i=0; i<10; ++i) // FIXME - get this value somehow...
+    for (uint i=0; i<11; ++i) // FIXME - get this value somehow...
     {
         const uint option(1u << i);
 
@@ -865,6 +957,7 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
     setBalanceRight(stateSave.balanceRight, true, true);
     setPanning(stateSave.panning, true, true);
     setCtrlChannel(stateSave.ctrlChannel, true, true);
+    setMinimumSplitFrames(stateSave.minSplitFrames);
     setActive(stateSave.active, true, true);
 #endif
 
@@ -1382,6 +1475,20 @@ void CarlaPlugin::setCtrlChannel(const int8_t channel, const bool sendOsc, const
     return; (void)sendOsc; (void)sendCallback;
 }
 
+void CarlaPlugin::setMinimumSplitFrames(const uint32_t frames) noexcept
+{
+    // blocks of bridged plugins are split in the bridge process, which does not get this setting
+    if (pData->hints & PLUGIN_IS_BRIDGE)
+    {
+        if (frames != 0)
+            carla_stderr2("CarlaPlugin::setMinimumSplitFrames(%u) - not supported for bridged plugins", frames);
+        return;
+    }
+
+    pData->blockSplit.minFrames = frames;
+    pData->blockSplit.clearStats();
+}
+
 // -------------------------------------------------------------------
 // Set data (plugin-specific stuff)
 
@@ -1671,6 +1778,10 @@ void CarlaPlugin::idle()
 
     const CarlaMutexLocker sl(pData->postRtEvents.mutex);
 
+    // we might get woken up before the plugin got to splice its RT events, take them now
+    if (pData->postRtEvents.dataPendingRT.count() > 0)
+        pData->postRtEvents.dataPendingRT.moveTo(pData->postRtEvents.data, true);
+
     for (RtLinkedList<PluginPostRtEvent>::Itenerator it = pData->postRtEvents.data.begin2(); it.valid(); it.next())
     {
         const PluginPostRtEvent& event(it.getValue(kPluginPostRtEventFallback));
@@ -1838,6 +1949,40 @@ void CarlaPlugin::idle()
     }
 
     pData->postRtEvents.data.clear();
+
+    // top up the RT pools while we are outside the audio thread
+    pData->postRtEvents.dataPool.refill();
+    pData->extNotes.dataPool.refill();
+}
+
+void CarlaPlugin::idleParameterOutputs(const bool sendOsc, const bool sendUi, const bool forceSend)
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->param.count == 0 || pData->param.lastOutputValues != nullptr,);
+
+    for (uint32_t i=0; i < pData->param.count; ++i)
+    {
+        if (pData->param.data[i].type != PARAMETER_OUTPUT)
+            continue;
+
+        const float value(getParameterValue(i));
+
+        if (! forceSend && carla_isEqual(pData->param.lastOutputValues[i], value))
+            continue;
+
+        pData->param.lastOutputValues[i] = value;
+
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+        // Update OSC control client
+        if (sendOsc)
+            pData->engine->oscSend_control_set_parameter_value(pData->id, static_cast<int32_t>(i), value);
+#endif
+        // Update UI
+        if (sendUi)
+            uiParameterChange(i, value);
+    }
+
+    // may be unused
+    return; (void)sendOsc;
 }
 
 bool CarlaPlugin::tryLock(const bool forcedOffline) noexcept
@@ -2071,6 +2216,8 @@ void CarlaPlugin::sendMidiAllNotesOffToCallback()
         postEvent.value2 = i;
         pData->postRtEvents.appendRT(postEvent);
     }
+
+    pData->engine->markPluginDirty(pData->id);
 }
 #endif
 
@@ -31,6 +31,7 @@
 #include <ctime>
 
 #include "water/files/File.h"
+#include "water/memory/MemoryBlock.h"
 #include "water/misc/Time.h"
 #include "water/threads/ChildProcess.h"
 
@@ -38,6 +39,7 @@
 
 using water::ChildProcess;
 using water::File;
+using water::MemoryBlock;
 using water::String;
 using water::StringArray;
 using water::Time;
@@ -356,11 +358,14 @@ public:
           fSaved(true),
           fTimedOut(false),
           fTimedError(false),
+          fPipelinePending(false),
+          fPipelineFrames(0),
           fProcWaitTime(0),
           fLastPongTime(-1),
           fBridgeBinary(),
           fBridgeThread(engine, this),
           fShmAudioPool(),
+          fShmChunkPool(),
           fShmRtClientControl(),
           fShmNonRtClientControl(),
           fShmNonRtServerControl(),
@@ -413,6 +418,7 @@ public:
         fShmNonRtClientControl.clear();
         fShmRtClientControl.clear();
         fShmAudioPool.clear();
+        fShmChunkPool.clear();
 
         clearBuffers();
 
@@ -444,9 +450,18 @@ public:
 
     uint32_t getLatencyInFrames() const noexcept override
     {
+        if (pData->options & PLUGIN_OPTION_PIPELINED)
+            return fLatency + pData->engine->getBufferSize();
+
         return fLatency;
     }
 
+    float getBridgeRoundTripTime(const bool maximum) const noexcept override
+    {
+        return static_cast<float>(maximum ? fShmRtClientControl.maximumRoundTrip
+                                          : fShmRtClientControl.averageRoundTrip) / 1000.0f;
+    }
+
     // -------------------------------------------------------------------
     // Information (count)
 
@@ -487,7 +502,7 @@ public:
 
     uint getOptionsAvailable() const noexcept override
     {
-        return fInfo.optionsAvailable;
+        return fInfo.optionsAvailable | PLUGIN_OPTION_PIPELINED;
     }
 
     float getParameterValue(const uint32_t parameterId) const noexcept override
@@ -584,6 +599,14 @@ public:
 
     void setOption(const uint option, const bool yesNo, const bool sendCallback) override
     {
+        // handled on our side only
+        if (option == PLUGIN_OPTION_PIPELINED)
+        {
+            CarlaPlugin::setOption(option, yesNo, sendCallback);
+            updateLatency();
+            return;
+        }
+
         {
             const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
 
@@ -752,6 +775,17 @@ public:
         CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
         CARLA_SAFE_ASSERT_RETURN(dataSize > 0,);
 
+        // save data internally as well
+        fInfo.chunk.resize(dataSize);
+#ifdef CARLA_PROPER_CPP11_SUPPORT
+        std::memcpy(fInfo.chunk.data(), data, dataSize);
+#else
+        std::memcpy(&fInfo.chunk.front(), data, dataSize);
+#endif
+
+        if (sendChunkDataShm(data, dataSize))
+            return;
+
         CarlaString dataBase64(CarlaString::asBase64(data, dataSize));
         CARLA_SAFE_ASSERT_RETURN(dataBase64.length() > 0,);
 
@@ -771,14 +805,6 @@ public:
             fShmNonRtClientControl.writeCustomData(filePath.toRawUTF8(), ulength);
             fShmNonRtClientControl.commitWrite();
         }
-
-        // save data internally as well
-        fInfo.chunk.resize(dataSize);
-#ifdef CARLA_PROPER_CPP11_SUPPORT
-        std::memcpy(fInfo.chunk.data(), data, dataSize);
-#else
-        std::memcpy(&fInfo.chunk.front(), data, dataSize);
-#endif
     }
 
     // -------------------------------------------------------------------
@@ -1054,6 +1080,30 @@ public:
             return;
         }
 
+        // --------------------------------------------------------------------------------------------------------
+        // Collect the previous block, if running pipelined
+
+        bool hasPipelinedOutput = false;
+
+        if (fPipelinePending)
+        {
+            fPipelinePending = false;
+
+            waitForClientDone("process", fProcWaitTime);
+
+            if (fTimedOut)
+            {
+                for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                    carla_zeroFloats(audioOut[i], frames);
+                for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                    carla_zeroFloats(cvOut[i], frames);
+                return;
+            }
+
+            hasPipelinedOutput = (fPipelineFrames == frames);
+            processOutputEvents();
+        }
+
         // --------------------------------------------------------------------------------------------------------
         // Check if needs reset
 
@@ -1281,9 +1331,16 @@ public:
 
         } // End of Event Input
 
-        if (! processSingle(audioIn, audioOut, cvIn, cvOut, frames))
+        if (! processSingle(audioIn, audioOut, cvIn, cvOut, frames, hasPipelinedOutput))
             return;
 
+        // when pipelined, the output is collected on the next cycle
+        if (! fPipelinePending)
+            processOutputEvents();
+    }
+
+    void processOutputEvents()
+    {
         // --------------------------------------------------------------------------------------------------------
         // Control and MIDI Output
 
@@ -1338,7 +1395,8 @@ public:
     }
 
     bool processSingle(const float** const audioIn, float** const audioOut,
-                       const float** const cvIn, float** const cvOut, const uint32_t frames)
+                       const float** const cvIn, float** const cvOut, const uint32_t frames,
+                       const bool hasPipelinedOutput)
     {
         CARLA_SAFE_ASSERT_RETURN(! fTimedError, false);
         CARLA_SAFE_ASSERT_RETURN(frames > 0, false);
@@ -1382,6 +1440,20 @@ public:
         for (uint32_t i=0; i < fInfo.aIns; ++i)
             carla_copyFloats(fShmAudioPool.data + (i * frames), audioIn[i], frames);
 
+        const bool pipelined = (pData->options & PLUGIN_OPTION_PIPELINED) != 0;
+
+        // when pipelined, the pool still has the output of the previous block
+        if (pipelined)
+        {
+            for (uint32_t i=0; i < fInfo.aOuts; ++i)
+            {
+                if (hasPipelinedOutput)
+                    carla_copyFloats(audioOut[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), frames);
+                else
+                    carla_zeroFloats(audioOut[i], frames);
+            }
+        }
+
         // --------------------------------------------------------------------------------------------------------
         // TimeInfo
 
@@ -1411,20 +1483,31 @@ public:
         // Run plugin
 
         {
+            fShmRtClientControl.updateRtPriority();
             fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcess);
             fShmRtClientControl.commitWrite();
         }
 
-        waitForClient("process", fProcWaitTime);
-
-        if (fTimedOut)
+        if (pipelined)
         {
-            pData->singleMutex.unlock();
-            return false;
+            // let it run in parallel with the rest of the engine, collected on the next cycle
+            fShmRtClientControl.signalClient();
+            fPipelinePending = true;
+            fPipelineFrames  = frames;
         }
+        else
+        {
+            waitForClient("process", fProcWaitTime);
 
-        for (uint32_t i=0; i < fInfo.aOuts; ++i)
-            carla_copyFloats(audioOut[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), frames);
+            if (fTimedOut)
+            {
+                pData->singleMutex.unlock();
+                return false;
+            }
+
+            for (uint32_t i=0; i < fInfo.aOuts; ++i)
+                carla_copyFloats(audioOut[i], fShmAudioPool.data + ((i + fInfo.aIns) * frames), frames);
+        }
 
 #ifndef BUILD_BRIDGE
         // --------------------------------------------------------------------------------------------------------
@@ -1437,7 +1520,7 @@ public:
             const bool isMono    = (pData->audioIn.count == 1);
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float oldBufLeft[doBalance ? frames : 1];
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1446,17 +1529,12 @@ public:
                 {
                     const uint32_t c = isMono ? 0 : i;
 
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (k < pData->latency.frames)
-                            bufValue = pData->latency.buffers[c][k];
-                        else if (pData->latency.frames < frames)
-                            bufValue = audioIn[c][k-pData->latency.frames];
-                        else
-                            bufValue = audioIn[c][k];
-
-                        audioOut[i][k] = (audioOut[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
+                    const uint32_t latFrames = carla_minPositive(pData->latency.frames, frames);
+
+                    if (latFrames > 0)
+                        carla_mixFloats(audioOut[i], pData->latency.buffers[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, latFrames);
+                    if (latFrames < frames)
+                        carla_mixFloats(audioOut[i]+latFrames, audioIn[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, frames-latFrames);
                 }
 
                 // Balance
@@ -1473,28 +1551,24 @@ public:
                     float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
                     float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
 
-                    for (uint32_t k=0; k < frames; ++k)
+                    if (isPair)
                     {
-                        if (isPair)
-                        {
-                            // left
-                            audioOut[i][k]  = oldBufLeft[k]     * (1.0f - balRangeL);
-                            audioOut[i][k] += audioOut[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            audioOut[i][k]  = audioOut[i][k] * balRangeR;
-                            audioOut[i][k] += oldBufLeft[k]   * balRangeL;
-                        }
+                        // left
+                        carla_copyFloatsWithGain(audioOut[i], oldBufLeft, 1.0f - balRangeL, frames);
+                        carla_addFloatsWithGain(audioOut[i], audioOut[i+1], 1.0f - balRangeR, frames);
+                    }
+                    else
+                    {
+                        // right
+                        carla_multiply(audioOut[i], balRangeR, frames);
+                        carla_addFloatsWithGain(audioOut[i], oldBufLeft, balRangeL, frames);
                     }
                 }
 
                 // Volume (and buffer copy)
                 if (doVolume)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k] *= pData->postProc.volume;
+                    carla_multiply(audioOut[i], pData->postProc.volume, frames);
                 }
             }
 
@@ -1549,6 +1623,8 @@ public:
         fProcWaitTime = 1000;
 
         waitForClient("buffersize", 1000);
+
+        updateLatency();
     }
 
     void sampleRateChanged(const double newSampleRate) override
@@ -1689,7 +1765,7 @@ public:
                 }
 
                 pData->hints   = hints | PLUGIN_IS_BRIDGE;
-                pData->options = optionEn;
+                pData->options = optionEn | (pData->options & PLUGIN_OPTION_PIPELINED);
 
                 fInfo.category = static_cast<PluginCategory>(category);
                 fInfo.optionsAvailable = optionAv;
@@ -2043,7 +2119,8 @@ public:
                 CarlaPlugin::setCustomData(type, key, value, false);
             }   break;
 
-            case kPluginBridgeNonRtServerSetChunkDataFile: {
+            case kPluginBridgeNonRtServerSetChunkDataFile:
+            case kPluginBridgeNonRtServerSetChunkDataBinaryFile: {
                 // uint/size, str[] (filename)
 
                 // chunkFilePath
@@ -2074,10 +2151,28 @@ public:
                 File chunkFile(realChunkFilePath);
                 CARLA_SAFE_ASSERT_BREAK(chunkFile.existsAsFile());
 
-                fInfo.chunk = carla_getChunkFromBase64String(chunkFile.loadFileAsString().toRawUTF8());
+                if (opcode == kPluginBridgeNonRtServerSetChunkDataBinaryFile)
+                {
+                    MemoryBlock chunkData;
+
+                    if (chunkFile.loadFileAsData(chunkData))
+                    {
+                        const uint8_t* const chunkBytes((const uint8_t*)chunkData.getData());
+                        fInfo.chunk.assign(chunkBytes, chunkBytes + chunkData.getSize());
+                    }
+                }
+                else
+                {
+                    fInfo.chunk = carla_getChunkFromBase64String(chunkFile.loadFileAsString().toRawUTF8());
+                }
+
                 chunkFile.deleteFile();
             }   break;
 
+            case kPluginBridgeNonRtServerChunkDataShmReleased:
+                fShmChunkPool.inUse = false;
+                break;
+
             case kPluginBridgeNonRtServerSetLatency:
                 // FIXME
                 if (true) break;
@@ -2194,6 +2289,8 @@ public:
             return false;
         }
 
+        fShmRtClientControl.setSpinTime(pData->engine->getOptions().pluginBridgesSpinTime);
+
         if (! fShmNonRtClientControl.initializeServer())
         {
             carla_stderr("Failed to initialize Non-RT client control");
@@ -2351,6 +2448,8 @@ private:
     bool fSaved;
     bool fTimedOut;
     bool fTimedError;
+    bool fPipelinePending;
+    uint32_t fPipelineFrames;
     uint fProcWaitTime;
 
     int64_t fLastPongTime;
@@ -2359,6 +2458,7 @@ private:
     CarlaPluginBridgeThread fBridgeThread;
 
     BridgeAudioPool          fShmAudioPool;
+    BridgeChunkPool          fShmChunkPool;
     BridgeRtClientControl    fShmRtClientControl;
     BridgeNonRtClientControl fShmNonRtClientControl;
     BridgeNonRtServerControl fShmNonRtServerControl;
@@ -2415,11 +2515,45 @@ private:
         waitForClient("resize-pool", 5000);
     }
 
+    // copy chunk into shared memory and tell the bridge to read it from there.
+    // the pool stays reserved until the bridge replies, any chunk set meanwhile goes through a temp file.
+    bool sendChunkDataShm(const void* const data, const std::size_t dataSize)
+    {
+        if (fShmChunkPool.inUse)
+            return false;
+
+        if (! jackbridge_shm_is_valid(fShmChunkPool.shm) && ! fShmChunkPool.initializeServer())
+            return false;
+
+        if (! fShmChunkPool.resize(dataSize))
+        {
+            fShmChunkPool.clear();
+            return false;
+        }
+
+        std::memcpy(fShmChunkPool.data, data, dataSize);
+        fShmChunkPool.inUse = true;
+
+        const char* const basename(&fShmChunkPool.filename[fShmChunkPool.filename.length()-6]);
+
+        const CarlaMutexLocker _cml(fShmNonRtClientControl.mutex);
+
+        fShmNonRtClientControl.writeOpcode(kPluginBridgeNonRtClientSetChunkDataShm);
+        fShmNonRtClientControl.writeUInt(6);
+        fShmNonRtClientControl.writeCustomData(basename, 6);
+        fShmNonRtClientControl.writeULong(static_cast<uint64_t>(dataSize));
+        fShmNonRtClientControl.commitWrite();
+        return true;
+    }
+
     void waitForClient(const char* const action, const uint msecs)
     {
         CARLA_SAFE_ASSERT_RETURN(! fTimedOut,);
         CARLA_SAFE_ASSERT_RETURN(! fTimedError,);
 
+        // a new request also completes any pipelined one
+        fPipelinePending = false;
+
         if (fShmRtClientControl.waitForClient(msecs))
             return;
 
@@ -2427,6 +2561,41 @@ private:
         carla_stderr("waitForClient(%s) timed out", action);
     }
 
+    void waitForClientDone(const char* const action, const uint msecs)
+    {
+        CARLA_SAFE_ASSERT_RETURN(! fTimedOut,);
+        CARLA_SAFE_ASSERT_RETURN(! fTimedError,);
+
+        if (fShmRtClientControl.waitForClientDone(msecs))
+            return;
+
+        fTimedOut = true;
+        carla_stderr("waitForClientDone(%s) timed out", action);
+    }
+
+    void updateLatency()
+    {
+        const uint32_t latency = getLatencyInFrames();
+#ifndef BUILD_BRIDGE
+        const uint32_t channels = std::max(fInfo.aIns, fInfo.aOuts);
+
+        if (pData->latency.frames == latency && pData->latency.channels == channels)
+            return;
+#else
+        if (pData->latency.frames == latency)
+            return;
+#endif
+
+        const ScopedSingleProcessLocker sspl(this, true);
+
+        pData->client->setLatency(latency);
+#ifndef BUILD_BRIDGE
+        pData->latency.recreateBuffers(channels, latency);
+#else
+        pData->latency.frames = latency;
+#endif
+    }
+
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginBridge)
 };
 
@@ -1383,6 +1383,9 @@ public:
             else
                 nextBankId = 0;
 
+            if (isSampleAccurate && pData->event.portIn->getEventCount() > 0)
+                ++pData->blockSplit.cycles;
+
             for (uint32_t i=0, numEvents=pData->event.portIn->getEventCount(); i < numEvents; ++i)
             {
                 const EngineEvent& event(pData->event.portIn->getEvent(i));
@@ -1392,9 +1395,16 @@ public:
 
                 CARLA_ASSERT_INT2(event.time >= timeOffset, event.time, timeOffset);
 
+                // position of an event coalesced into the current sub-block, relative to its start
+                uint32_t coalescedTime = 0;
+
                 if (isSampleAccurate && event.time > timeOffset)
                 {
-                    if (processSingle(audioIn, audioOut, event.time - timeOffset, timeOffset, midiEventCount))
+                    if (! pData->blockSplit.shouldSplit(event.time - timeOffset))
+                    {
+                        coalescedTime = event.time - timeOffset;
+                    }
+                    else if (processSingle(audioIn, audioOut, event.time - timeOffset, timeOffset, midiEventCount))
                     {
                         startTime  = 0;
                         timeOffset = event.time;
@@ -1511,7 +1521,7 @@ public:
 
                             snd_seq_event_t& seqEvent(fMidiEvents[midiEventCount++]);
 
-                            seqEvent.time.tick = isSampleAccurate ? startTime : event.time;
+                            seqEvent.time.tick = isSampleAccurate ? startTime + coalescedTime : event.time;
 
                             seqEvent.type = SND_SEQ_EVENT_CONTROLLER;
                             seqEvent.data.control.channel = event.channel;
@@ -1553,7 +1563,7 @@ public:
 
                             snd_seq_event_t& seqEvent(fMidiEvents[midiEventCount++]);
 
-                            seqEvent.time.tick = isSampleAccurate ? startTime : event.time;
+                            seqEvent.time.tick = isSampleAccurate ? startTime + coalescedTime : event.time;
 
                             seqEvent.type = SND_SEQ_EVENT_CONTROLLER;
                             seqEvent.data.control.channel = event.channel;
@@ -1577,7 +1587,7 @@ public:
 
                             snd_seq_event_t& seqEvent(fMidiEvents[midiEventCount++]);
 
-                            seqEvent.time.tick = isSampleAccurate ? startTime : event.time;
+                            seqEvent.time.tick = isSampleAccurate ? startTime + coalescedTime : event.time;
 
                             seqEvent.type = SND_SEQ_EVENT_CONTROLLER;
                             seqEvent.data.control.channel = event.channel;
@@ -1605,7 +1615,7 @@ public:
 
                     snd_seq_event_t& seqEvent(fMidiEvents[midiEventCount++]);
 
-                    seqEvent.time.tick = isSampleAccurate ? startTime : event.time;
+                    seqEvent.time.tick = isSampleAccurate ? startTime + coalescedTime : event.time;
 
                     switch (status)
                     {
@@ -1836,7 +1846,7 @@ public:
             const bool isMono    = (pData->audioIn.count == 1);
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float oldBufLeft[doBalance ? frames : 1];
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1845,17 +1855,12 @@ public:
                 {
                     const uint32_t c = isMono ? 0 : i;
 
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (k < pData->latency.frames)
-                            bufValue = pData->latency.buffers[c][k];
-                        else if (pData->latency.frames < frames)
-                            bufValue = fAudioInBuffers[c][k-pData->latency.frames];
-                        else
-                            bufValue = fAudioInBuffers[c][k];
+                    const uint32_t latFrames = carla_minPositive(pData->latency.frames, frames);
 
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
+                    if (latFrames > 0)
+                        carla_mixFloats(fAudioOutBuffers[i], pData->latency.buffers[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, latFrames);
+                    if (latFrames < frames)
+                        carla_mixFloats(fAudioOutBuffers[i]+latFrames, fAudioInBuffers[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, frames-latFrames);
                 }
 
                 // Balance
@@ -1872,27 +1877,23 @@ public:
                     float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
                     float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
 
-                    for (uint32_t k=0; k < frames; ++k)
+                    if (isPair)
                     {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
+                        // left
+                        carla_copyFloatsWithGain(fAudioOutBuffers[i], oldBufLeft, 1.0f - balRangeL, frames);
+                        carla_addFloatsWithGain(fAudioOutBuffers[i], fAudioOutBuffers[i+1], 1.0f - balRangeR, frames);
+                    }
+                    else
+                    {
+                        // right
+                        carla_multiply(fAudioOutBuffers[i], balRangeR, frames);
+                        carla_addFloatsWithGain(fAudioOutBuffers[i], oldBufLeft, balRangeL, frames);
                     }
                 }
 
                 // Volume (and buffer copy)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k] * pData->postProc.volume;
+                    carla_copyFloatsWithGain(audioOut[i]+timeOffset, fAudioOutBuffers[i], pData->postProc.volume, frames);
                 }
             }
 
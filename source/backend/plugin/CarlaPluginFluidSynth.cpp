@@ -21,17 +21,27 @@
 #ifdef HAVE_FLUIDSYNTH
 
 #include "CarlaMathUtils.hpp"
+#include "CarlaTimeUtils.hpp"
 
+#include "water/files/File.h"
+#include "water/files/FileInputStream.h"
 #include "water/text/StringArray.h"
 
 #include <fluidsynth.h>
 
+// the SoundFont cache uses the 1.1.x loader structs, which became opaque in 2.0
+#if FLUIDSYNTH_VERSION_MAJOR >= 2
+# error This code requires FluidSynth 1.1.x
+#endif
+
 #if (FLUIDSYNTH_VERSION_MAJOR >= 1 && FLUIDSYNTH_VERSION_MINOR >= 1 && FLUIDSYNTH_VERSION_MICRO >= 4)
 # define FLUIDSYNTH_VERSION_NEW_API
 #endif
 
 #define FLUID_DEFAULT_POLYPHONY 64
 
+using water::File;
+using water::FileInputStream;
 using water::String;
 using water::StringArray;
 
@@ -42,6 +52,470 @@ CARLA_BACKEND_START_NAMESPACE
 
 static const ExternalMidiNote kExternalMidiNoteFallback = { -1, 0, 0 };
 
+// -------------------------------------------------------------------------------------------------------------------
+// SoundFont cache, shared by all FluidSynth instances in this process.
+//
+// Files are loaded once by a private synth and kept while at least one instance uses them.
+// Each instance gets a small proxy sfont through its own sfloader, presets are forwarded to the shared sfont.
+// Preset data and samples are only ever read after loading, so sharing them between synths is safe.
+
+class FluidSoundFontCache
+{
+public:
+    struct Preset {
+        fluid_preset_t* preset;
+        int bank, num;
+    };
+
+    struct Font {
+        CarlaString filename;
+        int id;
+        fluid_sfont_t* sfont;
+        Preset* presets;
+        uint presetCount;
+        uint refCount;
+#ifdef DEBUG
+        uint64_t sampleDataSize; // only needed for printReport()
+#endif
+    };
+
+    FluidSoundFontCache() noexcept
+        : fSettings(nullptr),
+          fSynth(nullptr),
+          fFonts(),
+          fMutex() {}
+
+    ~FluidSoundFontCache() noexcept
+    {
+        // every synth should have released its fonts by now
+        CARLA_SAFE_ASSERT(fFonts.isEmpty());
+
+        deleteSynth();
+    }
+
+    /*
+     * Get the font for @a filename, loading it if not cached yet.
+     * Every successful call must be matched by a release().
+     */
+    Font* acquire(const char* const filename)
+    {
+        CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', nullptr);
+
+        const String fullPath(File(filename).getFullPathName());
+        const CarlaMutexLocker cml(fMutex);
+
+        for (LinkedList<Font*>::Itenerator it = fFonts.begin2(); it.valid(); it.next())
+        {
+            Font* const font(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(font != nullptr);
+
+            if (font->filename != fullPath.toRawUTF8())
+                continue;
+
+            ++font->refCount;
+            printReport();
+            return font;
+        }
+
+        Font* const font(load(fullPath.toRawUTF8()));
+
+        if (font == nullptr)
+            return nullptr;
+
+        fFonts.append(font);
+        printReport();
+        return font;
+    }
+
+    void release(Font* const font)
+    {
+        CARLA_SAFE_ASSERT_RETURN(font != nullptr,);
+
+        const CarlaMutexLocker cml(fMutex);
+
+        CARLA_SAFE_ASSERT_RETURN(font->refCount > 0,);
+
+        if (--font->refCount > 0)
+        {
+            printReport();
+            return;
+        }
+
+        fFonts.removeOne(font);
+
+        for (uint i=0; i < font->presetCount; ++i)
+        {
+            fluid_preset_t* const preset(font->presets[i].preset);
+
+            if (preset->free != nullptr)
+                preset->free(preset);
+        }
+
+        delete[] font->presets;
+
+        fluid_synth_sfunload(fSynth, static_cast<uint>(font->id), 0);
+        delete font;
+
+        printReport();
+
+        if (fFonts.isEmpty())
+            deleteSynth();
+    }
+
+    /*
+     * Add a loader to @a synth that gives it cached fonts, the synth takes ownership of it.
+     * Anything the cache fails to load goes through fluidsynth's default loader.
+     */
+    static void addLoader(fluid_synth_t* const synth)
+    {
+        fluid_sfloader_t* const loader(new fluid_sfloader_t);
+        carla_zeroStruct(*loader);
+
+        loader->free = _loader_free;
+        loader->load = _loader_load;
+
+        fluid_synth_add_sfloader(synth, loader);
+    }
+
+private:
+    fluid_settings_t* fSettings;
+    fluid_synth_t*    fSynth;
+
+    LinkedList<Font*> fFonts;
+    CarlaMutex fMutex;
+
+    // must be called with fMutex locked
+    Font* load(const char* const filename)
+    {
+        if (fSynth == nullptr)
+        {
+            fSettings = new_fluid_settings();
+            CARLA_SAFE_ASSERT_RETURN(fSettings != nullptr, nullptr);
+
+            // only used for loading, keep it as small as possible
+            fluid_settings_setint(fSettings, "synth.polyphony", 1);
+            fluid_settings_setint(fSettings, "synth.reverb.active", 0);
+            fluid_settings_setint(fSettings, "synth.chorus.active", 0);
+
+            fSynth = new_fluid_synth(fSettings);
+
+            if (fSynth == nullptr)
+            {
+                carla_safe_assert("fSynth != nullptr", __FILE__, __LINE__);
+                deleteSynth();
+                return nullptr;
+            }
+        }
+
+#ifdef DEBUG
+        const uint64_t startTime(carla_gettime_us());
+#endif
+
+        const int id(fluid_synth_sfload(fSynth, filename, 0));
+
+        if (id < 0)
+        {
+            if (fFonts.isEmpty())
+                deleteSynth();
+            return nullptr;
+        }
+
+        fluid_sfont_t* const sfont(fluid_synth_get_sfont_by_id(fSynth, static_cast<uint>(id)));
+
+        if (sfont == nullptr)
+        {
+            carla_safe_assert("sfont != nullptr", __FILE__, __LINE__);
+            fluid_synth_sfunload(fSynth, static_cast<uint>(id), 0);
+            return nullptr;
+        }
+
+        // collect presets now, so instances can iterate them without touching the shared sfont
+        fluid_preset_t tmpPreset;
+        uint presetCount = 0;
+
+        sfont->iteration_start(sfont);
+        for (; sfont->iteration_next(sfont, &tmpPreset);)
+            ++presetCount;
+
+        Font* const font(new Font);
+        font->filename = filename;
+        font->id = id;
+        font->sfont = sfont;
+        font->presets = new Preset[presetCount > 0 ? presetCount : 1];
+        font->presetCount = 0;
+        font->refCount = 1;
+#ifdef DEBUG
+        font->sampleDataSize = getSampleDataSize(filename);
+#endif
+
+        sfont->iteration_start(sfont);
+
+        for (; font->presetCount < presetCount && sfont->iteration_next(sfont, &tmpPreset);)
+        {
+            const int bank(tmpPreset.get_banknum(&tmpPreset));
+            const int num(tmpPreset.get_num(&tmpPreset));
+
+            fluid_preset_t* const preset(sfont->get_preset(sfont, static_cast<uint>(bank), static_cast<uint>(num)));
+            CARLA_SAFE_ASSERT_CONTINUE(preset != nullptr);
+
+            Preset& fontPreset(font->presets[font->presetCount++]);
+            fontPreset.preset = preset;
+            fontPreset.bank   = bank;
+            fontPreset.num    = num;
+        }
+
+        carla_debug("FluidSynth SoundFont cache: loaded \"%s\" in %.1f ms",
+                    filename, static_cast<double>(carla_gettime_us() - startTime) / 1000.0);
+
+        return font;
+    }
+
+    void deleteSynth() noexcept
+    {
+        if (fSynth != nullptr)
+        {
+            delete_fluid_synth(fSynth);
+            fSynth = nullptr;
+        }
+
+        if (fSettings != nullptr)
+        {
+            delete_fluid_settings(fSettings);
+            fSettings = nullptr;
+        }
+    }
+
+    // must be called with fMutex locked
+    void printReport() const
+    {
+#ifdef DEBUG
+        uint64_t total = 0, saved = 0;
+
+        for (LinkedList<Font*>::Itenerator it = fFonts.begin2(); it.valid(); it.next())
+        {
+            const Font* const font(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(font != nullptr);
+
+            carla_debug("FluidSynth SoundFont cache: \"%s\" used by %u instance(s), %.1f MiB of samples",
+                        font->filename.buffer(), font->refCount,
+                        static_cast<double>(font->sampleDataSize) / 1048576.0);
+
+            total += font->sampleDataSize;
+            saved += font->sampleDataSize * (font->refCount - 1);
+        }
+
+        carla_debug("FluidSynth SoundFont cache: %u font(s), %.1f MiB in memory, %.1f MiB saved by sharing",
+                    static_cast<uint>(fFonts.count()),
+                    static_cast<double>(total) / 1048576.0, static_cast<double>(saved) / 1048576.0);
+#endif
+    }
+
+#ifdef DEBUG
+    // size of the "smpl" and "sm24" chunks, which is what fluidsynth keeps in memory
+    static uint64_t getSampleDataSize(const char* const filename)
+    {
+        FileInputStream stream((File(filename)));
+        CARLA_SAFE_ASSERT_RETURN(stream.openedOk(), 0);
+
+        char id[4];
+
+        if (stream.read(id, 4) != 4 || std::strncmp(id, "RIFF", 4) != 0)
+            return 0;
+
+        stream.setPosition(12); // skip size and "sfbk"
+
+        for (; ! stream.isExhausted();)
+        {
+            if (stream.read(id, 4) != 4)
+                break;
+
+            const int64_t chunkSize(static_cast<uint32_t>(stream.readInt()));
+
+            if (std::strncmp(id, "LIST", 4) != 0)
+            {
+                stream.setPosition(stream.getPosition() + chunkSize);
+                continue;
+            }
+
+            const int64_t listEnd(stream.getPosition() + chunkSize);
+
+            if (stream.read(id, 4) != 4 || std::strncmp(id, "sdta", 4) != 0)
+            {
+                stream.setPosition(listEnd);
+                continue;
+            }
+
+            uint64_t size = 0;
+
+            for (; stream.getPosition() < listEnd;)
+            {
+                if (stream.read(id, 4) != 4)
+                    break;
+
+                const int64_t subChunkSize(static_cast<uint32_t>(stream.readInt()));
+
+                if (std::strncmp(id, "smpl", 4) == 0 || std::strncmp(id, "sm24", 4) == 0)
+                    size += static_cast<uint64_t>(subChunkSize);
+
+                stream.setPosition(stream.getPosition() + subChunkSize);
+            }
+
+            return size;
+        }
+
+        return 0;
+    }
+#endif
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // fluidsynth callbacks
+
+    struct Proxy {
+        Font* font;
+        uint iterIndex;
+    };
+
+    static int _loader_free(fluid_sfloader_t* const loader)
+    {
+        delete loader;
+        return 0;
+    }
+
+    static fluid_sfont_t* _loader_load(fluid_sfloader_t*, const char* const filename);
+
+    static int _sfont_free(fluid_sfont_t* const sfont);
+
+    static char* _sfont_get_name(fluid_sfont_t* const sfont)
+    {
+        const Proxy* const proxy((const Proxy*)sfont->data);
+        fluid_sfont_t* const shared(proxy->font->sfont);
+
+        return shared->get_name(shared);
+    }
+
+    static fluid_preset_t* _sfont_get_preset(fluid_sfont_t* const sfont, const uint bank, const uint num)
+    {
+        const Proxy* const proxy((const Proxy*)sfont->data);
+        const Font* const font(proxy->font);
+
+        for (uint i=0; i < font->presetCount; ++i)
+        {
+            Preset* const fontPreset(&font->presets[i]);
+
+            if (fontPreset->bank != static_cast<int>(bank) || fontPreset->num != static_cast<int>(num))
+                continue;
+
+            fluid_preset_t* const preset(new fluid_preset_t);
+            setupPreset(preset, sfont, fontPreset);
+            preset->free = _preset_free;
+            return preset;
+        }
+
+        return nullptr;
+    }
+
+    static void _sfont_iteration_start(fluid_sfont_t* const sfont)
+    {
+        Proxy* const proxy((Proxy*)sfont->data);
+
+        proxy->iterIndex = 0;
+    }
+
+    static int _sfont_iteration_next(fluid_sfont_t* const sfont, fluid_preset_t* const preset)
+    {
+        Proxy* const proxy((Proxy*)sfont->data);
+        const Font* const font(proxy->font);
+
+        if (proxy->iterIndex >= font->presetCount)
+            return 0;
+
+        setupPreset(preset, sfont, &font->presets[proxy->iterIndex++]);
+        return 1;
+    }
+
+    static void setupPreset(fluid_preset_t* const preset, fluid_sfont_t* const sfont, Preset* const fontPreset)
+    {
+        carla_zeroStruct(*preset);
+
+        preset->data        = fontPreset;
+        preset->sfont       = sfont;
+        preset->get_name    = _preset_get_name;
+        preset->get_banknum = _preset_get_banknum;
+        preset->get_num     = _preset_get_num;
+        preset->noteon      = _preset_noteon;
+    }
+
+    static int _preset_free(fluid_preset_t* const preset)
+    {
+        delete preset;
+        return 0;
+    }
+
+    static char* _preset_get_name(fluid_preset_t* const preset)
+    {
+        fluid_preset_t* const shared(((const Preset*)preset->data)->preset);
+
+        return shared->get_name(shared);
+    }
+
+    static int _preset_get_banknum(fluid_preset_t* const preset)
+    {
+        return ((const Preset*)preset->data)->bank;
+    }
+
+    static int _preset_get_num(fluid_preset_t* const preset)
+    {
+        return ((const Preset*)preset->data)->num;
+    }
+
+    static int _preset_noteon(fluid_preset_t* const preset, fluid_synth_t* const synth, const int chan, const int key, const int vel)
+    {
+        fluid_preset_t* const shared(((const Preset*)preset->data)->preset);
+
+        // voices are allocated from the calling synth, the shared preset is only read
+        return shared->noteon(shared, synth, chan, key, vel);
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(FluidSoundFontCache)
+};
+
+static FluidSoundFontCache gFluidSoundFontCache;
+
+fluid_sfont_t* FluidSoundFontCache::_loader_load(fluid_sfloader_t*, const char* const filename)
+{
+    Font* const font(gFluidSoundFontCache.acquire(filename));
+
+    if (font == nullptr)
+        return nullptr;
+
+    Proxy* const proxy(new Proxy);
+    proxy->font      = font;
+    proxy->iterIndex = 0;
+
+    fluid_sfont_t* const sfont(new fluid_sfont_t);
+    carla_zeroStruct(*sfont);
+
+    sfont->data            = proxy;
+    sfont->free            = _sfont_free;
+    sfont->get_name        = _sfont_get_name;
+    sfont->get_preset      = _sfont_get_preset;
+    sfont->iteration_start = _sfont_iteration_start;
+    sfont->iteration_next  = _sfont_iteration_next;
+
+    return sfont;
+}
+
+int FluidSoundFontCache::_sfont_free(fluid_sfont_t* const sfont)
+{
+    Proxy* const proxy((Proxy*)sfont->data);
+
+    gFluidSoundFontCache.release(proxy->font);
+
+    delete proxy;
+    delete sfont;
+    return 0;
+}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 class CarlaPluginFluidSynth : public CarlaPlugin
@@ -77,6 +551,9 @@ public:
         fSynth = new_fluid_synth(fSettings);
         CARLA_SAFE_ASSERT_RETURN(fSynth != nullptr,);
 
+        // share sample data with other instances using the same file
+        FluidSoundFontCache::addLoader(fSynth);
+
 #ifdef FLUIDSYNTH_VERSION_NEW_API
         fluid_synth_set_sample_rate(fSynth, (float)pData->engine->getSampleRate());
 #endif
@@ -1461,13 +1938,11 @@ public:
                 // Volume
                 if (kUse16Outs)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] = fAudio16Buffers[i][k] * pData->postProc.volume;
+                    carla_copyFloatsWithGain(outBuffer[i]+timeOffset, fAudio16Buffers[i], pData->postProc.volume, frames);
                 }
                 else if (doVolume)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] *= pData->postProc.volume;
+                    carla_multiply(outBuffer[i]+timeOffset, pData->postProc.volume, frames);
                 }
             }
 
@@ -181,7 +181,8 @@ PluginParameterData::PluginParameterData() noexcept
     : count(0),
       data(nullptr),
       ranges(nullptr),
-      special(nullptr) {}
+      special(nullptr),
+      lastOutputValues(nullptr) {}
 
 PluginParameterData::~PluginParameterData() noexcept
 {
@@ -189,6 +190,7 @@ PluginParameterData::~PluginParameterData() noexcept
     CARLA_SAFE_ASSERT(data == nullptr);
     CARLA_SAFE_ASSERT(ranges == nullptr);
     CARLA_SAFE_ASSERT(special == nullptr);
+    CARLA_SAFE_ASSERT(lastOutputValues == nullptr);
 }
 
 void PluginParameterData::createNew(const uint32_t newCount, const bool withSpecial)
@@ -197,6 +199,7 @@ void PluginParameterData::createNew(const uint32_t newCount, const bool withSpec
     CARLA_SAFE_ASSERT_RETURN(data == nullptr,);
     CARLA_SAFE_ASSERT_RETURN(ranges == nullptr,);
     CARLA_SAFE_ASSERT_RETURN(special == nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(lastOutputValues == nullptr,);
     CARLA_SAFE_ASSERT_RETURN(newCount > 0,);
 
     data = new ParameterData[newCount];
@@ -218,6 +221,9 @@ void PluginParameterData::createNew(const uint32_t newCount, const bool withSpec
         carla_zeroStructs(special, newCount);
     }
 
+    lastOutputValues = new float[newCount];
+    carla_zeroFloats(lastOutputValues, newCount);
+
     count = newCount;
 }
 
@@ -241,6 +247,12 @@ void PluginParameterData::clear() noexcept
         special = nullptr;
     }
 
+    if (lastOutputValues != nullptr)
+    {
+        delete[] lastOutputValues;
+        lastOutputValues = nullptr;
+    }
+
     count = 0;
 }
 
@@ -497,6 +509,22 @@ void CarlaPlugin::ProtectedData::Latency::recreateBuffers(const uint32_t newChan
 }
 #endif
 
+// -----------------------------------------------------------------------
+// ProtectedData::BlockSplit
+
+CarlaPlugin::ProtectedData::BlockSplit::BlockSplit() noexcept
+    : minFrames(0),
+      cycles(0),
+      splits(0),
+      coalesced(0) {}
+
+void CarlaPlugin::ProtectedData::BlockSplit::clearStats() noexcept
+{
+    cycles    = 0;
+    splits    = 0;
+    coalesced = 0;
+}
+
 // -----------------------------------------------------------------------
 // ProtectedData::PostRtEvents
 
@@ -609,6 +637,7 @@ CarlaPlugin::ProtectedData::ProtectedData(CarlaEngine* const eng, const uint idx
       stateSave(),
       extNotes(),
       latency(),
+      blockSplit(),
       postRtEvents(),
       postUiEvents()
 #ifndef BUILD_BRIDGE
@@ -730,6 +759,7 @@ void CarlaPlugin::ProtectedData::postponeRtEvent(const PluginPostRtEvent& rtEven
     CARLA_SAFE_ASSERT_RETURN(rtEvent.type != kPluginPostRtEventNull,);
 
     postRtEvents.appendRT(rtEvent);
+    engine->markPluginDirty(id);
 }
 
 void CarlaPlugin::ProtectedData::postponeRtEvent(const PluginPostRtEventType type, const int32_t value1, const int32_t value2, const float value3) noexcept
@@ -739,6 +769,7 @@ void CarlaPlugin::ProtectedData::postponeRtEvent(const PluginPostRtEventType typ
     PluginPostRtEvent rtEvent = { type, value1, value2, value3 };
 
     postRtEvents.appendRT(rtEvent);
+    engine->markPluginDirty(id);
 }
 
 // -----------------------------------------------------------------------
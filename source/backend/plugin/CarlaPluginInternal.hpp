@@ -163,6 +163,7 @@ struct PluginParameterData {
     ParameterData* data;
     ParameterRanges* ranges;
     SpecialParameterType* special;
+    float* lastOutputValues;
 
     PluginParameterData() noexcept;
     ~PluginParameterData() noexcept;
@@ -282,6 +283,35 @@ struct CarlaPlugin::ProtectedData {
 
     } latency;
 
+    // Sample-accurate block splitting policy and stats.
+    // Control events closer than 'minFrames' to the start of the current sub-block
+    // are coalesced into it instead of splitting the block again.
+    struct BlockSplit {
+        uint32_t minFrames;
+        uint64_t cycles;
+        uint64_t splits;
+        uint64_t coalesced;
+
+        BlockSplit() noexcept;
+        void clearStats() noexcept;
+
+        // called from the plugin process loop for each event past the current sub-block start
+        bool shouldSplit(const uint32_t framesSinceLastSplit) noexcept
+        {
+            if (framesSinceLastSplit >= minFrames)
+            {
+                ++splits;
+                return true;
+            }
+
+            ++coalesced;
+            return false;
+        }
+
+        CARLA_DECLARE_NON_COPY_STRUCT(BlockSplit)
+
+    } blockSplit;
+
     struct PostRtEvents {
         CarlaMutex mutex;
         RtLinkedList<PluginPostRtEvent>::Pool dataPool;
@@ -976,7 +976,7 @@ public:
             const bool isMono    = (pData->audioIn.count == 1);
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float oldBufLeft[doBalance ? frames : 1];
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -985,11 +985,7 @@ public:
                 {
                     const uint32_t c = isMono ? 0 : i;
 
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        bufValue = audioIn[c][k];
-                        audioOut[i][k] = (audioOut[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
+                    carla_mixFloats(audioOut[i], audioIn[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, frames);
                 }
 
                 // Balance
@@ -1006,28 +1002,24 @@ public:
                     float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
                     float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
 
-                    for (uint32_t k=0; k < frames; ++k)
+                    if (isPair)
                     {
-                        if (isPair)
-                        {
-                            // left
-                            audioOut[i][k]  = oldBufLeft[k]     * (1.0f - balRangeL);
-                            audioOut[i][k] += audioOut[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            audioOut[i][k]  = audioOut[i][k] * balRangeR;
-                            audioOut[i][k] += oldBufLeft[k]   * balRangeL;
-                        }
+                        // left
+                        carla_copyFloatsWithGain(audioOut[i], oldBufLeft, 1.0f - balRangeL, frames);
+                        carla_addFloatsWithGain(audioOut[i], audioOut[i+1], 1.0f - balRangeR, frames);
+                    }
+                    else
+                    {
+                        // right
+                        carla_multiply(audioOut[i], balRangeR, frames);
+                        carla_addFloatsWithGain(audioOut[i], oldBufLeft, balRangeL, frames);
                     }
                 }
 
                 // Volume (and buffer copy)
                 if (doVolume)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k] *= pData->postProc.volume;
+                    carla_multiply(audioOut[i], pData->postProc.volume, frames);
                 }
             }
 
@@ -1125,13 +1117,15 @@ public:
             case kPluginBridgeNonRtServerSetCustomData:
                 break;
 
-            case kPluginBridgeNonRtServerSetChunkDataFile: {
+            case kPluginBridgeNonRtServerSetChunkDataFile:
+            case kPluginBridgeNonRtServerSetChunkDataBinaryFile: {
                 // uint/size, str[] (filename)
                 const uint32_t chunkFilePathSize(fShmNonRtServerControl.readUInt());
                 char chunkFilePath[chunkFilePathSize];
                 fShmNonRtServerControl.readCustomData(chunkFilePath, chunkFilePathSize);
             }   break;
 
+            case kPluginBridgeNonRtServerChunkDataShmReleased:
             case kPluginBridgeNonRtServerSetLatency:
                 break;
 
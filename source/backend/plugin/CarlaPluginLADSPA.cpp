@@ -927,6 +927,9 @@ public:
 
             uint32_t timeOffset = 0;
 
+            if (isSampleAccurate && pData->event.portIn->getEventCount() > 0)
+                ++pData->blockSplit.cycles;
+
             for (uint32_t i=0, numEvents=pData->event.portIn->getEventCount(); i < numEvents; ++i)
             {
                 const EngineEvent& event(pData->event.portIn->getEvent(i));
@@ -936,7 +939,7 @@ public:
 
                 CARLA_ASSERT_INT2(event.time >= timeOffset, event.time, timeOffset);
 
-                if (isSampleAccurate && event.time > timeOffset)
+                if (isSampleAccurate && event.time > timeOffset && pData->blockSplit.shouldSplit(event.time - timeOffset))
                 {
                     if (processSingle(audioIn, audioOut, event.time - timeOffset, timeOffset))
                         timeOffset = event.time;
@@ -1191,7 +1194,7 @@ public:
             const bool isMono    = (pData->audioIn.count == 1);
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float oldBufLeft[doBalance ? frames : 1];
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1200,17 +1203,12 @@ public:
                 {
                     const uint32_t c = isMono ? 0 : i;
 
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (k < pData->latency.frames)
-                            bufValue = pData->latency.buffers[c][k];
-                        else if (pData->latency.frames < frames)
-                            bufValue = fAudioInBuffers[c][k-pData->latency.frames];
-                        else
-                            bufValue = fAudioInBuffers[c][k];
+                    const uint32_t latFrames = carla_minPositive(pData->latency.frames, frames);
 
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
+                    if (latFrames > 0)
+                        carla_mixFloats(fAudioOutBuffers[i], pData->latency.buffers[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, latFrames);
+                    if (latFrames < frames)
+                        carla_mixFloats(fAudioOutBuffers[i]+latFrames, fAudioInBuffers[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, frames-latFrames);
                 }
 
                 // Balance
@@ -1227,27 +1225,23 @@ public:
                     float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
                     float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
 
-                    for (uint32_t k=0; k < frames; ++k)
+                    if (isPair)
                     {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
+                        // left
+                        carla_copyFloatsWithGain(fAudioOutBuffers[i], oldBufLeft, 1.0f - balRangeL, frames);
+                        carla_addFloatsWithGain(fAudioOutBuffers[i], fAudioOutBuffers[i+1], 1.0f - balRangeR, frames);
+                    }
+                    else
+                    {
+                        // right
+                        carla_multiply(fAudioOutBuffers[i], balRangeR, frames);
+                        carla_addFloatsWithGain(fAudioOutBuffers[i], oldBufLeft, balRangeL, frames);
                     }
                 }
 
                 // Volume (and buffer copy)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k] * pData->postProc.volume;
+                    carla_copyFloatsWithGain(audioOut[i]+timeOffset, fAudioOutBuffers[i], pData->postProc.volume, frames);
                 }
             }
 
@@ -22,13 +22,17 @@
 #include "CarlaPluginInternal.hpp"
 #include "CarlaEngine.hpp"
 
+#include "CarlaLv2CacheUtils.hpp"
 #include "CarlaLv2Utils.hpp"
 
 #include "CarlaBase64Utils.hpp"
 #include "CarlaEngineUtils.hpp"
 #include "CarlaPipeUtils.hpp"
 #include "CarlaPluginUI.hpp"
+#include "CarlaTimeUtils.hpp"
 #include "Lv2AtomRingBuffer.hpp"
+#include "Lv2UridMap.hpp"
+#include "Lv2WorkerPool.hpp"
 
 #include "../engine/CarlaEngineOsc.hpp"
 #include "../modules/lilv/config/lilv_config.h"
@@ -39,7 +43,6 @@ extern "C" {
 
 #include "water/files/File.h"
 
-#include <string>
 #include <vector>
 
 using water::File;
@@ -55,6 +58,12 @@ static const CustomData       kCustomDataFallback       = { nullptr, nullptr, nu
 static /* */ CustomData       kCustomDataFallbackNC     = { nullptr, nullptr, nullptr };
 static const ExternalMidiNote kExternalMidiNoteFallback = { -1, 0, 0 };
 
+// -------------------------------------------------------------------------------------------------------------------
+// Plugins can be loaded from several threads at once while opening a project.
+// lilv is not thread-safe, and LV2 discovery functions must not run concurrently.
+
+static CarlaRecursiveMutex gLv2LoadMutex;
+
 // -------------------------------------------------------------------------------------------------------------------
 
 // Maximum default buffer size
@@ -134,6 +143,12 @@ enum CarlaLv2URIDs {
     kUridCount
 };
 
+// URIDs for everything not in CarlaLv2URIDs, shared by all plugins and UIs in this process.
+static Lv2UridMap gLv2UridMap(kUridCount);
+
+// Worker threads shared by all plugins
+static Lv2WorkerPool gLv2WorkerPool;
+
 // LV2 Feature Ids
 enum CarlaLv2Features {
     // DSP features
@@ -496,7 +511,8 @@ private:
 // -------------------------------------------------------------------------------------------------------------------
 
 class CarlaPluginLV2 : public CarlaPlugin,
-                       private CarlaPluginUI::CloseCallback
+                       private CarlaPluginUI::CloseCallback,
+                       private Lv2WorkerPool::Client
 {
 public:
     CarlaPluginLV2(CarlaEngine* const engine, const uint id)
@@ -523,15 +539,15 @@ public:
           fEventsOut(),
           fLv2Options(),
           fPipeServer(engine, this),
-          fCustomURIDs(kUridCount, std::string("urn:null")),
+          fUridsSentToBridge(kUridCount),
           fFirstActive(true),
           fLastStateChunk(nullptr),
           fLastTimeInfo(),
           fExt(),
-          fUI()
+          fUI(),
+          fWorker()
     {
         carla_debug("CarlaPluginLV2::CarlaPluginLV2(%p, %i)", engine, id);
-        CARLA_SAFE_ASSERT(fCustomURIDs.size() == kUridCount);
 
         carla_zeroPointers(fFeatures, kFeatureCountAll+1);
 
@@ -702,6 +718,18 @@ public:
             fTmpAtomBuffer = nullptr;
         }
 
+        if (fWorker.scheduleCount != 0)
+        {
+            carla_debug("CarlaPluginLV2::~CarlaPluginLV2() - '%s' worker stats: "
+                        "%u requests, schedule latency avg " P_UINT64 " max " P_UINT64 " us, "
+                        "%u responses, response latency avg " P_UINT64 " max " P_UINT64 " us",
+                        pData->name,
+                        fWorker.scheduleCount, fWorker.scheduleTotal / fWorker.scheduleCount, fWorker.scheduleMax,
+                        fWorker.responseCount,
+                        fWorker.responseCount != 0 ? fWorker.responseTotal / fWorker.responseCount : 0,
+                        fWorker.responseMax);
+        }
+
         clearBuffers();
     }
 
@@ -759,6 +787,17 @@ public:
         return static_cast<uint32_t>(latency);
     }
 
+    void getWorkerStats(uint32_t& requests, uint64_t& requestAvgTime, uint64_t& requestMaxTime,
+                        uint32_t& responses, uint64_t& responseAvgTime, uint64_t& responseMaxTime) const noexcept override
+    {
+        requests        = fWorker.scheduleCount;
+        requestAvgTime  = requests != 0 ? fWorker.scheduleTotal / requests : 0;
+        requestMaxTime  = fWorker.scheduleMax;
+        responses       = fWorker.responseCount;
+        responseAvgTime = responses != 0 ? fWorker.responseTotal / responses : 0;
+        responseMaxTime = fWorker.responseMax;
+    }
+
     // -------------------------------------------------------------------
     // Information (count)
 
@@ -1213,8 +1252,17 @@ public:
         {
             const LV2_URID_Map* const uridMap = (const LV2_URID_Map*)fFeatures[kFeatureIdUridMap]->data;
 
-            LilvState* const state = Lv2WorldClass::getInstance().getStateFromURI(fRdfDescriptor->Presets[index].URI,
-                                                                                  uridMap);
+            LilvState* state;
+
+            {
+                const CarlaRecursiveMutexLocker crml(gLv2LoadMutex);
+
+                // presets can live in other bundles, like the user's own
+                Lv2WorldClass::getInstance().initFullIfNeeded();
+
+                state = Lv2WorldClass::getInstance().getStateFromURI(fRdfDescriptor->Presets[index].URI, uridMap);
+            }
+
             CARLA_SAFE_ASSERT_RETURN(state != nullptr,);
 
             // invalidate midi-program selection
@@ -1304,18 +1352,18 @@ public:
                     const ScopedLocale csl;
 
                     // write URI mappings
-                    uint32_t u = 0;
-                    for (std::vector<std::string>::iterator it=fCustomURIDs.begin(), end=fCustomURIDs.end(); it != end; ++it, ++u)
+                    fUridsSentToBridge = gLv2UridMap.getNextId();
+
+                    for (uint32_t u = kUridCount; u < fUridsSentToBridge; ++u)
                     {
-                        if (u < kUridCount)
-                            continue;
-                        const std::string& uri(*it);
+                        const char* const uri(gLv2UridMap.unmap(u));
+                        CARLA_SAFE_ASSERT_CONTINUE(uri != nullptr);
 
                         std::snprintf(tmpBuf, 0xff, "%u\n", u);
 
                         fPipeServer.writeMessage("urid\n", 5);
                         fPipeServer.writeMessage(tmpBuf);
-                        fPipeServer.writeAndFixMessage(uri.c_str());
+                        fPipeServer.writeAndFixMessage(uri);
                     }
 
                     // write UI options
@@ -1508,6 +1556,10 @@ public:
 
     void uiIdle() override
     {
+        // other plugins might have mapped new URIs
+        if (fUI.type == UI::TYPE_BRIDGE && fPipeServer.isPipeRunning())
+            sendNewUridsToBridge();
+
         if (fAtomBufferOut.isDataAvailableForReading())
         {
             Lv2AtomRingBuffer tmpRingBuffer(fAtomBufferOut, fTmpAtomBuffer);
@@ -1520,12 +1572,7 @@ public:
 
             for (; tmpRingBuffer.get(atom, portIndex);)
             {
-                if (atom->type == kUridCarlaAtomWorker)
-                {
-                    CARLA_SAFE_ASSERT_CONTINUE(fExt.worker != nullptr && fExt.worker->work != nullptr);
-                    fExt.worker->work(fHandle, carla_lv2_worker_respond, this, atom->size, LV2_ATOM_BODY_CONST(atom));
-                }
-                else if (fUI.type == UI::TYPE_BRIDGE)
+                if (fUI.type == UI::TYPE_BRIDGE)
                 {
                     if (fPipeServer.isPipeRunning())
                         fPipeServer.writeLv2AtomMessage(portIndex, atom);
@@ -2341,15 +2388,25 @@ public:
             pData->event.portOut = (CarlaEngineEventPort*)pData->client->addPort(kEnginePortTypeEvent, portName, false, 0);
         }
 
-        if (fExt.worker != nullptr || (fUI.type != UI::TYPE_NULL && fEventsIn.count > 0 && (fEventsIn.data[0].type & CARLA_EVENT_DATA_ATOM) != 0))
+        if (fUI.type != UI::TYPE_NULL && fEventsIn.count > 0 && (fEventsIn.data[0].type & CARLA_EVENT_DATA_ATOM) != 0)
             fAtomBufferIn.createBuffer(eventBufferSize);
 
-        if (fExt.worker != nullptr || (fUI.type != UI::TYPE_NULL && fEventsOut.count > 0 && (fEventsOut.data[0].type & CARLA_EVENT_DATA_ATOM) != 0))
+        if (fUI.type != UI::TYPE_NULL && fEventsOut.count > 0 && (fEventsOut.data[0].type & CARLA_EVENT_DATA_ATOM) != 0)
         {
             fAtomBufferOut.createBuffer(std::min(eventBufferSize*32, 1638400U));
             fTmpAtomBuffer = new uint8_t[fAtomBufferOut.getSize()];
         }
 
+        if (fExt.worker != nullptr && ! fWorker.requests.isReady())
+        {
+            const uint32_t workerBufferSize(std::min(eventBufferSize*32, 1638400U));
+
+            fWorker.requests.createBuffer(workerBufferSize);
+            fWorker.responses.createBuffer(workerBufferSize);
+            fWorker.requestData  = new uint8_t[fWorker.requests.getSize()];
+            fWorker.responseData = new uint8_t[fWorker.responses.getSize()];
+        }
+
         if (fEventsIn.ctrl != nullptr && fEventsIn.ctrl->port == nullptr)
             fEventsIn.ctrl->port = pData->event.portIn;
 
@@ -2546,8 +2603,15 @@ public:
             }
             else
             {
+                LilvState* state;
+
+                {
+                    const CarlaRecursiveMutexLocker crml(gLv2LoadMutex);
+                    state = Lv2WorldClass::getInstance().getStateFromURI(fDescriptor->URI, (const LV2_URID_Map*)fFeatures[kFeatureIdUridMap]->data);
+                }
+
                 // load default state
-                if (LilvState* const state = Lv2WorldClass::getInstance().getStateFromURI(fDescriptor->URI, (const LV2_URID_Map*)fFeatures[kFeatureIdUridMap]->data))
+                if (state != nullptr)
                 {
                     lilv_state_restore(state, fExt.state, fHandle, carla_lilv_set_port_value, this, 0, fFeatures);
 
@@ -2622,6 +2686,12 @@ public:
             }
         }
 
+        if (fExt.worker != nullptr && ! fWorker.registered)
+        {
+            gLv2WorkerPool.addClient(this);
+            fWorker.registered = true;
+        }
+
         fFirstActive = true;
     }
 
@@ -2630,6 +2700,13 @@ public:
         CARLA_SAFE_ASSERT_RETURN(fDescriptor != nullptr,);
         CARLA_SAFE_ASSERT_RETURN(fHandle != nullptr,);
 
+        // waits for any work() call in progress, requests still queued run after the next activate()
+        if (fWorker.registered)
+        {
+            gLv2WorkerPool.removeClient(this);
+            fWorker.registered = false;
+        }
+
         if (fDescriptor->deactivate != nullptr)
         {
             try {
@@ -2931,6 +3008,23 @@ public:
 
         if (fEventsIn.ctrl != nullptr)
         {
+            // ----------------------------------------------------------------------------------------------------
+            // Worker Responses
+
+            if (fExt.worker != nullptr)
+            {
+                uint32_t size;
+                uint64_t time;
+
+                for (; fWorker.responses.get(size, time, fWorker.responseData);)
+                {
+                    fWorker.addResponseLatency(carla_gettime_us() - time);
+
+                    if (fExt.worker->work_response != nullptr)
+                        fExt.worker->work_response(fHandle, size, fWorker.responseData);
+                }
+            }
+
             // ----------------------------------------------------------------------------------------------------
             // Message Input
 
@@ -2945,12 +3039,7 @@ public:
                     {
                         j = (portIndex < fEventsIn.count) ? portIndex : fEventsIn.ctrlIndex;
 
-                        if (atom->type == kUridCarlaAtomWorker)
-                        {
-                            CARLA_SAFE_ASSERT_CONTINUE(fExt.worker != nullptr && fExt.worker->work_response != nullptr);
-                            fExt.worker->work_response(fHandle, atom->size, LV2_ATOM_BODY_CONST(atom));
-                        }
-                        else if (! lv2_atom_buffer_write(&evInAtomIters[j], 0, 0, atom->type, atom->size, LV2_ATOM_BODY_CONST(atom)))
+                        if (! lv2_atom_buffer_write(&evInAtomIters[j], 0, 0, atom->type, atom->size, LV2_ATOM_BODY_CONST(atom)))
                         {
                             carla_stdout("Event input buffer full, at least 1 message lost");
                             continue;
@@ -3021,6 +3110,9 @@ public:
 
             const uint32_t numEvents = (fEventsIn.ctrl->port != nullptr) ? fEventsIn.ctrl->port->getEventCount() : 0;
 
+            if (isSampleAccurate && numEvents > 0)
+                ++pData->blockSplit.cycles;
+
             for (uint32_t i=0; i < numEvents; ++i)
             {
                 const EngineEvent& event(fEventsIn.ctrl->port->getEvent(i));
@@ -3030,9 +3122,16 @@ public:
 
                 CARLA_ASSERT_INT2(event.time >= timeOffset, event.time, timeOffset);
 
+                // position of an event coalesced into the current sub-block, relative to its start
+                uint32_t coalescedTime = 0;
+
                 if (isSampleAccurate && event.time > timeOffset)
                 {
-                    if (processSingle(audioIn, audioOut, cvIn, cvOut, event.time - timeOffset, timeOffset))
+                    if (! pData->blockSplit.shouldSplit(event.time - timeOffset))
+                    {
+                        coalescedTime = event.time - timeOffset;
+                    }
+                    else if (processSingle(audioIn, audioOut, cvIn, cvOut, event.time - timeOffset, timeOffset))
                     {
                         startTime  = 0;
                         timeOffset = event.time;
@@ -3187,7 +3286,7 @@ public:
                             midiData[1] = uint8_t(ctrlEvent.param);
                             midiData[2] = uint8_t(ctrlEvent.value*127.0f);
 
-                            const uint32_t mtime(isSampleAccurate ? startTime : event.time);
+                            const uint32_t mtime(isSampleAccurate ? startTime + coalescedTime : event.time);
 
                             if (fEventsIn.ctrl->type & CARLA_EVENT_DATA_ATOM)
                                 lv2_atom_buffer_write(&evInAtomIters[fEventsIn.ctrlIndex], mtime, 0, kUridMidiEvent, 3, midiData);
@@ -3215,7 +3314,7 @@ public:
                             midiData[1] = MIDI_CONTROL_BANK_SELECT;
                             midiData[2] = uint8_t(ctrlEvent.param);
 
-                            const uint32_t mtime(isSampleAccurate ? startTime : event.time);
+                            const uint32_t mtime(isSampleAccurate ? startTime + coalescedTime : event.time);
 
                             if (fEventsIn.ctrl->type & CARLA_EVENT_DATA_ATOM)
                                 lv2_atom_buffer_write(&evInAtomIters[fEventsIn.ctrlIndex], mtime, 0, kUridMidiEvent, 3, midiData);
@@ -3253,7 +3352,7 @@ public:
                             midiData[0] = uint8_t(MIDI_STATUS_PROGRAM_CHANGE | (event.channel & MIDI_CHANNEL_BIT));
                             midiData[1] = uint8_t(ctrlEvent.param);
 
-                            const uint32_t mtime(isSampleAccurate ? startTime : event.time);
+                            const uint32_t mtime(isSampleAccurate ? startTime + coalescedTime : event.time);
 
                             if (fEventsIn.ctrl->type & CARLA_EVENT_DATA_ATOM)
                                 lv2_atom_buffer_write(&evInAtomIters[fEventsIn.ctrlIndex], mtime, 0, kUridMidiEvent, 2, midiData);
@@ -3269,7 +3368,7 @@ public:
                     case kEngineControlEventTypeAllSoundOff:
                         if (pData->options & PLUGIN_OPTION_SEND_ALL_SOUND_OFF)
                         {
-                            const uint32_t mtime(isSampleAccurate ? startTime : event.time);
+                            const uint32_t mtime(isSampleAccurate ? startTime + coalescedTime : event.time);
 
                             uint8_t midiData[3];
                             midiData[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (event.channel & MIDI_CHANNEL_BIT));
@@ -3298,7 +3397,7 @@ public:
                             }
 #endif
 
-                            const uint32_t mtime(isSampleAccurate ? startTime : event.time);
+                            const uint32_t mtime(isSampleAccurate ? startTime + coalescedTime : event.time);
 
                             uint8_t midiData[3];
                             midiData[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (event.channel & MIDI_CHANNEL_BIT));
@@ -3340,7 +3439,7 @@ public:
                         status = MIDI_STATUS_NOTE_OFF;
 
                     const uint32_t j     = fEventsIn.ctrlIndex;
-                    const uint32_t mtime = isSampleAccurate ? startTime : event.time;
+                    const uint32_t mtime = isSampleAccurate ? startTime + coalescedTime : event.time;
 
                     // put back channel in data
                     uint8_t midiData2[midiEvent.size];
@@ -3633,7 +3732,7 @@ public:
             const bool isMono    = (pData->audioIn.count == 1);
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float oldBufLeft[doBalance ? frames : 1];
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -3642,17 +3741,12 @@ public:
                 {
                     const uint32_t c = isMono ? 0 : i;
 
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        if (k < pData->latency.frames)
-                            bufValue = pData->latency.buffers[c][k];
-                        else if (pData->latency.frames < frames)
-                            bufValue = fAudioInBuffers[c][k-pData->latency.frames];
-                        else
-                            bufValue = fAudioInBuffers[c][k];
+                    const uint32_t latFrames = carla_minPositive(pData->latency.frames, frames);
 
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
+                    if (latFrames > 0)
+                        carla_mixFloats(fAudioOutBuffers[i], pData->latency.buffers[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, latFrames);
+                    if (latFrames < frames)
+                        carla_mixFloats(fAudioOutBuffers[i]+latFrames, fAudioInBuffers[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, frames-latFrames);
                 }
 
                 // Balance
@@ -3669,27 +3763,23 @@ public:
                     float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
                     float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
 
-                    for (uint32_t k=0; k < frames; ++k)
+                    if (isPair)
                     {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
+                        // left
+                        carla_copyFloatsWithGain(fAudioOutBuffers[i], oldBufLeft, 1.0f - balRangeL, frames);
+                        carla_addFloatsWithGain(fAudioOutBuffers[i], fAudioOutBuffers[i+1], 1.0f - balRangeR, frames);
+                    }
+                    else
+                    {
+                        // right
+                        carla_multiply(fAudioOutBuffers[i], balRangeR, frames);
+                        carla_addFloatsWithGain(fAudioOutBuffers[i], oldBufLeft, balRangeL, frames);
                     }
                 }
 
                 // Volume (and buffer copy)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k] * pData->postProc.volume;
+                    carla_copyFloatsWithGain(audioOut[i]+timeOffset, fAudioOutBuffers[i], pData->postProc.volume, frames);
                 }
             }
         } // End of Post-processing
@@ -4307,24 +4397,10 @@ public:
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', kUridNull);
         carla_debug("CarlaPluginLV2::getCustomURID(\"%s\")", uri);
 
-        const std::string    s_uri(uri);
-        const std::ptrdiff_t s_pos(std::find(fCustomURIDs.begin(), fCustomURIDs.end(), s_uri) - fCustomURIDs.begin());
-
-        if (s_pos <= 0 || s_pos >= INT32_MAX)
-            return kUridNull;
-
-        const LV2_URID urid     = static_cast<LV2_URID>(s_pos);
-        const LV2_URID uriCount = static_cast<LV2_URID>(fCustomURIDs.size());
-
-        if (urid < uriCount)
-            return urid;
-
-        CARLA_SAFE_ASSERT(urid == uriCount);
-
-        fCustomURIDs.push_back(uri);
+        const LV2_URID urid(gLv2UridMap.map(uri));
 
         if (fUI.type == UI::TYPE_BRIDGE && fPipeServer.isPipeRunning())
-            fPipeServer.writeLv2UridMessage(uriCount, uri);
+            sendNewUridsToBridge();
 
         return urid;
     }
@@ -4333,10 +4409,21 @@ public:
     {
         static const char* const sFallback = "urn:null";
         CARLA_SAFE_ASSERT_RETURN(urid != kUridNull, sFallback);
-        CARLA_SAFE_ASSERT_RETURN(urid < fCustomURIDs.size(), sFallback);
         carla_debug("CarlaPluginLV2::getCustomURIString(%i)", urid);
 
-        return fCustomURIDs[urid].c_str();
+        const char* const uri(gLv2UridMap.unmap(urid));
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr, sFallback);
+
+        return uri;
+    }
+
+    void sendNewUridsToBridge() noexcept
+    {
+        for (const uint32_t nextId = gLv2UridMap.getNextId(); fUridsSentToBridge < nextId; ++fUridsSentToBridge)
+        {
+            if (const char* const uri = gLv2UridMap.unmap(fUridsSentToBridge))
+                fPipeServer.writeLv2UridMessage(fUridsSentToBridge, uri);
+        }
     }
 
     // -------------------------------------------------------------------
@@ -4513,22 +4600,43 @@ public:
             return LV2_WORKER_SUCCESS;
         }
 
-        LV2_Atom atom;
-        atom.size = size;
-        atom.type = kUridCarlaAtomWorker;
+        if (! fWorker.requests.put(size, data, carla_gettime_us()))
+            return LV2_WORKER_ERR_NO_SPACE;
 
-        return fAtomBufferOut.putChunk(&atom, data, fEventsOut.ctrlIndex) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+        gLv2WorkerPool.wakeUp();
+        return LV2_WORKER_SUCCESS;
     }
 
     LV2_Worker_Status handleWorkerRespond(const uint32_t size, const void* const data)
     {
         carla_debug("CarlaPluginLV2::handleWorkerRespond(%i, %p)", size, data);
 
-        LV2_Atom atom;
-        atom.size = size;
-        atom.type = kUridCarlaAtomWorker;
+        return fWorker.responses.put(size, data, carla_gettime_us()) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+    }
 
-        return fAtomBufferIn.putChunk(&atom, data, fEventsIn.ctrlIndex) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+    // -------------------------------------------------------------------
+    // Lv2WorkerPool::Client calls, from a pool thread
+
+    bool hasPendingWork() const noexcept override
+    {
+        return fWorker.requests.isDataAvailableForReading();
+    }
+
+    void runPendingWork() noexcept override
+    {
+        CARLA_SAFE_ASSERT_RETURN(fExt.worker != nullptr && fExt.worker->work != nullptr,);
+
+        uint32_t size;
+        uint64_t time;
+
+        for (; fWorker.requests.get(size, time, fWorker.requestData);)
+        {
+            fWorker.addScheduleLatency(carla_gettime_us() - time);
+
+            try {
+                fExt.worker->work(fHandle, carla_lv2_worker_respond, this, size, fWorker.requestData);
+            } CARLA_SAFE_EXCEPTION("LV2 worker work");
+        }
     }
 
     // -------------------------------------------------------------------
@@ -4771,24 +4879,52 @@ public:
         // ---------------------------------------------------------------
         // Init LV2 World if needed, sets LV2_PATH for lilv
 
-        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
+        {
+            // lilv is not thread-safe
+            const CarlaRecursiveMutexLocker crml(gLv2LoadMutex);
 
-        if (pData->engine->getOptions().pathLV2 != nullptr && pData->engine->getOptions().pathLV2[0] != '\0')
-            lv2World.initIfNeeded(pData->engine->getOptions().pathLV2);
-        else if (const char* const LV2_PATH = std::getenv("LV2_PATH"))
-            lv2World.initIfNeeded(LV2_PATH);
-        else
-            lv2World.initIfNeeded(LILV_DEFAULT_LV2_PATH);
+            Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
 
-        // ---------------------------------------------------------------
-        // get plugin from lv2_rdf (lilv)
+            const char* LV2_PATH = pData->engine->getOptions().pathLV2;
 
-        fRdfDescriptor = lv2_rdf_new(uri, true);
+            if (LV2_PATH == nullptr || LV2_PATH[0] == '\0')
+                LV2_PATH = std::getenv("LV2_PATH");
+            if (LV2_PATH == nullptr)
+                LV2_PATH = LILV_DEFAULT_LV2_PATH;
 
-        if (fRdfDescriptor == nullptr)
-        {
-            pData->engine->setLastError("Failed to find the requested plugin");
-            return false;
+            // ---------------------------------------------------------------
+            // get plugin from the metadata cache, only loading its own bundle into lilv
+
+            Lv2MetadataCache& lv2Cache(Lv2MetadataCache::getInstance());
+
+            if (lv2World.needsInit && ! lv2Cache.isUpToDate())
+                lv2Cache.loadAndCheck(LV2_PATH);
+
+            if (lv2World.needsInit && lv2Cache.isUpToDate())
+            {
+                if (const Lv2CachePluginInfo* const cacheInfo = lv2Cache.getPluginFromURI(uri))
+                {
+                    fRdfDescriptor = lv2Cache.createDescriptor(cacheInfo);
+
+                    if (fRdfDescriptor != nullptr)
+                        lv2World.loadBundleIfNeeded(LV2_PATH, cacheInfo->bundle);
+                }
+            }
+
+            // ---------------------------------------------------------------
+            // otherwise get plugin from lv2_rdf (lilv)
+
+            if (fRdfDescriptor == nullptr)
+            {
+                lv2World.initIfNeeded(LV2_PATH);
+                fRdfDescriptor = lv2_rdf_new(uri, true);
+            }
+
+            if (fRdfDescriptor == nullptr)
+            {
+                pData->engine->setLastError("Failed to find the requested plugin");
+                return false;
+            }
         }
 
         // ---------------------------------------------------------------
@@ -4803,50 +4939,55 @@ public:
         // ---------------------------------------------------------------
         // try to get DLL main entry via new mode
 
-        if (const LV2_Lib_Descriptor_Function libDescFn = pData->libSymbol<LV2_Lib_Descriptor_Function>("lv2_lib_descriptor"))
         {
-            // -----------------------------------------------------------
-            // all ok, get lib descriptor
-
-            const LV2_Lib_Descriptor* const libDesc = libDescFn(fRdfDescriptor->Bundle, nullptr);
+            // plugin discovery functions must not run concurrently
+            const CarlaRecursiveMutexLocker crml(gLv2LoadMutex);
 
-            if (libDesc == nullptr)
+            if (const LV2_Lib_Descriptor_Function libDescFn = pData->libSymbol<LV2_Lib_Descriptor_Function>("lv2_lib_descriptor"))
             {
-                pData->engine->setLastError("Could not find the LV2 Descriptor");
-                return false;
-            }
+                // -----------------------------------------------------------
+                // all ok, get lib descriptor
 
-            // -----------------------------------------------------------
-            // get descriptor that matches URI (new mode)
+                const LV2_Lib_Descriptor* const libDesc = libDescFn(fRdfDescriptor->Bundle, nullptr);
 
-            uint32_t i = 0;
-            while ((fDescriptor = libDesc->get_plugin(libDesc->handle, i++)))
-            {
-                if (std::strcmp(fDescriptor->URI, uri) == 0)
-                    break;
-            }
-        }
-        else
-        {
-            // -----------------------------------------------------------
-            // get DLL main entry (old mode)
+                if (libDesc == nullptr)
+                {
+                    pData->engine->setLastError("Could not find the LV2 Descriptor");
+                    return false;
+                }
 
-            const LV2_Descriptor_Function descFn = pData->libSymbol<LV2_Descriptor_Function>("lv2_descriptor");
+                // -----------------------------------------------------------
+                // get descriptor that matches URI (new mode)
 
-            if (descFn == nullptr)
-            {
-                pData->engine->setLastError("Could not find the LV2 Descriptor in the plugin library");
-                return false;
+                uint32_t i = 0;
+                while ((fDescriptor = libDesc->get_plugin(libDesc->handle, i++)))
+                {
+                    if (std::strcmp(fDescriptor->URI, uri) == 0)
+                        break;
+                }
             }
+            else
+            {
+                // -----------------------------------------------------------
+                // get DLL main entry (old mode)
 
-            // -----------------------------------------------------------
-            // get descriptor that matches URI (old mode)
+                const LV2_Descriptor_Function descFn = pData->libSymbol<LV2_Descriptor_Function>("lv2_descriptor");
 
-            uint32_t i = 0;
-            while ((fDescriptor = descFn(i++)))
-            {
-                if (std::strcmp(fDescriptor->URI, uri) == 0)
-                    break;
+                if (descFn == nullptr)
+                {
+                    pData->engine->setLastError("Could not find the LV2 Descriptor in the plugin library");
+                    return false;
+                }
+
+                // -----------------------------------------------------------
+                // get descriptor that matches URI (old mode)
+
+                uint32_t i = 0;
+                while ((fDescriptor = descFn(i++)))
+                {
+                    if (std::strcmp(fDescriptor->URI, uri) == 0)
+                        break;
+                }
             }
         }
 
@@ -5579,27 +5720,21 @@ public:
 
     void handleUridMap(const LV2_URID urid, const char* const uri)
     {
-        CARLA_SAFE_ASSERT_RETURN(urid != kUridNull,);
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0',);
-        carla_debug("CarlaPluginLV2::handleUridMap(%i v " P_SIZE ", \"%s\")", urid, fCustomURIDs.size()-1, uri);
-
-        const std::size_t uriCount(fCustomURIDs.size());
+        carla_debug("CarlaPluginLV2::handleUridMap(%i v %i, \"%s\")", urid, gLv2UridMap.getNextId()-1, uri);
 
-        if (urid < uriCount)
+        // the UI asks for a new URID, getCustomURID() sends it back together with any other new ones
+        if (urid == kUridNull)
         {
-            const char* const ourURI(carla_lv2_urid_unmap(this, urid));
-            CARLA_SAFE_ASSERT_RETURN(ourURI != nullptr,);
-
-            if (std::strcmp(ourURI, uri) != 0)
-            {
-                carla_stderr2("PLUGIN :: wrong URI '%s' vs '%s'", ourURI,  uri);
-            }
-        }
-        else
-        {
-            CARLA_SAFE_ASSERT_RETURN(urid == uriCount,);
-            fCustomURIDs.push_back(uri);
+            CARLA_SAFE_ASSERT(carla_lv2_urid_map(this, uri) != kUridNull);
+            return;
         }
+
+        // all other URIDs are ours, the UI only tells which ones it uses
+        const char* const ourURI(carla_lv2_urid_unmap(this, urid));
+
+        if (ourURI == nullptr || std::strcmp(ourURI, uri) != 0)
+            carla_stderr2("PLUGIN :: wrong URI '%s' vs '%s'", ourURI != nullptr ? ourURI : "(null)", uri);
     }
 
     // -------------------------------------------------------------------
@@ -5633,7 +5768,7 @@ private:
     CarlaPluginLV2Options   fLv2Options;
     CarlaPipeServerLV2      fPipeServer;
 
-    std::vector<std::string> fCustomURIDs;
+    uint32_t fUridsSentToBridge; // see sendNewUridsToBridge()
 
     bool fFirstActive; // first process() call after activate()
     void* fLastStateChunk;
@@ -5700,6 +5835,59 @@ private:
         CARLA_DECLARE_NON_COPY_STRUCT(UI);
     } fUI;
 
+    struct Worker {
+        Lv2WorkerRingBuffer requests;  // audio thread -> pool
+        Lv2WorkerRingBuffer responses; // pool -> audio thread
+        uint8_t* requestData;          // read buffer for the pool side
+        uint8_t* responseData;         // read buffer for the audio side
+        bool registered;
+
+        // latency stats in microseconds, time from schedule_work() until work() runs,
+        // and from the response until work_response() runs
+        uint32_t scheduleCount, responseCount;
+        uint64_t scheduleTotal, scheduleMax;
+        uint64_t responseTotal, responseMax;
+
+        Worker()
+            : requests(),
+              responses(),
+              requestData(nullptr),
+              responseData(nullptr),
+              registered(false),
+              scheduleCount(0),
+              responseCount(0),
+              scheduleTotal(0),
+              scheduleMax(0),
+              responseTotal(0),
+              responseMax(0) {}
+
+        ~Worker()
+        {
+            CARLA_ASSERT(! registered);
+
+            delete[] requestData;
+            delete[] responseData;
+        }
+
+        void addScheduleLatency(const uint64_t latency) noexcept
+        {
+            ++scheduleCount;
+            scheduleTotal += latency;
+            if (latency > scheduleMax)
+                scheduleMax = latency;
+        }
+
+        void addResponseLatency(const uint64_t latency) noexcept
+        {
+            ++responseCount;
+            responseTotal += latency;
+            if (latency > responseMax)
+                responseMax = latency;
+        }
+
+        CARLA_DECLARE_NON_COPY_STRUCT(Worker)
+    } fWorker;
+
     // -------------------------------------------------------------------
     // Event Feature
 
@@ -6239,22 +6427,11 @@ bool CarlaPipeServerLV2::msgReceived(const char* const msg) noexcept
     if (std::strcmp(msg, "atom") == 0)
     {
         uint32_t index, size;
-        const char* base64atom;
+        const LV2_Atom* atom;
 
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(index), true);
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(size), true);
-        CARLA_SAFE_ASSERT_RETURN(readNextLineAsString(base64atom), true);
-
-        std::vector<uint8_t> chunk(carla_getChunkFromBase64String(base64atom));
-        delete[] base64atom;
-        CARLA_SAFE_ASSERT_RETURN(chunk.size() >= sizeof(LV2_Atom), true);
-
-#ifdef CARLA_PROPER_CPP11_SUPPORT
-        const LV2_Atom* const atom((const LV2_Atom*)chunk.data());
-#else
-        const LV2_Atom* const atom((const LV2_Atom*)&chunk.front());
-#endif
-        CARLA_SAFE_ASSERT_RETURN(lv2_atom_total_size(atom) == chunk.size(), true);
+        CARLA_SAFE_ASSERT_RETURN(readNextLv2Atom(size, atom), true);
 
         try {
             kPlugin->handleUIWrite(index, lv2_atom_total_size(atom), kUridAtomTransferEvent, atom);
@@ -6284,12 +6461,9 @@ bool CarlaPipeServerLV2::msgReceived(const char* const msg) noexcept
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(urid), true);
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsString(uri), true);
 
-        if (urid != 0)
-        {
-            try {
-                kPlugin->handleUridMap(urid, uri);
-            } CARLA_SAFE_EXCEPTION("msgReceived urid");
-        }
+        try {
+            kPlugin->handleUridMap(urid, uri);
+        } CARLA_SAFE_EXCEPTION("msgReceived urid");
 
         delete[] uri;
         return true;
@@ -1153,8 +1153,7 @@ public:
                 // Volume
                 if (doVolume)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] *= pData->postProc.volume;
+                    carla_multiply(outBuffer[i]+timeOffset, pData->postProc.volume, frames);
                 }
             }
 
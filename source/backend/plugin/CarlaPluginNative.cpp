@@ -1910,18 +1910,16 @@ public:
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float oldBufLeft[doBalance ? frames : 1];
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
                 // Dry/Wet
                 if (doDryWet)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        bufValue = fAudioInBuffers[(pData->audioIn.count == 1) ? 0 : i][k];
-                        fAudioOutBuffers[i][k] = (fAudioOutBuffers[i][k] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
+                    const uint32_t c = (pData->audioIn.count == 1) ? 0 : i;
+
+                    carla_mixFloats(fAudioOutBuffers[i], fAudioInBuffers[c], pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, frames);
                 }
 
                 // Balance
@@ -1938,27 +1936,23 @@ public:
                     float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
                     float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
 
-                    for (uint32_t k=0; k < frames; ++k)
+                    if (isPair)
                     {
-                        if (isPair)
-                        {
-                            // left
-                            fAudioOutBuffers[i][k]  = oldBufLeft[k]            * (1.0f - balRangeL);
-                            fAudioOutBuffers[i][k] += fAudioOutBuffers[i+1][k] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            fAudioOutBuffers[i][k]  = fAudioOutBuffers[i][k] * balRangeR;
-                            fAudioOutBuffers[i][k] += oldBufLeft[k]          * balRangeL;
-                        }
+                        // left
+                        carla_copyFloatsWithGain(fAudioOutBuffers[i], oldBufLeft, 1.0f - balRangeL, frames);
+                        carla_addFloatsWithGain(fAudioOutBuffers[i], fAudioOutBuffers[i+1], 1.0f - balRangeR, frames);
+                    }
+                    else
+                    {
+                        // right
+                        carla_multiply(fAudioOutBuffers[i], balRangeR, frames);
+                        carla_addFloatsWithGain(fAudioOutBuffers[i], oldBufLeft, balRangeL, frames);
                     }
                 }
 
                 // Volume (and buffer copy)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        audioOut[i][k+timeOffset] = fAudioOutBuffers[i][k] * pData->postProc.volume;
+                    carla_copyFloatsWithGain(audioOut[i]+timeOffset, fAudioOutBuffers[i], pData->postProc.volume, frames);
                 }
             }
 
@@ -1176,6 +1176,9 @@ public:
             uint32_t startTime  = 0;
             uint32_t timeOffset = 0;
 
+            if (isSampleAccurate && pData->event.portIn->getEventCount() > 0)
+                ++pData->blockSplit.cycles;
+
             for (uint32_t i=0, numEvents = pData->event.portIn->getEventCount(); i < numEvents; ++i)
             {
                 const EngineEvent& event(pData->event.portIn->getEvent(i));
@@ -1185,9 +1188,16 @@ public:
 
                 CARLA_ASSERT_INT2(event.time >= timeOffset, event.time, timeOffset);
 
+                // position of an event coalesced into the current sub-block, relative to its start
+                uint32_t coalescedTime = 0;
+
                 if (isSampleAccurate && event.time > timeOffset)
                 {
-                    if (processSingle(audioIn, audioOut, event.time - timeOffset, timeOffset))
+                    if (! pData->blockSplit.shouldSplit(event.time - timeOffset))
+                    {
+                        coalescedTime = event.time - timeOffset;
+                    }
+                    else if (processSingle(audioIn, audioOut, event.time - timeOffset, timeOffset))
                     {
                         startTime  = 0;
                         timeOffset = event.time;
@@ -1308,7 +1318,7 @@ public:
 
                             vstMidiEvent.type        = kVstMidiType;
                             vstMidiEvent.byteSize    = kVstMidiEventSize;
-                            vstMidiEvent.deltaFrames = static_cast<int32_t>(isSampleAccurate ? startTime : event.time);
+                            vstMidiEvent.deltaFrames = static_cast<int32_t>(isSampleAccurate ? startTime + coalescedTime : event.time);
                             vstMidiEvent.midiData[0] = char(MIDI_STATUS_CONTROL_CHANGE | (event.channel & MIDI_CHANNEL_BIT));
                             vstMidiEvent.midiData[1] = char(ctrlEvent.param);
                             vstMidiEvent.midiData[2] = char(ctrlEvent.value*127.0f);
@@ -1343,7 +1353,7 @@ public:
 
                             vstMidiEvent.type        = kVstMidiType;
                             vstMidiEvent.byteSize    = kVstMidiEventSize;
-                            vstMidiEvent.deltaFrames = static_cast<int32_t>(isSampleAccurate ? startTime : event.time);
+                            vstMidiEvent.deltaFrames = static_cast<int32_t>(isSampleAccurate ? startTime + coalescedTime : event.time);
                             vstMidiEvent.midiData[0] = char(MIDI_STATUS_CONTROL_CHANGE | (event.channel & MIDI_CHANNEL_BIT));
                             vstMidiEvent.midiData[1] = MIDI_CONTROL_ALL_SOUND_OFF;
                         }
@@ -1368,7 +1378,7 @@ public:
 
                             vstMidiEvent.type        = kVstMidiType;
                             vstMidiEvent.byteSize    = kVstMidiEventSize;
-                            vstMidiEvent.deltaFrames = static_cast<int32_t>(isSampleAccurate ? startTime : event.time);
+                            vstMidiEvent.deltaFrames = static_cast<int32_t>(isSampleAccurate ? startTime + coalescedTime : event.time);
                             vstMidiEvent.midiData[0] = char(MIDI_STATUS_CONTROL_CHANGE | (event.channel & MIDI_CHANNEL_BIT));
                             vstMidiEvent.midiData[1] = MIDI_CONTROL_ALL_NOTES_OFF;
                         }
@@ -1409,7 +1419,7 @@ public:
 
                     vstMidiEvent.type        = kVstMidiType;
                     vstMidiEvent.byteSize    = kVstMidiEventSize;
-                    vstMidiEvent.deltaFrames = static_cast<int32_t>(isSampleAccurate ? startTime : event.time);
+                    vstMidiEvent.deltaFrames = static_cast<int32_t>(isSampleAccurate ? startTime + coalescedTime : event.time);
                     vstMidiEvent.midiData[0] = char(status | (event.channel & MIDI_CHANNEL_BIT));
                     vstMidiEvent.midiData[1] = char(midiEvent.size >= 2 ? midiEvent.data[1] : 0);
                     vstMidiEvent.midiData[2] = char(midiEvent.size >= 3 ? midiEvent.data[2] : 0);
@@ -1551,18 +1561,16 @@ public:
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float oldBufLeft[doBalance ? frames : 1];
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
                 // Dry/Wet
                 if (doDryWet)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                    {
-                        bufValue = inBuffer[(pData->audioIn.count == 1) ? 0 : i][k+timeOffset];
-                        outBuffer[i][k+timeOffset] = (outBuffer[i][k+timeOffset] * pData->postProc.dryWet) + (bufValue * (1.0f - pData->postProc.dryWet));
-                    }
+                    const uint32_t c = (pData->audioIn.count == 1) ? 0 : i;
+
+                    carla_mixFloats(outBuffer[i]+timeOffset, inBuffer[c]+timeOffset, pData->postProc.dryWet, 1.0f - pData->postProc.dryWet, frames);
                 }
 
                 // Balance
@@ -1579,28 +1587,24 @@ public:
                     float balRangeL = (pData->postProc.balanceLeft  + 1.0f)/2.0f;
                     float balRangeR = (pData->postProc.balanceRight + 1.0f)/2.0f;
 
-                    for (uint32_t k=0; k < frames; ++k)
+                    if (isPair)
                     {
-                        if (isPair)
-                        {
-                            // left
-                            outBuffer[i][k+timeOffset]  = oldBufLeft[k]                * (1.0f - balRangeL);
-                            outBuffer[i][k+timeOffset] += outBuffer[i+1][k+timeOffset] * (1.0f - balRangeR);
-                        }
-                        else
-                        {
-                            // right
-                            outBuffer[i][k+timeOffset]  = outBuffer[i][k+timeOffset] * balRangeR;
-                            outBuffer[i][k+timeOffset] += oldBufLeft[k]              * balRangeL;
-                        }
+                        // left
+                        carla_copyFloatsWithGain(outBuffer[i]+timeOffset, oldBufLeft, 1.0f - balRangeL, frames);
+                        carla_addFloatsWithGain(outBuffer[i]+timeOffset, outBuffer[i+1]+timeOffset, 1.0f - balRangeR, frames);
+                    }
+                    else
+                    {
+                        // right
+                        carla_multiply(outBuffer[i]+timeOffset, balRangeR, frames);
+                        carla_addFloatsWithGain(outBuffer[i]+timeOffset, oldBufLeft, balRangeL, frames);
                     }
                 }
 
                 // Volume
                 if (doVolume)
                 {
-                    for (uint32_t k=0; k < frames; ++k)
-                        outBuffer[i][k+timeOffset] *= pData->postProc.volume;
+                    carla_multiply(outBuffer[i]+timeOffset, pData->postProc.volume, frames);
                 }
             }
 
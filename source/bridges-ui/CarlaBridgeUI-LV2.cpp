@@ -17,14 +17,16 @@
 
 #include "CarlaBridgeUI.hpp"
 #include "CarlaLibUtils.hpp"
+#include "CarlaLv2CacheUtils.hpp"
 #include "CarlaLv2Utils.hpp"
 #include "CarlaMIDI.h"
 #include "LinkedList.hpp"
+#include "Lv2UridMap.hpp"
+
+#include "../modules/lilv/config/lilv_config.h"
 
 #include "water/files/File.h"
 
-#include <string>
-#include <vector>
 
 #define URI_CARLA_ATOM_WORKER "http://kxstudio.sf.net/ns/carla/atomWorker"
 
@@ -87,6 +89,10 @@ const uint32_t CARLA_URI_MAP_ID_CARLA_ATOM_WORKER      = 46;
 const uint32_t CARLA_URI_MAP_ID_CARLA_TRANSIENT_WIN_ID = 47;
 const uint32_t CARLA_URI_MAP_ID_COUNT                  = 48;
 
+// URIDs are assigned by the host, the UI only hands out ids by itself when the host cannot be asked.
+// Those start here, far away from the host ids.
+const uint32_t CARLA_URI_MAP_ID_UI_LOCAL               = 0x40000000;
+
 // LV2 Feature Ids
 enum CarlaLv2Features {
     // DSP features
@@ -180,11 +186,10 @@ public:
           fRdfUiDescriptor(nullptr),
           fLv2Options(),
           fUiOptions(),
-          fCustomURIDs(CARLA_URI_MAP_ID_COUNT, std::string("urn:null")),
+          fCustomURIDs(CARLA_URI_MAP_ID_COUNT),
+          fLocalURIDs(CARLA_URI_MAP_ID_UI_LOCAL),
           fExt()
     {
-        CARLA_SAFE_ASSERT(fCustomURIDs.size() == CARLA_URI_MAP_ID_COUNT);
-
         carla_zeroPointers(fFeatures, kFeatureCount+1);
 
         // ---------------------------------------------------------------
@@ -337,7 +342,10 @@ public:
         // load plugin
 
         Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
-        lv2World.initIfNeeded(std::getenv("LV2_PATH"));
+
+        const char* LV2_PATH = std::getenv("LV2_PATH");
+        if (LV2_PATH == nullptr)
+            LV2_PATH = LILV_DEFAULT_LV2_PATH;
 
         //Lilv::Node bundleNode(lv2World.new_file_uri(nullptr, uiBundle));
         //CARLA_SAFE_ASSERT_RETURN(bundleNode.is_uri(), false);
@@ -350,9 +358,24 @@ public:
         //lv2World.load_bundle(sBundle);
 
         // -----------------------------------------------------------------
-        // get plugin from lv2_rdf (lilv)
+        // get plugin from the metadata cache, or lv2_rdf (lilv) if not there
+
+        Lv2MetadataCache& lv2Cache(Lv2MetadataCache::getInstance());
+
+        if (lv2Cache.load())
+        {
+            const Lv2CachePluginInfo* const cacheInfo(lv2Cache.getPluginFromURI(pluginURI));
+
+            if (cacheInfo != nullptr && lv2Cache.isPluginUpToDate(cacheInfo))
+                fRdfDescriptor = lv2Cache.createDescriptor(cacheInfo);
+        }
+
+        if (fRdfDescriptor == nullptr)
+        {
+            lv2World.initIfNeeded(LV2_PATH);
+            fRdfDescriptor = lv2_rdf_new(pluginURI, true);
+        }
 
-        fRdfDescriptor = lv2_rdf_new(pluginURI, true);
         CARLA_SAFE_ASSERT_RETURN(fRdfDescriptor != nullptr, false);
 
         // -----------------------------------------------------------------
@@ -476,6 +499,8 @@ public:
 
     void idleUI() override
     {
+        dispatchPendingMessages();
+
 #if defined(BRIDGE_COCOA) || defined(BRIDGE_HWND) || defined(BRIDGE_X11)
         if (fHandle != nullptr && fExt.idle != nullptr)
             fExt.idle->idle(fHandle);
@@ -559,10 +584,11 @@ public:
 
     void dspURIDReceived(const LV2_URID urid, const char* const uri) override
     {
-        CARLA_SAFE_ASSERT_RETURN(urid == fCustomURIDs.size(),);
+        CARLA_SAFE_ASSERT_RETURN(urid >= CARLA_URI_MAP_ID_COUNT && urid < CARLA_URI_MAP_ID_UI_LOCAL,);
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0',);
 
-        fCustomURIDs.push_back(uri);
+        if (! fCustomURIDs.insert(urid, uri))
+            carla_stderr2("UI :: wrong URI '%s' for URID %u", uri, urid);
     }
 
     void uiOptionsChanged(const double sampleRate, const bool useTheme, const bool useThemeColors, const char* const windowTitle, uintptr_t transientWindowId) override
@@ -594,36 +620,66 @@ public:
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', CARLA_URI_MAP_ID_NULL);
         carla_debug("CarlaLv2Client::getCustomURID(\"%s\")", uri);
 
-        const std::string    s_uri(uri);
-        const std::ptrdiff_t s_pos(std::find(fCustomURIDs.begin(), fCustomURIDs.end(), s_uri) - fCustomURIDs.begin());
+        if (const LV2_URID urid = fCustomURIDs.find(uri))
+            return urid;
+        if (const LV2_URID urid = fLocalURIDs.find(uri))
+            return urid;
+
+        if (isPipeRunning())
+        {
+            // messages can't be read while handling one, the current one might still be in use
+            if (isPipeReading())
+            {
+                carla_stderr2("UI :: URI '%s' mapped while handling a host message, the host will not know its URID", uri);
+            }
+            else
+            {
+                // ask the host, it owns the URIDs and replies with a regular urid message
+                {
+                    const CarlaMutexLocker cml(getPipeLock());
+
+                    writeMessage("urid\n0\n", 7);
+                    writeAndFixMessage(uri);
+                    flushMessages();
+                }
 
-        if (s_pos <= 0 || s_pos >= INT32_MAX)
-            return CARLA_URI_MAP_ID_NULL;
+                // we are inside the UI's own map call, other host messages must wait until it returns
+                LV2_URID urid = CARLA_URI_MAP_ID_NULL;
+                fIsWaitingForHost = true;
 
-        const LV2_URID urid     = static_cast<LV2_URID>(s_pos);
-        const LV2_URID uriCount = static_cast<LV2_URID>(fCustomURIDs.size());
+                for (uint i=0; i < 200; ++i)
+                {
+                    idlePipe();
 
-        if (urid < uriCount)
-            return urid;
+                    if ((urid = fCustomURIDs.find(uri)) != CARLA_URI_MAP_ID_NULL)
+                        break;
 
-        CARLA_SAFE_ASSERT(urid == uriCount);
+                    carla_msleep(5);
+                }
 
-        fCustomURIDs.push_back(uri);
+                fIsWaitingForHost = false;
 
-        if (isPipeRunning())
-            writeLv2UridMessage(urid, uri);
+                // queued messages are delivered on the next idle
+                if (urid != CARLA_URI_MAP_ID_NULL)
+                    return urid;
 
-        return urid;
+                carla_stderr2("UI :: host did not map URI '%s' on time", uri);
+            }
+        }
+
+        return fLocalURIDs.map(uri);
     }
 
     const char* getCustomURIDString(const LV2_URID urid) const noexcept
     {
         static const char* const sFallback = "urn:null";
         CARLA_SAFE_ASSERT_RETURN(urid != CARLA_URI_MAP_ID_NULL, sFallback);
-        CARLA_SAFE_ASSERT_RETURN(urid < fCustomURIDs.size(), sFallback);
         carla_debug("CarlaLv2Client::getCustomURIDString(%i)", urid);
 
-        return fCustomURIDs[urid].c_str();
+        const char* const uri(urid >= CARLA_URI_MAP_ID_UI_LOCAL ? fLocalURIDs.unmap(urid) : fCustomURIDs.unmap(urid));
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr, sFallback);
+
+        return uri;
     }
 
     // ---------------------------------------------------------------------
@@ -710,7 +766,8 @@ private:
     Lv2PluginOptions          fLv2Options;
 
     Options fUiOptions;
-    std::vector<std::string> fCustomURIDs;
+    Lv2UridMap fCustomURIDs;
+    Lv2UridMap fLocalURIDs;
 
     struct Extensions {
         const LV2_Options_Interface* options;
@@ -18,8 +18,6 @@
 #include "CarlaBridgeUI.hpp"
 #include "CarlaMIDI.h"
 
-#include "CarlaBase64Utils.hpp"
-
 #ifdef CARLA_OS_LINUX
 # include <signal.h>
 # include <sys/prctl.h>
@@ -44,7 +42,9 @@ CarlaBridgeUI::CarlaBridgeUI() noexcept
       fLastMsgTimer(-1),
       fToolkit(nullptr),
       fLib(nullptr),
-      fLibFilename()
+      fLibFilename(),
+      fIsWaitingForHost(false),
+      fPendingMessages()
 {
     carla_debug("CarlaBridgeUI::CarlaBridgeUI()");
 
@@ -57,6 +57,8 @@ CarlaBridgeUI::~CarlaBridgeUI() /*noexcept*/
 {
     carla_debug("CarlaBridgeUI::~CarlaBridgeUI()");
 
+    _clearPendingMessages();
+
     if (fLib != nullptr)
     {
         lib_close(fLib);
@@ -134,6 +136,17 @@ bool CarlaBridgeUI::msgReceived(const char* const msg) noexcept
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(index), true);
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsFloat(value), true);
 
+        if (_shouldQueueMessages())
+        {
+            PendingMessage pending;
+            carla_zeroStruct(pending);
+            pending.type  = PendingMessage::kControl;
+            pending.index = index;
+            pending.value = value;
+            _queueMessage(pending);
+            return true;
+        }
+
         dspParameterChanged(index, value);
         return true;
     }
@@ -144,6 +157,16 @@ bool CarlaBridgeUI::msgReceived(const char* const msg) noexcept
 
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(index), true);
 
+        if (_shouldQueueMessages())
+        {
+            PendingMessage pending;
+            carla_zeroStruct(pending);
+            pending.type  = PendingMessage::kProgram;
+            pending.index = index;
+            _queueMessage(pending);
+            return true;
+        }
+
         dspProgramChanged(index);
         return true;
     }
@@ -155,6 +178,17 @@ bool CarlaBridgeUI::msgReceived(const char* const msg) noexcept
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(bank), true);
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(program), true);
 
+        if (_shouldQueueMessages())
+        {
+            PendingMessage pending;
+            carla_zeroStruct(pending);
+            pending.type    = PendingMessage::kMidiProgram;
+            pending.index   = bank;
+            pending.program = program;
+            _queueMessage(pending);
+            return true;
+        }
+
         dspMidiProgramChanged(bank, program);
         return true;
     }
@@ -167,6 +201,18 @@ bool CarlaBridgeUI::msgReceived(const char* const msg) noexcept
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsString(key), true);
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsString(value), true);
 
+        if (_shouldQueueMessages())
+        {
+            // the queue takes ownership of the strings
+            PendingMessage pending;
+            carla_zeroStruct(pending);
+            pending.type   = PendingMessage::kConfigure;
+            pending.key    = key;
+            pending.string = value;
+            _queueMessage(pending);
+            return true;
+        }
+
         dspStateChanged(key, value);
 
         delete[] key;
@@ -184,6 +230,19 @@ bool CarlaBridgeUI::msgReceived(const char* const msg) noexcept
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsByte(note), true);
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsByte(velocity), true);
 
+        if (_shouldQueueMessages())
+        {
+            PendingMessage pending;
+            carla_zeroStruct(pending);
+            pending.type     = PendingMessage::kNote;
+            pending.onOff    = onOff;
+            pending.channel  = channel;
+            pending.note     = note;
+            pending.velocity = velocity;
+            _queueMessage(pending);
+            return true;
+        }
+
         dspNoteReceived(onOff, channel, note, velocity);
         return true;
     }
@@ -191,25 +250,32 @@ bool CarlaBridgeUI::msgReceived(const char* const msg) noexcept
     if (std::strcmp(msg, "atom") == 0)
     {
         uint32_t index, atomTotalSize;
-        const char* base64atom;
+        const LV2_Atom* atom;
 
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(index), true);
         CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(atomTotalSize), true);
-        CARLA_SAFE_ASSERT_RETURN(readNextLineAsString(base64atom), true);
-
-        std::vector<uint8_t> chunk(carla_getChunkFromBase64String(base64atom));
-        delete[] base64atom;
-        CARLA_SAFE_ASSERT_RETURN(chunk.size() >= sizeof(LV2_Atom), true);
-
-#ifdef CARLA_PROPER_CPP11_SUPPORT
-        const LV2_Atom* const atom((const LV2_Atom*)chunk.data());
-#else
-        const LV2_Atom* const atom((const LV2_Atom*)&chunk.front());
-#endif
-        const uint32_t atomTotalSizeCheck(lv2_atom_total_size(atom));
+        CARLA_SAFE_ASSERT_RETURN(readNextLv2Atom(atomTotalSize, atom), true);
 
-        CARLA_SAFE_ASSERT_RETURN(atomTotalSizeCheck == atomTotalSize, true);
-        CARLA_SAFE_ASSERT_RETURN(atomTotalSizeCheck == chunk.size(), true);
+        if (_shouldQueueMessages())
+        {
+            // the atom lives in the pipe buffer, which is reused by the next message
+            const uint32_t size = lv2_atom_total_size(atom);
+            uint8_t* atomCopy;
+
+            try {
+                atomCopy = new uint8_t[size];
+            } CARLA_SAFE_EXCEPTION_RETURN("CarlaBridgeUI::msgReceived atom", true);
+
+            std::memcpy(atomCopy, atom, size);
+
+            PendingMessage pending;
+            carla_zeroStruct(pending);
+            pending.type  = PendingMessage::kAtom;
+            pending.index = index;
+            pending.atom  = (LV2_Atom*)atomCopy;
+            _queueMessage(pending);
+            return true;
+        }
 
         dspAtomReceived(index, atom);
         return true;
@@ -252,6 +318,37 @@ bool CarlaBridgeUI::msgReceived(const char* const msg) noexcept
 
     CARLA_SAFE_ASSERT_RETURN(fToolkit != nullptr, true);
 
+    if (_shouldQueueMessages())
+    {
+        /**/ if (std::strcmp(msg, "show") == 0)
+            _queueMessage(PendingMessage::kShow);
+        else if (std::strcmp(msg, "focus") == 0)
+            _queueMessage(PendingMessage::kFocus);
+        else if (std::strcmp(msg, "hide") == 0)
+            _queueMessage(PendingMessage::kHide);
+        else if (std::strcmp(msg, "quit") == 0)
+            _queueMessage(PendingMessage::kQuit);
+        else if (std::strcmp(msg, "uiTitle") == 0)
+        {
+            const char* title;
+
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsString(title), true);
+
+            PendingMessage pending;
+            carla_zeroStruct(pending);
+            pending.type   = PendingMessage::kTitle;
+            pending.string = title;
+            _queueMessage(pending);
+        }
+        else
+        {
+            carla_stderr("CarlaBridgeUI::msgReceived : %s", msg);
+            return false;
+        }
+
+        return true;
+    }
+
     if (std::strcmp(msg, "show") == 0)
     {
         fToolkit->show();
@@ -297,6 +394,112 @@ bool CarlaBridgeUI::msgReceived(const char* const msg) noexcept
 
 // ---------------------------------------------------------------------
 
+void CarlaBridgeUI::dispatchPendingMessages() noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(! fIsWaitingForHost,);
+
+    PendingMessage fallback;
+    carla_zeroStruct(fallback);
+    fallback.type = PendingMessage::kShow;
+
+    for (; ! fPendingMessages.isEmpty();)
+    {
+        const PendingMessage pending(fPendingMessages.getFirst(fallback, true));
+
+        try {
+            switch (pending.type)
+            {
+            case PendingMessage::kControl:
+                dspParameterChanged(pending.index, pending.value);
+                break;
+            case PendingMessage::kProgram:
+                dspProgramChanged(pending.index);
+                break;
+            case PendingMessage::kMidiProgram:
+                dspMidiProgramChanged(pending.index, pending.program);
+                break;
+            case PendingMessage::kConfigure:
+                dspStateChanged(pending.key, pending.string);
+                break;
+            case PendingMessage::kNote:
+                dspNoteReceived(pending.onOff, pending.channel, pending.note, pending.velocity);
+                break;
+            case PendingMessage::kAtom:
+                dspAtomReceived(pending.index, pending.atom);
+                break;
+            case PendingMessage::kShow:
+                if (fToolkit != nullptr)
+                    fToolkit->show();
+                break;
+            case PendingMessage::kFocus:
+                if (fToolkit != nullptr)
+                    fToolkit->focus();
+                break;
+            case PendingMessage::kHide:
+                if (fToolkit != nullptr)
+                    fToolkit->hide();
+                break;
+            case PendingMessage::kQuit:
+                fQuitReceived = true;
+                if (fToolkit != nullptr)
+                {
+                    fToolkit->quit();
+                    delete fToolkit;
+                    fToolkit = nullptr;
+                }
+                break;
+            case PendingMessage::kTitle:
+                if (fToolkit != nullptr)
+                    fToolkit->setTitle(pending.string);
+                break;
+            }
+        } CARLA_SAFE_EXCEPTION("CarlaBridgeUI::dispatchPendingMessages");
+
+        delete[] pending.key;
+        delete[] pending.string;
+        delete[] (uint8_t*)pending.atom;
+    }
+}
+
+void CarlaBridgeUI::_queueMessage(const PendingMessage::Type type) noexcept
+{
+    PendingMessage pending;
+    carla_zeroStruct(pending);
+    pending.type = type;
+    _queueMessage(pending);
+}
+
+void CarlaBridgeUI::_queueMessage(const PendingMessage& pending) noexcept
+{
+    if (fPendingMessages.append(pending))
+        return;
+
+    carla_stderr2("CarlaBridgeUI: failed to queue a message received while waiting for the host");
+
+    delete[] pending.key;
+    delete[] pending.string;
+    delete[] (uint8_t*)pending.atom;
+}
+
+void CarlaBridgeUI::_clearPendingMessages() noexcept
+{
+    PendingMessage fallback;
+    carla_zeroStruct(fallback);
+
+    for (LinkedList<PendingMessage>::Itenerator it = fPendingMessages.begin2(); it.valid(); it.next())
+    {
+        const PendingMessage& pending(it.getValue(fallback));
+
+        delete[] pending.key;
+        delete[] pending.string;
+        delete[] (uint8_t*)pending.atom;
+    }
+
+    fPendingMessages.clear();
+}
+
+// ---------------------------------------------------------------------
+
 bool CarlaBridgeUI::init(const int argc, const char* argv[])
 {
     CARLA_SAFE_ASSERT_RETURN(fToolkit != nullptr, false);
@@ -22,6 +22,7 @@
 #include "CarlaLibUtils.hpp"
 #include "CarlaPipeUtils.hpp"
 #include "CarlaString.hpp"
+#include "LinkedList.hpp"
 
 #include "lv2/atom.h"
 #include "lv2/urid.h"
@@ -150,9 +151,58 @@ protected:
     lib_t fLib;
     CarlaString fLibFilename;
 
+    /*!
+     * Set while the UI is blocked waiting for a reply from the host.
+     * Only "urid" and "uiOptions" messages are handled right away, the others are queued
+     * so that the UI is not re-entered, and delivered by dispatchPendingMessages().
+     * Messages keep being queued after that until the queue has been delivered, to keep their order.
+     */
+    bool fIsWaitingForHost;
+
+    /*!
+     * Deliver messages queued while fIsWaitingForHost was set.
+     */
+    void dispatchPendingMessages() noexcept;
+
     /*! @internal */
     bool msgReceived(const char* const msg) noexcept override;
 
+private:
+    struct PendingMessage {
+        enum Type {
+            kControl,
+            kProgram,
+            kMidiProgram,
+            kConfigure,
+            kNote,
+            kAtom,
+            kShow,
+            kFocus,
+            kHide,
+            kQuit,
+            kTitle
+        } type;
+        uint32_t index;
+        uint32_t program;
+        float    value;
+        bool     onOff;
+        uint8_t  channel, note, velocity;
+        const char* key;    // owned
+        const char* string; // owned
+        LV2_Atom* atom;     // owned
+    };
+
+    LinkedList<PendingMessage> fPendingMessages;
+
+    bool _shouldQueueMessages() const noexcept
+    {
+        return fIsWaitingForHost || ! fPendingMessages.isEmpty();
+    }
+
+    void _queueMessage(const PendingMessage::Type type) noexcept;
+    void _queueMessage(const PendingMessage& msg) noexcept;
+    void _clearPendingMessages() noexcept;
+
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaBridgeUI)
 };
 
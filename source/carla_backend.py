@@ -258,6 +258,10 @@ PLUGIN_OPTION_SEND_ALL_SOUND_OFF = 0x100
 # @note: This option conflicts with PLUGIN_OPTION_MAP_PROGRAM_CHANGES and cannot be used at the same time.
 PLUGIN_OPTION_SEND_PROGRAM_CHANGES = 0x200
 
+# Run one block behind the engine, in parallel with the rest of the audio cycle.
+# Adds one block of latency. Only available for plugin bridges.
+PLUGIN_OPTION_PIPELINED = 0x400
+
 # ------------------------------------------------------------------------------------------------------------
 # Parameter Hints
 # Various parameter hints.
@@ -704,6 +708,12 @@ ENGINE_CALLBACK_ERROR = 39
 # The engine has crashed or malfunctioned and will no longer work.
 ENGINE_CALLBACK_QUIT = 40
 
+# Engine process statistics, sent once per second while ENGINE_OPTION_PROCESS_STATS is enabled.
+# @a value1 Number of xruns
+# @a value2 Number of cycles that took longer than the buffer period
+# @a value3 DSP load, in percent
+ENGINE_CALLBACK_PROCESS_STATS = 41
+
 # ------------------------------------------------------------------------------------------------------------
 # Engine Option
 # Engine options.
@@ -808,6 +818,49 @@ ENGINE_OPTION_WINE_SERVER_RT_PRIO = 23
 # Capture console output into debug callbacks
 ENGINE_OPTION_DEBUG_CONSOLE_OUTPUT = 24
 
+# Number of extra realtime threads used to process independent plugins in parallel.
+# Used in patchbay mode, and in rack mode together with ENGINE_OPTION_RACK_LANES.
+# Takes effect when the engine is (re)started.
+# Values above the number of CPU cores minus one are clamped to it.
+# Default is 0, meaning everything is processed serially in the audio thread.
+ENGINE_OPTION_AUDIO_WORKER_THREADS = 25
+
+# Split the rack into independent lanes that are processed in parallel and summed at the end.
+# valueStr is a comma-separated list of rack slots where each lane starts, for example "0,4,8".
+# Every lane receives the rack audio and MIDI input, and plugins within a lane run in series.
+# While any plugin has more than one MIDI/event input or output port the whole rack is processed serially.
+# Only used in rack mode, takes effect when the engine is (re)started.
+# Default is empty, meaning the whole rack is a single serial chain.
+ENGINE_OPTION_RACK_LANES = 26
+
+# Maximum time in microseconds the engine busy-waits for a plugin bridge before sleeping.
+# The actual spin time adapts to how long each bridge usually takes to process.
+# Only affects bridges loaded after the change.
+# Default is 0, meaning the engine always sleeps while waiting for bridges.
+ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME = 27
+
+# Maximum time in milliseconds between engine idle passes over all plugins.
+# Plugins with pending realtime events are handled right away, regardless of this value.
+# Output parameters, peaks and plugins that need polling are only refreshed at this interval.
+# Default is 25.
+ENGINE_OPTION_IDLE_MAX_INTERVAL = 28
+
+# Number of threads used to create plugins and restore their state when loading a project.
+# Plugins that need the main thread (native VST2, internal, LinuxSampler and JACK applications) are always loaded there.
+# Only used in rack and patchbay modes, other modes always load plugins one at a time.
+# Default is 1, loading plugins one at a time. Set to 0 to use one thread per CPU core.
+ENGINE_OPTION_PROJECT_LOAD_THREADS = 29
+
+# Store plugin chunks as raw binary in a side-car file when saving a project, instead of base64 inside the xml.
+# The side-car file is the project filename plus ".chunks", and must be kept next to the project.
+# Default is false.
+ENGINE_OPTION_PROJECT_CHUNK_FILES = 30
+
+# Measure the engine DSP load, xruns and the time each plugin takes to process.
+# Adds two clock reads per plugin per cycle while enabled.
+# Default is false.
+ENGINE_OPTION_PROCESS_STATS = 31
+
 # ------------------------------------------------------------------------------------------------------------
 # Engine Process Mode
 # Engine process mode.
@@ -1162,6 +1215,77 @@ class CarlaTransportInfo(Structure):
         ("bpm", c_double)
     ]
 
+# Runtime engine information.
+# Only updated while ENGINE_OPTION_PROCESS_STATS is enabled.
+# @see carla_get_runtime_engine_info()
+class CarlaRuntimeEngineInfo(Structure):
+    _fields_ = [
+        # DSP load, in percent.
+        ("load", c_float),
+
+        # Number of xruns reported by the audio driver.
+        ("xruns", c_uint32),
+
+        # Number of cycles that took longer than the buffer period.
+        ("overruns", c_uint32)
+    ]
+
+# Plugin process time statistics, all times are in microseconds.
+# Only updated while ENGINE_OPTION_PROCESS_STATS is enabled.
+# @see carla_get_plugin_process_stats()
+class CarlaPluginProcessStats(Structure):
+    _fields_ = [
+        # Number of measured process calls.
+        ("count", c_uint32),
+
+        # Minimum, average and maximum process time.
+        ("minTime", c_float),
+        ("avgTime", c_float),
+        ("maxTime", c_float),
+
+        # Process time percentiles (50th, 90th and 99th).
+        ("p50Time", c_float),
+        ("p90Time", c_float),
+        ("p99Time", c_float)
+    ]
+
+# Plugin sample-accurate block splitting stats.
+# @see carla_get_plugin_block_split_stats()
+class CarlaPluginBlockSplitStats(Structure):
+    _fields_ = [
+        # Current minimum number of frames between splits.
+        ("minimumFrames", c_uint32),
+
+        # Number of processed blocks that received events.
+        ("cycles", c_uint64),
+
+        # Number of extra sub-blocks created for events.
+        ("splits", c_uint64),
+
+        # Number of events merged into a previous sub-block instead of splitting.
+        ("coalesced", c_uint64)
+    ]
+
+# Plugin worker stats, only used by LV2 plugins with the worker extension.
+# All times are in microseconds.
+# @see carla_get_plugin_worker_stats()
+class CarlaPluginWorkerStats(Structure):
+    _fields_ = [
+        # Number of work requests run so far.
+        ("requests", c_uint32),
+
+        # Average and maximum time between a request being scheduled and the worker running it.
+        ("requestAvgTime", c_uint64),
+        ("requestMaxTime", c_uint64),
+
+        # Number of worker responses delivered so far.
+        ("responses", c_uint32),
+
+        # Average and maximum time between a response and the plugin receiving it.
+        ("responseAvgTime", c_uint64),
+        ("responseMaxTime", c_uint64)
+    ]
+
 # Image data for LV2 inline display API.
 # raw image pixmap format is ARGB32,
 class CarlaInlineDisplayImageSurface(Structure):
@@ -1221,6 +1345,42 @@ PyCarlaTransportInfo = {
     "bpm": 0.0
 }
 
+# @see CarlaRuntimeEngineInfo
+PyCarlaRuntimeEngineInfo = {
+    "load": 0.0,
+    "xruns": 0,
+    "overruns": 0
+}
+
+# @see CarlaPluginProcessStats
+PyCarlaPluginProcessStats = {
+    "count": 0,
+    "minTime": 0.0,
+    "avgTime": 0.0,
+    "maxTime": 0.0,
+    "p50Time": 0.0,
+    "p90Time": 0.0,
+    "p99Time": 0.0
+}
+
+# @see CarlaPluginBlockSplitStats
+PyCarlaPluginBlockSplitStats = {
+    "minimumFrames": 0,
+    "cycles": 0,
+    "splits": 0,
+    "coalesced": 0
+}
+
+# @see CarlaPluginWorkerStats
+PyCarlaPluginWorkerStats = {
+    "requests": 0,
+    "requestAvgTime": 0,
+    "requestMaxTime": 0,
+    "responses": 0,
+    "responseAvgTime": 0,
+    "responseMaxTime": 0
+}
+
 # ------------------------------------------------------------------------------------------------------------
 # Set BINARY_NATIVE
 
@@ -1251,6 +1411,13 @@ class CarlaHostMeta(object):
 
 
         # settings
+        self.audioWorkerThreads  = 0
+        self.rackLanes           = ""
+        self.bridgesSpinTime     = 0
+        self.idleMaxInterval     = 25
+        self.projectLoadThreads  = 1
+        self.projectChunkFiles   = False
+        self.processStats        = False
         self.experimental        = False
         self.exportLV2           = False
         self.forceStereo         = False
@@ -1419,6 +1586,25 @@ class CarlaHostMeta(object):
     def get_transport_info(self):
         raise NotImplementedError
 
+    # Get the engine DSP load and xrun counts.
+    @abstractmethod
+    def get_runtime_engine_info(self):
+        raise NotImplementedError
+
+    # Reset the xrun counts and all process time statistics, including the ones of each plugin.
+    @abstractmethod
+    def clear_process_stats(self):
+        raise NotImplementedError
+
+    # Render the current project into an audio file, as fast as possible.
+    # Starts from frame 0 and renders 'frames' of audio, the file format is taken from the extension (WAV or FLAC).
+    # Requires the engine to be running with the "Offline" driver.
+    # @param filename Filename
+    # @param frames   Number of frames to render
+    @abstractmethod
+    def render_to_file(self, filename, frames):
+        raise NotImplementedError
+
     # Current number of plugins loaded.
     @abstractmethod
     def get_current_plugin_count(self):
@@ -1484,6 +1670,19 @@ class CarlaHostMeta(object):
     def switch_plugins(self, pluginIdA, pluginIdB):
         raise NotImplementedError
 
+    # Start a plugin transaction.
+    # Until commit_plugin_transaction() is called, add_plugin(), remove_plugin(), remove_all_plugins() and
+    # switch_plugins() only change a pending plugin list, and plugin ids given to them refer to that list.
+    # Plugins cannot be cloned, replaced or renamed while a transaction is in progress.
+    @abstractmethod
+    def begin_plugin_transaction(self):
+        raise NotImplementedError
+
+    # Apply all plugin changes made since begin_plugin_transaction() at once.
+    @abstractmethod
+    def commit_plugin_transaction(self):
+        raise NotImplementedError
+
     # Load a plugin state.
     # @param pluginId Plugin
     # @param filename Path to plugin state
@@ -1692,6 +1891,35 @@ class CarlaHostMeta(object):
     def get_output_peak_value(self, pluginId, isLeft):
         raise NotImplementedError
 
+    # Get a bridged plugin's processing round trip time, in milliseconds.
+    # Returns 0 for non-bridged plugins.
+    # @param pluginId Plugin
+    # @param maximum  Get the maximum time seen so far, otherwise the running average.
+    @abstractmethod
+    def get_plugin_round_trip_time(self, pluginId, maximum):
+        raise NotImplementedError
+
+    # Get a plugin's process time statistics.
+    # Bridged plugins are measured on the host side, so the time includes the round trip.
+    # @param pluginId Plugin
+    @abstractmethod
+    def get_plugin_process_stats(self, pluginId):
+        raise NotImplementedError
+
+    # Get a plugin's sample-accurate block splitting stats.
+    # Counters restart when the minimum split size changes.
+    # @param pluginId Plugin
+    @abstractmethod
+    def get_plugin_block_split_stats(self, pluginId):
+        raise NotImplementedError
+
+    # Get a plugin's worker stats.
+    # Everything is 0 for plugins that do not use a worker.
+    # @param pluginId Plugin
+    @abstractmethod
+    def get_plugin_worker_stats(self, pluginId):
+        raise NotImplementedError
+
     # Render a plugin's inline display.
     # @param pluginId Plugin
     @abstractmethod
@@ -1755,6 +1983,16 @@ class CarlaHostMeta(object):
     def set_ctrl_channel(self, pluginId, channel):
         raise NotImplementedError
 
+    # Change the minimum number of frames between a plugin's sample-accurate block splits.
+    # Control events arriving sooner are applied at the start of the current sub-block, MIDI events keep their exact time.
+    # The default of 0 splits the block at every new event time.
+    # Bridged plugins do not support this and always keep 0.
+    # @param pluginId Plugin
+    # @param frames   Minimum number of frames
+    @abstractmethod
+    def set_plugin_minimum_split_frames(self, pluginId, frames):
+        raise NotImplementedError
+
     # Change a plugin's parameter value.
     # @param pluginId    Plugin
     # @param parameterId Parameter index
@@ -1961,6 +2199,15 @@ class CarlaHostNull(CarlaHostMeta):
     def get_transport_info(self):
         return PyCarlaTransportInfo
 
+    def get_runtime_engine_info(self):
+        return PyCarlaRuntimeEngineInfo
+
+    def clear_process_stats(self):
+        return
+
+    def render_to_file(self, filename, frames):
+        return False
+
     def get_current_plugin_count(self):
         return 0
 
@@ -1988,6 +2235,12 @@ class CarlaHostNull(CarlaHostMeta):
     def switch_plugins(self, pluginIdA, pluginIdB):
         return False
 
+    def begin_plugin_transaction(self):
+        return False
+
+    def commit_plugin_transaction(self):
+        return False
+
     def load_plugin_state(self, pluginId, filename):
         return False
 
@@ -2075,6 +2328,18 @@ class CarlaHostNull(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return 0.0
 
+    def get_plugin_round_trip_time(self, pluginId, maximum):
+        return 0.0
+
+    def get_plugin_process_stats(self, pluginId):
+        return PyCarlaPluginProcessStats
+
+    def get_plugin_block_split_stats(self, pluginId):
+        return PyCarlaPluginBlockSplitStats
+
+    def get_plugin_worker_stats(self, pluginId):
+        return PyCarlaPluginWorkerStats
+
     def render_inline_display(self, pluginId, width, height):
         return None
 
@@ -2102,6 +2367,9 @@ class CarlaHostNull(CarlaHostMeta):
     def set_ctrl_channel(self, pluginId, channel):
         return
 
+    def set_plugin_minimum_split_frames(self, pluginId, frames):
+        return
+
     def set_parameter_value(self, pluginId, parameterId, value):
         return
 
@@ -2243,6 +2511,15 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_get_transport_info.argtypes = None
         self.lib.carla_get_transport_info.restype = POINTER(CarlaTransportInfo)
 
+        self.lib.carla_get_runtime_engine_info.argtypes = None
+        self.lib.carla_get_runtime_engine_info.restype = POINTER(CarlaRuntimeEngineInfo)
+
+        self.lib.carla_clear_process_stats.argtypes = None
+        self.lib.carla_clear_process_stats.restype = None
+
+        self.lib.carla_render_to_file.argtypes = [c_char_p, c_uint64]
+        self.lib.carla_render_to_file.restype = c_bool
+
         self.lib.carla_get_current_plugin_count.argtypes = None
         self.lib.carla_get_current_plugin_count.restype = c_uint32
 
@@ -2270,6 +2547,12 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_switch_plugins.argtypes = [c_uint, c_uint]
         self.lib.carla_switch_plugins.restype = c_bool
 
+        self.lib.carla_begin_plugin_transaction.argtypes = None
+        self.lib.carla_begin_plugin_transaction.restype = c_bool
+
+        self.lib.carla_commit_plugin_transaction.argtypes = None
+        self.lib.carla_commit_plugin_transaction.restype = c_bool
+
         self.lib.carla_load_plugin_state.argtypes = [c_uint, c_char_p]
         self.lib.carla_load_plugin_state.restype = c_bool
 
@@ -2357,6 +2640,18 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_get_output_peak_value.argtypes = [c_uint, c_bool]
         self.lib.carla_get_output_peak_value.restype = c_float
 
+        self.lib.carla_get_plugin_round_trip_time.argtypes = [c_uint, c_bool]
+        self.lib.carla_get_plugin_round_trip_time.restype = c_float
+
+        self.lib.carla_get_plugin_process_stats.argtypes = [c_uint]
+        self.lib.carla_get_plugin_process_stats.restype = POINTER(CarlaPluginProcessStats)
+
+        self.lib.carla_get_plugin_block_split_stats.argtypes = [c_uint]
+        self.lib.carla_get_plugin_block_split_stats.restype = POINTER(CarlaPluginBlockSplitStats)
+
+        self.lib.carla_get_plugin_worker_stats.argtypes = [c_uint]
+        self.lib.carla_get_plugin_worker_stats.restype = POINTER(CarlaPluginWorkerStats)
+
         self.lib.carla_render_inline_display.argtypes = [c_uint, c_uint, c_uint]
         self.lib.carla_render_inline_display.restype = POINTER(CarlaInlineDisplayImageSurface)
 
@@ -2384,6 +2679,9 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_set_ctrl_channel.argtypes = [c_uint, c_int8]
         self.lib.carla_set_ctrl_channel.restype = None
 
+        self.lib.carla_set_plugin_minimum_split_frames.argtypes = [c_uint, c_uint32]
+        self.lib.carla_set_plugin_minimum_split_frames.restype = None
+
         self.lib.carla_set_parameter_value.argtypes = [c_uint, c_uint32, c_float]
         self.lib.carla_set_parameter_value.restype = None
 
@@ -2517,6 +2815,15 @@ class CarlaHostDLL(CarlaHostMeta):
     def get_transport_info(self):
         return structToDict(self.lib.carla_get_transport_info().contents)
 
+    def get_runtime_engine_info(self):
+        return structToDict(self.lib.carla_get_runtime_engine_info().contents)
+
+    def clear_process_stats(self):
+        self.lib.carla_clear_process_stats()
+
+    def render_to_file(self, filename, frames):
+        return bool(self.lib.carla_render_to_file(filename.encode("utf-8"), frames))
+
     def get_current_plugin_count(self):
         return int(self.lib.carla_get_current_plugin_count())
 
@@ -2547,6 +2854,12 @@ class CarlaHostDLL(CarlaHostMeta):
     def switch_plugins(self, pluginIdA, pluginIdB):
         return bool(self.lib.carla_switch_plugins(pluginIdA, pluginIdB))
 
+    def begin_plugin_transaction(self):
+        return bool(self.lib.carla_begin_plugin_transaction())
+
+    def commit_plugin_transaction(self):
+        return bool(self.lib.carla_commit_plugin_transaction())
+
     def load_plugin_state(self, pluginId, filename):
         return bool(self.lib.carla_load_plugin_state(pluginId, filename.encode("utf-8")))
 
@@ -2634,6 +2947,18 @@ class CarlaHostDLL(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return float(self.lib.carla_get_output_peak_value(pluginId, isLeft))
 
+    def get_plugin_round_trip_time(self, pluginId, maximum):
+        return float(self.lib.carla_get_plugin_round_trip_time(pluginId, maximum))
+
+    def get_plugin_process_stats(self, pluginId):
+        return structToDict(self.lib.carla_get_plugin_process_stats(pluginId).contents)
+
+    def get_plugin_block_split_stats(self, pluginId):
+        return structToDict(self.lib.carla_get_plugin_block_split_stats(pluginId).contents)
+
+    def get_plugin_worker_stats(self, pluginId):
+        return structToDict(self.lib.carla_get_plugin_worker_stats(pluginId).contents)
+
     def render_inline_display(self, pluginId, width, height):
         return structToDict(self.lib.carla_render_inline_display(pluginId, width, height))
 
@@ -2661,6 +2986,9 @@ class CarlaHostDLL(CarlaHostMeta):
     def set_ctrl_channel(self, pluginId, channel):
         self.lib.carla_set_ctrl_channel(pluginId, channel)
 
+    def set_plugin_minimum_split_frames(self, pluginId, frames):
+        self.lib.carla_set_plugin_minimum_split_frames(pluginId, frames)
+
     def set_parameter_value(self, pluginId, parameterId, value):
         self.lib.carla_set_parameter_value(pluginId, parameterId, value)
 
@@ -2742,7 +3070,9 @@ class PluginStoreInfo(object):
         'midiProgramData',
         'customDataCount',
         'customData',
-        'peaks'
+        'peaks',
+        'processStats',
+        'blockSplitStats'
     ]
 
 # ------------------------------------------------------------------------------------------------------------
@@ -2774,6 +3104,9 @@ class CarlaHostPlugin(CarlaHostMeta):
             "bpm": 0.0
         }
 
+        # runtime engine info
+        self.fRuntimeEngineInfo = PyCarlaRuntimeEngineInfo.copy()
+
         # some other vars
         self.fBufferSize = 0
         self.fSampleRate = 0.0
@@ -2855,6 +3188,16 @@ class CarlaHostPlugin(CarlaHostMeta):
     def get_transport_info(self):
         return self.fTransportInfo
 
+    def get_runtime_engine_info(self):
+        return self.fRuntimeEngineInfo
+
+    def clear_process_stats(self):
+        self.sendMsg(["clear_process_stats"])
+
+    def render_to_file(self, filename, frames):
+        # only available with the offline engine driver, never the case in plugin version
+        return False
+
     def get_current_plugin_count(self):
         return len(self.fPluginsInfo)
 
@@ -2886,6 +3229,12 @@ class CarlaHostPlugin(CarlaHostMeta):
     def switch_plugins(self, pluginIdA, pluginIdB):
         return self.sendMsgAndSetError(["switch_plugins", pluginIdA, pluginIdB])
 
+    def begin_plugin_transaction(self):
+        return self.sendMsgAndSetError(["begin_plugin_transaction"])
+
+    def commit_plugin_transaction(self):
+        return self.sendMsgAndSetError(["commit_plugin_transaction"])
+
     def load_plugin_state(self, pluginId, filename):
         return self.sendMsgAndSetError(["load_plugin_state", pluginId, filename])
 
@@ -2979,6 +3328,18 @@ class CarlaHostPlugin(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return self.fPluginsInfo[pluginId].peaks[2 if isLeft else 3]
 
+    def get_plugin_round_trip_time(self, pluginId, maximum):
+        return 0.0
+
+    def get_plugin_process_stats(self, pluginId):
+        return self.fPluginsInfo[pluginId].processStats
+
+    def get_plugin_block_split_stats(self, pluginId):
+        return self.fPluginsInfo[pluginId].blockSplitStats
+
+    def get_plugin_worker_stats(self, pluginId):
+        return PyCarlaPluginWorkerStats
+
     def render_inline_display(self, pluginId, width, height):
         return None
 
@@ -3013,6 +3374,11 @@ class CarlaHostPlugin(CarlaHostMeta):
         self.sendMsg(["set_ctrl_channel", pluginId, channel])
         self.fPluginsInfo[pluginId].internalValues[6] = float(channel)
 
+    def set_plugin_minimum_split_frames(self, pluginId, frames):
+        self.sendMsg(["set_plugin_minimum_split_frames", pluginId, frames])
+        self.fPluginsInfo[pluginId].blockSplitStats = PyCarlaPluginBlockSplitStats.copy()
+        self.fPluginsInfo[pluginId].blockSplitStats['minimumFrames'] = frames
+
     def set_parameter_value(self, pluginId, parameterId, value):
         self.sendMsg(["set_parameter_value", pluginId, parameterId, value])
         self.fPluginsInfo[pluginId].parameterValues[parameterId] = value
@@ -3119,6 +3485,8 @@ class CarlaHostPlugin(CarlaHostMeta):
         info.customDataCount = 0
         info.customData      = []
         info.peaks = [0.0, 0.0, 0.0, 0.0]
+        info.processStats = PyCarlaPluginProcessStats.copy()
+        info.blockSplitStats = PyCarlaPluginBlockSplitStats.copy()
 
     def _set_pluginInfo(self, pluginId, info):
         self.fPluginsInfo[pluginId].pluginInfo = info
@@ -3242,4 +3610,22 @@ class CarlaHostPlugin(CarlaHostMeta):
     def _set_peaks(self, pluginId, in1, in2, out1, out2):
         self.fPluginsInfo[pluginId].peaks = [in1, in2, out1, out2]
 
+    def _set_engine_stats(self, load, xruns, overruns):
+        self.fRuntimeEngineInfo = {
+            "load": load,
+            "xruns": xruns,
+            "overruns": overruns
+        }
+
+    def _set_process_stats(self, pluginId, count, minTime, avgTime, maxTime, p50Time, p90Time, p99Time):
+        self.fPluginsInfo[pluginId].processStats = {
+            "count": count,
+            "minTime": minTime,
+            "avgTime": avgTime,
+            "maxTime": maxTime,
+            "p50Time": p50Time,
+            "p90Time": p90Time,
+            "p99Time": p99Time
+        }
+
 # ------------------------------------------------------------------------------------------------------------
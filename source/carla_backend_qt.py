@@ -79,6 +79,7 @@ class CarlaHostSignals(QObject):
     InfoCallback = pyqtSignal(str)
     ErrorCallback = pyqtSignal(str)
     QuitCallback = pyqtSignal()
+    ProcessStatsCallback = pyqtSignal(float, int, int)
 
 # ------------------------------------------------------------------------------------------------------------
 # Carla Host object (dummy/null, does nothing)
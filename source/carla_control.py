@@ -388,6 +388,19 @@ class CarlaControlServer(Server):
         pluginId, in1, in2, out1, out2 = args
         self.host._set_peaks(pluginId, in1, in2, out1, out2)
 
+    @make_method('/carla-control/set_engine_stats', 'fii')
+    def set_engine_stats_callback(self, path, args):
+        self.fReceivedMsgs = True
+        load, xruns, overruns = args
+        self.host._set_engine_stats(load, xruns, overruns)
+        self.host.ProcessStatsCallback.emit(load, xruns, overruns)
+
+    @make_method('/carla-control/set_process_stats', 'iiffffff')
+    def set_process_stats_callback(self, path, args):
+        self.fReceivedMsgs = True
+        pluginId, count, minTime, avgTime, maxTime, p50Time, p90Time, p99Time = args
+        self.host._set_process_stats(pluginId, count, minTime, avgTime, maxTime, p50Time, p90Time, p99Time)
+
     @make_method('/carla-control/exit', '')
     def set_exit_callback(self, path, args):
         print(path, args)
@@ -164,11 +164,7 @@ def findWinePrefix(filename, recursionLimit = 10):
 
     return findWinePrefix(path, recursionLimit-1)
 
-def runCarlaDiscovery(itype, stype, filename, tool, wineSettings=None):
-    if not os.path.exists(tool):
-        qWarning("runCarlaDiscovery() - tool '%s' does not exist" % tool)
-        return
-
+def getDiscoveryCommand(tool, filename, wineSettings=None):
     command = []
 
     if LINUX or MACOS:
@@ -197,6 +193,14 @@ def runCarlaDiscovery(itype, stype, filename, tool, wineSettings=None):
             command.append(wineSettings['executable'] if wineSettings['executable'] else "wine")
 
     command.append(tool)
+    return command
+
+def runCarlaDiscovery(itype, stype, filename, tool, wineSettings=None):
+    if not os.path.exists(tool):
+        qWarning("runCarlaDiscovery() - tool '%s' does not exist" % tool)
+        return
+
+    command = getDiscoveryCommand(tool, filename, wineSettings)
     command.append(stype)
     command.append(filename)
 
@@ -303,6 +307,105 @@ def runCarlaDiscovery(itype, stype, filename, tool, wineSettings=None):
 
     return plugins
 
+# Check many files with a single carla-discovery process, see the batch mode in carla-discovery.cpp.
+# Files are grouped per wine prefix, callback is called with (filename, plugins) as each file is done.
+# Returns the list of files that could not be handled in batch mode, so they can be checked one by one.
+def runCarlaDiscoveryBatch(itype, stype, filenames, tool, callback, wineSettings=None):
+    if not os.path.exists(tool):
+        qWarning("runCarlaDiscoveryBatch() - tool '%s' does not exist" % tool)
+        return []
+
+    groups = {}
+    for filename in filenames:
+        command = tuple(getDiscoveryCommand(tool, filename, wineSettings))
+        groups.setdefault(command, []).append(filename)
+
+    remaining = []
+
+    for command, files in groups.items():
+        remaining += _runCarlaDiscoveryBatchGroup(itype, list(command) + [stype, ":batch"], files, callback)
+
+    return remaining
+
+def _runCarlaDiscoveryBatchGroup(itype, command, filenames, callback):
+    global gDiscoveryProcess
+    gDiscoveryProcess = Popen(command, stdin=PIPE, stdout=PIPE)
+
+    try:
+        gDiscoveryProcess.stdin.write(("\n".join(filenames) + "\n").encode("utf-8"))
+        gDiscoveryProcess.stdin.close()
+    except:
+        pass
+
+    pending  = set(filenames)
+    filename = None
+    plugins  = []
+    validFormat = False
+
+    def fileDone():
+        if filename is None:
+            return
+        pending.discard(filename)
+        callback(filename, plugins)
+
+    for line in gDiscoveryProcess.stdout:
+        line   = line.decode("utf-8", errors="ignore").rstrip("\r\n")
+        fields = line.split("\t")
+
+        if fields[0] == "V":
+            validFormat = fields[1:] == ["1"]
+            if not validFormat:
+                break
+
+        elif not validFormat:
+            continue
+
+        elif fields[0] == "F" and len(fields) >= 6:
+            fileDone()
+            filename = "\t".join(fields[5:])
+            plugins  = []
+
+            if fields[1] in ("crash", "timeout"):
+                print("carla-discovery::%s::%s failed during discovery" % (fields[1], filename))
+
+        elif fields[0] == "P" and len(fields) == 13 and filename is not None:
+            fakeLabel = os.path.basename(filename).rsplit(".", 1)[0]
+
+            pinfo = deepcopy(PyPluginInfo)
+            pinfo['type']     = itype
+            pinfo['filename'] = filename
+            pinfo['build']    = int(fields[1])
+            pinfo['hints']    = int(fields[2])
+            pinfo['uniqueId'] = int(fields[3])
+            pinfo['audio.ins']  = int(fields[4])
+            pinfo['audio.outs'] = int(fields[5])
+            pinfo['midi.ins']   = int(fields[6])
+            pinfo['midi.outs']  = int(fields[7])
+            pinfo['parameters.ins']  = int(fields[8])
+            pinfo['parameters.outs'] = int(fields[9])
+            pinfo['name']  = fields[10] if fields[10] else fakeLabel
+            pinfo['label'] = fields[11] if fields[11] else fakeLabel
+            pinfo['maker'] = fields[12]
+            plugins.append(pinfo)
+
+        elif fields[0] == "M" and len(fields) >= 3:
+            print("carla-discovery::%s::%s - %s" % (fields[1], "\t".join(fields[2:]), filename))
+
+        elif fields[0] == "S":
+            break
+
+    fileDone()
+
+    gDiscoveryProcess.wait()
+
+    # FIXME?
+    tmp = gDiscoveryProcess
+    gDiscoveryProcess = None
+    del gDiscoveryProcess, tmp
+
+    # older tools do not know about batch mode, or the scan was stopped
+    return [f for f in filenames if f in pending]
+
 def killDiscovery():
     global gDiscoveryProcess
 
@@ -678,16 +781,7 @@ class SearchPluginsThread(QThread):
 
         if not self.fContinueChecking: return
 
-        for i in range(len(ladspaBinaries)):
-            ladspa  = ladspaBinaries[i]
-            percent = ( float(i) / len(ladspaBinaries) ) * self.fCurPercentValue
-            self._pluginLook((self.fLastCheckValue + percent) * 0.9, ladspa)
-
-            plugins = checkPluginLADSPA(ladspa, tool, self.fWineSettings if isWine else None)
-            if plugins:
-                self.fLadspaPlugins.append(plugins)
-
-            if not self.fContinueChecking: break
+        self._checkBinaries(PLUGIN_LADSPA, "LADSPA", ladspaBinaries, tool, self.fWineSettings if isWine else None, self.fLadspaPlugins)
 
         self.fLastCheckValue += self.fCurPercentValue
 
@@ -711,16 +805,7 @@ class SearchPluginsThread(QThread):
 
         if not self.fContinueChecking: return
 
-        for i in range(len(dssiBinaries)):
-            dssi    = dssiBinaries[i]
-            percent = ( float(i) / len(dssiBinaries) ) * self.fCurPercentValue
-            self._pluginLook(self.fLastCheckValue + percent, dssi)
-
-            plugins = checkPluginDSSI(dssi, tool, self.fWineSettings if isWine else None)
-            if plugins:
-                self.fDssiPlugins.append(plugins)
-
-            if not self.fContinueChecking: break
+        self._checkBinaries(PLUGIN_DSSI, "DSSI", dssiBinaries, tool, self.fWineSettings if isWine else None, self.fDssiPlugins)
 
         self.fLastCheckValue += self.fCurPercentValue
 
@@ -750,16 +835,7 @@ class SearchPluginsThread(QThread):
 
         if not self.fContinueChecking: return
 
-        for i in range(len(vst2Binaries)):
-            vst2    = vst2Binaries[i]
-            percent = ( float(i) / len(vst2Binaries) ) * self.fCurPercentValue
-            self._pluginLook(self.fLastCheckValue + percent, vst2)
-
-            plugins = checkPluginVST2(vst2, tool, self.fWineSettings if isWine else None)
-            if plugins:
-                self.fVstPlugins.append(plugins)
-
-            if not self.fContinueChecking: break
+        self._checkBinaries(PLUGIN_VST2, "VST2", vst2Binaries, tool, self.fWineSettings if isWine else None, self.fVstPlugins)
 
         self.fLastCheckValue += self.fCurPercentValue
 
@@ -777,26 +853,39 @@ class SearchPluginsThread(QThread):
 
         if not self.fContinueChecking: return
 
-        for i in range(len(kitFiles)):
-            kit     = kitFiles[i]
-            percent = ( float(i) / len(kitFiles) ) * self.fCurPercentValue
-            self._pluginLook(self.fLastCheckValue + percent, kit)
-
-            if kitExtension == "gig":
-                plugins = checkFileGIG(kit, self.fToolNative)
-            elif kitExtension == "sf2":
-                plugins = checkFileSF2(kit, self.fToolNative)
-            elif kitExtension == "sfz":
-                plugins = checkFileSFZ(kit, self.fToolNative)
-            else:
-                plugins = None
+        if kitExtension == "gig":
+            self._checkBinaries(PLUGIN_GIG, "GIG", kitFiles, self.fToolNative, None, self.fKitPlugins)
+        elif kitExtension == "sf2":
+            self._checkBinaries(PLUGIN_SF2, "SF2", kitFiles, self.fToolNative, None, self.fKitPlugins)
+        elif kitExtension == "sfz":
+            self._checkBinaries(PLUGIN_SFZ, "SFZ", kitFiles, self.fToolNative, None, self.fKitPlugins)
 
-            if plugins:
-                self.fKitPlugins.append(plugins)
+        self.fLastCheckValue += self.fCurPercentValue
+
+    def _checkBinaries(self, itype, stype, binaries, tool, wineSettings, pluginList):
+        results = {}
+
+        def fileChecked(filename, plugins):
+            percent = ( float(len(results)) / len(binaries) ) * self.fCurPercentValue
+            self._pluginLook(self.fLastCheckValue + percent, filename)
+
+            results[filename] = plugins
 
+            if not self.fContinueChecking:
+                killDiscovery()
+
+        # check everything in one go, then one by one whatever the tool could not handle in batch mode
+        remaining = runCarlaDiscoveryBatch(itype, stype, binaries, tool, fileChecked, wineSettings)
+
+        for binary in remaining:
             if not self.fContinueChecking: break
+            fileChecked(binary, runCarlaDiscovery(itype, stype, binary, tool, wineSettings))
 
-        self.fLastCheckValue += self.fCurPercentValue
+        # keep the same order as the list of binaries
+        for binary in binaries:
+            plugins = results.get(binary, None)
+            if plugins:
+                pluginList.append(plugins)
 
     def _checkLv2Cached(self):
         settings  = QSettings("falkTX", "Carla2")
@@ -2423,6 +2423,8 @@ def engineCallback(host, action, pluginId, value1, value2, value3, valueStr):
         host.ErrorCallback.emit(valueStr)
     elif action == ENGINE_CALLBACK_QUIT:
         host.QuitCallback.emit()
+    elif action == ENGINE_CALLBACK_PROCESS_STATS:
+        host.ProcessStatsCallback.emit(value3, value1, value2)
 
 # ------------------------------------------------------------------------------------------------------------
 # File callback
@@ -2554,6 +2556,41 @@ def loadHostSettings(host):
     except:
         host.experimental = CARLA_DEFAULT_MAIN_EXPERIMENTAL
 
+    try:
+        host.audioWorkerThreads = settings.value(CARLA_KEY_ENGINE_AUDIO_WORKER_THREADS, CARLA_DEFAULT_AUDIO_WORKER_THREADS, type=int)
+    except:
+        host.audioWorkerThreads = CARLA_DEFAULT_AUDIO_WORKER_THREADS
+
+    try:
+        host.rackLanes = settings.value(CARLA_KEY_ENGINE_RACK_LANES, CARLA_DEFAULT_RACK_LANES, type=str)
+    except:
+        host.rackLanes = CARLA_DEFAULT_RACK_LANES
+
+    try:
+        host.bridgesSpinTime = settings.value(CARLA_KEY_ENGINE_BRIDGES_SPIN_TIME, CARLA_DEFAULT_BRIDGES_SPIN_TIME, type=int)
+    except:
+        host.bridgesSpinTime = CARLA_DEFAULT_BRIDGES_SPIN_TIME
+
+    try:
+        host.idleMaxInterval = settings.value(CARLA_KEY_ENGINE_IDLE_MAX_INTERVAL, CARLA_DEFAULT_IDLE_MAX_INTERVAL, type=int)
+    except:
+        host.idleMaxInterval = CARLA_DEFAULT_IDLE_MAX_INTERVAL
+
+    try:
+        host.projectLoadThreads = settings.value(CARLA_KEY_ENGINE_PROJECT_LOAD_THREADS, CARLA_DEFAULT_PROJECT_LOAD_THREADS, type=int)
+    except:
+        host.projectLoadThreads = CARLA_DEFAULT_PROJECT_LOAD_THREADS
+
+    try:
+        host.projectChunkFiles = settings.value(CARLA_KEY_ENGINE_PROJECT_CHUNK_FILES, CARLA_DEFAULT_PROJECT_CHUNK_FILES, type=bool)
+    except:
+        host.projectChunkFiles = CARLA_DEFAULT_PROJECT_CHUNK_FILES
+
+    try:
+        host.processStats = settings.value(CARLA_KEY_ENGINE_PROCESS_STATS, CARLA_DEFAULT_PROCESS_STATS, type=bool)
+    except:
+        host.processStats = CARLA_DEFAULT_PROCESS_STATS
+
     try:
         host.exportLV2 = settings.value(CARLA_KEY_EXPERIMENTAL_EXPORT_LV2, CARLA_DEFAULT_EXPERIMENTAL_LV2_EXPORT, type=bool)
     except:
@@ -2666,6 +2703,13 @@ def setHostSettings(host):
 
     host.set_engine_option(ENGINE_OPTION_PROCESS_MODE,          host.nextProcessMode,     "")
     host.set_engine_option(ENGINE_OPTION_TRANSPORT_MODE,        host.transportMode,       "")
+    host.set_engine_option(ENGINE_OPTION_AUDIO_WORKER_THREADS,  host.audioWorkerThreads,  "")
+    host.set_engine_option(ENGINE_OPTION_RACK_LANES,            0,                        host.rackLanes)
+    host.set_engine_option(ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME, host.bridgesSpinTime,  "")
+    host.set_engine_option(ENGINE_OPTION_IDLE_MAX_INTERVAL,     host.idleMaxInterval,     "")
+    host.set_engine_option(ENGINE_OPTION_PROJECT_LOAD_THREADS,  host.projectLoadThreads,  "")
+    host.set_engine_option(ENGINE_OPTION_PROJECT_CHUNK_FILES,   host.projectChunkFiles,   "")
+    host.set_engine_option(ENGINE_OPTION_PROCESS_STATS,         host.processStats,        "")
 
 # ------------------------------------------------------------------------------------------------------------
 # Set Engine settings according to carla preferences. Returns selected audio driver.
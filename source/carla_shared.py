@@ -217,6 +217,13 @@ CARLA_KEY_ENGINE_MANAGE_UIS            = "Engine/ManageUIs"           # bool
 CARLA_KEY_ENGINE_UIS_ALWAYS_ON_TOP     = "Engine/UIsAlwaysOnTop"      # bool
 CARLA_KEY_ENGINE_MAX_PARAMETERS        = "Engine/MaxParameters"       # int
 CARLA_KEY_ENGINE_UI_BRIDGES_TIMEOUT    = "Engine/UiBridgesTimeout"    # int
+CARLA_KEY_ENGINE_AUDIO_WORKER_THREADS  = "Engine/AudioWorkerThreads"  # int
+CARLA_KEY_ENGINE_RACK_LANES            = "Engine/RackLanes"           # str
+CARLA_KEY_ENGINE_BRIDGES_SPIN_TIME     = "Engine/BridgesSpinTime"     # int
+CARLA_KEY_ENGINE_IDLE_MAX_INTERVAL     = "Engine/IdleMaxInterval"     # int
+CARLA_KEY_ENGINE_PROJECT_LOAD_THREADS  = "Engine/ProjectLoadThreads"  # int
+CARLA_KEY_ENGINE_PROJECT_CHUNK_FILES   = "Engine/ProjectChunkFiles"   # bool
+CARLA_KEY_ENGINE_PROCESS_STATS         = "Engine/ProcessStats"        # bool
 
 CARLA_KEY_PATHS_LADSPA = "Paths/LADSPA"
 CARLA_KEY_PATHS_DSSI   = "Paths/DSSI"
@@ -278,6 +285,13 @@ CARLA_DEFAULT_MANAGE_UIS            = True
 CARLA_DEFAULT_UIS_ALWAYS_ON_TOP     = False
 CARLA_DEFAULT_MAX_PARAMETERS        = MAX_DEFAULT_PARAMETERS
 CARLA_DEFAULT_UI_BRIDGES_TIMEOUT    = 4000
+CARLA_DEFAULT_AUDIO_WORKER_THREADS  = 0
+CARLA_DEFAULT_RACK_LANES            = ""
+CARLA_DEFAULT_BRIDGES_SPIN_TIME     = 0
+CARLA_DEFAULT_IDLE_MAX_INTERVAL     = 25
+CARLA_DEFAULT_PROJECT_LOAD_THREADS  = 1
+CARLA_DEFAULT_PROJECT_CHUNK_FILES   = False
+CARLA_DEFAULT_PROCESS_STATS         = False
 
 CARLA_DEFAULT_AUDIO_NUM_PERIODS     = 2
 CARLA_DEFAULT_AUDIO_BUFFER_SIZE     = 512
@@ -49,9 +49,34 @@
 # include "linuxsampler/EngineFactory.h"
 #endif
 
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#ifndef CARLA_OS_WIN
+# include <cerrno>
+# include <fcntl.h>
+# include <poll.h>
+# include <signal.h>
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
+
+#ifdef CARLA_OS_LINUX
+# include <sys/prctl.h>
+#endif
 
 #include "water/water.h"
+#include "water/misc/Time.h"
+
+#ifdef CARLA_OS_WIN
+# include "water/threads/ChildProcess.h"
+#endif
 
 #define DISCOVERY_OUT(x, y) std::cout << "\ncarla-discovery::" << x << "::" << y << std::endl;
 
@@ -1607,13 +1632,683 @@ static void do_linuxsampler_check(const char* const filename, const char* const
 #endif
 }
 
+// ------------------------------ batch mode ------------------------------
+// Invoked as "carla-discovery <type> :batch [jobs]", reads one filename per line from stdin.
+// Each file is checked by a separate carla-discovery process so a crashing plugin only takes down its own check,
+// up to "jobs" of them run at the same time (CARLA_DISCOVERY_JOBS or the number of CPUs by default).
+// Results are printed as tab-separated records, one line each:
+//   V  <format-version>
+//   F  <status> <mtime> <size> <plugin-count> <filename>
+//   P  <build> <hints> <unique-id> <audio-ins> <audio-outs> <midi-ins> <midi-outs> <param-ins> <param-outs> <name> <label> <maker>
+//   M  <info|warning|error> <message>
+//   S  <files> <cached> <failed>
+// where status is one of ok, error, crash or timeout, and P and M records belong to the F record before them.
+// Results are stored in a per-tool cache keyed on file modification time and size, so unchanged files are
+// reported without being loaded again. Set CARLA_DISCOVERY_NO_CACHE to ignore (and rebuild) the cache.
+
+static const uint32_t kBatchFormatVersion = 1;
+static const uint32_t kBatchDefaultTimeout = 60; // seconds, override with CARLA_DISCOVERY_TIMEOUT
+static const uint     kBatchMaxJobs = 64;
+
+struct BatchResult {
+    std::string filename;
+    std::string status;
+    int64_t mtime;
+    int64_t size;
+    uint32_t pluginCount;
+    std::string records; // P and M lines
+
+    BatchResult()
+        : filename(),
+          status(),
+          mtime(0),
+          size(0),
+          pluginCount(0),
+          records() {}
+};
+
+static std::string batch_sanitize(std::string value)
+{
+    for (std::string::iterator it = value.begin(), end = value.end(); it != end; ++it)
+    {
+        if (*it == '\t' || *it == '\n' || *it == '\r')
+            *it = ' ';
+    }
+
+    return value;
+}
+
+static void batch_get_file_stats(const char* const filename, int64_t& mtime, int64_t& size)
+{
+    struct stat st;
+
+    if (stat(filename, &st) == 0)
+    {
+        mtime = static_cast<int64_t>(st.st_mtime);
+        size  = static_cast<int64_t>(st.st_size);
+    }
+    else
+    {
+        mtime = size = -1;
+    }
+}
+
+static std::string batch_format_result(const BatchResult& result)
+{
+    std::ostringstream out;
+    out << "F\t" << result.status
+        << '\t'  << result.mtime
+        << '\t'  << result.size
+        << '\t'  << result.pluginCount
+        << '\t'  << result.filename << '\n'
+        << result.records;
+    return out.str();
+}
+
+// Turn the regular DISCOVERY_OUT output of a single check into P and M records.
+// Returns false if the check reported an error.
+static bool batch_parse_output(const std::string& output, BatchResult& result)
+{
+    static const char* const kNumericKeys[] = {
+        "build", "hints", "uniqueId",
+        "audio.ins", "audio.outs", "midi.ins", "midi.outs", "parameters.ins", "parameters.outs"
+    };
+    static const std::size_t kNumNumericKeys = sizeof(kNumericKeys)/sizeof(kNumericKeys[0]);
+    static const std::string kPrefix("carla-discovery::");
+
+    std::string numbers[kNumNumericKeys];
+    std::string name, label, maker;
+    bool inPlugin = false;
+    bool noErrors = true;
+
+    for (std::size_t pos = 0, next; pos < output.size(); pos = next + 1)
+    {
+        next = output.find('\n', pos);
+
+        if (next == std::string::npos)
+            next = output.size();
+
+        std::string line(output, pos, next - pos);
+
+        if (! line.empty() && line[line.size()-1] == '\r')
+            line.resize(line.size()-1);
+
+        if (line.compare(0, kPrefix.size(), kPrefix) != 0)
+            continue;
+
+        const std::size_t sep = line.find("::", kPrefix.size());
+
+        if (sep == std::string::npos)
+            continue;
+
+        const std::string key(line, kPrefix.size(), sep - kPrefix.size());
+        const std::string value(line, sep + 2);
+
+        if (key == "init")
+        {
+            for (std::size_t i=0; i < kNumNumericKeys; ++i)
+                numbers[i] = "0";
+            name.clear();
+            label.clear();
+            maker.clear();
+            inPlugin = true;
+        }
+        else if (key == "end")
+        {
+            if (! inPlugin)
+                continue;
+
+            result.records += "P";
+            for (std::size_t i=0; i < kNumNumericKeys; ++i)
+                result.records += "\t" + numbers[i];
+            result.records += "\t" + name + "\t" + label + "\t" + maker + "\n";
+
+            ++result.pluginCount;
+            inPlugin = false;
+        }
+        else if (key == "info" || key == "warning" || key == "error")
+        {
+            result.records += "M\t" + key + "\t" + batch_sanitize(value) + "\n";
+
+            if (key == "error")
+                noErrors = false;
+        }
+        else if (! inPlugin)
+        {
+            continue;
+        }
+        else if (key == "name")
+        {
+            name = batch_sanitize(value);
+        }
+        else if (key == "label")
+        {
+            label = batch_sanitize(value);
+        }
+        else if (key == "maker")
+        {
+            maker = batch_sanitize(value);
+        }
+        else if (key == "uri")
+        {
+            // cannot use empty URIs
+            if (value.empty())
+                inPlugin = false;
+            else
+                label = batch_sanitize(value);
+        }
+        else
+        {
+            for (std::size_t i=0; i < kNumNumericKeys; ++i)
+            {
+                if (key != kNumericKeys[i])
+                    continue;
+                if (! value.empty() && value.find_first_not_of("0123456789") == std::string::npos)
+                    numbers[i] = value;
+                break;
+            }
+        }
+    }
+
+    return noErrors;
+}
+
+// --------------------------------------------------------------------------
+
+class BatchCache
+{
+public:
+    BatchCache(const char* const toolName, const char* const stype)
+        : fFilename(),
+          fEntries(),
+          fChanged(false)
+    {
+        CarlaString typeName(stype);
+        typeName.toLower();
+
+#ifdef CARLA_OS_WIN
+        if (const char* const appData = std::getenv("APPDATA"))
+            fFilename = appData;
+        fFilename += "\\Carla\\";
+#else
+        if (const char* const cacheHome = std::getenv("XDG_CACHE_HOME"))
+        {
+            fFilename = cacheHome;
+        }
+        else
+        {
+            if (const char* const home = std::getenv("HOME"))
+                fFilename = home;
+            fFilename += "/.cache";
+        }
+        fFilename += "/carla/";
+#endif
+        fFilename += toolName;
+        fFilename += "-";
+        fFilename += typeName.buffer();
+        fFilename += ".cache";
+    }
+
+    void load()
+    {
+        std::ifstream in(fFilename.c_str());
+        std::string line;
+
+        if (! std::getline(in, line) || line != batch_format_version_line())
+            return;
+
+        BatchResult* current = nullptr;
+
+        while (std::getline(in, line))
+        {
+            if (line.size() < 2 || line[1] != '\t')
+                continue;
+
+            if (line[0] == 'F')
+            {
+                current = nullptr;
+
+                std::istringstream fields(line.substr(2));
+                BatchResult result;
+
+                if (! std::getline(fields, result.status, '\t'))
+                    continue;
+                if (! (fields >> result.mtime >> result.size >> result.pluginCount))
+                    continue;
+                if (fields.get() != '\t' || ! std::getline(fields, result.filename) || result.filename.empty())
+                    continue;
+
+                current = &fEntries[result.filename];
+                *current = result;
+            }
+            else if (current != nullptr && (line[0] == 'P' || line[0] == 'M'))
+            {
+                current->records += line + "\n";
+            }
+        }
+    }
+
+    bool save()
+    {
+        if (! fChanged)
+            return true;
+
+        const File cacheFile(water::String(CharPointer_UTF8(fFilename.c_str())));
+        cacheFile.getParentDirectory().createDirectory();
+
+        // write to a temporary file first so concurrent scans never see a partial cache
+        const std::string tmpFilename(fFilename + ".tmp");
+
+        {
+            std::ofstream out(tmpFilename.c_str(), std::ios::out | std::ios::trunc);
+            out << batch_format_version_line() << '\n';
+
+            for (std::map<std::string, BatchResult>::const_iterator it = fEntries.begin(), end = fEntries.end(); it != end; ++it)
+                out << batch_format_result(it->second);
+
+            if (! out.good())
+                return false;
+        }
+
+#ifdef CARLA_OS_WIN
+        std::remove(fFilename.c_str());
+#endif
+        if (std::rename(tmpFilename.c_str(), fFilename.c_str()) != 0)
+            return false;
+
+        fChanged = false;
+        return true;
+    }
+
+    const BatchResult* find(const std::string& filename, const int64_t mtime, const int64_t size) const
+    {
+        const std::map<std::string, BatchResult>::const_iterator it(fEntries.find(filename));
+
+        if (it == fEntries.end())
+            return nullptr;
+        if (it->second.mtime != mtime || it->second.size != size)
+            return nullptr;
+
+        return &it->second;
+    }
+
+    void update(const BatchResult& result)
+    {
+        fEntries[result.filename] = result;
+        fChanged = true;
+    }
+
+    static std::string batch_format_version_line()
+    {
+        std::ostringstream out;
+        out << "V\t" << kBatchFormatVersion;
+        return out.str();
+    }
+
+private:
+    std::string fFilename;
+    std::map<std::string, BatchResult> fEntries;
+    bool fChanged;
+
+    CARLA_DECLARE_NON_COPY_CLASS(BatchCache)
+};
+
+// --------------------------------------------------------------------------
+
+class BatchScanner
+{
+public:
+    BatchScanner(const char* const stype)
+        : fExecutable(File::getSpecialLocation(File::currentExecutableFile).getFullPathName().toStdString()),
+          fType(stype),
+          fCache(File::getSpecialLocation(File::currentExecutableFile).getFileNameWithoutExtension().toRawUTF8(), stype),
+          fUseCache(std::getenv("CARLA_DISCOVERY_NO_CACHE") == nullptr),
+          fTimeout(kBatchDefaultTimeout * 1000),
+          fNumCached(0),
+          fNumFailed(0)
+    {
+        if (const char* const timeout = std::getenv("CARLA_DISCOVERY_TIMEOUT"))
+        {
+            const int seconds = std::atoi(timeout);
+
+            if (seconds > 0)
+                fTimeout = static_cast<uint32_t>(seconds) * 1000;
+        }
+    }
+
+    int run(const std::vector<std::string>& filenames, const uint jobs)
+    {
+        std::cout << BatchCache::batch_format_version_line() << std::endl;
+
+        if (fUseCache)
+            fCache.load();
+
+        std::vector<BatchResult> pending;
+
+        for (std::vector<std::string>::const_iterator it = filenames.begin(), end = filenames.end(); it != end; ++it)
+        {
+            BatchResult result;
+            result.filename = *it;
+            batch_get_file_stats(it->c_str(), result.mtime, result.size);
+
+            if (const BatchResult* const cached = fUseCache ? fCache.find(result.filename, result.mtime, result.size) : nullptr)
+            {
+                ++fNumCached;
+                report(*cached, false);
+                continue;
+            }
+
+            pending.push_back(result);
+        }
+
+        scan(pending, jobs);
+
+        fCache.save();
+
+        std::cout << "S\t" << filenames.size() << '\t' << fNumCached << '\t' << fNumFailed << std::endl;
+        return 0;
+    }
+
+private:
+    const std::string fExecutable;
+    const std::string fType;
+    BatchCache fCache;
+    const bool fUseCache;
+    uint32_t fTimeout;
+    uint32_t fNumCached, fNumFailed;
+
+    void report(const BatchResult& result, const bool store)
+    {
+        if (result.status != "ok")
+            ++fNumFailed;
+
+        std::cout << batch_format_result(result) << std::flush;
+
+        // a timeout might just mean the system is busy, try again next time
+        if (store && result.status != "timeout" && result.mtime != -1)
+            fCache.update(result);
+    }
+
+    void finish(BatchResult& result, const std::string& output, const char* const failureStatus)
+    {
+        const bool noErrors = batch_parse_output(output, result);
+
+        if (failureStatus != nullptr)
+            result.status = failureStatus;
+        else if (result.pluginCount == 0 && ! noErrors)
+            result.status = "error";
+        else
+            result.status = "ok";
+
+        report(result, true);
+    }
+
+#ifdef CARLA_OS_WIN
+    // Windows builds check one file at a time
+    void scan(std::vector<BatchResult>& pending, uint)
+    {
+        for (std::vector<BatchResult>::iterator it = pending.begin(), end = pending.end(); it != end; ++it)
+        {
+            water::ChildProcess child;
+            water::String command;
+            command << "\"" << fExecutable.c_str() << "\" " << fType.c_str() << " \"" << it->filename.c_str() << "\"";
+
+            if (! child.start(command, water::ChildProcess::wantStdOut))
+            {
+                finish(*it, std::string(), "error");
+                continue;
+            }
+
+            const std::string output(child.readAllProcessOutput().toStdString());
+
+            if (! child.waitForProcessToFinish(static_cast<int>(fTimeout)))
+            {
+                child.kill();
+                finish(*it, output, "timeout");
+                continue;
+            }
+
+            const uint32_t exitCode = child.getExitCode();
+
+            if (exitCode >= 0xC0000000)
+                finish(*it, output, "crash");
+            else if (exitCode != 0)
+                finish(*it, output, "error");
+            else
+                finish(*it, output, nullptr);
+        }
+    }
+#else
+    struct Worker {
+        pid_t pid;
+        int fd;
+        uint32_t startTime;
+        std::string output;
+        BatchResult result;
+
+        Worker()
+            : pid(0),
+              fd(-1),
+              startTime(0),
+              output(),
+              result() {}
+    };
+
+    bool spawn(Worker& worker, const BatchResult& result)
+    {
+        int pipeFds[2];
+
+        if (pipe(pipeFds) != 0)
+            return false;
+
+        const pid_t pid = fork();
+
+        if (pid < 0)
+        {
+            close(pipeFds[0]);
+            close(pipeFds[1]);
+            return false;
+        }
+
+        if (pid == 0)
+        {
+#ifdef CARLA_OS_LINUX
+            // do not leave checks running if the batch process gets killed
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+            const int devNull = open("/dev/null", O_RDONLY);
+
+            if (devNull >= 0)
+            {
+                dup2(devNull, STDIN_FILENO);
+                close(devNull);
+            }
+
+            dup2(pipeFds[1], STDOUT_FILENO);
+            close(pipeFds[0]);
+            close(pipeFds[1]);
+
+            const char* const args[] = { fExecutable.c_str(), fType.c_str(), result.filename.c_str(), nullptr };
+            execv(args[0], const_cast<char* const*>(args));
+            _exit(1);
+        }
+
+        close(pipeFds[1]);
+        fcntl(pipeFds[0], F_SETFL, fcntl(pipeFds[0], F_GETFL) | O_NONBLOCK);
+
+        worker.pid       = pid;
+        worker.fd        = pipeFds[0];
+        worker.startTime = water::Time::getMillisecondCounter();
+        worker.output.clear();
+        worker.result    = result;
+        return true;
+    }
+
+    // returns false once the pipe is closed
+    static bool drain(Worker& worker)
+    {
+        char buffer[4096];
+
+        for (;;)
+        {
+            const ssize_t r = read(worker.fd, buffer, sizeof(buffer));
+
+            if (r > 0)
+                worker.output.append(buffer, static_cast<std::size_t>(r));
+            else if (r == 0)
+                return false;
+            else
+                return errno == EAGAIN || errno == EINTR;
+        }
+    }
+
+    void reap(Worker& worker, const int status, const bool timedOut)
+    {
+        drain(worker);
+        close(worker.fd);
+
+        if (timedOut)
+            finish(worker.result, worker.output, "timeout");
+        else if (WIFSIGNALED(status))
+            finish(worker.result, worker.output, "crash");
+        else if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
+            finish(worker.result, worker.output, "error");
+        else
+            finish(worker.result, worker.output, nullptr);
+
+        worker.pid = 0;
+        worker.fd  = -1;
+        worker.output.clear();
+    }
+
+    void scan(std::vector<BatchResult>& pending, const uint jobs)
+    {
+        std::vector<Worker> workers(jobs);
+        std::vector<struct pollfd> pollFds;
+        std::size_t next = 0;
+        uint active = 0;
+
+        while (next < pending.size() || active != 0)
+        {
+            for (std::vector<Worker>::iterator it = workers.begin(), end = workers.end(); it != end && next < pending.size(); ++it)
+            {
+                if (it->pid != 0)
+                    continue;
+
+                const BatchResult& result(pending[next++]);
+
+                if (spawn(*it, result))
+                {
+                    ++active;
+                    continue;
+                }
+
+                BatchResult failed(result);
+                finish(failed, std::string(), "error");
+            }
+
+            if (active == 0)
+                continue;
+
+            pollFds.clear();
+
+            for (std::vector<Worker>::iterator it = workers.begin(), end = workers.end(); it != end; ++it)
+            {
+                if (it->pid == 0)
+                    continue;
+
+                struct pollfd pfd;
+                pfd.fd      = it->fd;
+                pfd.events  = POLLIN;
+                pfd.revents = 0;
+                pollFds.push_back(pfd);
+            }
+
+            poll(&pollFds[0], pollFds.size(), 50);
+
+            const uint32_t now = water::Time::getMillisecondCounter();
+
+            for (std::vector<Worker>::iterator it = workers.begin(), end = workers.end(); it != end; ++it)
+            {
+                if (it->pid == 0)
+                    continue;
+
+                const bool pipeOpen = drain(*it);
+                int status = 0;
+
+                if (! pipeOpen)
+                {
+                    waitpid(it->pid, &status, 0);
+                    reap(*it, status, false);
+                    --active;
+                }
+                else if (waitpid(it->pid, &status, WNOHANG) == it->pid)
+                {
+                    // exited but something it spawned still holds the pipe
+                    reap(*it, status, false);
+                    --active;
+                }
+                else if (now - it->startTime > fTimeout)
+                {
+                    kill(it->pid, SIGKILL);
+                    waitpid(it->pid, &status, 0);
+                    reap(*it, status, true);
+                    --active;
+                }
+            }
+        }
+    }
+#endif
+
+    CARLA_DECLARE_NON_COPY_CLASS(BatchScanner)
+};
+
+static int do_batch_check(const char* const stype, const char* const jobsArg)
+{
+    int jobs = 0;
+
+    if (jobsArg != nullptr)
+        jobs = std::atoi(jobsArg);
+    else if (const char* const jobsEnv = std::getenv("CARLA_DISCOVERY_JOBS"))
+        jobs = std::atoi(jobsEnv);
+
+#ifndef CARLA_OS_WIN
+    if (jobs <= 0)
+        jobs = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+
+    if (jobs <= 0)
+        jobs = 1;
+    else if (jobs > static_cast<int>(kBatchMaxJobs))
+        jobs = static_cast<int>(kBatchMaxJobs);
+
+    std::vector<std::string> filenames;
+    std::string line;
+
+    while (std::getline(std::cin, line))
+    {
+        if (! line.empty() && line[line.size()-1] == '\r')
+            line.resize(line.size()-1);
+
+        if (! line.empty())
+            filenames.push_back(line);
+    }
+
+    BatchScanner scanner(stype);
+    return scanner.run(filenames, static_cast<uint>(jobs));
+}
+
 // ------------------------------ main entry point ------------------------------
 
 int main(int argc, char* argv[])
 {
+    if ((argc == 3 || argc == 4) && std::strcmp(argv[2], ":batch") == 0)
+        return do_batch_check(argv[1], argc == 4 ? argv[3] : nullptr);
+
     if (argc != 3)
     {
         carla_stdout("usage: %s <type> </path/to/plugin>", argv[0]);
+        carla_stdout("       %s <type> :batch [jobs] < filelist", argv[0]);
         return 1;
     }
 
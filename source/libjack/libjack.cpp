@@ -910,6 +910,7 @@ bool CarlaJackAppClient::handleNonRtData()
         case kPluginBridgeNonRtClientSetMidiProgram:
         case kPluginBridgeNonRtClientSetCustomData:
         case kPluginBridgeNonRtClientSetChunkDataFile:
+        case kPluginBridgeNonRtClientSetChunkDataShm:
             break;
 
         case kPluginBridgeNonRtClientSetOption:
@@ -21,6 +21,8 @@
 #include "AudioProcessorGraph.h"
 #include "../containers/SortedSet.h"
 
+#include "CarlaRtThreadPool.hpp"
+
 namespace water {
 
 const int AudioProcessorGraph::midiChannelIndex = 0x1000;
@@ -29,6 +31,47 @@ const int AudioProcessorGraph::midiChannelIndex = 0x1000;
 namespace GraphRenderingOps
 {
 
+//==============================================================================
+/** The shared buffers touched by a rendering op.
+    Used to find out which parts of the rendering sequence can run concurrently.
+*/
+struct BufferUsage
+{
+    BufferUsage() noexcept : usesGraphIO (false) {}
+
+    void clear()
+    {
+        audioRead.clearQuick();
+        audioWritten.clearQuick();
+        midiRead.clearQuick();
+        midiWritten.clearQuick();
+        usesGraphIO = false;
+    }
+
+    bool conflictsWith (const BufferUsage& other) const
+    {
+        if (usesGraphIO && other.usesGraphIO)
+            return true;
+
+        return intersects (audioWritten, other.audioRead) || intersects (audioWritten, other.audioWritten)
+            || intersects (audioRead, other.audioWritten)
+            || intersects (midiWritten, other.midiRead) || intersects (midiWritten, other.midiWritten)
+            || intersects (midiRead, other.midiWritten);
+    }
+
+    static bool intersects (const Array<int>& a, const Array<int>& b)
+    {
+        for (int i = a.size(); --i >= 0;)
+            if (b.contains (a.getUnchecked (i)))
+                return true;
+
+        return false;
+    }
+
+    Array<int> audioRead, audioWritten, midiRead, midiWritten;
+    bool usesGraphIO;
+};
+
 struct AudioGraphRenderingOpBase
 {
     AudioGraphRenderingOpBase() noexcept {}
@@ -37,6 +80,10 @@ struct AudioGraphRenderingOpBase
     virtual void perform (AudioSampleBuffer& sharedBufferChans,
                           const OwnedArray<MidiBuffer>& sharedMidiBuffers,
                           const int numSamples) = 0;
+
+    virtual void addBufferUsage (BufferUsage& usage) const = 0;
+
+    virtual bool isProcessOp() const noexcept   { return false; }
 };
 
 // use CRTP
@@ -61,6 +108,11 @@ struct ClearChannelOp  : public AudioGraphRenderingOp<ClearChannelOp>
         sharedBufferChans.clear (channelNum, 0, numSamples);
     }
 
+    void addBufferUsage (BufferUsage& usage) const override
+    {
+        usage.audioWritten.addIfNotAlreadyThere (channelNum);
+    }
+
     const int channelNum;
 
     CARLA_DECLARE_NON_COPY_CLASS (ClearChannelOp)
@@ -78,6 +130,12 @@ struct CopyChannelOp  : public AudioGraphRenderingOp<CopyChannelOp>
         sharedBufferChans.copyFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
     }
 
+    void addBufferUsage (BufferUsage& usage) const override
+    {
+        usage.audioRead.addIfNotAlreadyThere (srcChannelNum);
+        usage.audioWritten.addIfNotAlreadyThere (dstChannelNum);
+    }
+
     const int srcChannelNum, dstChannelNum;
 
     CARLA_DECLARE_NON_COPY_CLASS (CopyChannelOp)
@@ -95,6 +153,12 @@ struct AddChannelOp  : public AudioGraphRenderingOp<AddChannelOp>
         sharedBufferChans.addFrom (dstChannelNum, 0, sharedBufferChans, srcChannelNum, 0, numSamples);
     }
 
+    void addBufferUsage (BufferUsage& usage) const override
+    {
+        usage.audioRead.addIfNotAlreadyThere (srcChannelNum);
+        usage.audioWritten.addIfNotAlreadyThere (dstChannelNum);
+    }
+
     const int srcChannelNum, dstChannelNum;
 
     CARLA_DECLARE_NON_COPY_CLASS (AddChannelOp)
@@ -110,6 +174,11 @@ struct ClearMidiBufferOp  : public AudioGraphRenderingOp<ClearMidiBufferOp>
         sharedMidiBuffers.getUnchecked (bufferNum)->clear();
     }
 
+    void addBufferUsage (BufferUsage& usage) const override
+    {
+        usage.midiWritten.addIfNotAlreadyThere (bufferNum);
+    }
+
     const int bufferNum;
 
     CARLA_DECLARE_NON_COPY_CLASS (ClearMidiBufferOp)
@@ -127,6 +196,12 @@ struct CopyMidiBufferOp  : public AudioGraphRenderingOp<CopyMidiBufferOp>
         *sharedMidiBuffers.getUnchecked (dstBufferNum) = *sharedMidiBuffers.getUnchecked (srcBufferNum);
     }
 
+    void addBufferUsage (BufferUsage& usage) const override
+    {
+        usage.midiRead.addIfNotAlreadyThere (srcBufferNum);
+        usage.midiWritten.addIfNotAlreadyThere (dstBufferNum);
+    }
+
     const int srcBufferNum, dstBufferNum;
 
     CARLA_DECLARE_NON_COPY_CLASS (CopyMidiBufferOp)
@@ -145,6 +220,12 @@ struct AddMidiBufferOp  : public AudioGraphRenderingOp<AddMidiBufferOp>
             ->addEvents (*sharedMidiBuffers.getUnchecked (srcBufferNum), 0, numSamples, 0);
     }
 
+    void addBufferUsage (BufferUsage& usage) const override
+    {
+        usage.midiRead.addIfNotAlreadyThere (srcBufferNum);
+        usage.midiWritten.addIfNotAlreadyThere (dstBufferNum);
+    }
+
     const int srcBufferNum, dstBufferNum;
 
     CARLA_DECLARE_NON_COPY_CLASS (AddMidiBufferOp)
@@ -176,6 +257,11 @@ struct DelayChannelOp  : public AudioGraphRenderingOp<DelayChannelOp>
         }
     }
 
+    void addBufferUsage (BufferUsage& usage) const override
+    {
+        usage.audioWritten.addIfNotAlreadyThere (channel);
+    }
+
 private:
     HeapBlock<float> buffer;
     const int channel, bufferSize;
@@ -229,6 +315,29 @@ struct ProcessBufferOp   : public AudioGraphRenderingOp<ProcessBufferOp>
         processor->processBlock (buffer, midiMessages);
     }
 
+    void addBufferUsage (BufferUsage& usage) const override
+    {
+        for (int i = totalChans; --i >= 0;)
+        {
+            const int bufIndex = audioChannelsToUse.getUnchecked (i);
+
+            usage.audioRead.addIfNotAlreadyThere (bufIndex);
+
+            // first buffer is read-only zeros
+            if (bufIndex != 0)
+                usage.audioWritten.addIfNotAlreadyThere (bufIndex);
+        }
+
+        usage.midiRead.addIfNotAlreadyThere (midiBufferToUse);
+        usage.midiWritten.addIfNotAlreadyThere (midiBufferToUse);
+
+        // graph I/O nodes share the graph input and output buffers
+        if (dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (processor) != nullptr)
+            usage.usesGraphIO = true;
+    }
+
+    bool isProcessOp() const noexcept override  { return true; }
+
     const AudioProcessorGraph::Node::Ptr node;
     AudioProcessor* const processor;
 
@@ -250,10 +359,12 @@ struct RenderingOpSequenceCalculator
 {
     RenderingOpSequenceCalculator (AudioProcessorGraph& g,
                                    const Array<AudioProcessorGraph::Node*>& nodes,
-                                   Array<void*>& renderingOps)
+                                   Array<void*>& renderingOps,
+                                   const bool forParallelRendering)
         : graph (g),
           orderedNodes (nodes),
-          totalLatency (0)
+          totalLatency (0),
+          neverReuseBuffers (forParallelRendering)
     {
         nodeIds.add ((uint32) zeroNodeID); // first buffer is read-only zeros
         channels.add (0);
@@ -287,6 +398,10 @@ private:
     Array<int> nodeDelays;
     int totalLatency;
 
+    // when rendering in parallel, every op gets its own buffers so that unrelated nodes
+    // don't end up depending on each other just because they shared a free buffer
+    const bool neverReuseBuffers;
+
     int getNodeDelay (const uint32 nodeID) const        { return nodeDelays [nodeDelayIDs.indexOf (nodeID)]; }
 
     void setNodeDelay (const uint32 nodeID, const int latency)
@@ -620,18 +735,20 @@ private:
     {
         if (forMidi)
         {
-            for (int i = 1; i < midiNodeIds.size(); ++i)
-                if (midiNodeIds.getUnchecked(i) == freeNodeID)
-                    return i;
+            if (! neverReuseBuffers)
+                for (int i = 1; i < midiNodeIds.size(); ++i)
+                    if (midiNodeIds.getUnchecked(i) == freeNodeID)
+                        return i;
 
             midiNodeIds.add ((uint32) freeNodeID);
             return midiNodeIds.size() - 1;
         }
         else
         {
-            for (int i = 1; i < nodeIds.size(); ++i)
-                if (nodeIds.getUnchecked(i) == freeNodeID)
-                    return i;
+            if (! neverReuseBuffers)
+                for (int i = 1; i < nodeIds.size(); ++i)
+                    if (nodeIds.getUnchecked(i) == freeNodeID)
+                        return i;
 
             nodeIds.add ((uint32) freeNodeID);
             channels.add (0);
@@ -740,6 +857,69 @@ private:
     CARLA_DECLARE_NON_COPY_CLASS (RenderingOpSequenceCalculator)
 };
 
+//==============================================================================
+/** The rendering sequence split into one job per node, plus the dependencies between them.
+
+    Each job contains the ops preparing the inputs of a node followed by the op that
+    processes it. Two jobs depend on each other when one of them writes a buffer that the
+    other one reads or writes, so running them respecting the dependencies gives the exact
+    same result as running the whole sequence in order.
+*/
+struct RenderingJobs
+{
+    explicit RenderingJobs (const Array<void*>& renderingOps)
+    {
+        OwnedArray<BufferUsage> usages;
+        BufferUsage* usage = nullptr;
+
+        for (int i = 0; i < renderingOps.size(); ++i)
+        {
+            const AudioGraphRenderingOpBase* const op = (const AudioGraphRenderingOpBase*) renderingOps.getUnchecked(i);
+
+            if (usage == nullptr)
+            {
+                usage = usages.add (new BufferUsage());
+                opStarts.add (i);
+            }
+
+            op->addBufferUsage (*usage);
+
+            if (op->isProcessOp())
+                usage = nullptr;
+        }
+
+        opStarts.add (renderingOps.size());
+
+        Array<uint> edgesFrom, edgesTo;
+
+        for (int i = 1; i < usages.size(); ++i)
+        {
+            for (int j = 0; j < i; ++j)
+            {
+                if (usages.getUnchecked(j)->conflictsWith (*usages.getUnchecked(i)))
+                {
+                    edgesFrom.add ((uint) j);
+                    edgesTo.add ((uint) i);
+                }
+            }
+        }
+
+        if (! graph.create ((uint) usages.size(), edgesFrom.getRawDataPointer(), edgesTo.getRawDataPointer(), (uint) edgesFrom.size()))
+            opStarts.clear();
+    }
+
+    bool isValid() const noexcept
+    {
+        return opStarts.size() > 0;
+    }
+
+    // index of the first op of each job, plus the end of the last one
+    Array<int> opStarts;
+    CarlaRtJobGraph graph;
+
+    CARLA_DECLARE_NON_COPY_CLASS (RenderingJobs)
+};
+
 //==============================================================================
 // Holds a fast lookup table for checking which nodes are inputs to others.
 class ConnectionLookupTable
@@ -948,15 +1128,78 @@ struct AudioProcessorGraph::AudioProcessorGraphBufferHelpers
     AudioSampleBuffer  currentAudioOutputBuffer;
 };
 
+//==============================================================================
+struct AudioProcessorGraph::AudioProcessorGraphParallelRenderer : public CarlaRtThreadPool::Callback
+{
+    AudioProcessorGraphParallelRenderer()
+        : pool ("AudioGraphWorker"),
+          jobs(),
+          currentOps (nullptr),
+          currentBuffers (nullptr),
+          currentMidiBuffers (nullptr),
+          currentNumSamples (0)
+    {
+    }
+
+    bool isEnabled() const noexcept
+    {
+        return pool.getNumWorkers() > 0;
+    }
+
+    bool canProcess() const noexcept
+    {
+        return jobs != nullptr && pool.getNumWorkers() > 0;
+    }
+
+    void process (const Array<void*>& ops, AudioSampleBuffer& buffers,
+                  const OwnedArray<MidiBuffer>& midiBuffers, const int numSamples)
+    {
+        currentOps = &ops;
+        currentBuffers = &buffers;
+        currentMidiBuffers = &midiBuffers;
+        currentNumSamples = numSamples;
+
+        pool.process (jobs->graph, this);
+
+        currentOps = nullptr;
+        currentBuffers = nullptr;
+        currentMidiBuffers = nullptr;
+    }
+
+    void runJob (const uint index) override
+    {
+        for (int i = jobs->opStarts.getUnchecked ((int) index), end = jobs->opStarts.getUnchecked ((int) index + 1); i < end; ++i)
+        {
+            GraphRenderingOps::AudioGraphRenderingOpBase* const op
+                = (GraphRenderingOps::AudioGraphRenderingOpBase*) currentOps->getUnchecked(i);
+
+            op->perform (*currentBuffers, *currentMidiBuffers, currentNumSamples);
+        }
+    }
+
+    CarlaRtThreadPool pool;
+    ScopedPointer<GraphRenderingOps::RenderingJobs> jobs;
+
+private:
+    const Array<void*>* currentOps;
+    AudioSampleBuffer* currentBuffers;
+    const OwnedArray<MidiBuffer>* currentMidiBuffers;
+    int currentNumSamples;
+
+    CARLA_DECLARE_NON_COPY_CLASS (AudioProcessorGraphParallelRenderer)
+};
+
 //==============================================================================
 AudioProcessorGraph::AudioProcessorGraph()
     : lastNodeId (0), audioBuffers (new AudioProcessorGraphBufferHelpers),
+      parallelRenderer (new AudioProcessorGraphParallelRenderer),
       currentMidiInputBuffer (nullptr), isPrepared (false), needsReorder (false)
 {
 }
 
 AudioProcessorGraph::~AudioProcessorGraph()
 {
+    parallelRenderer->pool.stop();
     clearRenderingSequence();
     clear();
 }
@@ -1207,10 +1450,12 @@ static void deleteRenderOpArray (Array<void*>& ops)
 void AudioProcessorGraph::clearRenderingSequence()
 {
     Array<void*> oldOps;
+    ScopedPointer<GraphRenderingOps::RenderingJobs> oldJobs;
 
     {
         const CarlaRecursiveMutexLocker cml (getCallbackLock());
         renderingOps.swapWith (oldOps);
+        parallelRenderer->jobs.swapWith (oldJobs);
     }
 
     deleteRenderOpArray (oldOps);
@@ -1239,6 +1484,7 @@ bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
 void AudioProcessorGraph::buildRenderingSequence()
 {
     Array<void*> newRenderingOps;
+    ScopedPointer<GraphRenderingOps::RenderingJobs> newRenderingJobs;
     int numRenderingBuffersNeeded = 2;
     int numMidiBuffersNeeded = 1;
 
@@ -1265,10 +1511,20 @@ void AudioProcessorGraph::buildRenderingSequence()
             }
         }
 
-        GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, newRenderingOps);
+        const bool parallel = parallelRenderer->isEnabled();
+
+        GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, newRenderingOps, parallel);
 
         numRenderingBuffersNeeded = calculator.getNumBuffersNeeded();
         numMidiBuffersNeeded = calculator.getNumMidiBuffersNeeded();
+
+        if (parallel)
+        {
+            newRenderingJobs = new GraphRenderingOps::RenderingJobs (newRenderingOps);
+
+            if (! newRenderingJobs->isValid())
+                newRenderingJobs = nullptr;
+        }
     }
 
     {
@@ -1284,6 +1540,7 @@ void AudioProcessorGraph::buildRenderingSequence()
             midiBuffers.add (new MidiBuffer());
 
         renderingOps.swapWith (newRenderingOps);
+        parallelRenderer->jobs.swapWith (newRenderingJobs);
     }
 
     // delete the old ones..
@@ -1350,12 +1607,19 @@ void AudioProcessorGraph::processAudio (AudioSampleBuffer& buffer, MidiBuffer& m
     currentMidiInputBuffer = &midiMessages;
     currentMidiOutputBuffer.clear();
 
-    for (int i = 0; i < renderingOps.size(); ++i)
+    if (parallelRenderer->canProcess())
+    {
+        parallelRenderer->process (renderingOps, renderingBuffers, midiBuffers, numSamples);
+    }
+    else
     {
-        GraphRenderingOps::AudioGraphRenderingOpBase* const op
-            = (GraphRenderingOps::AudioGraphRenderingOpBase*) renderingOps.getUnchecked(i);
+        for (int i = 0; i < renderingOps.size(); ++i)
+        {
+            GraphRenderingOps::AudioGraphRenderingOpBase* const op
+                = (GraphRenderingOps::AudioGraphRenderingOpBase*) renderingOps.getUnchecked(i);
 
-        op->perform (renderingBuffers, midiBuffers, numSamples);
+            op->perform (renderingBuffers, midiBuffers, numSamples);
+        }
     }
 
     for (int i = 0; i < buffer.getNumChannels(); ++i)
@@ -1373,6 +1637,27 @@ void AudioProcessorGraph::processBlock (AudioSampleBuffer& buffer, MidiBuffer& m
     processAudio (buffer, midiMessages);
 }
 
+void AudioProcessorGraph::setNumWorkerThreads (const int numThreads)
+{
+    CARLA_SAFE_ASSERT_RETURN (numThreads >= 0,);
+
+    if (numThreads == getNumWorkerThreads())
+        return;
+
+    // drop the current jobs first, so that nothing uses the pool while it restarts
+    clearRenderingSequence();
+
+    parallelRenderer->pool.start ((uint) numThreads);
+
+    if (isPrepared)
+        buildRenderingSequence();
+}
+
+int AudioProcessorGraph::getNumWorkerThreads() const noexcept
+{
+    return (int) parallelRenderer->pool.getNumWorkers();
+}
+
 void AudioProcessorGraph::reorderNowIfNeeded()
 {
     if (needsReorder)
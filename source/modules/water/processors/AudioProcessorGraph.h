@@ -347,6 +347,21 @@ public:
 
     void reorderNowIfNeeded();
 
+    //==============================================================================
+    /** Sets the number of extra threads used to render the graph.
+
+        With a value greater than 0, nodes that do not depend on each other are
+        processed concurrently, the thread calling processBlock() taking part in
+        the work as well. 0 (the default) renders everything in order on the
+        calling thread.
+
+        Must not be called while processing.
+    */
+    void setNumWorkerThreads (int numThreads);
+
+    /** Returns the number of extra threads used to render the graph. */
+    int getNumWorkerThreads() const noexcept;
+
 private:
     //==============================================================================
     void processAudio (AudioSampleBuffer& buffer, MidiBuffer& midiMessages);
@@ -362,6 +377,9 @@ private:
     struct AudioProcessorGraphBufferHelpers;
     ScopedPointer<AudioProcessorGraphBufferHelpers> audioBuffers;
 
+    struct AudioProcessorGraphParallelRenderer;
+    ScopedPointer<AudioProcessorGraphParallelRenderer> parallelRenderer;
+
     MidiBuffer* currentMidiInputBuffer;
     MidiBuffer currentMidiOutputBuffer;
 
@@ -20,6 +20,11 @@
 
 #include "CarlaThread.hpp"
 #include "CarlaMathUtils.hpp"
+#include "CarlaMutex.hpp"
+#include "CarlaSemUtils.hpp"
+#include "CarlaString.hpp"
+#include "CarlaTimeUtils.hpp"
+#include "LinkedList.hpp"
 
 extern "C" {
 #include "audio_decoder/ad.h"
@@ -27,80 +32,257 @@ extern "C" {
 
 typedef struct adinfo ADInfo;
 
-struct AudioFilePool {
-    float*   buffer[2];
-    uint32_t startFrame;
+// -----------------------------------------------------------------------
+// Ring of decoded, interleaved audio frames.
+// The disk thread is the only writer and the audio thread the only reader, so no locks are needed.
+// One frame is always kept free, so that readPos == writePos means empty.
+
+struct AudioFileRing {
+    float*   buffer;
+    uint32_t channels;
     uint32_t size;
+    volatile uint32_t readPos;
+    volatile uint32_t writePos;
+
+    AudioFileRing()
+        : buffer(nullptr),
+          channels(0),
+          size(0),
+          readPos(0),
+          writePos(0) {}
 
-#ifdef CARLA_PROPER_CPP11_SUPPORT
-    AudioFilePool()
-        : buffer{nullptr},
-          startFrame(0),
-          size(0) {}
-#else
-    AudioFilePool()
-        : startFrame(0),
-          size(0)
+    ~AudioFileRing()
     {
-        buffer[0] = buffer[1] = nullptr;
+        CARLA_SAFE_ASSERT(buffer == nullptr);
     }
-#endif
 
-    ~AudioFilePool()
+    void create(const uint32_t numChannels, const uint32_t numFrames)
     {
-        CARLA_ASSERT(buffer[0] == nullptr);
-        CARLA_ASSERT(buffer[1] == nullptr);
-        CARLA_ASSERT(startFrame == 0);
-        CARLA_ASSERT(size == 0);
+        CARLA_SAFE_ASSERT_RETURN(buffer == nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(numChannels > 0 && numFrames > 1,);
+
+        buffer   = new float[numChannels*numFrames];
+        channels = numChannels;
+        size     = numFrames;
+        readPos  = writePos = 0;
+
+        carla_zeroFloats(buffer, numChannels*numFrames);
     }
 
-    void create(const uint32_t sampleRate)
+    void destroy()
     {
-        CARLA_ASSERT(buffer[0] == nullptr);
-        CARLA_ASSERT(buffer[1] == nullptr);
-        CARLA_ASSERT(startFrame == 0);
-        CARLA_ASSERT(size == 0);
+        if (buffer != nullptr)
+        {
+            delete[] buffer;
+            buffer = nullptr;
+        }
 
-        size = sampleRate * 2;
+        channels = 0;
+        size     = 0;
+        readPos  = writePos = 0;
+    }
 
-        buffer[0] = new float[size];
-        buffer[1] = new float[size];
+    uint32_t getReadableFrames() const noexcept
+    {
+        const uint32_t r(readPos), w(writePos);
+        return (w >= r) ? w - r : size - r + w;
+    }
 
-        reset();
+    uint32_t getWritableFrames() const noexcept
+    {
+        return size - 1 - getReadableFrames();
     }
 
-    void destroy()
+    // writer side, reserve a contiguous area for up to maxFrames
+    float* getWriteArea(const uint32_t maxFrames, uint32_t& frames) const noexcept
+    {
+        const uint32_t w(writePos);
+
+        frames = std::min(std::min(maxFrames, getWritableFrames()), size - w);
+        return buffer + w*channels;
+    }
+
+    void commitWrite(const uint32_t frames) noexcept
+    {
+        // make sure the data is in place before the reader sees it
+        __sync_synchronize();
+        writePos = (writePos + frames) % size;
+    }
+
+    void commitRead(const uint32_t frames) noexcept
+    {
+        __sync_synchronize();
+        readPos = (readPos + frames) % size;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(AudioFileRing)
+};
+
+// -----------------------------------------------------------------------
+// Fold interleaved frames into 2 output channels.
+// Mono goes to both sides, extra channels are mixed into left and right alternately.
+
+static inline
+void carla_audiofile_fold_frames(float* const out1, float* const out2,
+                                 const float* const data, const uint32_t channels, const uint32_t frames) noexcept
+{
+    switch (channels)
     {
-        CARLA_ASSERT(buffer[0] != nullptr);
-        CARLA_ASSERT(buffer[1] != nullptr);
-        CARLA_ASSERT(size != 0);
+    case 1:
+        carla_copyFloats(out1, data, frames);
+        carla_copyFloats(out2, data, frames);
+        break;
+
+    case 2:
+        for (uint32_t i=0; i < frames; ++i)
+        {
+            out1[i] = data[i*2];
+            out2[i] = data[i*2+1];
+        }
+        break;
+
+    default: {
+        const float gain(2.0f / static_cast<float>(channels));
+
+        for (uint32_t i=0; i < frames; ++i)
+        {
+            const float* const frameData(data + i*channels);
+            float left = 0.0f, right = 0.0f;
+
+            for (uint32_t c=0; c < channels; c += 2)
+                left += frameData[c];
+            for (uint32_t c=1; c < channels; c += 2)
+                right += frameData[c];
+
+            out1[i] = left * gain;
+            out2[i] = right * gain;
+        }
+    }   break;
+    }
+}
+
+// -----------------------------------------------------------------------
+// Fully decoded audio files, shared between all plugin instances playing the same file.
+
+struct AudioFileCacheEntry {
+    CarlaString filename;
+    float*   data;
+    uint32_t channels;
+    uint32_t frames;
+    uint32_t refCount;
+
+    AudioFileCacheEntry(const char* const fname, const uint32_t numChannels, const uint32_t numFrames)
+        : filename(fname),
+          data(new float[numChannels*numFrames]),
+          channels(numChannels),
+          frames(numFrames),
+          refCount(1) {}
+
+    ~AudioFileCacheEntry()
+    {
+        delete[] data;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(AudioFileCacheEntry)
+};
+
+class AudioFileCache
+{
+public:
+    /*
+     * Get the decoded data for an already opened file, decoding it if no other instance did it yet.
+     * Must be matched by a call to release().
+     */
+    static const AudioFileCacheEntry* acquire(const char* const filename, void* const filePtr, const ADInfo& nfo)
+    {
+        CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filePtr != nullptr, nullptr);
+        CARLA_SAFE_ASSERT_RETURN(nfo.channels > 0 && nfo.frames > 0, nullptr);
+
+        const uint32_t channels(nfo.channels);
+        const uint32_t frames(static_cast<uint32_t>(nfo.frames));
 
-        if (buffer[0] != nullptr)
+        const CarlaMutexLocker cml(getMutex());
+
+        for (LinkedList<AudioFileCacheEntry*>::Itenerator it = getEntries().begin2(); it.valid(); it.next())
         {
-            delete[] buffer[0];
-            buffer[0] = nullptr;
+            AudioFileCacheEntry* const entry(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(entry != nullptr);
+
+            if (entry->channels != channels || entry->frames != frames || entry->filename != filename)
+                continue;
+
+            ++entry->refCount;
+            return entry;
         }
 
-        if (buffer[1] != nullptr)
+        AudioFileCacheEntry* entry;
+
+        try {
+            entry = new AudioFileCacheEntry(filename, channels, frames);
+        } CARLA_SAFE_EXCEPTION_RETURN("AudioFileCacheEntry", nullptr);
+
+        // decode the whole file in one go
+        const std::size_t numSamples(static_cast<std::size_t>(channels)*frames);
+        std::size_t done = 0;
+
+        ad_seek(filePtr, 0);
+
+        for (ssize_t rv; done < numSamples; done += static_cast<std::size_t>(rv))
         {
-            delete[] buffer[1];
-            buffer[1] = nullptr;
+            rv = ad_read(filePtr, entry->data + done, numSamples - done);
+
+            if (rv <= 0)
+                break;
         }
 
-        startFrame = 0;
-        size = 0;
+        if (done < numSamples)
+            carla_zeroFloats(entry->data + done, numSamples - done);
+
+        getEntries().append(entry);
+        return entry;
     }
 
-    void reset()
+    static void release(const AudioFileCacheEntry* const entry)
     {
-        startFrame = 0;
-        CARLA_SAFE_ASSERT_RETURN(size != 0,);
+        CARLA_SAFE_ASSERT_RETURN(entry != nullptr,);
+
+        const CarlaMutexLocker cml(getMutex());
+
+        for (LinkedList<AudioFileCacheEntry*>::Itenerator it = getEntries().begin2(); it.valid(); it.next())
+        {
+            AudioFileCacheEntry* const entry2(it.getValue(nullptr));
+
+            if (entry2 != entry)
+                continue;
+
+            if (--entry2->refCount == 0)
+            {
+                getEntries().remove(it);
+                delete entry2;
+            }
+
+            return;
+        }
+
+        carla_safe_assert("entry in cache", __FILE__, __LINE__);
+    }
+
+private:
+    static CarlaMutex& getMutex() noexcept
+    {
+        static CarlaMutex mutex;
+        return mutex;
+    }
 
-        carla_zeroFloats(buffer[0], size);
-        carla_zeroFloats(buffer[1], size);
+    static LinkedList<AudioFileCacheEntry*>& getEntries() noexcept
+    {
+        static LinkedList<AudioFileCacheEntry*> entries;
+        return entries;
     }
 };
 
+// -----------------------------------------------------------------------
+
 class AbstractAudioPlayer
 {
 public:
@@ -108,15 +290,34 @@ public:
     virtual uint32_t getLastFrame() const = 0;
 };
 
+// -----------------------------------------------------------------------
+// Streams an audio file from disk into a ring buffer.
+// The audio thread asks for a seek whenever playback jumps, and wakes up the disk thread as it consumes frames.
+// Short files are instead decoded once into the shared cache and played straight from memory.
+
 class AudioFileThread : public CarlaThread
 {
 public:
     AudioFileThread(AbstractAudioPlayer* const player, const double sampleRate)
         : CarlaThread("AudioFileThread"),
           kPlayer(player),
-          fNeedsRead(false),
-          fQuitNow(true),
-          fFilePtr(nullptr)
+          kRingFrames(static_cast<uint32_t>(sampleRate) * 2),
+          fFilePtr(nullptr),
+          fCacheEntry(nullptr),
+          fRing(),
+          fRingMutex(),
+          fSemaphore(),
+          fSemaphoreValid(false),
+          fWakeUpPending(0),
+          fSeekFrame(0),
+          fSeekRequest(0),
+          fSeekDone(0),
+          fDiskFrame(0),
+          fRingFrame(0),
+          fSeekTime(0),
+          fSeekLatency(0),
+          fMeasureSeekLatency(false),
+          fReportSeekLatency(0)
     {
         CARLA_ASSERT(kPlayer != nullptr);
 
@@ -130,46 +331,58 @@ public:
 
         ad_clear_nfo(&fFileNfo);
 
-        fPool.create(sampleRate);
+        fSemaphoreValid = carla_sem_create2(fSemaphore);
     }
 
     ~AudioFileThread() override
     {
-        CARLA_ASSERT(fQuitNow);
         CARLA_ASSERT(! isThreadRunning());
 
         if (fFilePtr != nullptr)
             ad_close(fFilePtr);
 
-        fPool.destroy();
+        if (fCacheEntry != nullptr)
+            AudioFileCache::release(fCacheEntry);
+
+        fRing.destroy();
+
+        if (fSemaphoreValid)
+            carla_sem_destroy2(fSemaphore);
     }
 
     void startNow()
     {
-        fNeedsRead = true;
-        fQuitNow = false;
+        // nothing to stream
+        if (fCacheEntry != nullptr)
+            return;
+
+        // initial read position, handled by the disk thread as a regular seek
+        fSeekFrame  = kPlayer->getLastFrame();
+        fRingFrame  = fSeekFrame;
+        fDiskFrame  = fSeekFrame;
+        fMeasureSeekLatency = false;
+        fSeekDone   = __sync_add_and_fetch(&fSeekRequest, 1) - 1;
+
         startThread();
+        wakeUp();
     }
 
     void stopNow()
     {
-        fNeedsRead = false;
-        fQuitNow = true;
-
+        signalThreadShouldExit();
+        wakeUp();
         stopThread(1000);
-
-        const CarlaMutexLocker cml(fMutex);
-        fPool.reset();
     }
 
     uint32_t getMaxFrame() const
     {
-        return fFileNfo.frames > 0 ? fFileNfo.frames : 0;
+        return fFileNfo.frames > 0 ? static_cast<uint32_t>(fFileNfo.frames) : 0;
     }
 
-    void setNeedsRead()
+    // time between the audio thread asking for a new position and the first frame of it being played, in milliseconds
+    double getLastSeekLatency() const noexcept
     {
-        fNeedsRead = true;
+        return static_cast<double>(fSeekLatency) / 1000.0;
     }
 
     bool loadFilename(const char* const filename)
@@ -177,7 +390,7 @@ public:
         CARLA_ASSERT(! isThreadRunning());
         CARLA_ASSERT(filename != nullptr);
 
-        fPool.startFrame = 0;
+        const CarlaMutexLocker cml(fRingMutex);
 
         // clear old data
         if (fFilePtr != nullptr)
@@ -186,6 +399,13 @@ public:
             fFilePtr = nullptr;
         }
 
+        if (fCacheEntry != nullptr)
+        {
+            AudioFileCache::release(fCacheEntry);
+            fCacheEntry = nullptr;
+        }
+
+        fRing.destroy();
         ad_clear_nfo(&fFileNfo);
 
         // open new
@@ -199,10 +419,22 @@ public:
         if (fFileNfo.frames == 0)
             carla_stderr("L: filename \"%s\" has 0 frames", filename);
 
-        if ((fFileNfo.channels == 1 || fFileNfo.channels == 2) && fFileNfo.frames > 0)
+        if (fFileNfo.channels > 0 && fFileNfo.frames > 0)
         {
-            // valid
-            readPoll();
+            // valid, keep short files fully in memory
+            if (fFileNfo.frames <= static_cast<int64_t>(fFileNfo.sample_rate) * kMaxPreloadSeconds)
+            {
+                fCacheEntry = AudioFileCache::acquire(filename, fFilePtr, fFileNfo);
+
+                if (fCacheEntry != nullptr)
+                {
+                    ad_close(fFilePtr);
+                    fFilePtr = nullptr;
+                    return true;
+                }
+            }
+
+            fRing.create(fFileNfo.channels, kRingFrames);
             return true;
         }
         else
@@ -215,173 +447,241 @@ public:
         }
     }
 
-    void tryPutData(AudioFilePool& pool)
-    {
-        CARLA_ASSERT(pool.size == fPool.size);
-
-        if (pool.size != fPool.size)
-            return;
-        if (! fMutex.tryLock())
-            return;
+    // -------------------------------------------------------------------
+    // audio thread side
 
-        //if (pool.startFrame != fPool.startFrame || pool.buffer[0] != fPool.buffer[0] || pool.buffer[1] != fPool.buffer[1])
+    /*
+     * Get @a frames of audio starting at file position @a frame, folded into 2 output channels.
+     * Outputs silence while the disk thread has not caught up with the requested position.
+     */
+    void readFrames(float* const out1, float* const out2, const uint32_t frame, const uint32_t frames) noexcept
+    {
+        if (! fRingMutex.tryLock())
         {
-            pool.startFrame = fPool.startFrame;
-            carla_copyFloats(pool.buffer[0], fPool.buffer[0], fPool.size);
-            carla_copyFloats(pool.buffer[1], fPool.buffer[1], fPool.size);
+            carla_zeroFloats(out1, frames);
+            carla_zeroFloats(out2, frames);
+            return;
         }
 
-        fMutex.unlock();
-    }
+        uint32_t done = 0;
 
-    void readPoll()
-    {
-        if (fFileNfo.frames <= 0 || fFilePtr == nullptr)
+        if (fCacheEntry != nullptr)
         {
-            carla_stderr("R: no song loaded");
-            fNeedsRead = false;
-            return;
+            if (frame < fCacheEntry->frames)
+            {
+                done = std::min(frames, fCacheEntry->frames - frame);
+                carla_audiofile_fold_frames(out1, out2, fCacheEntry->data + frame*fCacheEntry->channels, fCacheEntry->channels, done);
+            }
         }
+        else if (fRing.buffer != nullptr && fSeekDone == fSeekRequest)
+        {
+            const uint32_t readable(fRing.getReadableFrames());
 
-        int64_t lastFrame = kPlayer->getLastFrame();
-        int64_t readFrame = lastFrame;
-        int64_t maxFrame  = fFileNfo.frames;
+            // pairs with commitWrite(), only read the data after loading the write position
+            __sync_synchronize();
 
-        if (lastFrame >= maxFrame)
-        {
-#if 0
-            if (false)
-            //if (handlePtr->loopMode)
+            if (frame < fRingFrame || frame > fRingFrame + readable)
             {
-                carla_stderr("R: DEBUG read loop, lastFrame:%i, maxFrame:%i", lastFrame, maxFrame);
+                // position jumped, or we ran out of data
+                requestSeek(frame);
+            }
+            else
+            {
+                // skip what we do not need, then read what is there
+                if (const uint32_t skip = frame - fRingFrame)
+                    fRing.commitRead(skip);
 
-                if (maxFrame >= static_cast<int64_t>(fPool.size))
-                {
-                    readFrame %= maxFrame;
-                }
-                else
+                done = std::min(frames, readable - (frame - fRingFrame));
+
+                if (done > 0)
+                    copyFrames(out1, out2, done);
+
+                fRingFrame = frame + done;
+
+                if (done > 0 && fMeasureSeekLatency)
                 {
-                    readFrame  = 0;
-                    lastFrame -= lastFrame % maxFrame;
+                    fSeekLatency = carla_gettime_us() - fSeekTime;
+                    fMeasureSeekLatency = false;
+                    fReportSeekLatency = 1;
                 }
+
+                // read-ahead is driven by consumption, wake up the disk thread once a quarter of the ring is free
+                if (fRing.getWritableFrames() >= fRing.size/4)
+                    wakeUp();
+            }
+        }
+
+        fRingMutex.unlock();
+
+        if (done < frames)
+        {
+            carla_zeroFloats(out1 + done, frames - done);
+            carla_zeroFloats(out2 + done, frames - done);
+        }
+    }
+
+protected:
+    void run() override
+    {
+        while (! shouldThreadExit())
+        {
+            if (fSemaphoreValid)
+            {
+                if (carla_sem_timedwait(fSemaphore, 500, true))
+                    __sync_bool_compare_and_swap(&fWakeUpPending, 1, 0);
             }
             else
-#endif
             {
-                carla_stderr("R: transport out of bounds");
-                fNeedsRead = false;
-                return;
+                carla_msleep(50);
             }
+
+            if (shouldThreadExit())
+                break;
+
+            if (fReportSeekLatency != 0)
+            {
+                fReportSeekLatency = 0;
+                carla_debug("AudioFileThread: seek to frame %u played after %.2f ms", fSeekFrame, getLastSeekLatency());
+            }
+
+            readAhead();
         }
+    }
+
+private:
+    AbstractAudioPlayer* const kPlayer;
+    const uint32_t kRingFrames;
+
+    void*  fFilePtr;
+    ADInfo fFileNfo;
+
+    // files up to this length are decoded into the shared cache instead of streamed
+    static const int64_t kMaxPreloadSeconds = 60;
+    const AudioFileCacheEntry* fCacheEntry;
+
+    // ring data is lock-free, the mutex only protects against the ring being reallocated while in use
+    AudioFileRing fRing;
+    CarlaMutex    fRingMutex;
+
+    carla_sem_t fSemaphore;
+    bool        fSemaphoreValid;
+    int         fWakeUpPending;
+
+    // seek requests from the audio thread, fSeekRequest != fSeekDone means the disk thread has not handled it yet
+    volatile uint32_t fSeekFrame;
+    volatile int      fSeekRequest;
+    volatile int      fSeekDone;
+
+    // file position of the next frame to decode (disk thread) and of the next frame to play (audio thread)
+    uint32_t fDiskFrame;
+    uint32_t fRingFrame;
+
+    // seek latency measurement
+    uint64_t fSeekTime;
+    volatile uint64_t fSeekLatency;
+    bool     fMeasureSeekLatency;
+    volatile int fReportSeekLatency;
+
+    void wakeUp() noexcept
+    {
+        // post only once until the thread wakes up, the semaphore cannot count past 1
+        if (fSemaphoreValid && __sync_bool_compare_and_swap(&fWakeUpPending, 0, 1))
+            carla_sem_post(fSemaphore, true);
+    }
+
+    void requestSeek(const uint32_t frame) noexcept
+    {
+        fSeekFrame  = frame;
+        fRingFrame  = frame;
+        fSeekTime   = carla_gettime_us();
+        fMeasureSeekLatency = true;
+
+        __sync_synchronize();
+        __sync_add_and_fetch(&fSeekRequest, 1);
 
-        // temp data buffer
-        const size_t tmpSize = fPool.size * fFileNfo.channels;
+        wakeUp();
+    }
+
+    void copyFrames(float* const out1, float* const out2, const uint32_t frames) noexcept
+    {
+        const uint32_t pos(fRing.readPos);
+        const uint32_t firstPart(std::min(frames, fRing.size - pos));
 
-        float tmpData[tmpSize];
-        carla_zeroFloats(tmpData, tmpSize);
+        carla_audiofile_fold_frames(out1, out2, fRing.buffer + pos*fRing.channels, fRing.channels, firstPart);
+
+        if (firstPart < frames)
+            carla_audiofile_fold_frames(out1 + firstPart, out2 + firstPart, fRing.buffer, fRing.channels, frames - firstPart);
+
+        fRing.commitRead(frames);
+    }
+
+    // decode into the ring until it is full, handling new seek requests first
+    void readAhead()
+    {
+        if (fFilePtr == nullptr || fRing.buffer == nullptr)
+            return;
 
+        const uint32_t maxFrame(getMaxFrame());
+        const uint32_t chunkFrames(std::max(fRing.size/16, 1U));
+
+        for (bool seekPending = false; ! shouldThreadExit();)
         {
-            carla_stderr("R: poll data - reading at %li:%02li", readFrame/44100/60, (readFrame/44100) % 60);
+            const int seekRequest(fSeekRequest);
+
+            if (seekRequest != fSeekDone)
+            {
+                __sync_synchronize();
 
-            ad_seek(fFilePtr, readFrame);
-            ssize_t i, j, rv = ad_read(fFilePtr, tmpData, tmpSize);
-            i = j = 0;
+                // the audio thread does not touch the ring until we acknowledge the seek
+                fRing.readPos = fRing.writePos = 0;
+                fDiskFrame = fSeekFrame;
+
+                if (fDiskFrame < maxFrame)
+                    ad_seek(fFilePtr, fDiskFrame);
+
+                seekPending = true;
+            }
 
-            // lock, and put data asap
-            const CarlaMutexLocker cml(fMutex);
+            uint32_t frames = 0;
 
-            for (; i < fPool.size && j < rv; ++j)
+            // wait until there is room for a full chunk, unless close to the end of the file
+            if (fDiskFrame < maxFrame && fRing.getWritableFrames() >= std::min(chunkFrames, maxFrame - fDiskFrame))
             {
-                if (fFileNfo.channels == 1)
-                {
-                    fPool.buffer[0][i] = tmpData[j];
-                    fPool.buffer[1][i] = tmpData[j];
-                    i++;
-                }
-                else
+                float* const data(fRing.getWriteArea(std::min(chunkFrames, maxFrame - fDiskFrame), frames));
+
+                if (frames > 0)
                 {
-                    if (j % 2 == 0)
+                    const ssize_t rv(ad_read(fFilePtr, data, frames*fRing.channels));
+
+                    if (rv > 0)
                     {
-                        fPool.buffer[0][i] = tmpData[j];
+                        frames = static_cast<uint32_t>(rv) / fRing.channels;
+                        fRing.commitWrite(frames);
+                        fDiskFrame += frames;
                     }
                     else
                     {
-                        fPool.buffer[1][i] = tmpData[j];
-                        i++;
+                        // decoder gave up early, treat as end of file
+                        frames = 0;
+                        fDiskFrame = maxFrame;
                     }
                 }
             }
 
-#if 0
-            if (false)
-            //if (handlePtr->loopMode && i < fPool.size)
-            {
-                while (i < fPool.size)
-                {
-                    for (j=0; i < fPool.size && j < rv; ++j)
-                    {
-                        if (fFileNfo.channels == 1)
-                        {
-                            fPool.buffer[0][i] = tmpData[j];
-                            fPool.buffer[1][i] = tmpData[j];
-                            i++;
-                        }
-                        else
-                        {
-                            if (j % 2 == 0)
-                            {
-                                fPool.buffer[0][i] = tmpData[j];
-                            }
-                            else
-                            {
-                                fPool.buffer[1][i] = tmpData[j];
-                                i++;
-                            }
-                        }
-                    }
-                }
-            }
-            else
-#endif
+            if (seekPending)
             {
-                for (; i < fPool.size; ++i)
-                {
-                    fPool.buffer[0][i] = 0.0f;
-                    fPool.buffer[1][i] = 0.0f;
-                }
+                // let the audio thread play as soon as the first chunk is in
+                __sync_synchronize();
+                fSeekDone = seekRequest;
+                seekPending = false;
             }
 
-            fPool.startFrame = lastFrame;
+            if (frames == 0 && fSeekRequest == fSeekDone)
+                break;
         }
-
-        fNeedsRead = false;
     }
 
-protected:
-    void run() override
-    {
-        while (! fQuitNow)
-        {
-            const uint32_t lastFrame(kPlayer->getLastFrame());
-
-            if (fNeedsRead || lastFrame < fPool.startFrame || (lastFrame - fPool.startFrame >= fPool.size*3/4 && lastFrame < fFileNfo.frames))
-                readPoll();
-            else
-                carla_msleep(50);
-        }
-    }
-
-private:
-    AbstractAudioPlayer* const kPlayer;
-
-    bool fNeedsRead;
-    bool fQuitNow;
-
-    void*  fFilePtr;
-    ADInfo fFileNfo;
-
-    AudioFilePool fPool;
-    CarlaMutex    fMutex;
+    CARLA_DECLARE_NON_COPY_CLASS(AudioFileThread)
 };
 
 #endif // AUDIO_BASE_HPP_INCLUDED
@@ -33,14 +33,10 @@ public:
           fDoProcess(false),
           fLastFrame(0),
           fMaxFrame(0),
-          fThread(this, getSampleRate())
-    {
-        fPool.create(getSampleRate());
-    }
+          fThread(this, getSampleRate()) {}
 
     ~AudioFilePlugin() override
     {
-        fPool.destroy();
         fThread.stopNow();
     }
 
@@ -102,7 +98,6 @@ protected:
             return;
 
         fLoopMode = b;
-        fThread.setNeedsRead();
     }
 
     void setCustomData(const char* const key, const char* const value) override
@@ -137,51 +132,23 @@ protected:
         {
             //carla_stderr("P: not playing");
             fLastFrame = timePos->frame;
-
-            if (timePos->frame == 0 && fLastFrame > 0)
-                fThread.setNeedsRead();
-
             carla_zeroFloats(out1, frames);
             carla_zeroFloats(out2, frames);
             return;
         }
 
-        fThread.tryPutData(fPool);
-
         // out of reach
-        if (timePos->frame + frames < fPool.startFrame || timePos->frame >= fMaxFrame) /*&& ! loopMode)*/
+        if (timePos->frame >= fMaxFrame) /*&& ! loopMode)*/
         {
             //carla_stderr("P: out of reach");
             fLastFrame = timePos->frame;
-
-            if (timePos->frame + frames < fPool.startFrame)
-                fThread.setNeedsRead();
-
             carla_zeroFloats(out1, frames);
             carla_zeroFloats(out2, frames);
             return;
         }
 
-        int64_t poolFrame = (int64_t)timePos->frame - fPool.startFrame;
-        int64_t poolSize  = fPool.size;
-
-        for (uint32_t i=0; i < frames; ++i, ++poolFrame)
-        {
-            if (poolFrame >= 0 && poolFrame < poolSize)
-            {
-                out1[i] = fPool.buffer[0][poolFrame];
-                out2[i] = fPool.buffer[1][poolFrame];
-
-                // reset
-                fPool.buffer[0][poolFrame] = 0.0f;
-                fPool.buffer[1][poolFrame] = 0.0f;
-            }
-            else
-            {
-                out1[i] = 0.0f;
-                out2[i] = 0.0f;
-            }
-        }
+        // the disk thread takes care of seeking when the position jumps
+        fThread.readFrames(out1, out2, static_cast<uint32_t>(timePos->frame), frames);
 
         fLastFrame = timePos->frame;
     }
@@ -207,7 +174,6 @@ private:
     uint32_t fLastFrame;
     uint32_t fMaxFrame;
 
-    AudioFilePool   fPool;
     AudioFileThread fThread;
 
     void loadFilename(const char* const filename)
@@ -20,11 +20,13 @@
 
 #include "CarlaMIDI.h"
 #include "CarlaMutex.hpp"
-#include "LinkedList.hpp"
 
 #include "CarlaJuceUtils.hpp"
 #include "CarlaMathUtils.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 // -----------------------------------------------------------------------
 
 #define MAX_EVENT_DATA_SIZE          4
@@ -58,7 +60,11 @@ public:
           fMidiPort(0),
           fStartTime(0),
           fMutex(),
-          fData()
+          fData(nullptr),
+          fDataCount(0),
+          fDataSize(0),
+          fCursor(0),
+          fCursorTime(-1.0L)
     {
         CARLA_SAFE_ASSERT(kPlayer != nullptr);
     }
@@ -73,23 +79,26 @@ public:
 
     void addControl(const uint64_t time, const uint8_t channel, const uint8_t control, const uint8_t value)
     {
-        RawMidiEvent* const ctrlEvent(new RawMidiEvent());
-        ctrlEvent->time    = time;
-        ctrlEvent->size    = 3;
-        ctrlEvent->data[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (channel & MIDI_CHANNEL_BIT));
-        ctrlEvent->data[1] = control;
-        ctrlEvent->data[2] = value;
+        RawMidiEvent ctrlEvent;
+        ctrlEvent.time    = time;
+        ctrlEvent.size    = 3;
+        ctrlEvent.data[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (channel & MIDI_CHANNEL_BIT));
+        ctrlEvent.data[1] = control;
+        ctrlEvent.data[2] = value;
+        ctrlEvent.data[3] = 0;
 
         appendSorted(ctrlEvent);
     }
 
     void addChannelPressure(const uint64_t time, const uint8_t channel, const uint8_t pressure)
     {
-        RawMidiEvent* const pressureEvent(new RawMidiEvent());
-        pressureEvent->time    = time;
-        pressureEvent->size    = 2;
-        pressureEvent->data[0] = uint8_t(MIDI_STATUS_CHANNEL_PRESSURE | (channel & MIDI_CHANNEL_BIT));
-        pressureEvent->data[1] = pressure;
+        RawMidiEvent pressureEvent;
+        pressureEvent.time    = time;
+        pressureEvent.size    = 2;
+        pressureEvent.data[0] = uint8_t(MIDI_STATUS_CHANNEL_PRESSURE | (channel & MIDI_CHANNEL_BIT));
+        pressureEvent.data[1] = pressure;
+        pressureEvent.data[2] = 0;
+        pressureEvent.data[3] = 0;
 
         appendSorted(pressureEvent);
     }
@@ -102,54 +111,60 @@ public:
 
     void addNoteOn(const uint64_t time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity)
     {
-        RawMidiEvent* const noteOnEvent(new RawMidiEvent());
-        noteOnEvent->time    = time;
-        noteOnEvent->size    = 3;
-        noteOnEvent->data[0] = uint8_t(MIDI_STATUS_NOTE_ON | (channel & MIDI_CHANNEL_BIT));
-        noteOnEvent->data[1] = pitch;
-        noteOnEvent->data[2] = velocity;
+        RawMidiEvent noteOnEvent;
+        noteOnEvent.time    = time;
+        noteOnEvent.size    = 3;
+        noteOnEvent.data[0] = uint8_t(MIDI_STATUS_NOTE_ON | (channel & MIDI_CHANNEL_BIT));
+        noteOnEvent.data[1] = pitch;
+        noteOnEvent.data[2] = velocity;
+        noteOnEvent.data[3] = 0;
 
         appendSorted(noteOnEvent);
     }
 
     void addNoteOff(const uint64_t time, const uint8_t channel, const uint8_t pitch, const uint8_t velocity = 0)
     {
-        RawMidiEvent* const noteOffEvent(new RawMidiEvent());
-        noteOffEvent->time    = time;
-        noteOffEvent->size    = 3;
-        noteOffEvent->data[0] = uint8_t(MIDI_STATUS_NOTE_OFF | (channel & MIDI_CHANNEL_BIT));
-        noteOffEvent->data[1] = pitch;
-        noteOffEvent->data[2] = velocity;
+        RawMidiEvent noteOffEvent;
+        noteOffEvent.time    = time;
+        noteOffEvent.size    = 3;
+        noteOffEvent.data[0] = uint8_t(MIDI_STATUS_NOTE_OFF | (channel & MIDI_CHANNEL_BIT));
+        noteOffEvent.data[1] = pitch;
+        noteOffEvent.data[2] = velocity;
+        noteOffEvent.data[3] = 0;
 
         appendSorted(noteOffEvent);
     }
 
     void addNoteAftertouch(const uint64_t time, const uint8_t channel, const uint8_t pitch, const uint8_t pressure)
     {
-        RawMidiEvent* const noteAfterEvent(new RawMidiEvent());
-        noteAfterEvent->time    = time;
-        noteAfterEvent->size    = 3;
-        noteAfterEvent->data[0] = uint8_t(MIDI_STATUS_POLYPHONIC_AFTERTOUCH | (channel & MIDI_CHANNEL_BIT));
-        noteAfterEvent->data[1] = pitch;
-        noteAfterEvent->data[2] = pressure;
+        RawMidiEvent noteAfterEvent;
+        noteAfterEvent.time    = time;
+        noteAfterEvent.size    = 3;
+        noteAfterEvent.data[0] = uint8_t(MIDI_STATUS_POLYPHONIC_AFTERTOUCH | (channel & MIDI_CHANNEL_BIT));
+        noteAfterEvent.data[1] = pitch;
+        noteAfterEvent.data[2] = pressure;
+        noteAfterEvent.data[3] = 0;
 
         appendSorted(noteAfterEvent);
     }
 
     void addProgram(const uint64_t time, const uint8_t channel, const uint8_t bank, const uint8_t program)
     {
-        RawMidiEvent* const bankEvent(new RawMidiEvent());
-        bankEvent->time    = time;
-        bankEvent->size    = 3;
-        bankEvent->data[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (channel & MIDI_CHANNEL_BIT));
-        bankEvent->data[1] = MIDI_CONTROL_BANK_SELECT;
-        bankEvent->data[2] = bank;
-
-        RawMidiEvent* const programEvent(new RawMidiEvent());
-        programEvent->time    = time;
-        programEvent->size    = 2;
-        programEvent->data[0] = uint8_t(MIDI_STATUS_PROGRAM_CHANGE | (channel & MIDI_CHANNEL_BIT));
-        programEvent->data[1] = program;
+        RawMidiEvent bankEvent;
+        bankEvent.time    = time;
+        bankEvent.size    = 3;
+        bankEvent.data[0] = uint8_t(MIDI_STATUS_CONTROL_CHANGE | (channel & MIDI_CHANNEL_BIT));
+        bankEvent.data[1] = MIDI_CONTROL_BANK_SELECT;
+        bankEvent.data[2] = bank;
+        bankEvent.data[3] = 0;
+
+        RawMidiEvent programEvent;
+        programEvent.time    = time;
+        programEvent.size    = 2;
+        programEvent.data[0] = uint8_t(MIDI_STATUS_PROGRAM_CHANGE | (channel & MIDI_CHANNEL_BIT));
+        programEvent.data[1] = program;
+        programEvent.data[2] = 0;
+        programEvent.data[3] = 0;
 
         appendSorted(bankEvent);
         appendSorted(programEvent);
@@ -157,27 +172,56 @@ public:
 
     void addPitchbend(const uint64_t time, const uint8_t channel, const uint8_t lsb, const uint8_t msb)
     {
-        RawMidiEvent* const pressureEvent(new RawMidiEvent());
-        pressureEvent->time    = time;
-        pressureEvent->size    = 3;
-        pressureEvent->data[0] = uint8_t(MIDI_STATUS_PITCH_WHEEL_CONTROL | (channel & MIDI_CHANNEL_BIT));
-        pressureEvent->data[1] = lsb;
-        pressureEvent->data[2] = msb;
+        RawMidiEvent pressureEvent;
+        pressureEvent.time    = time;
+        pressureEvent.size    = 3;
+        pressureEvent.data[0] = uint8_t(MIDI_STATUS_PITCH_WHEEL_CONTROL | (channel & MIDI_CHANNEL_BIT));
+        pressureEvent.data[1] = lsb;
+        pressureEvent.data[2] = msb;
+        pressureEvent.data[3] = 0;
 
         appendSorted(pressureEvent);
     }
 
     void addRaw(const uint64_t time, const uint8_t* const data, const uint8_t size)
     {
-        RawMidiEvent* const rawEvent(new RawMidiEvent());
-        rawEvent->time = time;
-        rawEvent->size = size;
+        CARLA_SAFE_ASSERT_RETURN(size > 0 && size <= MAX_EVENT_DATA_SIZE,);
+
+        RawMidiEvent rawEvent;
+        carla_zeroStruct(rawEvent);
+        rawEvent.time = time;
+        rawEvent.size = size;
 
-        carla_copy<uint8_t>(rawEvent->data, data, size);
+        carla_copy<uint8_t>(rawEvent.data, data, size);
 
         appendSorted(rawEvent);
     }
 
+    // -------------------------------------------------------------------
+    // add many events at once, sorting only once at the end
+
+    void addEvents(const RawMidiEvent* const events, const std::size_t count)
+    {
+        CARLA_SAFE_ASSERT_RETURN(events != nullptr,);
+
+        if (count == 0)
+            return;
+
+        const CarlaMutexLocker sl(fMutex);
+
+        CARLA_SAFE_ASSERT_RETURN(reserve(fDataCount + count),);
+
+        const bool wasSorted(fDataCount == 0 || fData[fDataCount-1].time <= events[0].time);
+
+        std::memcpy(fData + fDataCount, events, sizeof(RawMidiEvent)*count);
+        fDataCount += count;
+
+        if (! wasSorted || ! std::is_sorted(fData + fDataCount - count, fData + fDataCount, compareEventTime))
+            std::stable_sort(fData, fData + fDataCount, compareEventTime);
+
+        fCursorTime = -1.0L;
+    }
+
     // -------------------------------------------------------------------
     // remove data
 
@@ -185,20 +229,18 @@ public:
     {
         const CarlaMutexLocker sl(fMutex);
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
+        for (std::size_t i = lowerBound(time); i < fDataCount && fData[i].time == time; ++i)
         {
-            const RawMidiEvent* const rawMidiEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(rawMidiEvent != nullptr);
+            const RawMidiEvent& rawMidiEvent(fData[i]);
 
-            if (rawMidiEvent->time != time)
-                continue;
-            if (rawMidiEvent->size != size)
+            if (rawMidiEvent.size != size)
                 continue;
-            if (std::memcmp(rawMidiEvent->data, data, size) != 0)
+            if (std::memcmp(rawMidiEvent.data, data, size) != 0)
                 continue;
 
-            delete rawMidiEvent;
-            fData.remove(it);
+            std::memmove(fData + i, fData + i + 1, sizeof(RawMidiEvent)*(fDataCount - i - 1));
+            --fDataCount;
+            fCursorTime = -1.0L;
 
             return;
         }
@@ -213,10 +255,16 @@ public:
     {
         const CarlaMutexLocker sl(fMutex);
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
-            delete it.getValue(nullptr);
+        if (fData != nullptr)
+        {
+            std::free(fData);
+            fData = nullptr;
+        }
 
-        fData.clear();
+        fDataCount  = 0;
+        fDataSize   = 0;
+        fCursor     = 0;
+        fCursorTime = -1.0L;
     }
 
     // -------------------------------------------------------------------
@@ -235,19 +283,33 @@ public:
         if (fStartTime != 0)
             timePosFrame += static_cast<long double>(fStartTime);
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
+        const long double endTimePosFrame(timePosFrame + frames);
+
+        // continue from where the previous block stopped, or look up the new position after a relocation
+        std::size_t i;
+
+        if (carla_isEqual(fCursorTime, timePosFrame))
+        {
+            i = fCursor;
+        }
+        else
         {
-            const RawMidiEvent* const rawMidiEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(rawMidiEvent != nullptr);
+            i = lowerBound(timePosFrame <= 0.0L ? 0 : static_cast<uint64_t>(std::ceil(timePosFrame)));
+        }
 
-            if (timePosFrame > rawMidiEvent->time)
-                continue;
-            if (timePosFrame + frames <= rawMidiEvent->time)
-                continue;
+        for (; i < fDataCount; ++i)
+        {
+            const RawMidiEvent& rawMidiEvent(fData[i]);
+
+            if (endTimePosFrame <= rawMidiEvent.time)
+                break;
 
-            kPlayer->writeMidiEvent(fMidiPort, static_cast<long double>(rawMidiEvent->time)-timePosFrame, rawMidiEvent);
+            kPlayer->writeMidiEvent(fMidiPort, static_cast<long double>(rawMidiEvent.time)-timePosFrame, &rawMidiEvent);
         }
 
+        fCursor     = i;
+        fCursorTime = endTimePosFrame;
+
         fMutex.unlock();
     }
 
@@ -272,9 +334,15 @@ public:
         return fMutex;
     }
 
-    LinkedList<const RawMidiEvent*>::Itenerator iteneratorBegin() const noexcept
+    // events are sorted by time, lock the mutex while iterating
+    const RawMidiEvent* getEvents() const noexcept
+    {
+        return fData;
+    }
+
+    std::size_t getEventCount() const noexcept
     {
-        return fData.begin2();
+        return fDataCount;
     }
 
     // -------------------------------------------------------------------
@@ -288,19 +356,18 @@ public:
 
         const CarlaMutexLocker sl(fMutex);
 
-        if (fData.count() == 0)
+        if (fDataCount == 0)
             return nullptr;
 
-        char* const data((char*)std::calloc(1, fData.count()*maxMsgSize));
+        char* const data((char*)std::calloc(1, fDataCount*maxMsgSize + 1));
         CARLA_SAFE_ASSERT_RETURN(data != nullptr, nullptr);
 
         char* dataWrtn = data;
         int wrtn;
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
+        for (std::size_t j=0; j < fDataCount; ++j)
         {
-            const RawMidiEvent* const rawMidiEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(rawMidiEvent != nullptr);
+            const RawMidiEvent* const rawMidiEvent(&fData[j]);
 
             wrtn = std::snprintf(dataWrtn, maxTimeSize+4, P_INT64 ":%i:", rawMidiEvent->time, rawMidiEvent->size);
             CARLA_SAFE_ASSERT_BREAK(wrtn > 0);
@@ -339,6 +406,16 @@ public:
 
         const CarlaMutexLocker sl(fMutex);
 
+        // count lines so we allocate only once
+        std::size_t numEvents = 0;
+        for (const char* c = data; *c != '\0'; ++c)
+        {
+            if (*c == '\n')
+                ++numEvents;
+        }
+
+        CARLA_SAFE_ASSERT_RETURN(reserve(numEvents+1),);
+
         for (; *dataRead != '\0';)
         {
             // get time
@@ -407,9 +484,10 @@ public:
             for (int i=size; i<MAX_EVENT_DATA_SIZE; ++i)
                 midiEvent.data[i] = 0;
 
-            RawMidiEvent* const event(new RawMidiEvent());
-            carla_copyStruct(*event, midiEvent);
-            fData.append(event);
+            if (fDataCount != 0 && fData[fDataCount-1].time > midiEvent.time)
+                appendSortedLocked(midiEvent);
+            else
+                appendLocked(midiEvent);
         }
     }
 
@@ -422,31 +500,110 @@ private:
     uint64_t fStartTime;
 
     CarlaMutex fMutex;
-    LinkedList<const RawMidiEvent*> fData;
 
-    void appendSorted(const RawMidiEvent* const event)
+    // contiguous array, sorted by time, events with the same time keep their insertion order
+    RawMidiEvent* fData;
+    std::size_t   fDataCount;
+    std::size_t   fDataSize;
+
+    // playback position, valid while fCursorTime matches the start of the next block
+    std::size_t fCursor;
+    long double fCursorTime;
+
+    static bool compareEventTime(const RawMidiEvent& a, const RawMidiEvent& b) noexcept
     {
-        const CarlaMutexLocker sl(fMutex);
+        return a.time < b.time;
+    }
 
-        if (fData.isEmpty())
+    // index of the first event at or after time
+    std::size_t lowerBound(const uint64_t time) const noexcept
+    {
+        std::size_t first = 0, count = fDataCount;
+
+        for (std::size_t step; count > 0;)
         {
-            fData.append(event);
-            return;
+            step = count / 2;
+
+            if (fData[first + step].time < time)
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
         }
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fData.begin2(); it.valid(); it.next())
-        {
-            const RawMidiEvent* const oldEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(oldEvent != nullptr);
+        return first;
+    }
 
-            if (event->time >= oldEvent->time)
-                continue;
+    // index of the first event after time
+    std::size_t upperBound(const uint64_t time) const noexcept
+    {
+        std::size_t first = 0, count = fDataCount;
 
-            fData.insertAt(event, it);
-            return;
+        for (std::size_t step; count > 0;)
+        {
+            step = count / 2;
+
+            if (fData[first + step].time <= time)
+            {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else
+            {
+                count = step;
+            }
         }
 
-        fData.append(event);
+        return first;
+    }
+
+    bool reserve(const std::size_t size) noexcept
+    {
+        if (size <= fDataSize)
+            return true;
+
+        std::size_t newSize = fDataSize != 0 ? fDataSize : MIN_PREALLOCATED_EVENT_COUNT;
+
+        while (newSize < size)
+            newSize *= 2;
+
+        RawMidiEvent* const newData((RawMidiEvent*)std::realloc(fData, sizeof(RawMidiEvent)*newSize));
+        CARLA_SAFE_ASSERT_RETURN(newData != nullptr, false);
+
+        fData     = newData;
+        fDataSize = newSize;
+        return true;
+    }
+
+    void appendLocked(const RawMidiEvent& event) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(reserve(fDataCount + 1),);
+
+        carla_copyStruct(fData[fDataCount++], event);
+        fCursorTime = -1.0L;
+    }
+
+    void appendSortedLocked(const RawMidiEvent& event) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(reserve(fDataCount + 1),);
+
+        const std::size_t index(upperBound(event.time));
+
+        std::memmove(fData + index + 1, fData + index, sizeof(RawMidiEvent)*(fDataCount - index));
+        carla_copyStruct(fData[index], event);
+        ++fDataCount;
+        fCursorTime = -1.0L;
+    }
+
+    void appendSorted(const RawMidiEvent& event) noexcept
+    {
+        const CarlaMutexLocker sl(fMutex);
+
+        appendSortedLocked(event);
     }
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiPattern)
@@ -160,6 +160,18 @@ private:
 
         const double sampleRate(getSampleRate());
 
+        // collect all events first and add them in one go, sorting is done only once
+        std::size_t numEvents = 0;
+
+        for (int i=0, numTracks = midiFile.getNumTracks(); i<numTracks; ++i)
+        {
+            if (const MidiMessageSequence* const track = midiFile.getTrack(i))
+                numEvents += static_cast<std::size_t>(track->getNumEvents());
+        }
+
+        RawMidiEvent* const rawMidiEvents(new RawMidiEvent[numEvents]);
+        std::size_t numRawMidiEvents = 0;
+
         for (int i=0, numTracks = midiFile.getNumTracks(); i<numTracks; ++i)
         {
             const MidiMessageSequence* const track(midiFile.getTrack(i));
@@ -202,10 +214,17 @@ private:
                 const double time(midiMessage.getTimeStamp()*sampleRate);
                 CARLA_SAFE_ASSERT_CONTINUE(time >= 0.0);
 
-                fMidiOut.addRaw(static_cast<uint64_t>(time), midiMessage.getRawData(), static_cast<uint8_t>(dataSize));
+                RawMidiEvent& rawMidiEvent(rawMidiEvents[numRawMidiEvents++]);
+                carla_zeroStruct(rawMidiEvent);
+                rawMidiEvent.time = static_cast<uint64_t>(time);
+                rawMidiEvent.size = static_cast<uint8_t>(dataSize);
+                carla_copy<uint8_t>(rawMidiEvent.data, midiMessage.getRawData(), static_cast<std::size_t>(dataSize));
             }
         }
 
+        fMidiOut.addEvents(rawMidiEvents, numRawMidiEvents);
+        delete[] rawMidiEvents;
+
         fNeedsAllNotesOff = true;
     }
 
@@ -446,10 +446,11 @@ private:
 
         writeMessage("midi-clear-all\n", 15);
 
-        for (LinkedList<const RawMidiEvent*>::Itenerator it = fMidiOut.iteneratorBegin(); it.valid(); it.next())
+        const RawMidiEvent* const rawMidiEvents(fMidiOut.getEvents());
+
+        for (std::size_t j=0, count=fMidiOut.getEventCount(); j < count; ++j)
         {
-            const RawMidiEvent* const rawMidiEvent(it.getValue(nullptr));
-            CARLA_SAFE_ASSERT_CONTINUE(rawMidiEvent != nullptr);
+            const RawMidiEvent* const rawMidiEvent(&rawMidiEvents[j]);
 
             writeMessage("midievent-add\n", 14);
 
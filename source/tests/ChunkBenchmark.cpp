@@ -0,0 +1,209 @@
+/*
+ * Carla Chunk Benchmark
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaBase64Utils.hpp"
+#include "CarlaShmUtils.hpp"
+#include "CarlaString.hpp"
+#include "CarlaTimeUtils.hpp"
+
+#include "water/files/File.h"
+#include "water/memory/MemoryBlock.h"
+#include "water/streams/MemoryOutputStream.h"
+
+#include <vector>
+
+using water::File;
+using water::MemoryBlock;
+using water::MemoryOutputStream;
+
+// -----------------------------------------------------------------------
+// Compares the old base64 paths for big plugin chunks against the raw binary ones,
+// both for saving projects (inline <Chunk> vs side-car file) and for sending chunks to bridges (temp file vs shm).
+
+static double elapsedMs(const uint64_t startTime) noexcept
+{
+    return static_cast<double>(carla_gettime_us() - startTime) / 1000.0;
+}
+
+static void fillChunk(std::vector<uint8_t>& chunk)
+{
+    uint32_t seed = 0x12345678;
+
+    for (std::size_t i=0, size=chunk.size(); i < size; ++i)
+    {
+        // xorshift, so that nothing compresses or dedups
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        chunk[i] = static_cast<uint8_t>(seed);
+    }
+}
+
+static void benchmarkProject(const std::vector<uint8_t>& chunk, const File& tmpDir)
+{
+    const File projectFile(tmpDir.getChildFile("ChunkBenchmark.carxp"));
+    const File chunkFile(tmpDir.getChildFile("ChunkBenchmark.carxp.chunks"));
+
+    // base64 inside the project xml
+    {
+        const uint64_t startTime = carla_gettime_us();
+
+        const CarlaString base64(CarlaString::asBase64(chunk.data(), chunk.size()));
+
+        MemoryOutputStream out;
+        out << "<CARLA-PROJECT>\n <Chunk>\n" << base64.buffer() << "\n </Chunk>\n</CARLA-PROJECT>\n";
+        CARLA_SAFE_ASSERT_RETURN(projectFile.replaceWithData(out.getData(), out.getDataSize()),);
+
+        const double saveTime = elapsedMs(startTime);
+
+        const uint64_t loadStartTime = carla_gettime_us();
+
+        const water::String text(projectFile.loadFileAsString());
+        const water::String chunkText(text.fromFirstOccurrenceOf("<Chunk>", false, false)
+                                          .upToFirstOccurrenceOf("</Chunk>", false, false).trim());
+        const std::vector<uint8_t> loaded(carla_getChunkFromBase64String(chunkText.toRawUTF8()));
+
+        const double loadTime = elapsedMs(loadStartTime);
+
+        CARLA_SAFE_ASSERT(loaded == chunk);
+        carla_stdout("  project base64:  save %9.2f ms, load %9.2f ms, %lu bytes on disk",
+                     saveTime, loadTime, static_cast<ulong>(projectFile.getSize()));
+    }
+
+    // raw side-car file
+    {
+        const uint64_t startTime = carla_gettime_us();
+
+        MemoryOutputStream out;
+        out << "<CARLA-PROJECT>\n <ChunkFile Offset='0' Size='" << static_cast<water::int64>(chunk.size())
+            << "'>ChunkBenchmark.carxp.chunks</ChunkFile>\n</CARLA-PROJECT>\n";
+        CARLA_SAFE_ASSERT_RETURN(projectFile.replaceWithData(out.getData(), out.getDataSize()),);
+        CARLA_SAFE_ASSERT_RETURN(chunkFile.replaceWithData(chunk.data(), chunk.size()),);
+
+        const double saveTime = elapsedMs(startTime);
+
+        const uint64_t loadStartTime = carla_gettime_us();
+
+        MemoryBlock data;
+        CARLA_SAFE_ASSERT_RETURN(chunkFile.loadFileAsData(data),);
+
+        const double loadTime = elapsedMs(loadStartTime);
+
+        CARLA_SAFE_ASSERT(data.getSize() == chunk.size() && std::memcmp(data.getData(), chunk.data(), chunk.size()) == 0);
+        carla_stdout("  project raw:     save %9.2f ms, load %9.2f ms, %lu bytes on disk",
+                     saveTime, loadTime, static_cast<ulong>(projectFile.getSize() + chunkFile.getSize()));
+    }
+
+    projectFile.deleteFile();
+    chunkFile.deleteFile();
+}
+
+static void benchmarkBridge(const std::vector<uint8_t>& chunk, const File& tmpDir)
+{
+    // base64 temporary file, what bridges used before
+    {
+        const File chunkFile(tmpDir.getChildFile(".CarlaChunk_benchmark"));
+        const uint64_t startTime = carla_gettime_us();
+
+        const CarlaString base64(CarlaString::asBase64(chunk.data(), chunk.size()));
+        CARLA_SAFE_ASSERT_RETURN(chunkFile.replaceWithText(base64.buffer()),);
+
+        const std::vector<uint8_t> received(carla_getChunkFromBase64String(chunkFile.loadFileAsString().toRawUTF8()));
+        chunkFile.deleteFile();
+
+        const double time = elapsedMs(startTime);
+
+        CARLA_SAFE_ASSERT(received == chunk);
+        carla_stdout("  bridge file:     %9.2f ms", time);
+    }
+
+    // shared memory, one side creates and fills it, the other attaches and reads
+    {
+        char tmpFileBase[64];
+        std::strcpy(tmpFileBase, "/crlbrdg_shm_chunk_XXXXXX");
+
+        const uint64_t startTime = carla_gettime_us();
+
+        carla_shm_t server(carla_shm_create_temp(tmpFileBase));
+        CARLA_SAFE_ASSERT_RETURN(carla_is_shm_valid(server),);
+
+        uint8_t* const serverData = (uint8_t*)carla_shm_map(server, chunk.size());
+
+        if (serverData == nullptr)
+        {
+            carla_stderr("  bridge shm:      failed to map %lu bytes, check the locked memory limit",
+                         static_cast<ulong>(chunk.size()));
+            carla_shm_close(server);
+            return;
+        }
+
+        std::memcpy(serverData, chunk.data(), chunk.size());
+
+        std::vector<uint8_t> received;
+        carla_shm_t client(carla_shm_attach(tmpFileBase));
+
+        if (carla_is_shm_valid(client))
+        {
+            if (uint8_t* const clientData = (uint8_t*)carla_shm_map(client, chunk.size()))
+            {
+                received.assign(clientData, clientData + chunk.size());
+                carla_shm_unmap(client, clientData);
+            }
+
+            carla_shm_close(client);
+        }
+
+        carla_shm_unmap(server, serverData);
+        carla_shm_close(server);
+
+        const double time = elapsedMs(startTime);
+
+        CARLA_SAFE_ASSERT(received == chunk);
+        carla_stdout("  bridge shm:      %9.2f ms", time);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    const File tmpDir(File::getSpecialLocation(File::tempDirectory));
+
+    std::vector<std::size_t> sizes;
+
+    for (int i=1; i < argc; ++i)
+        sizes.push_back(static_cast<std::size_t>(std::atol(argv[i])) * 1024 * 1024);
+
+    if (sizes.empty())
+    {
+        sizes.push_back(1 * 1024 * 1024);
+        sizes.push_back(16 * 1024 * 1024);
+        sizes.push_back(64 * 1024 * 1024);
+    }
+
+    for (std::vector<std::size_t>::iterator it = sizes.begin(); it != sizes.end(); ++it)
+    {
+        std::vector<uint8_t> chunk(*it);
+        fillChunk(chunk);
+
+        carla_stdout("%lu MiB chunk:", static_cast<ulong>(*it / 1024 / 1024));
+        benchmarkProject(chunk, tmpDir);
+        benchmarkBridge(chunk, tmpDir);
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,610 @@
+/*
+ * Carla DSP Benchmark
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "../backend/engine/CarlaEngineInternal.hpp"
+#include "../backend/engine/CarlaEngineGraph.hpp"
+
+#include "CarlaPlugin.hpp"
+#include "CarlaMIDI.h"
+#include "CarlaTimeUtils.hpp"
+
+#include <vector>
+
+// -----------------------------------------------------------------------
+// Runs synthetic sessions of internal plugins through the rack and patchbay graphs, headless and as fast as possible.
+// Reports the cost per frame of the whole cycle and of each plugin, plus heap allocations made on the process thread.
+
+static const char* const kDefaultLabels[] = { "bypass", "midithrough", "zita-rev1", "3bandeq", "zynaddsubfx", nullptr };
+static const uint32_t kDefaultBufferSizes[] = { 64, 128, 256, 512, 1024, 0 };
+
+// -----------------------------------------------------------------------
+// Allocation counting, only for the thread that runs the graph
+
+static __thread bool gCountAllocations = false;
+static uint64_t gAllocationCount = 0;
+
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* ptr, std::size_t size);
+
+void* malloc(std::size_t size) noexcept
+{
+    if (gCountAllocations)
+        ++gAllocationCount;
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    if (gCountAllocations)
+        ++gAllocationCount;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept
+{
+    if (gCountAllocations)
+        ++gAllocationCount;
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+// -----------------------------------------------------------------------
+
+CARLA_BACKEND_START_NAMESPACE
+
+// patchbay port ids, as used by CarlaEngine::patchbayConnect()
+static const uint kAudioInputPortOffset  = MAX_PATCHBAY_PLUGINS*1;
+static const uint kAudioOutputPortOffset = MAX_PATCHBAY_PLUGINS*2;
+static const uint kMidiInputPortOffset   = MAX_PATCHBAY_PLUGINS*3;
+static const uint kMidiOutputPortOffset  = MAX_PATCHBAY_PLUGINS*3+1;
+
+class CarlaEngineBenchmark : public CarlaEngine
+{
+public:
+    CarlaEngineBenchmark()
+        : CarlaEngine(),
+          fIsRunning(false),
+          fAudioBufIn(nullptr),
+          fAudioBufOut(nullptr),
+          fFrame(0)
+    {
+        pData->options.transportMode = ENGINE_TRANSPORT_MODE_INTERNAL;
+    }
+
+    ~CarlaEngineBenchmark() override
+    {
+        CARLA_SAFE_ASSERT(! fIsRunning);
+    }
+
+    // -------------------------------------
+
+    bool init(const char* const clientName) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(! fIsRunning, false);
+
+        fIsRunning = true;
+
+        if (! pData->init(clientName))
+        {
+            close();
+            setLastError("Failed to init internal data");
+            return false;
+        }
+
+        pData->bufferSize = pData->options.audioBufferSize;
+        pData->sampleRate = pData->options.audioSampleRate;
+        pData->initTime(nullptr);
+
+        fAudioBufIn  = new float[2*pData->bufferSize];
+        fAudioBufOut = new float[2*pData->bufferSize];
+        carla_zeroFloats(fAudioBufIn, 2*pData->bufferSize);
+        fFrame = 0;
+
+        pData->graph.create(2, 2);
+        return true;
+    }
+
+    bool close() override
+    {
+        // nothing else drives the graph, so pending plugin actions must run right away
+        fIsRunning = false;
+
+        CarlaEngine::close();
+
+        pData->graph.destroy();
+
+        if (fAudioBufIn != nullptr)
+        {
+            delete[] fAudioBufIn;
+            fAudioBufIn = nullptr;
+        }
+
+        if (fAudioBufOut != nullptr)
+        {
+            delete[] fAudioBufOut;
+            fAudioBufOut = nullptr;
+        }
+
+        return true;
+    }
+
+    bool isRunning() const noexcept override
+    {
+        return fIsRunning;
+    }
+
+    bool isOffline() const noexcept override
+    {
+        // plugins must take their realtime code paths
+        return false;
+    }
+
+    EngineType getType() const noexcept override
+    {
+        return kEngineTypeOffline;
+    }
+
+    const char* getCurrentDriverName() const noexcept override
+    {
+        return "Benchmark";
+    }
+
+    // -------------------------------------
+
+    // Chain all plugins from the audio input to the audio output, and feed MIDI input into each of them.
+    void connectPatchbayChain()
+    {
+        PatchbayGraph* const graph(pData->graph.getPatchbayGraph());
+        CARLA_SAFE_ASSERT_RETURN(graph != nullptr,);
+
+        uint audioInNode = 0, audioOutNode = 0, midiInNode = 0;
+
+        for (int i=0, count=graph->graph.getNumNodes(); i < count; ++i)
+        {
+            water::AudioProcessorGraph::Node* const node(graph->graph.getNode(i));
+
+            typedef water::AudioProcessorGraph::AudioGraphIOProcessor IOProcessor;
+
+            if (IOProcessor* const ioProc = dynamic_cast<IOProcessor*>(node->getProcessor()))
+            {
+                switch (ioProc->getType())
+                {
+                case IOProcessor::audioInputNode:  audioInNode  = node->nodeId; break;
+                case IOProcessor::audioOutputNode: audioOutNode = node->nodeId; break;
+                case IOProcessor::midiInputNode:   midiInNode   = node->nodeId; break;
+                default: break;
+                }
+            }
+        }
+
+        CARLA_SAFE_ASSERT_RETURN(audioInNode != 0 && audioOutNode != 0 && midiInNode != 0,);
+
+        uint prevNode = audioInNode;
+        uint prevOuts = 2;
+
+        for (uint i=0; i < pData->curPluginCount; ++i)
+        {
+            CarlaPlugin* const plugin(pData->plugins[i].plugin);
+            CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
+
+            const uint nodeId(plugin->getPatchbayNodeId());
+            const uint32_t ins(plugin->getAudioInCount());
+
+            for (uint32_t j=0; j < ins && prevOuts != 0; ++j)
+                graph->connect(false, prevNode, kAudioOutputPortOffset + std::min(j, prevOuts-1),
+                                      nodeId, kAudioInputPortOffset + j, false);
+
+            if (plugin->getMidiInCount() > 0)
+                graph->connect(false, midiInNode, kMidiOutputPortOffset, nodeId, kMidiInputPortOffset, false);
+
+            if (const uint32_t outs = plugin->getAudioOutCount())
+            {
+                prevNode = nodeId;
+                prevOuts = outs;
+            }
+        }
+
+        for (uint j=0; j < 2; ++j)
+            graph->connect(false, prevNode, kAudioOutputPortOffset + std::min(j, prevOuts-1),
+                                  audioOutNode, kAudioInputPortOffset + j, false);
+    }
+
+    // Run @a blocks cycles, returns the elapsed time in nanoseconds.
+    uint64_t runBlocks(const uint blocks, uint64_t& allocations)
+    {
+        const uint32_t bufferSize(pData->bufferSize);
+        const bool isRack(pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK);
+
+        const float* inBuf[2]  = { fAudioBufIn, fAudioBufIn + bufferSize };
+        /* */ float* outBuf[2] = { fAudioBufOut, fAudioBufOut + bufferSize };
+
+        gAllocationCount  = 0;
+        gCountAllocations = true;
+
+        const uint64_t startTime(carla_gettime_ns());
+
+        for (uint i=0; i < blocks; ++i)
+        {
+            const PendingRtEventsRunner prt(this, bufferSize);
+
+            pData->events.reset();
+            fillMidiEvents(fFrame, bufferSize);
+            fillAudioInput(bufferSize);
+            fFrame += bufferSize;
+
+            if (isRack)
+                pData->graph.processRack(pData, inBuf, outBuf, bufferSize);
+            else
+                pData->graph.process(pData, inBuf, outBuf, bufferSize);
+        }
+
+        const uint64_t elapsedTime(carla_gettime_ns() - startTime);
+
+        gCountAllocations = false;
+        allocations = gAllocationCount;
+
+        return elapsedTime;
+    }
+
+private:
+    bool   fIsRunning;
+    float* fAudioBufIn;
+    float* fAudioBufOut;
+    uint64_t fFrame;
+
+    // A 4-note chord every half second, so that synths always have voices playing
+    void fillMidiEvents(const uint64_t frame, const uint32_t frames) noexcept
+    {
+        static const uint8_t kChord[4] = { 48, 55, 64, 71 };
+
+        const uint64_t interval(static_cast<uint64_t>(pData->sampleRate / 2));
+        const uint64_t nextChord(((frame + interval - 1) / interval) * interval);
+
+        if (nextChord >= frame + frames)
+            return;
+
+        const uint32_t time(static_cast<uint32_t>(nextChord - frame));
+        const uint8_t transpose(static_cast<uint8_t>((nextChord / interval) % 5));
+
+        EngineEventBuffer& eventsIn(pData->events.in);
+
+        for (uint i=0; i < 8 && ! eventsIn.isFull(); ++i)
+        {
+            const bool noteOff(i < 4);
+            const uint8_t note(static_cast<uint8_t>(kChord[i % 4] + (noteOff ? (transpose+4) % 5 : transpose)));
+            const uint8_t midiData[3] = {
+                static_cast<uint8_t>(noteOff ? MIDI_STATUS_NOTE_OFF : MIDI_STATUS_NOTE_ON), note, 100
+            };
+
+            EngineEvent& event(eventsIn.data[eventsIn.count++]);
+            event.time = time;
+            event.fillFromMidiData(3, midiData, 0);
+        }
+    }
+
+    // Low level noise, keeps effects busy without denormals
+    void fillAudioInput(const uint32_t frames) noexcept
+    {
+        static uint32_t seed = 0x12345678;
+
+        for (uint32_t i=0; i < frames*2; ++i)
+        {
+            seed = seed * 1664525 + 1013904223;
+            fAudioBufIn[i] = static_cast<float>(static_cast<int32_t>(seed)) / 2147483648.0f * 0.1f;
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaEngineBenchmark)
+};
+
+CARLA_BACKEND_END_NAMESPACE
+
+// -----------------------------------------------------------------------
+
+CARLA_BACKEND_USE_NAMESPACE
+
+struct BenchmarkPluginResult {
+    float avgTime;
+    float p99Time;
+    float maxTime;
+};
+
+struct BenchmarkResult {
+    const char* mode;
+    const char* label;
+    uint pluginCount;
+    uint32_t bufferSize;
+    double sampleRate;
+    uint blocks;
+    double nsPerFrame;
+    double realtimeFactor;
+    uint64_t allocations;
+    std::vector<BenchmarkPluginResult> plugins;
+};
+
+static bool runSession(const EngineProcessMode processMode, const char* const label, const uint pluginCount,
+                       const uint32_t bufferSize, const double sampleRate, const double seconds, BenchmarkResult& result)
+{
+    CarlaEngineBenchmark engine;
+
+    engine.setOption(ENGINE_OPTION_PROCESS_MODE, processMode, nullptr);
+    engine.setOption(ENGINE_OPTION_AUDIO_BUFFER_SIZE, static_cast<int>(bufferSize), nullptr);
+    engine.setOption(ENGINE_OPTION_AUDIO_SAMPLE_RATE, static_cast<int>(sampleRate), nullptr);
+    engine.setOption(ENGINE_OPTION_PROCESS_STATS, 1, nullptr);
+
+    // relative to this folder, same as the library paths in the Makefile
+    engine.setOption(ENGINE_OPTION_PATH_BINARIES, 0, "../../bin");
+    engine.setOption(ENGINE_OPTION_PATH_RESOURCES, 0, "../../bin/resources");
+
+    if (! engine.init("DspBenchmark"))
+    {
+        carla_stderr2("Failed to init engine: %s", engine.getLastError());
+        return false;
+    }
+
+    bool ok = true;
+
+    for (uint i=0; i < pluginCount; ++i)
+    {
+        if (! engine.addPlugin(PLUGIN_INTERNAL, "", label, label, 0, nullptr))
+        {
+            carla_stdout("  %s: unavailable (%s)", label, engine.getLastError());
+            ok = false;
+            break;
+        }
+    }
+
+    if (ok)
+    {
+        if (processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+        {
+            engine.connectPatchbayChain();
+
+            // let the graph rebuild its rendering sequence
+            carla_msleep(200);
+        }
+
+        const uint blocks(std::max(1U, static_cast<uint>(seconds * sampleRate / bufferSize)));
+        uint64_t allocations;
+
+        // warm-up, then measure from a clean state
+        engine.runBlocks(std::max(1U, blocks/10), allocations);
+        engine.clearProcessStats();
+        carla_msleep(10);
+
+        const uint64_t elapsedTime(engine.runBlocks(blocks, allocations));
+        const double frames(static_cast<double>(blocks) * bufferSize);
+
+        result.mode           = processMode == ENGINE_PROCESS_MODE_PATCHBAY ? "patchbay" : "rack";
+        result.label          = label;
+        result.pluginCount    = pluginCount;
+        result.bufferSize     = bufferSize;
+        result.sampleRate     = sampleRate;
+        result.blocks         = blocks;
+        result.nsPerFrame     = static_cast<double>(elapsedTime) / frames;
+        result.realtimeFactor = frames / sampleRate / (static_cast<double>(elapsedTime) / 1000000000.0);
+        result.allocations    = allocations;
+        result.plugins.clear();
+
+        for (uint i=0; i < pluginCount; ++i)
+        {
+            EngineProcessStats stats;
+            engine.getPluginProcessStats(i, stats);
+
+            const BenchmarkPluginResult pluginResult = { stats.avgTime, stats.p99Time, stats.maxTime };
+            result.plugins.push_back(pluginResult);
+        }
+    }
+
+    engine.close();
+    return ok;
+}
+
+static void printResult(const BenchmarkResult& result)
+{
+    double pluginAvgSum = 0.0;
+
+    for (std::vector<BenchmarkPluginResult>::const_iterator it = result.plugins.begin(); it != result.plugins.end(); ++it)
+        pluginAvgSum += it->avgTime;
+
+    const double pluginAvg(result.plugins.empty() ? 0.0 : pluginAvgSum / static_cast<double>(result.plugins.size()));
+
+    carla_stdout("  %-8s %-12s x%-3u %5u frames: %9.2f ns/frame, %8.1fx realtime, plugin avg %8.2f us (%8.2f ns/frame), %lu allocs",
+                 result.mode, result.label, result.pluginCount, result.bufferSize,
+                 result.nsPerFrame, result.realtimeFactor,
+                 pluginAvg, pluginAvg * 1000.0 / result.bufferSize,
+                 static_cast<ulong>(result.allocations));
+}
+
+static bool writeJson(const char* const filename, const std::vector<BenchmarkResult>& results)
+{
+    std::FILE* const file = std::fopen(filename, "w");
+    CARLA_SAFE_ASSERT_RETURN(file != nullptr, false);
+
+    std::fprintf(file, "[\n");
+
+    for (std::size_t i=0, count=results.size(); i < count; ++i)
+    {
+        const BenchmarkResult& result(results[i]);
+
+        std::fprintf(file, "  {\"mode\": \"%s\", \"label\": \"%s\", \"plugins\": %u, \"buffer_size\": %u, \"sample_rate\": %.0f, "
+                           "\"blocks\": %u, \"ns_per_frame\": %.3f, \"realtime_factor\": %.3f, \"allocations\": %lu,\n"
+                           "   \"plugin_stats\": [",
+                     result.mode, result.label, result.pluginCount, result.bufferSize, result.sampleRate,
+                     result.blocks, result.nsPerFrame, result.realtimeFactor, static_cast<ulong>(result.allocations));
+
+        for (std::size_t j=0, pcount=result.plugins.size(); j < pcount; ++j)
+        {
+            const BenchmarkPluginResult& plugin(result.plugins[j]);
+
+            std::fprintf(file, "%s{\"avg_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, \"ns_per_frame\": %.3f}",
+                         j == 0 ? "" : ", ", plugin.avgTime, plugin.p99Time, plugin.maxTime,
+                         plugin.avgTime * 1000.0 / result.bufferSize);
+        }
+
+        std::fprintf(file, "]}%s\n", i+1 == count ? "" : ",");
+    }
+
+    std::fprintf(file, "]\n");
+    std::fclose(file);
+    return true;
+}
+
+static void printUsage(const char* const argv0)
+{
+    carla_stdout("usage: %s [options] [label...]\n"
+                 "\n"
+                 "Runs sessions of N instances of each internal plugin label, for every buffer size and graph mode.\n"
+                 "Default labels are bypass, midithrough, zita-rev1, 3bandeq and zynaddsubfx.\n"
+                 "\n"
+                 "Options:\n"
+                 "  --plugins=N             Number of plugin instances per session, defaults to 4\n"
+                 "  --seconds=SECONDS       Length of audio processed per session, defaults to 10\n"
+                 "  --sample-rate=RATE      Sample rate, defaults to 48000\n"
+                 "  --buffer-sizes=A,B,...  Buffer sizes, defaults to 64,128,256,512,1024\n"
+                 "  --mode=MODE             rack, patchbay or both (default)\n"
+                 "  --json=FILE             Also write the results to FILE, as JSON", argv0);
+}
+
+int main(int argc, const char* argv[])
+{
+    uint pluginCount = 4;
+    double seconds = 10.0;
+    double sampleRate = 48000.0;
+    bool rack = true, patchbay = true;
+    const char* jsonFile = nullptr;
+
+    std::vector<uint32_t> bufferSizes;
+    std::vector<const char*> labels;
+
+    for (int i=1; i < argc; ++i)
+    {
+        const char* const arg(argv[i]);
+
+        if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0)
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (std::strncmp(arg, "--plugins=", 10) == 0)
+        {
+            pluginCount = static_cast<uint>(std::atoi(arg + 10));
+        }
+        else if (std::strncmp(arg, "--seconds=", 10) == 0)
+        {
+            seconds = std::atof(arg + 10);
+        }
+        else if (std::strncmp(arg, "--sample-rate=", 14) == 0)
+        {
+            sampleRate = std::atof(arg + 14);
+        }
+        else if (std::strncmp(arg, "--buffer-sizes=", 15) == 0)
+        {
+            for (const char* sizes = arg + 15; *sizes != '\0';)
+            {
+                bufferSizes.push_back(static_cast<uint32_t>(std::atoi(sizes)));
+
+                if (const char* const comma = std::strchr(sizes, ','))
+                    sizes = comma + 1;
+                else
+                    break;
+            }
+        }
+        else if (std::strncmp(arg, "--mode=", 7) == 0)
+        {
+            rack     = std::strcmp(arg + 7, "patchbay") != 0;
+            patchbay = std::strcmp(arg + 7, "rack") != 0;
+        }
+        else if (std::strncmp(arg, "--json=", 7) == 0)
+        {
+            jsonFile = arg + 7;
+        }
+        else if (arg[0] == '-')
+        {
+            carla_stderr2("Unknown option '%s'", arg);
+            return 1;
+        }
+        else
+        {
+            labels.push_back(arg);
+        }
+    }
+
+    if (pluginCount == 0 || pluginCount > MAX_RACK_PLUGINS || seconds <= 0.0 || sampleRate <= 0.0)
+    {
+        carla_stderr2("Invalid plugin count, length or sample rate");
+        return 1;
+    }
+
+    if (bufferSizes.empty())
+        for (uint i=0; kDefaultBufferSizes[i] != 0; ++i)
+            bufferSizes.push_back(kDefaultBufferSizes[i]);
+
+    if (labels.empty())
+        for (uint i=0; kDefaultLabels[i] != nullptr; ++i)
+            labels.push_back(kDefaultLabels[i]);
+
+    std::vector<BenchmarkResult> results;
+
+    for (std::vector<const char*>::iterator lit = labels.begin(); lit != labels.end(); ++lit)
+    {
+        carla_stdout("%s:", *lit);
+
+        // a plugin that fails to load is skipped for the remaining sessions
+        bool available = true;
+
+        for (std::vector<uint32_t>::iterator bit = bufferSizes.begin(); available && bit != bufferSizes.end(); ++bit)
+        {
+            CARLA_SAFE_ASSERT_CONTINUE(*bit > 0);
+
+            for (uint m=0; available && m < 2; ++m)
+            {
+                if (m == 0 && ! rack)
+                    continue;
+                if (m == 1 && ! patchbay)
+                    continue;
+
+                BenchmarkResult result;
+
+                if (runSession(m == 0 ? ENGINE_PROCESS_MODE_CONTINUOUS_RACK : ENGINE_PROCESS_MODE_PATCHBAY,
+                               *lit, pluginCount, *bit, sampleRate, seconds, result))
+                {
+                    printResult(result);
+                    results.push_back(result);
+                }
+                else
+                {
+                    available = false;
+                }
+            }
+        }
+    }
+
+    if (jsonFile != nullptr && ! writeJson(jsonFile, results))
+    {
+        carla_stderr2("Failed to write '%s'", jsonFile);
+        return 1;
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,196 @@
+/*
+ * Carla Pipe Benchmark
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "../utils/CarlaPipeUtils.cpp"
+#include "CarlaTimeUtils.hpp"
+
+// -----------------------------------------------------------------------
+// The same binary runs as server and client, the client floods the server with control and atom messages.
+
+static const uint32_t kNumMessages = 100000;
+static const uint32_t kAtomBodySize = 256;
+
+class BenchmarkClient : public CarlaPipeClient
+{
+public:
+    BenchmarkClient()
+        : CarlaPipeClient(),
+          fStarted(false) {}
+
+    bool isStarted() const noexcept
+    {
+        return fStarted;
+    }
+
+    bool msgReceived(const char* const msg) noexcept override
+    {
+        if (std::strcmp(msg, "start") == 0)
+        {
+            fStarted = true;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    bool fStarted;
+};
+
+class BenchmarkServer : public CarlaPipeServer
+{
+public:
+    BenchmarkServer()
+        : CarlaPipeServer(),
+          fNumControls(0),
+          fNumAtoms(0),
+          fNumBytes(0),
+          fDone(false) {}
+
+    uint32_t fNumControls;
+    uint32_t fNumAtoms;
+    uint64_t fNumBytes;
+    bool fDone;
+
+    bool msgReceived(const char* const msg) noexcept override
+    {
+        if (std::strcmp(msg, "control") == 0)
+        {
+            uint32_t index;
+            float value;
+
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(index), true);
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsFloat(value), true);
+
+            ++fNumControls;
+            return true;
+        }
+
+        if (std::strcmp(msg, "atom") == 0)
+        {
+            uint32_t index, size;
+            const LV2_Atom* atom;
+
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(index), true);
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(size), true);
+            CARLA_SAFE_ASSERT_RETURN(readNextLv2Atom(size, atom), true);
+            CARLA_SAFE_ASSERT_RETURN(atom->size == kAtomBodySize, true);
+
+            ++fNumAtoms;
+            fNumBytes += size;
+            return true;
+        }
+
+        if (std::strcmp(msg, "done") == 0)
+        {
+            fDone = true;
+            return true;
+        }
+
+        return false;
+    }
+};
+
+// -----------------------------------------------------------------------
+
+static int runClient(const char* argv[])
+{
+    BenchmarkClient client;
+    CARLA_SAFE_ASSERT_RETURN(client.initPipeClient(argv), 1);
+
+    while (! client.isStarted() && client.isPipeRunning())
+    {
+        client.idlePipe();
+        carla_msleep(1);
+    }
+
+    uint8_t atomBuf[sizeof(LV2_Atom) + kAtomBodySize];
+    carla_zeroBytes(atomBuf, sizeof(atomBuf));
+
+    LV2_Atom* const atom((LV2_Atom*)atomBuf);
+    atom->size = kAtomBodySize;
+    atom->type = 1;
+
+    for (uint32_t i=0; i < kNumMessages; ++i)
+    {
+        client.writeControlMessage(i % 100, static_cast<float>(i) / kNumMessages);
+        client.writeLv2AtomMessage(i % 100, atom);
+    }
+
+    client.lockPipe();
+    client.writeMessage("done\n", 5);
+    client.flushMessages();
+    client.unlockPipe();
+
+    // wait for server to close us
+    while (client.isPipeRunning())
+    {
+        client.idlePipe();
+        carla_msleep(10);
+    }
+
+    return 0;
+}
+
+static int runServer(const char* const filename)
+{
+    BenchmarkServer server;
+    CARLA_SAFE_ASSERT_RETURN(server.startPipeServer(filename, "client", "client"), 1);
+
+    // let both sides negotiate pipe features
+    for (int i=0; i < 20; ++i)
+    {
+        server.idlePipe();
+        carla_msleep(10);
+    }
+
+    const uint64_t startTime = carla_gettime_us();
+
+    server.lockPipe();
+    server.writeMessage("start\n", 6);
+    server.flushMessages();
+    server.unlockPipe();
+
+    while (! server.fDone && server.isPipeRunning())
+    {
+        server.idlePipe();
+        carla_msleep(1);
+    }
+
+    const double elapsed = static_cast<double>(carla_gettime_us() - startTime) / 1000000.0;
+
+    server.stopPipeServer(2000);
+
+    CARLA_SAFE_ASSERT_RETURN(server.fNumControls == kNumMessages, 1);
+    CARLA_SAFE_ASSERT_RETURN(server.fNumAtoms == kNumMessages, 1);
+
+    carla_stdout("%u control and %u atom messages in %.3fs: %.0f msgs/s, %.2f MiB/s of atoms",
+                 server.fNumControls, server.fNumAtoms, elapsed,
+                 static_cast<double>(server.fNumControls + server.fNumAtoms) / elapsed,
+                 static_cast<double>(server.fNumBytes) / elapsed / (1024.0 * 1024.0));
+    return 0;
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc != 1)
+        return runClient(argv);
+
+    return runServer(argv[0]);
+}
+
+// -----------------------------------------------------------------------
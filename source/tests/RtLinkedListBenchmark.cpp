@@ -0,0 +1,264 @@
+/*
+ * Carla RtLinkedList Pool Benchmark
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "RtLinkedList.hpp"
+
+#include "CarlaThread.hpp"
+#include "CarlaTimeUtils.hpp"
+
+extern "C" {
+#include "rtmempool/rtmempool.h"
+}
+
+// -----------------------------------------------------------------------
+// Several "realtime" threads hammer the same pool with atomic allocations while a non-RT thread
+// keeps refilling it. Every block is stamped and verified to catch double allocations.
+// rtmempool is built without its mutex (RTMEMPOOL_THREAD_SAFETY is 0), so it is only run from a
+// single thread and without refills, as a baseline for the uncontended allocation cost.
+
+static const uint kNumWorkers   = 4;
+static const uint kNumLoops     = 200000;
+static const uint kBurstSize    = 8;
+static const uint kMinBlocks    = 32;
+static const uint kMaxBlocks    = 256;
+
+struct MyData {
+    uint32_t owner;
+    uint32_t serial;
+    char padding[56];
+};
+
+typedef RtLinkedList<MyData>::Pool LockFreePool;
+
+// -----------------------------------------------------------------------
+
+struct LockFreeAdapter {
+    LockFreePool pool;
+
+    LockFreeAdapter()
+        : pool(kMinBlocks, kMaxBlocks) {}
+
+    void* allocate_atomic() noexcept { return pool.allocate_atomic(); }
+    void* allocate_sleepy() noexcept { return pool.allocate_sleepy(); }
+    void deallocate(void* const ptr) noexcept { pool.deallocate(ptr); }
+    void refill() noexcept { pool.refill(); }
+};
+
+struct RtMemPoolAdapter {
+    RtMemPool_Handle handle;
+
+    RtMemPoolAdapter()
+        : handle(nullptr)
+    {
+        rtsafe_memory_pool_create(&handle, nullptr, sizeof(MyData) + sizeof(void*)*2, kMinBlocks, kMaxBlocks);
+    }
+
+    ~RtMemPoolAdapter()
+    {
+        rtsafe_memory_pool_destroy(handle);
+    }
+
+    void* allocate_atomic() noexcept { return rtsafe_memory_pool_allocate_atomic(handle); }
+    void* allocate_sleepy() noexcept { return rtsafe_memory_pool_allocate_sleepy(handle); }
+    void deallocate(void* const ptr) noexcept { rtsafe_memory_pool_deallocate(handle, ptr); }
+    void refill() noexcept { rtsafe_memory_pool_deallocate(handle, rtsafe_memory_pool_allocate_sleepy(handle)); }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(RtMemPoolAdapter)
+};
+
+// -----------------------------------------------------------------------
+
+template<class Adapter>
+class WorkerThread : public CarlaThread
+{
+public:
+    WorkerThread(Adapter& adapter, const uint32_t id)
+        : CarlaThread("RtLinkedListBenchmark"),
+          fAllocations(0),
+          fFailures(0),
+          fCorruptions(0),
+          fTotalTime(0),
+          fMaxTime(0),
+          fAdapter(adapter),
+          fId(id) {}
+
+    uint64_t fAllocations, fFailures, fCorruptions;
+    uint64_t fTotalTime, fMaxTime;
+
+protected:
+    void run() override
+    {
+        MyData* blocks[kBurstSize];
+        uint32_t serial = 0;
+
+        for (uint i=0; i < kNumLoops; ++i)
+        {
+            for (uint j=0; j < kBurstSize; ++j)
+            {
+                const uint64_t start = carla_gettime_ns();
+                blocks[j] = (MyData*)fAdapter.allocate_atomic();
+                const uint64_t elapsed = carla_gettime_ns() - start;
+
+                fTotalTime += elapsed;
+                if (elapsed > fMaxTime)
+                    fMaxTime = elapsed;
+
+                if (blocks[j] == nullptr)
+                {
+                    ++fFailures;
+                    continue;
+                }
+
+                ++fAllocations;
+                blocks[j]->owner  = fId;
+                blocks[j]->serial = ++serial;
+            }
+
+            for (uint j=kBurstSize; j-- > 0;)
+            {
+                if (blocks[j] == nullptr)
+                    continue;
+
+                if (blocks[j]->owner != fId || blocks[j]->serial != serial--)
+                    ++fCorruptions;
+
+                fAdapter.deallocate(blocks[j]);
+            }
+        }
+    }
+
+private:
+    Adapter& fAdapter;
+    const uint32_t fId;
+};
+
+template<class Adapter>
+class RefillThread : public CarlaThread
+{
+public:
+    RefillThread(Adapter& adapter)
+        : CarlaThread("RtLinkedListBenchmarkRefill"),
+          fAdapter(adapter) {}
+
+protected:
+    void run() override
+    {
+        while (! shouldThreadExit())
+        {
+            fAdapter.refill();
+
+            if (void* const ptr = fAdapter.allocate_sleepy())
+                fAdapter.deallocate(ptr);
+
+            carla_msleep(1);
+        }
+    }
+
+private:
+    Adapter& fAdapter;
+};
+
+// -----------------------------------------------------------------------
+
+template<class Adapter>
+static bool runBenchmark(const char* const name, Adapter& adapter, const uint numWorkers, const bool withRefill)
+{
+    WorkerThread<Adapter>* workers[kNumWorkers];
+    RefillThread<Adapter> refiller(adapter);
+
+    CARLA_SAFE_ASSERT_RETURN(numWorkers <= kNumWorkers, false);
+
+    for (uint i=0; i < numWorkers; ++i)
+        workers[i] = new WorkerThread<Adapter>(adapter, i+1);
+
+    const uint64_t startTime = carla_gettime_us();
+
+    if (withRefill)
+        refiller.startThread();
+
+    for (uint i=0; i < numWorkers; ++i)
+        workers[i]->startThread();
+
+    for (uint i=0; i < numWorkers; ++i)
+        workers[i]->stopThread(-1);
+
+    if (withRefill)
+    {
+        refiller.signalThreadShouldExit();
+        refiller.stopThread(-1);
+    }
+
+    const double elapsed = static_cast<double>(carla_gettime_us() - startTime) / 1000000.0;
+
+    uint64_t allocations = 0, failures = 0, corruptions = 0, totalTime = 0, maxTime = 0;
+
+    for (uint i=0; i < numWorkers; ++i)
+    {
+        allocations += workers[i]->fAllocations;
+        failures    += workers[i]->fFailures;
+        corruptions += workers[i]->fCorruptions;
+        totalTime   += workers[i]->fTotalTime;
+
+        if (workers[i]->fMaxTime > maxTime)
+            maxTime = workers[i]->fMaxTime;
+
+        delete workers[i];
+    }
+
+    carla_stdout("%s: %llu allocations (%llu failed) in %.3fs, avg %.1fns, worst %.1fus, %llu corrupted",
+                 name,
+                 static_cast<unsigned long long>(allocations),
+                 static_cast<unsigned long long>(failures),
+                 elapsed,
+                 static_cast<double>(totalTime) / static_cast<double>(allocations + failures),
+                 static_cast<double>(maxTime) / 1000.0,
+                 static_cast<unsigned long long>(corruptions));
+
+    return corruptions == 0;
+}
+
+int main()
+{
+    bool ok = true;
+
+    {
+        LockFreeAdapter adapter;
+        ok &= runBenchmark("lock-free pool, 1 thread", adapter, 1, false);
+    }
+
+    {
+        LockFreeAdapter adapter;
+        ok &= runBenchmark("lock-free pool, 4 threads + refill", adapter, kNumWorkers, true);
+
+        const LockFreePool::Stats stats(adapter.pool.getStats());
+        carla_stdout("lock-free pool stats: %u blocks, %u in use, high-water %u, %u failed",
+                     uint(stats.total), uint(stats.used), uint(stats.highWater), uint(stats.failed));
+
+        ok &= (stats.used == 0);
+        ok &= (stats.total <= kMaxBlocks);
+        ok &= (stats.highWater <= stats.total);
+    }
+
+    {
+        RtMemPoolAdapter adapter;
+        ok &= runBenchmark("rtmempool, 1 thread", adapter, 1, false);
+    }
+
+    return ok ? 0 : 1;
+}
+
+// -----------------------------------------------------------------------
@@ -280,6 +280,8 @@ const char* EngineCallbackOpcode2Str(const EngineCallbackOpcode opcode) noexcept
         return "ENGINE_CALLBACK_ERROR";
     case ENGINE_CALLBACK_QUIT:
         return "ENGINE_CALLBACK_QUIT";
+    case ENGINE_CALLBACK_PROCESS_STATS:
+        return "ENGINE_CALLBACK_PROCESS_STATS";
     }
 
     carla_stderr("CarlaBackend::EngineCallbackOpcode2Str(%i) - invalid opcode", opcode);
@@ -341,6 +343,20 @@ const char* EngineOption2Str(const EngineOption option) noexcept
         return "ENGINE_OPTION_WINE_SERVER_RT_PRIO";
     case ENGINE_OPTION_DEBUG_CONSOLE_OUTPUT:
         return "ENGINE_OPTION_DEBUG_CONSOLE_OUTPUT";
+    case ENGINE_OPTION_AUDIO_WORKER_THREADS:
+        return "ENGINE_OPTION_AUDIO_WORKER_THREADS";
+    case ENGINE_OPTION_RACK_LANES:
+        return "ENGINE_OPTION_RACK_LANES";
+    case ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME:
+        return "ENGINE_OPTION_PLUGIN_BRIDGES_SPIN_TIME";
+    case ENGINE_OPTION_IDLE_MAX_INTERVAL:
+        return "ENGINE_OPTION_IDLE_MAX_INTERVAL";
+    case ENGINE_OPTION_PROJECT_LOAD_THREADS:
+        return "ENGINE_OPTION_PROJECT_LOAD_THREADS";
+    case ENGINE_OPTION_PROJECT_CHUNK_FILES:
+        return "ENGINE_OPTION_PROJECT_CHUNK_FILES";
+    case ENGINE_OPTION_PROCESS_STATS:
+        return "ENGINE_OPTION_PROCESS_STATS";
     }
 
     carla_stderr("CarlaBackend::EngineOption2Str(%i) - invalid option", option);
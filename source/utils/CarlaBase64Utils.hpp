@@ -37,13 +37,17 @@ static const char* const kBase64Chars =
 static inline
 uint8_t findBase64CharIndex(const char c)
 {
-    static const uint8_t kBase64CharsLen(static_cast<uint8_t>(std::strlen(kBase64Chars)));
-
-    for (uint8_t i=0; i<kBase64CharsLen; ++i)
-    {
-        if (kBase64Chars[i] == c)
-            return i;
-    }
+    // same order as kBase64Chars, without searching it for every single character
+    if (c >= 'A' && c <= 'Z')
+        return static_cast<uint8_t>(c - 'A');
+    if (c >= 'a' && c <= 'z')
+        return static_cast<uint8_t>(c - 'a' + 26);
+    if (c >= '0' && c <= '9')
+        return static_cast<uint8_t>(c - '0' + 52);
+    if (c == '+')
+        return 62;
+    if (c == '/')
+        return 63;
 
     carla_stderr2("findBase64CharIndex('%c') - failed", c);
     return 0;
@@ -20,7 +20,7 @@
 
 #include "CarlaRingBuffer.hpp"
 
-#define CARLA_PLUGIN_BRIDGE_API_VERSION 1
+#define CARLA_PLUGIN_BRIDGE_API_VERSION 3
 
 // -------------------------------------------------------------------------------------------------------------------
 
@@ -57,6 +57,7 @@ enum PluginBridgeNonRtClientOpcode {
     kPluginBridgeNonRtClientSetMidiProgram,          // int
     kPluginBridgeNonRtClientSetCustomData,           // uint/size, str[], uint/size, str[], uint/size, str[]
     kPluginBridgeNonRtClientSetChunkDataFile,        // uint/size, str[] (filename, base64 content)
+    kPluginBridgeNonRtClientSetChunkDataShm,         // uint/size, str[] (shm basename), ulong/size
     kPluginBridgeNonRtClientSetCtrlChannel,          // short
     kPluginBridgeNonRtClientSetOption,               // uint/option, bool
     kPluginBridgeNonRtClientPrepareForSave,
@@ -95,6 +96,8 @@ enum PluginBridgeNonRtServerOpcode {
     kPluginBridgeNonRtServerMidiProgramData,    // uint/index, uint/bank, uint/program, uint/size, str[] (name)
     kPluginBridgeNonRtServerSetCustomData,      // uint/size, str[], uint/size, str[], uint/size, str[]
     kPluginBridgeNonRtServerSetChunkDataFile,   // uint/size, str[] (filename, base64 content)
+    kPluginBridgeNonRtServerSetChunkDataBinaryFile, // uint/size, str[] (filename, raw content)
+    kPluginBridgeNonRtServerChunkDataShmReleased,
     kPluginBridgeNonRtServerSetLatency,         // uint
     kPluginBridgeNonRtServerReady,
     kPluginBridgeNonRtServerSaved,
@@ -139,6 +142,18 @@ struct BridgeTimeInfo {
     double barStartTick, ticksPerBeat, beatsPerMinute;
 };
 
+// spin-then-block handshake, semaphores are only posted when the other side is sleeping on them
+struct BridgeRtHandshake {
+    int32_t serverCount;   // requests sent by the server
+    int32_t clientCount;   // last request handled by the client
+    int32_t serverWaiting; // server is sleeping on sem.client
+    int32_t clientWaiting; // client is sleeping on sem.server
+    uint32_t spinTime;     // maximum busy-wait time in microseconds, 0 to always sleep
+    uint32_t clientTime;   // time the client took to handle the last request, in microseconds
+    int32_t rtPolicy;      // scheduling of the server audio thread, copied by the client
+    int32_t rtPriority;
+};
+
 // -------------------------------------------------------------------------------------------------------------------
 
 static const std::size_t kBridgeRtClientDataMidiOutSize = 511*4;
@@ -151,6 +166,7 @@ struct BridgeRtClientData {
     SmallStackBuffer ringBuffer;
     uint8_t midiOut[kBridgeRtClientDataMidiOutSize];
     uint32_t procFlags;
+    BridgeRtHandshake handshake;
 };
 
 // Server => Client Non-RT
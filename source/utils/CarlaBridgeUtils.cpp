@@ -17,6 +17,7 @@
 
 #include "CarlaBridgeUtils.hpp"
 #include "CarlaShmUtils.hpp"
+#include "CarlaTimeUtils.hpp"
 
 // must be last
 #include "jackbridge/JackBridge.hpp"
@@ -26,11 +27,13 @@
 # define PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT     "Global\\carla-bridge_shm_rtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_CLIENT "Global\\carla-bridge_shm_nonrtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_SERVER "Global\\carla-bridge_shm_nonrtS_"
+# define PLUGIN_BRIDGE_NAMEPREFIX_CHUNK_POOL    "Global\\carla-bridge_shm_chunk_"
 #else
 # define PLUGIN_BRIDGE_NAMEPREFIX_AUDIO_POOL    "/crlbrdg_shm_ap_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT     "/crlbrdg_shm_rtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_CLIENT "/crlbrdg_shm_nonrtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_SERVER "/crlbrdg_shm_nonrtS_"
+# define PLUGIN_BRIDGE_NAMEPREFIX_CHUNK_POOL    "/crlbrdg_shm_chunk_"
 #endif
 
 // -------------------------------------------------------------------------------------------------------------------
@@ -137,11 +140,129 @@ void BridgeAudioPool::resize(const uint32_t bufferSize, const uint32_t audioPort
 
 // -------------------------------------------------------------------------------------------------------------------
 
+BridgeChunkPool::BridgeChunkPool() noexcept
+    : data(nullptr),
+      dataSize(0),
+      filename(),
+      isServer(false),
+      inUse(false)
+{
+    carla_zeroChars(shm, 64);
+    jackbridge_shm_init(shm);
+}
+
+BridgeChunkPool::~BridgeChunkPool() noexcept
+{
+    clear();
+}
+
+bool BridgeChunkPool::initializeServer() noexcept
+{
+    char tmpFileBase[64];
+    std::sprintf(tmpFileBase, PLUGIN_BRIDGE_NAMEPREFIX_CHUNK_POOL "XXXXXX");
+
+    const carla_shm_t shm2 = carla_shm_create_temp(tmpFileBase);
+    CARLA_SAFE_ASSERT_RETURN(carla_is_shm_valid(shm2), false);
+
+    void* const shmptr = shm;
+    carla_shm_t& shm1  = *(carla_shm_t*)shmptr;
+    carla_copyStruct(shm1, shm2);
+
+    filename = tmpFileBase;
+    isServer = true;
+    return true;
+}
+
+bool BridgeChunkPool::attachClient(const char* const basename, const std::size_t size) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(basename != nullptr && basename[0] != '\0', false);
+    CARLA_SAFE_ASSERT_RETURN(size > 0, false);
+
+    // must be invalid right now
+    CARLA_SAFE_ASSERT_RETURN(! jackbridge_shm_is_valid(shm), false);
+
+    filename  = PLUGIN_BRIDGE_NAMEPREFIX_CHUNK_POOL;
+    filename += basename;
+
+    jackbridge_shm_attach(shm, filename);
+    CARLA_SAFE_ASSERT_RETURN(jackbridge_shm_is_valid(shm), false);
+
+    data = (uint8_t*)jackbridge_shm_map(shm, size);
+
+    if (data == nullptr)
+    {
+        clear();
+        return false;
+    }
+
+    dataSize = size;
+    return true;
+}
+
+void BridgeChunkPool::clear() noexcept
+{
+    filename.clear();
+    inUse = false;
+
+    if (! jackbridge_shm_is_valid(shm))
+    {
+        CARLA_SAFE_ASSERT(data == nullptr);
+        return;
+    }
+
+    // unlike the audio pool, the client maps a new size for every chunk, so always unmap
+    if (data != nullptr)
+    {
+        jackbridge_shm_unmap(shm, data);
+        data = nullptr;
+    }
+
+    dataSize = 0;
+    jackbridge_shm_close(shm);
+    jackbridge_shm_init(shm);
+}
+
+bool BridgeChunkPool::resize(const std::size_t size) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(jackbridge_shm_is_valid(shm), false);
+    CARLA_SAFE_ASSERT_RETURN(isServer, false);
+    CARLA_SAFE_ASSERT_RETURN(size > 0, false);
+
+    // only ever grows
+    if (data != nullptr && size <= dataSize)
+        return true;
+
+    if (data != nullptr)
+    {
+        jackbridge_shm_unmap(shm, data);
+        data = nullptr;
+        dataSize = 0;
+    }
+
+    data = (uint8_t*)jackbridge_shm_map(shm, size);
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
+
+    dataSize = size;
+    return true;
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+
 BridgeRtClientControl::BridgeRtClientControl() noexcept
     : data(nullptr),
       filename(),
       needsSemDestroy(false),
-      isServer(false)
+      isServer(false),
+      spinBudget(0),
+      lastRoundTrip(0),
+      averageRoundTrip(0),
+      maximumRoundTrip(0),
+      pendingRequest(0),
+      pendingTime(0),
+      rtThread(),
+      rtCheckTime(0),
+      rtPolicy(0),
+      rtPriority(0)
 {
     carla_zeroChars(shm, 64);
     jackbridge_shm_init(shm);
@@ -219,6 +340,7 @@ bool BridgeRtClientControl::attachClient(const char* const basename) noexcept
 void BridgeRtClientControl::clear() noexcept
 {
     filename.clear();
+    rtCheckTime = 0;
 
     if (needsSemDestroy)
     {
@@ -273,16 +395,107 @@ void BridgeRtClientControl::unmapData() noexcept
     setRingBuffer(nullptr, false);
 }
 
+// request counters wrap around, compare them as a difference
+static inline
+bool isBridgeRequestDone(const BridgeRtHandshake& handshake, const int32_t request) noexcept
+{
+    return static_cast<int32_t>(static_cast<uint32_t>(handshake.clientCount) - static_cast<uint32_t>(request)) >= 0;
+}
+
 bool BridgeRtClientControl::waitForClient(const uint msecs) noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(msecs > 0, false);
     CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
     CARLA_SAFE_ASSERT_RETURN(isServer, false);
 
-    jackbridge_sem_post(&data->sem.server, true);
+    signalClient();
+    return waitForClientDone(msecs);
+}
+
+void BridgeRtClientControl::signalClient() noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(isServer,);
+
+    BridgeRtHandshake& handshake(data->handshake);
+
+    pendingTime    = carla_gettime_us();
+    pendingRequest = __sync_add_and_fetch(&handshake.serverCount, 1);
+
+    // only wake up the client if it went to sleep
+    if (__sync_bool_compare_and_swap(&handshake.clientWaiting, 1, 0))
+        jackbridge_sem_post(&data->sem.server, true);
+}
+
+bool BridgeRtClientControl::waitForClientDone(const uint msecs) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(msecs > 0, false);
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
+    CARLA_SAFE_ASSERT_RETURN(isServer, false);
+
+    BridgeRtHandshake& handshake(data->handshake);
 
-    return jackbridge_sem_timedwait(&data->sem.client, msecs, true);
-    return false;
+    const uint64_t startTime = pendingTime;
+    const int32_t  request   = pendingRequest;
+
+    bool done = false;
+
+    // busy-wait while the client is likely to finish soon
+    if (spinBudget != 0)
+    {
+        for (;;)
+        {
+            if (isBridgeRequestDone(handshake, request))
+            {
+                done = true;
+                break;
+            }
+
+            if (carla_gettime_us() - startTime >= spinBudget)
+                break;
+
+            carla_cpu_relax();
+        }
+    }
+
+    if (! done)
+    {
+        __sync_lock_test_and_set(&handshake.serverWaiting, 1);
+
+        // check again, the client might have finished in the meantime
+        if (! isBridgeRequestDone(handshake, request))
+            done = jackbridge_sem_timedwait(&data->sem.client, msecs, true);
+
+        // if we cannot take back the flag then the client has posted (or is about to), consume it
+        if (! done && ! __sync_bool_compare_and_swap(&handshake.serverWaiting, 1, 0))
+            done = jackbridge_sem_timedwait(&data->sem.client, msecs, true);
+        else if (! done)
+            done = isBridgeRequestDone(handshake, request);
+    }
+
+    if (! done)
+        return false;
+
+    const uint32_t roundTrip = static_cast<uint32_t>(carla_gettime_us() - startTime);
+
+    lastRoundTrip    = roundTrip;
+    averageRoundTrip = averageRoundTrip != 0 ? (averageRoundTrip * 7 + roundTrip) / 8 : roundTrip;
+
+    if (roundTrip > maximumRoundTrip)
+        maximumRoundTrip = roundTrip;
+
+    // spin a bit longer than the client usually takes, or not at all if it is too slow
+    const uint32_t spinTime   = handshake.spinTime;
+    const uint32_t clientTime = handshake.clientTime;
+
+    if (spinTime == 0 || clientTime >= spinTime)
+        spinBudget = 0;
+    else if (clientTime * 2 + 10 < spinTime)
+        spinBudget = clientTime * 2 + 10;
+    else
+        spinBudget = spinTime;
+
+    return true;
 }
 
 void BridgeRtClientControl::writeOpcode(const PluginBridgeRtClientOpcode opcode) noexcept
@@ -290,6 +503,51 @@ void BridgeRtClientControl::writeOpcode(const PluginBridgeRtClientOpcode opcode)
     writeUInt(static_cast<uint32_t>(opcode));
 }
 
+void BridgeRtClientControl::setSpinTime(const uint usecs) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(isServer,);
+
+    uint spinTime = usecs;
+
+#ifndef CARLA_OS_WIN
+    // busy-waiting only makes sense if server and client can run at the same time
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+        spinTime = 0;
+#endif
+
+    data->handshake.spinTime = spinTime;
+    spinBudget = spinTime;
+}
+
+void BridgeRtClientControl::updateRtPriority() noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(isServer,);
+
+#ifndef CARLA_OS_WIN
+    const pthread_t thread = pthread_self();
+    const uint64_t  now    = carla_gettime_us();
+
+    // scheduling rarely changes, only query it again for a new thread or once per second
+    if (rtCheckTime != 0 && pthread_equal(thread, rtThread) && now - rtCheckTime < 1000000)
+        return;
+
+    rtThread    = thread;
+    rtCheckTime = now;
+
+    int policy;
+    sched_param param;
+    carla_zeroStruct(param);
+
+    if (pthread_getschedparam(thread, &policy, &param) != 0)
+        return;
+
+    data->handshake.rtPolicy   = policy;
+    data->handshake.rtPriority = param.sched_priority;
+#endif
+}
+
 PluginBridgeRtClientOpcode BridgeRtClientControl::readOpcode() noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(! isServer, kPluginBridgeRtClientNull);
@@ -298,12 +556,79 @@ PluginBridgeRtClientOpcode BridgeRtClientControl::readOpcode() noexcept
 }
 
 BridgeRtClientControl::WaitHelper::WaitHelper(BridgeRtClientControl& c) noexcept
-    : data(c.data),
-      ok(jackbridge_sem_timedwait(&data->sem.server, 5000, false)) {}
+    : control(c),
+      data(c.data),
+      request(0),
+      startTime(0),
+      ok(false)
+{
+    BridgeRtHandshake& handshake(data->handshake);
+
+    if (handshake.serverCount == handshake.clientCount)
+    {
+        // busy-wait for the next request, if the server allows it
+        if (const uint32_t spinTime = handshake.spinTime)
+        {
+            const uint64_t spinStart = carla_gettime_us();
+
+            while (handshake.serverCount == handshake.clientCount && carla_gettime_us() - spinStart < spinTime)
+                carla_cpu_relax();
+        }
+
+        if (handshake.serverCount == handshake.clientCount)
+        {
+            __sync_lock_test_and_set(&handshake.clientWaiting, 1);
+
+            bool posted = false;
+
+            // check again, the server might have sent a request in the meantime
+            if (handshake.serverCount == handshake.clientCount)
+                posted = jackbridge_sem_timedwait(&data->sem.server, 5000, false);
+
+            // if we cannot take back the flag then the server has posted (or is about to), consume it
+            if (! posted && ! __sync_bool_compare_and_swap(&handshake.clientWaiting, 1, 0))
+                posted = jackbridge_sem_timedwait(&data->sem.server, 5000, false);
+
+            if (! posted && handshake.serverCount == handshake.clientCount)
+                return;
+        }
+    }
+
+    __sync_synchronize();
+
+    request   = handshake.serverCount;
+    startTime = carla_gettime_us();
+    ok        = true;
+
+#ifndef CARLA_OS_WIN
+    // follow the scheduling of the server audio thread
+    if (handshake.rtPolicy != control.rtPolicy || handshake.rtPriority != control.rtPriority)
+    {
+        control.rtPolicy   = handshake.rtPolicy;
+        control.rtPriority = handshake.rtPriority;
+
+        sched_param param;
+        carla_zeroStruct(param);
+        param.sched_priority = control.rtPriority;
+
+        pthread_setschedparam(pthread_self(), control.rtPolicy, &param);
+    }
+#endif
+}
 
 BridgeRtClientControl::WaitHelper::~WaitHelper() noexcept
 {
-    if (ok)
+    if (! ok)
+        return;
+
+    BridgeRtHandshake& handshake(data->handshake);
+
+    handshake.clientTime = static_cast<uint32_t>(carla_gettime_us() - startTime);
+    __sync_synchronize();
+    __sync_lock_test_and_set(&handshake.clientCount, request);
+
+    // only wake up the server if it went to sleep
+    if (__sync_bool_compare_and_swap(&handshake.serverWaiting, 1, 0))
         jackbridge_sem_post(&data->sem.client, false);
 }
 
@@ -104,6 +104,8 @@ const char* PluginBridgeNonRtClientOpcode2str(const PluginBridgeNonRtClientOpcod
         return "kPluginBridgeNonRtClientSetCustomData";
     case kPluginBridgeNonRtClientSetChunkDataFile:
         return "kPluginBridgeNonRtClientSetChunkDataFile";
+    case kPluginBridgeNonRtClientSetChunkDataShm:
+        return "kPluginBridgeNonRtClientSetChunkDataShm";
     case kPluginBridgeNonRtClientSetCtrlChannel:
         return "kPluginBridgeNonRtClientSetCtrlChannel";
     case kPluginBridgeNonRtClientSetOption:
@@ -183,6 +185,10 @@ const char* PluginBridgeNonRtServerOpcode2str(const PluginBridgeNonRtServerOpcod
         return "kPluginBridgeNonRtServerSetCustomData";
     case kPluginBridgeNonRtServerSetChunkDataFile:
         return "kPluginBridgeNonRtServerSetChunkDataFile";
+    case kPluginBridgeNonRtServerSetChunkDataBinaryFile:
+        return "kPluginBridgeNonRtServerSetChunkDataBinaryFile";
+    case kPluginBridgeNonRtServerChunkDataShmReleased:
+        return "kPluginBridgeNonRtServerChunkDataShmReleased";
     case kPluginBridgeNonRtServerSetLatency:
         return "kPluginBridgeNonRtServerSetLatency";
     case kPluginBridgeNonRtServerReady:
@@ -222,6 +228,29 @@ struct BridgeAudioPool {
 
 // -------------------------------------------------------------------------------------------------------------------
 
+// used to send big chunks to the bridge without going through base64 and temporary files
+struct BridgeChunkPool {
+    uint8_t* data;
+    std::size_t dataSize;
+    CarlaString filename;
+    char shm[64];
+    bool isServer;
+    volatile bool inUse;
+
+    BridgeChunkPool() noexcept;
+    ~BridgeChunkPool() noexcept;
+
+    bool initializeServer() noexcept;
+    bool attachClient(const char* const fname, const std::size_t size) noexcept;
+    void clear() noexcept;
+
+    bool resize(const std::size_t size) noexcept;
+
+    CARLA_DECLARE_NON_COPY_STRUCT(BridgeChunkPool)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+
 struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
     BridgeRtClientData* data;
     CarlaString filename;
@@ -229,6 +258,24 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
     char shm[64];
     bool isServer;
 
+    // server only, round-trip statistics in microseconds
+    uint32_t spinBudget;
+    uint32_t lastRoundTrip;
+    uint32_t averageRoundTrip;
+    uint32_t maximumRoundTrip;
+
+    // server only, last request sent to the client
+    int32_t  pendingRequest;
+    uint64_t pendingTime;
+
+    // server only, thread whose scheduling was last sent to the client
+    pthread_t rtThread;
+    uint64_t  rtCheckTime;
+
+    // client only, last scheduling applied from the server
+    int32_t rtPolicy;
+    int32_t rtPriority;
+
     BridgeRtClientControl() noexcept;
     ~BridgeRtClientControl() noexcept override;
 
@@ -241,15 +288,22 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
 
     // non-bridge, server
     bool waitForClient(const uint msecs) noexcept;
+    void signalClient() noexcept;
+    bool waitForClientDone(const uint msecs) noexcept;
     void writeOpcode(const PluginBridgeRtClientOpcode opcode) noexcept;
+    void setSpinTime(const uint usecs) noexcept;
+    void updateRtPriority() noexcept;
 
     // bridge, client
     PluginBridgeRtClientOpcode readOpcode() noexcept;
 
     // helper class that automatically posts semaphore on destructor
     struct WaitHelper {
+        BridgeRtClientControl& control;
         BridgeRtClientData* const data;
-        const bool ok;
+        int32_t request;
+        uint64_t startTime;
+        bool ok;
 
         WaitHelper(BridgeRtClientControl& c) noexcept;
         ~WaitHelper() noexcept;
@@ -48,6 +48,8 @@ const char* EngineType2Str(const EngineType type) noexcept
         return "kEngineTypePlugin";
     case kEngineTypeBridge:
         return "kEngineTypeBridge";
+    case kEngineTypeOffline:
+        return "kEngineTypeOffline";
     }
 
     carla_stderr("CarlaBackend::EngineType2Str(%i) - invalid type", type);
@@ -116,53 +118,47 @@ const char* EngineControlEventType2Str(const EngineControlEventType type) noexce
 // -----------------------------------------------------------------------
 
 static inline
-void fillEngineEventsFromWaterMidiBuffer(EngineEvent engineEvents[kMaxEngineEventInternalCount], const water::MidiBuffer& midiBuffer)
+void fillEngineEventsFromWaterMidiBuffer(EngineEventBuffer& engineEvents, const water::MidiBuffer& midiBuffer)
 {
+    CARLA_SAFE_ASSERT_RETURN(engineEvents.data != nullptr,);
+
     const uint8_t* midiData;
     int numBytes, sampleNumber;
-    ushort engineEventIndex = 0;
-
-    for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
-    {
-        const EngineEvent& engineEvent(engineEvents[i]);
-
-        if (engineEvent.type != kEngineEventTypeNull)
-            continue;
-
-        engineEventIndex = i;
-        break;
-    }
 
-    for (water::MidiBuffer::Iterator midiBufferIterator(midiBuffer); midiBufferIterator.getNextEvent(midiData, numBytes, sampleNumber) && engineEventIndex < kMaxEngineEventInternalCount;)
+    // appends after any events already present
+    for (water::MidiBuffer::Iterator midiBufferIterator(midiBuffer); midiBufferIterator.getNextEvent(midiData, numBytes, sampleNumber) && ! engineEvents.isFull();)
     {
         CARLA_SAFE_ASSERT_CONTINUE(numBytes > 0);
         CARLA_SAFE_ASSERT_CONTINUE(sampleNumber >= 0);
         CARLA_SAFE_ASSERT_CONTINUE(numBytes < 0xFF /* uint8_t max */);
 
-        EngineEvent& engineEvent(engineEvents[engineEventIndex++]);
+        EngineEvent& engineEvent(engineEvents.data[engineEvents.count]);
 
         engineEvent.time = static_cast<uint32_t>(sampleNumber);
         engineEvent.fillFromMidiData(static_cast<uint8_t>(numBytes), midiData, 0);
+
+        if (engineEvent.type != kEngineEventTypeNull)
+            ++engineEvents.count;
     }
 }
 
 // -----------------------------------------------------------------------
 
 static inline
-void fillWaterMidiBufferFromEngineEvents(water::MidiBuffer& midiBuffer, const EngineEvent engineEvents[kMaxEngineEventInternalCount])
+void fillWaterMidiBufferFromEngineEvents(water::MidiBuffer& midiBuffer, const EngineEventBuffer& engineEvents)
 {
     uint8_t        size     = 0;
     uint8_t        mdata[3] = { 0, 0, 0 };
     const uint8_t* mdataPtr = mdata;
     uint8_t        mdataTmp[EngineMidiEvent::kDataSize];
 
-    for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+    for (uint32_t i=0; i < engineEvents.count; ++i)
     {
-        const EngineEvent& engineEvent(engineEvents[i]);
+        const EngineEvent& engineEvent(engineEvents.data[i]);
 
         if (engineEvent.type == kEngineEventTypeNull)
         {
-            break;
+            continue;
         }
         else if (engineEvent.type == kEngineEventTypeControl)
         {
@@ -201,6 +197,128 @@ void fillWaterMidiBufferFromEngineEvents(water::MidiBuffer& midiBuffer, const En
     }
 }
 
+// -----------------------------------------------------------------------
+// Process time statistics, filled by one RT thread and read from any other without locking.
+// Times go into a log-scale histogram with 4 buckets per power of 2 nanoseconds, used for percentiles.
+
+struct EngineProcessTimeStats {
+    static const uint kBucketCount = 128;
+
+    volatile uint32_t count;
+    volatile uint32_t minTime;
+    volatile uint32_t maxTime;
+    volatile uint64_t totalTime;
+    volatile uint32_t buckets[kBucketCount];
+    volatile int      clearPending;
+
+    EngineProcessTimeStats() noexcept
+        : count(0),
+          minTime(0),
+          maxTime(0),
+          totalTime(0),
+          clearPending(0)
+    {
+        clear();
+    }
+
+    // only safe while no times are being added
+    void clear() noexcept
+    {
+        count     = 0;
+        minTime   = 0;
+        maxTime   = 0;
+        totalTime = 0;
+
+        for (uint i=0; i < kBucketCount; ++i)
+            buckets[i] = 0;
+    }
+
+    // non-RT, the actual clearing happens on the next addTime() call
+    void requestClear() noexcept
+    {
+        __sync_bool_compare_and_swap(&clearPending, 0, 1);
+    }
+
+    // RT
+    void addTime(const uint64_t nanoseconds) noexcept
+    {
+        if (clearPending != 0 && __sync_bool_compare_and_swap(&clearPending, 1, 0))
+            clear();
+
+        const uint32_t time = nanoseconds < 0xffffffffULL ? static_cast<uint32_t>(nanoseconds) : 0xffffffffU;
+
+        if (count == 0 || time < minTime)
+            minTime = time;
+        if (time > maxTime)
+            maxTime = time;
+
+        totalTime += time;
+        ++buckets[getBucketIndex(time)];
+
+        // readers use count to know how much data there is, so update it last
+        __sync_synchronize();
+        ++count;
+    }
+
+    void fill(EngineProcessStats& stats) const noexcept
+    {
+        stats.clear();
+
+        const uint32_t numTimes = count;
+
+        if (numTimes == 0 || clearPending != 0)
+            return;
+
+        stats.count   = numTimes;
+        stats.minTime = static_cast<float>(minTime) / 1000.0f;
+        stats.maxTime = static_cast<float>(maxTime) / 1000.0f;
+        stats.avgTime = static_cast<float>(totalTime / numTimes) / 1000.0f;
+        stats.p50Time = getPercentile(0.50, numTimes);
+        stats.p90Time = getPercentile(0.90, numTimes);
+        stats.p99Time = getPercentile(0.99, numTimes);
+    }
+
+    // upper bound of the bucket holding the requested percentile, in microseconds
+    float getPercentile(const double percentile, const uint32_t numTimes) const noexcept
+    {
+        const uint64_t target = static_cast<uint64_t>(percentile * numTimes + 0.5);
+        uint64_t seen = 0;
+
+        for (uint i=0; i < kBucketCount; ++i)
+        {
+            seen += buckets[i];
+
+            if (seen < target || seen == 0)
+                continue;
+
+            const uint64_t upper = getBucketUpperTime(i);
+            return static_cast<float>(upper < maxTime ? upper : maxTime) / 1000.0f;
+        }
+
+        return static_cast<float>(maxTime) / 1000.0f;
+    }
+
+    static uint getBucketIndex(const uint32_t time) noexcept
+    {
+        if (time < 4)
+            return time;
+
+        const uint msb = 31U - static_cast<uint>(__builtin_clz(time));
+        return (msb - 1) * 4 + ((time >> (msb - 2)) & 3);
+    }
+
+    static uint64_t getBucketUpperTime(const uint index) noexcept
+    {
+        if (index < 4)
+            return index + 1;
+
+        const uint msb = index / 4 + 1;
+        return static_cast<uint64_t>(4 + index % 4 + 1) << (msb - 2);
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EngineProcessTimeStats)
+};
+
 // -------------------------------------------------------------------
 // Helper classes
 
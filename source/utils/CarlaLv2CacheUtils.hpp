@@ -0,0 +1,977 @@
+/*
+ * Carla LV2 metadata cache
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_LV2_CACHE_UTILS_HPP_INCLUDED
+#define CARLA_LV2_CACHE_UTILS_HPP_INCLUDED
+
+#include "CarlaString.hpp"
+#include "lv2_rdf.hpp"
+
+#include "water/files/File.h"
+#include "water/text/StringArray.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <sys/stat.h>
+
+#ifndef CARLA_OS_WIN
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------
+// The cache file keeps everything needed to list LV2 plugins and to create their LV2_RDF_Descriptor
+// without loading the lilv world. It is written in native byte order and mmap'ed read-only.
+//
+// Layout:
+//  - header: magic, version, LV2_PATH used for scanning, bundle count, plugin count
+//  - bundles: path and modification time of every bundle found in LV2_PATH, sorted by path
+//  - plugins: bundle, URI, cached plugin info and a serialized LV2_RDF_Descriptor
+//
+// Strings are stored as a 32-bit length followed by the string and its null terminator,
+// so they can be used in-place from the mapped file.
+
+static const char     kLv2CacheMagic[8] = { 'C', 'a', 'r', 'l', 'a', 'L', 'V', '2' };
+static const uint32_t kLv2CacheVersion  = 2;
+static const uint32_t kLv2CacheNullStr  = 0xffffffff;
+
+// -----------------------------------------------------------------------
+// Binary writer
+
+class Lv2CacheWriter
+{
+public:
+    Lv2CacheWriter()
+        : fData() {}
+
+    void writeData(const void* const data, const std::size_t size)
+    {
+        const uint8_t* const bytes = static_cast<const uint8_t*>(data);
+        fData.insert(fData.end(), bytes, bytes + size);
+    }
+
+    void writeU32(const uint32_t value)
+    {
+        writeData(&value, sizeof(uint32_t));
+    }
+
+    void writeU64(const uint64_t value)
+    {
+        writeData(&value, sizeof(uint64_t));
+    }
+
+    void writeFloat(const float value)
+    {
+        writeData(&value, sizeof(float));
+    }
+
+    void writeString(const char* const str)
+    {
+        if (str == nullptr)
+            return writeU32(kLv2CacheNullStr);
+
+        const std::size_t len = std::strlen(str);
+        writeU32(static_cast<uint32_t>(len));
+        writeData(str, len+1);
+    }
+
+    const uint8_t* getData() const noexcept
+    {
+        return fData.empty() ? nullptr : &fData[0];
+    }
+
+    std::size_t getSize() const noexcept
+    {
+        return fData.size();
+    }
+
+private:
+    std::vector<uint8_t> fData;
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2CacheWriter)
+};
+
+// -----------------------------------------------------------------------
+// Binary reader, works directly on the mapped data
+
+class Lv2CacheReader
+{
+public:
+    Lv2CacheReader(const uint8_t* const data, const std::size_t size) noexcept
+        : fData(data),
+          fSize(size),
+          fPos(0) {}
+
+    bool readData(void* const data, const std::size_t size) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(fPos + size <= fSize, false);
+
+        std::memcpy(data, fData + fPos, size);
+        fPos += size;
+        return true;
+    }
+
+    bool readU32(uint32_t& value) noexcept
+    {
+        return readData(&value, sizeof(uint32_t));
+    }
+
+    bool readU64(uint64_t& value) noexcept
+    {
+        return readData(&value, sizeof(uint64_t));
+    }
+
+    bool readFloat(float& value) noexcept
+    {
+        return readData(&value, sizeof(float));
+    }
+
+    // returns a pointer inside the data, valid for as long as the data is
+    bool readString(const char*& str) noexcept
+    {
+        uint32_t len;
+        if (! readU32(len))
+            return false;
+
+        if (len == kLv2CacheNullStr)
+        {
+            str = nullptr;
+            return true;
+        }
+
+        CARLA_SAFE_ASSERT_RETURN(fPos + len + 1 <= fSize, false);
+        CARLA_SAFE_ASSERT_RETURN(fData[fPos + len] == '\0', false);
+
+        str = reinterpret_cast<const char*>(fData + fPos);
+        fPos += len + 1;
+        return true;
+    }
+
+    // same as above, but returns a copy owned by the caller
+    bool readStringCopy(const char*& str) noexcept
+    {
+        const char* tmp;
+        if (! readString(tmp))
+            return false;
+
+        str = (tmp != nullptr) ? carla_strdup_safe(tmp) : nullptr;
+        return true;
+    }
+
+    bool skip(const std::size_t size) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(fPos + size <= fSize, false);
+
+        fPos += size;
+        return true;
+    }
+
+    const uint8_t* getCurrentData() const noexcept
+    {
+        return fData + fPos;
+    }
+
+    std::size_t getRemainingSize() const noexcept
+    {
+        return fSize - fPos;
+    }
+
+private:
+    const uint8_t* const fData;
+    const std::size_t fSize;
+    std::size_t fPos;
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2CacheReader)
+};
+
+// -----------------------------------------------------------------------
+// Serialize RDF object
+
+static inline
+void lv2_rdf_write_features(Lv2CacheWriter& writer, const uint32_t count, const LV2_RDF_Feature* const features)
+{
+    writer.writeU32(count);
+
+    for (uint32_t i=0; i < count; ++i)
+    {
+        writer.writeU32(features[i].Required ? 1 : 0);
+        writer.writeString(features[i].URI);
+    }
+}
+
+static inline
+void lv2_rdf_write_extensions(Lv2CacheWriter& writer, const uint32_t count, const LV2_URI* const extensions)
+{
+    writer.writeU32(count);
+
+    for (uint32_t i=0; i < count; ++i)
+        writer.writeString(extensions[i]);
+}
+
+static inline
+void lv2_rdf_write(Lv2CacheWriter& writer, const LV2_RDF_Descriptor* const desc)
+{
+    writer.writeU32(desc->Type[0]);
+    writer.writeU32(desc->Type[1]);
+    writer.writeString(desc->URI);
+    writer.writeString(desc->Name);
+    writer.writeString(desc->Author);
+    writer.writeString(desc->License);
+    writer.writeString(desc->Binary);
+    writer.writeString(desc->Bundle);
+    writer.writeU64(desc->UniqueID);
+
+    writer.writeU32(desc->PortCount);
+
+    for (uint32_t i=0; i < desc->PortCount; ++i)
+    {
+        const LV2_RDF_Port& port(desc->Ports[i]);
+
+        writer.writeU32(port.Types);
+        writer.writeU32(port.Properties);
+        writer.writeU32(port.Designation);
+        writer.writeString(port.Name);
+        writer.writeString(port.Symbol);
+
+        writer.writeU32(port.MidiMap.Type);
+        writer.writeU32(port.MidiMap.Number);
+
+        writer.writeU32(port.Points.Hints);
+        writer.writeFloat(port.Points.Default);
+        writer.writeFloat(port.Points.Minimum);
+        writer.writeFloat(port.Points.Maximum);
+
+        writer.writeU32(port.Unit.Hints);
+        writer.writeString(port.Unit.Name);
+        writer.writeString(port.Unit.Render);
+        writer.writeString(port.Unit.Symbol);
+        writer.writeU32(port.Unit.Unit);
+
+        writer.writeU32(port.MinimumSize);
+
+        writer.writeU32(port.ScalePointCount);
+
+        for (uint32_t j=0; j < port.ScalePointCount; ++j)
+        {
+            writer.writeString(port.ScalePoints[j].Label);
+            writer.writeFloat(port.ScalePoints[j].Value);
+        }
+    }
+
+    writer.writeU32(desc->PresetCount);
+
+    for (uint32_t i=0; i < desc->PresetCount; ++i)
+    {
+        writer.writeString(desc->Presets[i].URI);
+        writer.writeString(desc->Presets[i].Label);
+    }
+
+    lv2_rdf_write_features(writer, desc->FeatureCount, desc->Features);
+    lv2_rdf_write_extensions(writer, desc->ExtensionCount, desc->Extensions);
+
+    writer.writeU32(desc->UICount);
+
+    for (uint32_t i=0; i < desc->UICount; ++i)
+    {
+        const LV2_RDF_UI& ui(desc->UIs[i]);
+
+        writer.writeU32(ui.Type);
+        writer.writeString(ui.URI);
+        writer.writeString(ui.Binary);
+        writer.writeString(ui.Bundle);
+
+        lv2_rdf_write_features(writer, ui.FeatureCount, ui.Features);
+        lv2_rdf_write_extensions(writer, ui.ExtensionCount, ui.Extensions);
+    }
+}
+
+// -----------------------------------------------------------------------
+// Deserialize RDF object, counts are only set after their arrays so a partial object can be deleted
+
+static inline
+bool lv2_rdf_read_features(Lv2CacheReader& reader, uint32_t& count, LV2_RDF_Feature*& features)
+{
+    uint32_t newCount, required;
+    CARLA_SAFE_ASSERT_RETURN(reader.readU32(newCount), false);
+
+    if (newCount == 0)
+        return true;
+
+    features = new LV2_RDF_Feature[newCount];
+    count    = newCount;
+
+    for (uint32_t i=0; i < newCount; ++i)
+    {
+        CARLA_SAFE_ASSERT_RETURN(reader.readU32(required), false);
+        CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(features[i].URI), false);
+        features[i].Required = (required != 0);
+    }
+
+    return true;
+}
+
+static inline
+bool lv2_rdf_read_extensions(Lv2CacheReader& reader, uint32_t& count, LV2_URI*& extensions)
+{
+    uint32_t newCount;
+    CARLA_SAFE_ASSERT_RETURN(reader.readU32(newCount), false);
+
+    if (newCount == 0)
+        return true;
+
+    extensions = new LV2_URI[newCount];
+    carla_zeroPointers(extensions, newCount);
+    count = newCount;
+
+    for (uint32_t i=0; i < newCount; ++i)
+        CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(extensions[i]), false);
+
+    return true;
+}
+
+static inline
+bool lv2_rdf_read_internal(Lv2CacheReader& reader, LV2_RDF_Descriptor* const desc)
+{
+    uint32_t count;
+    uint64_t uniqueId;
+
+    CARLA_SAFE_ASSERT_RETURN(reader.readU32(desc->Type[0]), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.readU32(desc->Type[1]), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(desc->URI), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(desc->Name), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(desc->Author), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(desc->License), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(desc->Binary), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(desc->Bundle), false);
+    CARLA_SAFE_ASSERT_RETURN(reader.readU64(uniqueId), false);
+    desc->UniqueID = static_cast<ulong>(uniqueId);
+
+    // Ports
+    CARLA_SAFE_ASSERT_RETURN(reader.readU32(count), false);
+
+    if (count > 0)
+    {
+        desc->Ports     = new LV2_RDF_Port[count];
+        desc->PortCount = count;
+
+        for (uint32_t i=0; i < count; ++i)
+        {
+            LV2_RDF_Port& port(desc->Ports[i]);
+            uint32_t scalePointCount;
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.Types), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.Properties), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.Designation), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(port.Name), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(port.Symbol), false);
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.MidiMap.Type), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.MidiMap.Number), false);
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.Points.Hints), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readFloat(port.Points.Default), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readFloat(port.Points.Minimum), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readFloat(port.Points.Maximum), false);
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.Unit.Hints), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(port.Unit.Name), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(port.Unit.Render), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(port.Unit.Symbol), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.Unit.Unit), false);
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(port.MinimumSize), false);
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(scalePointCount), false);
+
+            if (scalePointCount == 0)
+                continue;
+
+            port.ScalePoints     = new LV2_RDF_PortScalePoint[scalePointCount];
+            port.ScalePointCount = scalePointCount;
+
+            for (uint32_t j=0; j < scalePointCount; ++j)
+            {
+                CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(port.ScalePoints[j].Label), false);
+                CARLA_SAFE_ASSERT_RETURN(reader.readFloat(port.ScalePoints[j].Value), false);
+            }
+        }
+    }
+
+    // Presets
+    CARLA_SAFE_ASSERT_RETURN(reader.readU32(count), false);
+
+    if (count > 0)
+    {
+        desc->Presets     = new LV2_RDF_Preset[count];
+        desc->PresetCount = count;
+
+        for (uint32_t i=0; i < count; ++i)
+        {
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(desc->Presets[i].URI), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(desc->Presets[i].Label), false);
+        }
+    }
+
+    // Features and Extensions
+    CARLA_SAFE_ASSERT_RETURN(lv2_rdf_read_features(reader, desc->FeatureCount, desc->Features), false);
+    CARLA_SAFE_ASSERT_RETURN(lv2_rdf_read_extensions(reader, desc->ExtensionCount, desc->Extensions), false);
+
+    // UIs
+    CARLA_SAFE_ASSERT_RETURN(reader.readU32(count), false);
+
+    if (count > 0)
+    {
+        desc->UIs     = new LV2_RDF_UI[count];
+        desc->UICount = count;
+
+        for (uint32_t i=0; i < count; ++i)
+        {
+            LV2_RDF_UI& ui(desc->UIs[i]);
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(ui.Type), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(ui.URI), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(ui.Binary), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readStringCopy(ui.Bundle), false);
+
+            CARLA_SAFE_ASSERT_RETURN(lv2_rdf_read_features(reader, ui.FeatureCount, ui.Features), false);
+            CARLA_SAFE_ASSERT_RETURN(lv2_rdf_read_extensions(reader, ui.ExtensionCount, ui.Extensions), false);
+        }
+    }
+
+    return true;
+}
+
+static inline
+const LV2_RDF_Descriptor* lv2_rdf_read(const uint8_t* const data, const std::size_t size)
+{
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr && size != 0, nullptr);
+
+    Lv2CacheReader reader(data, size);
+    LV2_RDF_Descriptor* const desc(new LV2_RDF_Descriptor());
+
+    if (lv2_rdf_read_internal(reader, desc))
+        return desc;
+
+    delete desc;
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------
+// Bundle scanning
+
+struct Lv2CacheBundle {
+    CarlaString path;
+    uint64_t mtime;
+
+    Lv2CacheBundle() noexcept
+        : path(),
+          mtime(0) {}
+
+    bool operator<(const Lv2CacheBundle& other) const noexcept
+    {
+        return std::strcmp(path.buffer(), other.path.buffer()) < 0;
+    }
+};
+
+// Modification time of a bundle, the newest of the bundle directory and all turtle files inside it.
+// Package managers replace files by renaming, which touches the directory too.
+static inline
+uint64_t lv2_cache_get_bundle_mtime(const char* const bundle)
+{
+    struct stat st;
+    uint64_t mtime = 0;
+
+    if (::stat(bundle, &st) == 0)
+        mtime = static_cast<uint64_t>(st.st_mtime);
+
+    water::Array<water::File> results;
+    water::File(bundle).findChildFiles(results, water::File::findFiles, true, "*.ttl");
+
+    for (int i=0, count=results.size(); i < count; ++i)
+    {
+        if (::stat(results.getReference(i).getFullPathName().toRawUTF8(), &st) == 0 && static_cast<uint64_t>(st.st_mtime) > mtime)
+            mtime = static_cast<uint64_t>(st.st_mtime);
+    }
+
+    return mtime;
+}
+
+// List all bundles in LV2_PATH the same way lilv does, sorted by path
+static inline
+void lv2_cache_scan_bundles(const char* const LV2_PATH, std::vector<Lv2CacheBundle>& bundles)
+{
+    CARLA_SAFE_ASSERT_RETURN(LV2_PATH != nullptr,);
+
+    bundles.clear();
+
+#ifdef CARLA_OS_WIN
+    static const char* const kPathSep = ";";
+#else
+    static const char* const kPathSep = ":";
+#endif
+
+    water::StringArray dirs;
+    dirs.addTokens(LV2_PATH, kPathSep, "");
+
+    for (int d=0, dcount=dirs.size(); d < dcount; ++d)
+    {
+        water::String dir(dirs[d].trim());
+
+        if (dir.isEmpty())
+            continue;
+
+#ifndef CARLA_OS_WIN
+        if (dir[0] == '~')
+        {
+            if (const char* const home = std::getenv("HOME"))
+                dir = water::String(home) + dir.substring(1);
+        }
+#endif
+
+        water::Array<water::File> results;
+        const water::File dirFile(dir);
+
+        if (! dirFile.isDirectory())
+            continue;
+
+        dirFile.findChildFiles(results, water::File::findDirectories, false);
+
+        for (int i=0, count=results.size(); i < count; ++i)
+        {
+            const water::File& bundleFile(results.getReference(i));
+
+            if (! bundleFile.getChildFile("manifest.ttl").existsAsFile())
+                continue;
+
+            Lv2CacheBundle bundle;
+            bundle.path  = bundleFile.getFullPathName().toRawUTF8();
+            bundle.mtime = lv2_cache_get_bundle_mtime(bundle.path);
+            bundles.push_back(bundle);
+        }
+    }
+
+    std::sort(bundles.begin(), bundles.end());
+}
+
+// -----------------------------------------------------------------------
+// Cached plugin data
+
+struct Lv2CachePluginInfo {
+    const char* bundle;
+    const char* uri;
+    uint32_t category;
+    uint32_t hints;
+    uint32_t audioIns;
+    uint32_t audioOuts;
+    uint32_t midiIns;
+    uint32_t midiOuts;
+    uint32_t parameterIns;
+    uint32_t parameterOuts;
+    const char* name;
+    const char* maker;
+    const char* copyright;
+
+    // serialized LV2_RDF_Descriptor
+    const uint8_t* rdfData;
+    uint32_t rdfSize;
+};
+
+// -----------------------------------------------------------------------
+// Cache file builder
+
+class Lv2MetadataCacheBuilder
+{
+public:
+    Lv2MetadataCacheBuilder(const char* const LV2_PATH, const std::vector<Lv2CacheBundle>& bundles)
+        : fLv2Path(LV2_PATH),
+          fBundles(bundles),
+          fPlugins(),
+          fPluginCount(0) {}
+
+    // bundle and descriptor are not kept, strings in info are copied
+    void addPlugin(const Lv2CachePluginInfo& info, const LV2_RDF_Descriptor* const rdfDescriptor)
+    {
+        CARLA_SAFE_ASSERT_RETURN(info.bundle != nullptr && info.uri != nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(rdfDescriptor != nullptr,);
+
+        Lv2CacheWriter rdfWriter;
+        lv2_rdf_write(rdfWriter, rdfDescriptor);
+
+        fPlugins.writeString(info.bundle);
+        fPlugins.writeString(info.uri);
+        fPlugins.writeU32(info.category);
+        fPlugins.writeU32(info.hints);
+        fPlugins.writeU32(info.audioIns);
+        fPlugins.writeU32(info.audioOuts);
+        fPlugins.writeU32(info.midiIns);
+        fPlugins.writeU32(info.midiOuts);
+        fPlugins.writeU32(info.parameterIns);
+        fPlugins.writeU32(info.parameterOuts);
+        fPlugins.writeString(info.name);
+        fPlugins.writeString(info.maker);
+        fPlugins.writeString(info.copyright);
+        fPlugins.writeU32(static_cast<uint32_t>(rdfWriter.getSize()));
+        fPlugins.writeData(rdfWriter.getData(), rdfWriter.getSize());
+
+        ++fPluginCount;
+    }
+
+    bool save(const char* const filename) const
+    {
+        CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+
+        Lv2CacheWriter writer;
+        writer.writeData(kLv2CacheMagic, sizeof(kLv2CacheMagic));
+        writer.writeU32(kLv2CacheVersion);
+        writer.writeString(fLv2Path);
+        writer.writeU32(static_cast<uint32_t>(fBundles.size()));
+        writer.writeU32(fPluginCount);
+
+        for (std::size_t i=0, count=fBundles.size(); i < count; ++i)
+        {
+            writer.writeString(fBundles[i].path);
+            writer.writeU64(fBundles[i].mtime);
+        }
+
+        writer.writeData(fPlugins.getData(), fPlugins.getSize());
+
+        const water::File file(filename);
+        file.getParentDirectory().createDirectory();
+
+        // written to a temporary file first, then moved over the old one
+        return file.replaceWithData(writer.getData(), writer.getSize());
+    }
+
+private:
+    const CarlaString fLv2Path;
+    const std::vector<Lv2CacheBundle>& fBundles;
+    Lv2CacheWriter fPlugins;
+    uint32_t fPluginCount;
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2MetadataCacheBuilder)
+};
+
+// -----------------------------------------------------------------------
+// Cache file reader
+
+class Lv2MetadataCache
+{
+public:
+    Lv2MetadataCache() noexcept
+        : fData(nullptr),
+          fSize(0),
+          fPlugins(),
+          fLv2Path(nullptr),
+          fBundleCount(0),
+          fBundlesData(nullptr),
+          fBundlesSize(0),
+          fIsUpToDate(false) {}
+
+    ~Lv2MetadataCache() noexcept
+    {
+        unload();
+    }
+
+    static Lv2MetadataCache& getInstance()
+    {
+        static Lv2MetadataCache lv2Cache;
+        return lv2Cache;
+    }
+
+    static CarlaString getDefaultFilename()
+    {
+        CarlaString filename;
+
+#ifdef CARLA_OS_WIN
+        if (const char* const appData = std::getenv("APPDATA"))
+            filename = appData;
+        filename += "\\Carla\\lv2-metadata.cache";
+#else
+        if (const char* const cacheHome = std::getenv("XDG_CACHE_HOME"))
+        {
+            filename = cacheHome;
+        }
+        else
+        {
+            if (const char* const home = std::getenv("HOME"))
+                filename = home;
+            filename += "/.cache";
+        }
+        filename += "/carla/lv2-metadata.cache";
+#endif
+
+        return filename;
+    }
+
+    // Load (or reload) the cache file without checking LV2_PATH, see isPluginUpToDate().
+    bool load()
+    {
+        unload();
+
+        if (_load(getDefaultFilename()))
+            return true;
+
+        unload();
+        return false;
+    }
+
+    // Load (or reload) the cache file and check it against the bundles currently in LV2_PATH.
+    // Returns true if all plugins can be served from the cache.
+    bool loadAndCheck(const char* const LV2_PATH, const std::vector<Lv2CacheBundle>& bundles)
+    {
+        CARLA_SAFE_ASSERT_RETURN(LV2_PATH != nullptr, false);
+
+        if (! load())
+            return false;
+
+        // the order of LV2_PATH decides which bundle wins when a plugin is found twice
+        fIsUpToDate = fLv2Path != nullptr && std::strcmp(fLv2Path, LV2_PATH) == 0 && _checkBundles(bundles);
+        return fIsUpToDate;
+    }
+
+    bool loadAndCheck(const char* const LV2_PATH)
+    {
+        std::vector<Lv2CacheBundle> bundles;
+        lv2_cache_scan_bundles(LV2_PATH, bundles);
+
+        return loadAndCheck(LV2_PATH, bundles);
+    }
+
+    void unload() noexcept
+    {
+        fPlugins.clear();
+        fLv2Path     = nullptr;
+        fBundleCount = 0;
+        fBundlesData = nullptr;
+        fBundlesSize = 0;
+        fIsUpToDate  = false;
+
+        if (fData == nullptr)
+            return;
+
+#ifdef CARLA_OS_WIN
+        std::free(fData);
+#else
+        ::munmap(fData, fSize);
+#endif
+        fData = nullptr;
+        fSize = 0;
+    }
+
+    bool isUpToDate() const noexcept
+    {
+        return fIsUpToDate;
+    }
+
+    uint32_t getPluginCount() const noexcept
+    {
+        return static_cast<uint32_t>(fPlugins.size());
+    }
+
+    const Lv2CachePluginInfo* getPluginFromIndex(const uint32_t index) const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(index < fPlugins.size(), nullptr);
+
+        return &fPlugins[index];
+    }
+
+    const Lv2CachePluginInfo* getPluginFromURI(const char* const uri) const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
+
+        for (std::size_t i=0, count=fPlugins.size(); i < count; ++i)
+        {
+            if (std::strcmp(fPlugins[i].uri, uri) == 0)
+                return &fPlugins[i];
+        }
+
+        return nullptr;
+    }
+
+    // Cheaper check than loadAndCheck() for a single plugin, only looks at the plugin's own bundle.
+    bool isPluginUpToDate(const Lv2CachePluginInfo* const info) const
+    {
+        CARLA_SAFE_ASSERT_RETURN(info != nullptr, false);
+
+        if (fIsUpToDate)
+            return true;
+
+        Lv2CacheReader reader(fBundlesData, fBundlesSize);
+
+        for (uint32_t i=0; i < fBundleCount; ++i)
+        {
+            const char* path;
+            uint64_t mtime;
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readString(path), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU64(mtime), false);
+
+            if (path != nullptr && std::strcmp(path, info->bundle) == 0)
+                return lv2_cache_get_bundle_mtime(path) == mtime;
+        }
+
+        return false;
+    }
+
+    // Create a new RDF object from cached data.
+    // Like lv2_rdf_new(), the returned object must be deleted by the caller.
+    const LV2_RDF_Descriptor* createDescriptor(const Lv2CachePluginInfo* const info) const
+    {
+        CARLA_SAFE_ASSERT_RETURN(info != nullptr, nullptr);
+
+        return lv2_rdf_read(info->rdfData, info->rdfSize);
+    }
+
+private:
+    uint8_t* fData;
+    std::size_t fSize;
+
+    std::vector<Lv2CachePluginInfo> fPlugins;
+
+    const char* fLv2Path;
+    uint32_t fBundleCount;
+    const uint8_t* fBundlesData;
+    std::size_t fBundlesSize;
+
+    bool fIsUpToDate;
+
+    bool _load(const char* const filename)
+    {
+        struct stat st;
+
+        if (::stat(filename, &st) != 0 || st.st_size <= 0)
+            return false;
+
+        fSize = static_cast<std::size_t>(st.st_size);
+
+#ifdef CARLA_OS_WIN
+        FILE* const file = std::fopen(filename, "rb");
+        CARLA_SAFE_ASSERT_RETURN(file != nullptr, false);
+
+        fData = (uint8_t*)std::malloc(fSize);
+
+        const bool ok = fData != nullptr && std::fread(fData, 1, fSize, file) == fSize;
+        std::fclose(file);
+        CARLA_SAFE_ASSERT_RETURN(ok, false);
+#else
+        const int fd = ::open(filename, O_RDONLY);
+        CARLA_SAFE_ASSERT_RETURN(fd >= 0, false);
+
+        void* const ptr = ::mmap(nullptr, fSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (ptr == MAP_FAILED)
+        {
+            fSize = 0;
+            carla_stderr2("Lv2MetadataCache: failed to map '%s'", filename);
+            return false;
+        }
+
+        fData = static_cast<uint8_t*>(ptr);
+#endif
+
+        Lv2CacheReader reader(fData, fSize);
+
+        char magic[sizeof(kLv2CacheMagic)];
+        uint32_t version, pluginCount;
+
+        if (! reader.readData(magic, sizeof(magic)) || std::memcmp(magic, kLv2CacheMagic, sizeof(magic)) != 0)
+            return false;
+        if (! reader.readU32(version) || version != kLv2CacheVersion)
+            return false;
+
+        CARLA_SAFE_ASSERT_RETURN(reader.readString(fLv2Path), false);
+        CARLA_SAFE_ASSERT_RETURN(reader.readU32(fBundleCount), false);
+        CARLA_SAFE_ASSERT_RETURN(reader.readU32(pluginCount), false);
+
+        // bundles are compared later, just skip over them now
+        fBundlesData = reader.getCurrentData();
+
+        for (uint32_t i=0; i < fBundleCount; ++i)
+        {
+            const char* path;
+            CARLA_SAFE_ASSERT_RETURN(reader.readString(path), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.skip(sizeof(uint64_t)), false);
+        }
+
+        fBundlesSize = static_cast<std::size_t>(reader.getCurrentData() - fBundlesData);
+
+        // smallest possible plugin entry: empty bundle and uri, 3 null strings and 9 numbers
+        static const std::size_t kMinPluginSize = 2*(sizeof(uint32_t)+1) + 3*sizeof(uint32_t) + 9*sizeof(uint32_t);
+        CARLA_SAFE_ASSERT_RETURN(pluginCount <= reader.getRemainingSize() / kMinPluginSize, false);
+
+        try {
+            fPlugins.resize(pluginCount);
+        } CARLA_SAFE_EXCEPTION_RETURN("Lv2MetadataCache::_load", false);
+
+        for (uint32_t i=0; i < pluginCount; ++i)
+        {
+            Lv2CachePluginInfo& info(fPlugins[i]);
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readString(info.bundle), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readString(info.uri), false);
+            CARLA_SAFE_ASSERT_RETURN(info.bundle != nullptr && info.uri != nullptr, false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.category), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.hints), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.audioIns), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.audioOuts), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.midiIns), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.midiOuts), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.parameterIns), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.parameterOuts), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readString(info.name), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readString(info.maker), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readString(info.copyright), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU32(info.rdfSize), false);
+
+            info.rdfData = reader.getCurrentData();
+            CARLA_SAFE_ASSERT_RETURN(reader.skip(info.rdfSize), false);
+        }
+
+        return true;
+    }
+
+    bool _checkBundles(const std::vector<Lv2CacheBundle>& bundles) const
+    {
+        if (bundles.size() != fBundleCount)
+            return false;
+
+        Lv2CacheReader reader(fBundlesData, fBundlesSize);
+
+        for (uint32_t i=0; i < fBundleCount; ++i)
+        {
+            const char* path;
+            uint64_t mtime;
+
+            CARLA_SAFE_ASSERT_RETURN(reader.readString(path), false);
+            CARLA_SAFE_ASSERT_RETURN(reader.readU64(mtime), false);
+
+            if (path == nullptr || bundles[i].path != path || bundles[i].mtime != mtime)
+                return false;
+        }
+
+        return true;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2MetadataCache)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // CARLA_LV2_CACHE_UTILS_HPP_INCLUDED
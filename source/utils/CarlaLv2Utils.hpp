@@ -19,6 +19,7 @@
 #define CARLA_LV2_UTILS_HPP_INCLUDED
 
 #include "CarlaUtils.hpp"
+#include "CarlaString.hpp"
 
 #ifndef nullptr
 # undef NULL
@@ -253,6 +254,8 @@ public:
     Lilv::Node rdfs_label;
 
     bool needsInit;
+    bool hasPartialInit;
+    CarlaString lv2Path;
 
     const LilvPlugins* allPlugins;
     const LilvPlugin** cachedPlugins;
@@ -376,6 +379,8 @@ public:
           rdfs_label         (new_uri(NS_rdfs "label")),
 
           needsInit(true),
+          hasPartialInit(false),
+          lv2Path(),
           allPlugins(nullptr),
           cachedPlugins(nullptr),
           pluginCount(0) {}
@@ -407,6 +412,8 @@ public:
             return;
 
         needsInit = false;
+        hasPartialInit = false;
+        lv2Path = LV2_PATH;
 
         Lilv::World::load_all(LV2_PATH);
 
@@ -446,6 +453,43 @@ public:
         }
     }
 
+    // Load a single plugin bundle, used when the plugin metadata comes from the LV2 cache.
+    // Does nothing if the full world has been loaded already.
+    void loadBundleIfNeeded(const char* const LV2_PATH, const char* const bundle)
+    {
+        CARLA_SAFE_ASSERT_RETURN(LV2_PATH != nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(bundle != nullptr && bundle[0] != '\0',);
+
+        if (! needsInit)
+            return;
+
+        lv2Path = LV2_PATH;
+
+        Lilv::Node bundleNode(new_file_uri(nullptr, bundle));
+        CARLA_SAFE_ASSERT_RETURN(bundleNode.is_uri(),);
+
+        CarlaString sBundle(bundleNode.as_uri());
+
+        if (! sBundle.endsWith("/"))
+            sBundle += "/";
+
+        Lilv::World::load_bundle(Lilv::Node(new_uri(sBundle)));
+
+        hasPartialInit = true;
+        allPlugins = lilv_world_get_all_plugins(this->me);
+    }
+
+    // Load everything in the last used LV2_PATH if we only loaded single bundles before.
+    // Needed for data that can live outside the plugin bundle, like user presets.
+    void initFullIfNeeded()
+    {
+        if (needsInit && hasPartialInit && lv2Path.isNotEmpty())
+        {
+            const CarlaString path(lv2Path);
+            initIfNeeded(path);
+        }
+    }
+
     uint getPluginCount() const
     {
         CARLA_SAFE_ASSERT_RETURN(! needsInit, 0);
@@ -465,7 +509,7 @@ public:
     const LilvPlugin* getPluginFromURI(const LV2_URI uri) const
     {
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
-        CARLA_SAFE_ASSERT_RETURN(! needsInit, nullptr);
+        CARLA_SAFE_ASSERT_RETURN(! needsInit || hasPartialInit, nullptr);
         CARLA_SAFE_ASSERT_RETURN(allPlugins != nullptr, nullptr);
 
         LilvNode* const uriNode(lilv_new_uri(this->me, uri));
@@ -481,7 +525,7 @@ public:
     {
         CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
         CARLA_SAFE_ASSERT_RETURN(uridMap != nullptr, nullptr);
-        CARLA_SAFE_ASSERT_RETURN(! needsInit, nullptr);
+        CARLA_SAFE_ASSERT_RETURN(! needsInit || hasPartialInit, nullptr);
 
         LilvNode* const uriNode(lilv_new_uri(this->me, uri));
         CARLA_SAFE_ASSERT_RETURN(uriNode != nullptr, nullptr);
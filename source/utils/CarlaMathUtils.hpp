@@ -23,6 +23,22 @@
 #include <cmath>
 #include <limits>
 
+#if defined(__SSE2__) || defined(__SSE2_MATH__)
+# define CARLA_MATH_USE_SSE2
+# include <emmintrin.h>
+#endif
+
+#if defined(CARLA_MATH_USE_SSE2) && (defined(__i386__) || defined(__x86_64__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+# define CARLA_MATH_USE_AVX
+# include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# define CARLA_MATH_USE_NEON
+# include <arm_neon.h>
+#endif
+
 // --------------------------------------------------------------------------------------------------------------------
 // math functions (base)
 
@@ -158,6 +174,177 @@ bool carla_isNotZero(const T& value)
     return std::abs(value) >= std::numeric_limits<T>::epsilon();
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// math functions (SIMD kernels)
+//
+// Buffers do not need to be aligned.
+// SSE2 and NEON are selected at build time, AVX at runtime when the CPU supports it.
+
+/*
+ * Highest of 4 values, used for the final horizontal reduction.
+ */
+static inline
+float carla_simdMaxOf4(const float values[4]) noexcept
+{
+    const float max01 = values[0] > values[1] ? values[0] : values[1];
+    const float max23 = values[2] > values[3] ? values[2] : values[3];
+    return max01 > max23 ? max01 : max23;
+}
+
+#ifdef CARLA_MATH_USE_AVX
+/*
+ * Check if the current CPU supports AVX, cached after the first call.
+ */
+static inline
+bool carla_cpuHasAVX() noexcept
+{
+    static const bool hasAVX = (__builtin_cpu_init(), __builtin_cpu_supports("avx") != 0);
+    return hasAVX;
+}
+
+__attribute__((target("avx")))
+static inline
+void carla_simdMixFloatsAVX(float dest[], const float src[], const float destGain, const float srcGain,
+                            std::size_t& i, const std::size_t count) noexcept
+{
+    const __m256 gd = _mm256_set1_ps(destGain);
+    const __m256 gs = _mm256_set1_ps(srcGain);
+
+    for (; i+8 <= count; i += 8)
+        _mm256_storeu_ps(dest+i, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(dest+i), gd), _mm256_mul_ps(_mm256_loadu_ps(src+i), gs)));
+}
+
+__attribute__((target("avx")))
+static inline
+void carla_simdMulFloatsAVX(float dest[], const float src[], const float gain, std::size_t& i, const std::size_t count) noexcept
+{
+    const __m256 g = _mm256_set1_ps(gain);
+
+    for (; i+8 <= count; i += 8)
+        _mm256_storeu_ps(dest+i, _mm256_mul_ps(_mm256_loadu_ps(src+i), g));
+}
+
+__attribute__((target("avx")))
+static inline
+float carla_simdMaxAbsFloatAVX(const float floats[], std::size_t& i, const std::size_t count) noexcept
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    __m256 maxv = _mm256_setzero_ps();
+
+    for (; i+8 <= count; i += 8)
+        maxv = _mm256_max_ps(maxv, _mm256_andnot_ps(signMask, _mm256_loadu_ps(floats+i)));
+
+    const __m128 max4 = _mm_max_ps(_mm256_castps256_ps128(maxv), _mm256_extractf128_ps(maxv, 1));
+
+    float tmp[4];
+    _mm_storeu_ps(tmp, max4);
+    return carla_simdMaxOf4(tmp);
+}
+#endif
+
+/*
+ * dest[i] = dest[i] * destGain + src[i] * srcGain, returns the number of processed values.
+ * 'dest' and 'src' can be the same buffer.
+ */
+static inline
+std::size_t carla_simdMixFloats(float dest[], const float src[], const float destGain, const float srcGain,
+                                const std::size_t count) noexcept
+{
+    std::size_t i = 0;
+
+#if defined(CARLA_MATH_USE_AVX)
+    if (carla_cpuHasAVX())
+        carla_simdMixFloatsAVX(dest, src, destGain, srcGain, i, count);
+#endif
+#if defined(CARLA_MATH_USE_SSE2)
+    const __m128 gd = _mm_set1_ps(destGain);
+    const __m128 gs = _mm_set1_ps(srcGain);
+
+    for (; i+4 <= count; i += 4)
+        _mm_storeu_ps(dest+i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(dest+i), gd), _mm_mul_ps(_mm_loadu_ps(src+i), gs)));
+#elif defined(CARLA_MATH_USE_NEON)
+    const float32x4_t gd = vdupq_n_f32(destGain);
+    const float32x4_t gs = vdupq_n_f32(srcGain);
+
+    for (; i+4 <= count; i += 4)
+        vst1q_f32(dest+i, vaddq_f32(vmulq_f32(vld1q_f32(dest+i), gd), vmulq_f32(vld1q_f32(src+i), gs)));
+#endif
+
+    return i;
+}
+
+/*
+ * dest[i] = src[i] * gain, returns the number of processed values.
+ * 'dest' and 'src' can be the same buffer.
+ */
+static inline
+std::size_t carla_simdMulFloats(float dest[], const float src[], const float gain, const std::size_t count) noexcept
+{
+    std::size_t i = 0;
+
+#if defined(CARLA_MATH_USE_AVX)
+    if (carla_cpuHasAVX())
+        carla_simdMulFloatsAVX(dest, src, gain, i, count);
+#endif
+#if defined(CARLA_MATH_USE_SSE2)
+    const __m128 g = _mm_set1_ps(gain);
+
+    for (; i+4 <= count; i += 4)
+        _mm_storeu_ps(dest+i, _mm_mul_ps(_mm_loadu_ps(src+i), g));
+#elif defined(CARLA_MATH_USE_NEON)
+    const float32x4_t g = vdupq_n_f32(gain);
+
+    for (; i+4 <= count; i += 4)
+        vst1q_f32(dest+i, vmulq_f32(vld1q_f32(src+i), g));
+#endif
+
+    return i;
+}
+
+/*
+ * Highest absolute value, stores the number of processed values in 'done'.
+ */
+static inline
+float carla_simdMaxAbsFloat(const float floats[], const std::size_t count, std::size_t& done) noexcept
+{
+    std::size_t i = 0;
+    float maxf = 0.0f;
+
+#if defined(CARLA_MATH_USE_AVX)
+    if (carla_cpuHasAVX())
+        maxf = carla_simdMaxAbsFloatAVX(floats, i, count);
+#endif
+#if defined(CARLA_MATH_USE_SSE2)
+    if (i+4 <= count)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 maxv = _mm_set1_ps(maxf);
+
+        for (; i+4 <= count; i += 4)
+            maxv = _mm_max_ps(maxv, _mm_andnot_ps(signMask, _mm_loadu_ps(floats+i)));
+
+        float tmp[4];
+        _mm_storeu_ps(tmp, maxv);
+        maxf = carla_simdMaxOf4(tmp);
+    }
+#elif defined(CARLA_MATH_USE_NEON)
+    if (i+4 <= count)
+    {
+        float32x4_t maxv = vdupq_n_f32(maxf);
+
+        for (; i+4 <= count; i += 4)
+            maxv = vmaxq_f32(maxv, vabsq_f32(vld1q_f32(floats+i)));
+
+        float tmp[4];
+        vst1q_f32(tmp, maxv);
+        maxf = carla_simdMaxOf4(tmp);
+    }
+#endif
+
+    done = i;
+    return maxf;
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // math functions (extended)
 
@@ -171,8 +358,37 @@ void carla_addFloats(float dest[], const float src[], const std::size_t count) n
     CARLA_SAFE_ASSERT_RETURN(src != nullptr,);
     CARLA_SAFE_ASSERT_RETURN(count > 0,);
 
-    for (std::size_t i=0; i<count; ++i)
-        *dest++ += *src++;
+    for (std::size_t i=carla_simdMixFloats(dest, src, 1.0f, 1.0f, count); i<count; ++i)
+        dest[i] += src[i];
+}
+
+/*
+ * Add float array values multiplied by a gain to another float array (mix with gain).
+ */
+static inline
+void carla_addFloatsWithGain(float dest[], const float src[], const float gain, const std::size_t count) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(dest != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(src != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(count > 0,);
+
+    for (std::size_t i=carla_simdMixFloats(dest, src, 1.0f, gain, count); i<count; ++i)
+        dest[i] += src[i] * gain;
+}
+
+/*
+ * Mix 2 float arrays with individual gains, storing the result in the first one.
+ * Used for dry/wet, 'dest' and 'src' can be the same buffer.
+ */
+static inline
+void carla_mixFloats(float dest[], const float src[], const float destGain, const float srcGain, const std::size_t count) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(dest != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(src != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(count > 0,);
+
+    for (std::size_t i=carla_simdMixFloats(dest, src, destGain, srcGain, count); i<count; ++i)
+        dest[i] = dest[i] * destGain + src[i] * srcGain;
 }
 
 /*
@@ -188,6 +404,20 @@ void carla_copyFloats(float dest[], const float src[], const std::size_t count)
     std::memcpy(dest, src, count*sizeof(float));
 }
 
+/*
+ * Copy float array values multiplied by a gain to another float array.
+ */
+static inline
+void carla_copyFloatsWithGain(float dest[], const float src[], const float gain, const std::size_t count) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(dest != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(src != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(count > 0,);
+
+    for (std::size_t i=carla_simdMulFloats(dest, src, gain, count); i<count; ++i)
+        dest[i] = src[i] * gain;
+}
+
 /*
  * Clear a float array.
  */
@@ -204,21 +434,17 @@ void carla_zeroFloats(float floats[], const std::size_t count) noexcept
  * Find the highest absolute and normalized value within a float array.
  */
 static inline
-float carla_findMaxNormalizedFloat(float floats[], const std::size_t count)
+float carla_findMaxNormalizedFloat(const float floats[], const std::size_t count) noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(floats != nullptr, 0.0f);
     CARLA_SAFE_ASSERT_RETURN(count > 0, 0.0f);
 
-    static const float kEmptyFloats[8192] = { 0.0f };
+    std::size_t i;
+    float tmp, maxf2 = carla_simdMaxAbsFloat(floats, count, i);
 
-    if (count <= 8192 && std::memcmp(floats, kEmptyFloats, count) == 0)
-        return 0.0f;
-
-    float tmp, maxf2 = std::abs(floats[0]);
-
-    for (std::size_t i=1; i<count; ++i)
+    for (; i<count; ++i)
     {
-        tmp = std::abs(*floats++);
+        tmp = std::abs(floats[i]);
 
         if (tmp > maxf2)
             maxf2 = tmp;
@@ -230,6 +456,19 @@ float carla_findMaxNormalizedFloat(float floats[], const std::size_t count)
     return maxf2;
 }
 
+/*
+ * Find the highest absolute and normalized value of each float array, for multi-channel peaks.
+ */
+static inline
+void carla_findMaxNormalizedFloats(float peaks[], const float* const floats[], const uint numBuffers, const std::size_t count) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(peaks != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(floats != nullptr,);
+
+    for (uint i=0; i<numBuffers; ++i)
+        peaks[i] = carla_findMaxNormalizedFloat(floats[i], count);
+}
+
 /*
  * Multiply an array with a fixed value, float-specific version.
  */
@@ -245,8 +484,8 @@ void carla_multiply(float data[], const float& multiplier, const std::size_t cou
     }
     else
     {
-        for (std::size_t i=0; i<count; ++i)
-            *data++ *= multiplier;
+        for (std::size_t i=carla_simdMulFloats(data, data, multiplier, count); i<count; ++i)
+            data[i] *= multiplier;
     }
 }
 
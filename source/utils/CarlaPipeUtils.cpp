@@ -16,6 +16,7 @@
  */
 
 #include "CarlaPipeUtils.hpp"
+#include "CarlaBase64Utils.hpp"
 #include "CarlaString.hpp"
 #include "CarlaMIDI.h"
 
@@ -73,6 +74,10 @@ ssize_t ReadFileWin32(const HANDLE pipeh, void* const buf, const std::size_t num
     if (::PeekNamedPipe(pipeh, nullptr, 0, nullptr, &available, nullptr) == FALSE || available == 0)
         return -1;
 
+    // never block
+    if (dsize > available)
+        dsize = available;
+
     if (::ReadFile(pipeh, buf, dsize, &dsize, nullptr) != FALSE)
         return static_cast<ssize_t>(dsize);
 
@@ -437,6 +442,14 @@ void waitForChildToStopOrKillIt(pid_t& pid, const uint32_t timeOutMilliseconds)
 }
 #endif
 
+// -----------------------------------------------------------------------
+// pipe features, negotiated with a "pipe-features" message right after the pipe starts
+
+// atoms can be sent as raw bytes instead of base64
+static const uint32_t kPipeFeatureBinaryAtoms = 0x1;
+
+static const uint32_t kPipeFeaturesSupported = kPipeFeatureBinaryAtoms;
+
 // -----------------------------------------------------------------------
 
 struct CarlaPipeCommon::PrivateData {
@@ -460,9 +473,27 @@ struct CarlaPipeCommon::PrivateData {
     // common write lock
     CarlaMutex writeLock;
 
-    // temporary buffers for _readline()
-    mutable char        tmpBuf[0xff+1];
-    mutable CarlaString tmpStr;
+    // features the other side can handle, see kPipeFeatureBinaryAtoms
+    uint32_t peerFeatures;
+    bool featuresSent;
+
+    // buffered input, refilled by _readbuffer()
+    char        readBuf[0x1000];
+    std::size_t readBufPos;
+    std::size_t readBufLen;
+
+    // line returned by _readline(), kept between calls if incomplete
+    char*       lineBuf;
+    std::size_t lineBufSize;
+    std::size_t lineBufLen;
+
+    // copy of the message given to msgReceived()
+    char*       msgBuf;
+    std::size_t msgBufSize;
+
+    // raw data returned by readNextLv2Atom()
+    uint8_t*    dataBuf;
+    std::size_t dataBufSize;
 
     PrivateData() noexcept
 #ifdef CARLA_OS_WIN
@@ -475,16 +506,68 @@ struct CarlaPipeCommon::PrivateData {
           isReading(false),
           lastMessageFailed(false),
           writeLock(),
-          tmpBuf(),
-          tmpStr()
+          peerFeatures(0),
+          featuresSent(false),
+          readBuf(),
+          readBufPos(0),
+          readBufLen(0),
+          lineBuf(nullptr),
+          lineBufSize(0),
+          lineBufLen(0),
+          msgBuf(nullptr),
+          msgBufSize(0),
+          dataBuf(nullptr),
+          dataBufSize(0)
     {
 #ifdef CARLA_OS_WIN
         carla_zeroStruct(processInfo);
         processInfo.hProcess = INVALID_HANDLE_VALUE;
         processInfo.hThread  = INVALID_HANDLE_VALUE;
 #endif
+    }
 
-        carla_zeroChars(tmpBuf, 0xff+1);
+    ~PrivateData() noexcept
+    {
+        delete[] lineBuf;
+        delete[] msgBuf;
+        delete[] dataBuf;
+    }
+
+    // called when a new pipe is set up
+    void resetState() noexcept
+    {
+        peerFeatures = 0;
+        featuresSent = false;
+        readBufPos   = 0;
+        readBufLen   = 0;
+        lineBufLen   = 0;
+    }
+
+    // buffers only grow, so after a while no more allocations are needed
+    template<typename T>
+    static bool growBuffer(T*& buffer, std::size_t& bufferSize, const std::size_t neededSize, const std::size_t usedSize) noexcept
+    {
+        if (neededSize <= bufferSize)
+            return true;
+
+        std::size_t newSize = bufferSize != 0 ? bufferSize : 0xff+1;
+
+        while (newSize < neededSize)
+            newSize *= 2;
+
+        T* newBuffer;
+
+        try {
+            newBuffer = new T[newSize];
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaPipeCommon growBuffer", false);
+
+        if (usedSize != 0)
+            std::memcpy(newBuffer, buffer, usedSize*sizeof(T));
+
+        delete[] buffer;
+        buffer     = newBuffer;
+        bufferSize = newSize;
+        return true;
     }
 
     CARLA_DECLARE_NON_COPY_STRUCT(PrivateData)
@@ -512,6 +595,11 @@ bool CarlaPipeCommon::isPipeRunning() const noexcept
     return (pData->pipeRecv != INVALID_PIPE_VALUE && pData->pipeSend != INVALID_PIPE_VALUE);
 }
 
+bool CarlaPipeCommon::isPipeReading() const noexcept
+{
+    return pData->isReading;
+}
+
 void CarlaPipeCommon::idlePipe(const bool onlyOnce) noexcept
 {
     const char* locale = nullptr;
@@ -523,22 +611,35 @@ void CarlaPipeCommon::idlePipe(const bool onlyOnce) noexcept
         if (msg == nullptr)
             break;
 
+        // keep a copy, reading the message arguments reuses the line buffer
+        const std::size_t msgSize(std::strlen(msg)+1);
+
+        if (! PrivateData::growBuffer(pData->msgBuf, pData->msgBufSize, msgSize, 0))
+            break;
+
+        std::memcpy(pData->msgBuf, msg, msgSize);
+
+        pData->isReading = true;
+
+        if (std::strcmp(pData->msgBuf, "pipe-features") == 0)
+        {
+            _handleFeaturesMessage();
+            pData->isReading = false;
+            continue;
+        }
+
         if (locale == nullptr && ! onlyOnce)
         {
             locale = carla_strdup_safe(::setlocale(LC_NUMERIC, nullptr));
             ::setlocale(LC_NUMERIC, "C");
         }
 
-        pData->isReading = true;
-
         try {
-            msgReceived(msg);
+            msgReceived(pData->msgBuf);
         } CARLA_SAFE_EXCEPTION("msgReceived");
 
         pData->isReading = false;
 
-        delete[] msg;
-
         if (onlyOnce)
             break;
     }
@@ -581,7 +682,6 @@ bool CarlaPipeCommon::readNextLineAsBool(bool& value) const noexcept
     if (const char* const msg = _readlineblock())
     {
         value = (std::strcmp(msg, "true") == 0);
-        delete[] msg;
         return true;
     }
 
@@ -595,7 +695,6 @@ bool CarlaPipeCommon::readNextLineAsByte(uint8_t& value) const noexcept
     if (const char* const msg = _readlineblock())
     {
         int tmp = std::atoi(msg);
-        delete[] msg;
 
         if (tmp >= 0 && tmp <= 0xFF)
         {
@@ -614,7 +713,6 @@ bool CarlaPipeCommon::readNextLineAsInt(int32_t& value) const noexcept
     if (const char* const msg = _readlineblock())
     {
         value = std::atoi(msg);
-        delete[] msg;
         return true;
     }
 
@@ -628,7 +726,6 @@ bool CarlaPipeCommon::readNextLineAsUInt(uint32_t& value) const noexcept
     if (const char* const msg = _readlineblock())
     {
         int32_t tmp = std::atoi(msg);
-        delete[] msg;
 
         if (tmp >= 0)
         {
@@ -647,7 +744,6 @@ bool CarlaPipeCommon::readNextLineAsLong(int64_t& value) const noexcept
     if (const char* const msg = _readlineblock())
     {
         value = std::atol(msg);
-        delete[] msg;
         return true;
     }
 
@@ -661,7 +757,6 @@ bool CarlaPipeCommon::readNextLineAsULong(uint64_t& value) const noexcept
     if (const char* const msg = _readlineblock())
     {
         int64_t tmp = std::atol(msg);
-        delete[] msg;
 
         if (tmp >= 0)
         {
@@ -680,7 +775,6 @@ bool CarlaPipeCommon::readNextLineAsFloat(float& value) const noexcept
     if (const char* const msg = _readlineblock())
     {
         value = static_cast<float>(std::atof(msg));
-        delete[] msg;
         return true;
     }
 
@@ -694,7 +788,6 @@ bool CarlaPipeCommon::readNextLineAsDouble(double& value) const noexcept
     if (const char* const msg = _readlineblock())
     {
         value = std::atof(msg);
-        delete[] msg;
         return true;
     }
 
@@ -707,13 +800,44 @@ bool CarlaPipeCommon::readNextLineAsString(const char*& value) const noexcept
 
     if (const char* const msg = _readlineblock())
     {
-        value = msg;
-        return true;
+        value = carla_strdup_safe(msg);
+        return (value != nullptr);
     }
 
     return false;
 }
 
+bool CarlaPipeCommon::readNextLv2Atom(const uint32_t size, const LV2_Atom*& atom) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->isReading, false);
+    CARLA_SAFE_ASSERT_RETURN(size >= sizeof(LV2_Atom), false);
+
+    if (! PrivateData::growBuffer(pData->dataBuf, pData->dataBufSize, size, 0))
+        return false;
+
+    const char* const msg = _readlineblock();
+    CARLA_SAFE_ASSERT_RETURN(msg != nullptr, false);
+
+    if (msg[0] == '\0')
+    {
+        // empty line, raw data follows
+        CARLA_SAFE_ASSERT_RETURN(_readbytesblock(pData->dataBuf, size), false);
+    }
+    else
+    {
+        try {
+            const std::vector<uint8_t> chunk(carla_getChunkFromBase64String(msg));
+            CARLA_SAFE_ASSERT_RETURN(chunk.size() == size, false);
+            std::memcpy(pData->dataBuf, &chunk.front(), size);
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaPipeCommon::readNextLv2Atom", false);
+    }
+
+    atom = (const LV2_Atom*)pData->dataBuf;
+    CARLA_SAFE_ASSERT_RETURN(lv2_atom_total_size(atom) == size, false);
+
+    return true;
+}
+
 // -------------------------------------------------------------------
 // must be locked before calling
 
@@ -918,7 +1042,12 @@ void CarlaPipeCommon::writeLv2AtomMessage(const uint32_t index, const LV2_Atom*
     tmpBuf[0xff] = '\0';
 
     const uint32_t atomTotalSize(lv2_atom_total_size(atom));
-    CarlaString base64atom(CarlaString::asBase64(atom, atomTotalSize));
+    const bool binary((pData->peerFeatures & kPipeFeatureBinaryAtoms) != 0);
+
+    CarlaString base64atom;
+
+    if (! binary)
+        base64atom = CarlaString::asBase64(atom, atomTotalSize);
 
     const CarlaMutexLocker cml(pData->writeLock);
 
@@ -931,7 +1060,16 @@ void CarlaPipeCommon::writeLv2AtomMessage(const uint32_t index, const LV2_Atom*
         std::snprintf(tmpBuf, 0xff, "%i\n", atomTotalSize);
         _writeMsgBuffer(tmpBuf, std::strlen(tmpBuf));
 
-        writeAndFixMessage(base64atom.buffer());
+        if (binary)
+        {
+            // an empty line tells the reader that raw data follows, see readNextLv2Atom()
+            _writeMsgBuffer("\n", 1);
+            _writeMsgBuffer((const char*)atom, atomTotalSize);
+        }
+        else
+        {
+            writeAndFixMessage(base64atom.buffer());
+        }
     }
 
     flushMessages();
@@ -962,57 +1100,62 @@ void CarlaPipeCommon::writeLv2UridMessage(const uint32_t urid, const char* const
 // -------------------------------------------------------------------
 
 // internal
-const char* CarlaPipeCommon::_readline() const noexcept
+bool CarlaPipeCommon::_readbuffer() const noexcept
 {
-    CARLA_SAFE_ASSERT_RETURN(pData->pipeRecv != INVALID_PIPE_VALUE, nullptr);
+    CARLA_SAFE_ASSERT_RETURN(pData->pipeRecv != INVALID_PIPE_VALUE, false);
+    CARLA_SAFE_ASSERT_RETURN(pData->readBufPos == pData->readBufLen, false);
 
-    char    c;
-    char*   ptr = pData->tmpBuf;
     ssize_t ret = -1;
 
-    pData->tmpStr.clear();
-
-    for (int i=0; i<0xff; ++i)
-    {
-        try {
+    try {
 #ifdef CARLA_OS_WIN
-            ret = ::ReadFileWin32(pData->pipeRecv, &c, 1);
+        ret = ::ReadFileWin32(pData->pipeRecv, pData->readBuf, sizeof(pData->readBuf));
 #else
-            ret = ::read(pData->pipeRecv, &c, 1);
+        ret = ::read(pData->pipeRecv, pData->readBuf, sizeof(pData->readBuf));
 #endif
-        } CARLA_SAFE_EXCEPTION_BREAK("CarlaPipeCommon::readline() - read");
-
-        if (ret != 1 || c == '\n')
-            break;
+    } CARLA_SAFE_EXCEPTION_RETURN("CarlaPipeCommon::readbuffer() - read", false);
 
-        if (c == '\r')
-            c = '\n';
+    pData->readBufPos = 0;
+    pData->readBufLen = ret > 0 ? static_cast<std::size_t>(ret) : 0;
 
-        *ptr++ = c;
+    return (ret > 0);
+}
 
-        if (i+1 == 0xff)
-        {
-            i = 0;
-            *ptr = '\0';
-            pData->tmpStr += pData->tmpBuf;
-            ptr = pData->tmpBuf;
-        }
-    }
+const char* CarlaPipeCommon::_readline() const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->pipeRecv != INVALID_PIPE_VALUE, nullptr);
 
-    if (ptr != pData->tmpBuf)
-    {
-        *ptr = '\0';
-        pData->tmpStr += pData->tmpBuf;
-    }
-    else if (pData->tmpStr.isEmpty() && ret != 1)
+    for (;;)
     {
-        // some error
-        return nullptr;
-    }
+        if (pData->readBufPos == pData->readBufLen && ! _readbuffer())
+            return nullptr; // no complete line yet, keep what we have for the next call
 
-    try {
-        return pData->tmpStr.dup();
-    } CARLA_SAFE_EXCEPTION_RETURN("CarlaPipeCommon::readline() - dup", nullptr);
+        const char* const start = pData->readBuf + pData->readBufPos;
+        const char* const end   = (const char*)std::memchr(start, '\n', pData->readBufLen - pData->readBufPos);
+        const std::size_t size  = end != nullptr ? static_cast<std::size_t>(end - start)
+                                                 : pData->readBufLen - pData->readBufPos;
+
+        const std::size_t lineBufLen = pData->lineBufLen;
+        CARLA_SAFE_ASSERT_RETURN(PrivateData::growBuffer(pData->lineBuf, pData->lineBufSize, lineBufLen + size + 1, lineBufLen), nullptr);
+
+        char* const line = pData->lineBuf + lineBufLen;
+
+        for (std::size_t i=0; i<size; ++i)
+            line[i] = start[i] == '\r' ? '\n' : start[i];
+
+        pData->lineBufLen += size;
+        pData->readBufPos += size;
+
+        if (end == nullptr)
+            continue;
+
+        // skip '\n'
+        ++pData->readBufPos;
+
+        pData->lineBuf[pData->lineBufLen] = '\0';
+        pData->lineBufLen = 0;
+        return pData->lineBuf;
+    }
 }
 
 const char* CarlaPipeCommon::_readlineblock(const uint32_t timeOutMilliseconds) const noexcept
@@ -1034,6 +1177,73 @@ const char* CarlaPipeCommon::_readlineblock(const uint32_t timeOutMilliseconds)
     return nullptr;
 }
 
+bool CarlaPipeCommon::_readbytesblock(void* const data, const std::size_t size, const uint32_t timeOutMilliseconds) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->lineBufLen == 0, false);
+
+    const uint32_t timeoutEnd(getMillisecondCounter() + timeOutMilliseconds);
+
+    uint8_t*    ptr  = (uint8_t*)data;
+    std::size_t left = size;
+
+    for (;;)
+    {
+        if (const std::size_t avail = pData->readBufLen - pData->readBufPos)
+        {
+            const std::size_t chunk = avail < left ? avail : left;
+
+            std::memcpy(ptr, pData->readBuf + pData->readBufPos, chunk);
+            pData->readBufPos += chunk;
+            ptr  += chunk;
+            left -= chunk;
+
+            if (left == 0)
+                return true;
+        }
+
+        if (_readbuffer())
+            continue;
+
+        if (getMillisecondCounter() >= timeoutEnd)
+            break;
+
+        carla_msleep(5);
+    }
+
+    carla_stderr("readbytesblock timed out");
+    return false;
+}
+
+void CarlaPipeCommon::_writeFeaturesMessage() const noexcept
+{
+    char tmpBuf[0xff+1];
+    tmpBuf[0xff] = '\0';
+
+    std::snprintf(tmpBuf, 0xff, "%i\n", kPipeFeaturesSupported);
+
+    _writeMsgBuffer("pipe-features\n", 14);
+    _writeMsgBuffer(tmpBuf, std::strlen(tmpBuf));
+
+    pData->featuresSent = true;
+}
+
+void CarlaPipeCommon::_handleFeaturesMessage() const noexcept
+{
+    uint32_t features;
+    CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(features),);
+
+    pData->peerFeatures = features & kPipeFeaturesSupported;
+
+    // reply if the other side started the negotiation
+    if (! pData->featuresSent)
+    {
+        const CarlaMutexLocker cml(pData->writeLock);
+
+        _writeFeaturesMessage();
+        flushMessages();
+    }
+}
+
 bool CarlaPipeCommon::_writeMsgBuffer(const char* const msg, const std::size_t size) const noexcept
 {
     // TESTING remove later
@@ -1310,6 +1520,12 @@ bool CarlaPipeServer::startPipeServer(const char* const filename,
 #endif
         pData->pipeRecv = pipeRecvClient;
         pData->pipeSend = pipeSendClient;
+        pData->resetState();
+
+        // let the client know what we can handle, it replies with the same
+        _writeFeaturesMessage();
+        flushMessages();
+
         carla_stdout("ALL OK!");
         return true;
     }
@@ -1513,6 +1729,7 @@ bool CarlaPipeClient::initPipeClient(const char* argv[]) noexcept
 
     pData->pipeRecv = pipeRecvServer;
     pData->pipeSend = pipeSendServer;
+    pData->resetState();
 
     writeMessage("\n", 1);
     flushMessages();
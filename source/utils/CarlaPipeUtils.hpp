@@ -66,6 +66,12 @@ public:
      */
     bool isPipeRunning() const noexcept;
 
+    /*!
+     * Check if a message is currently being handled by msgReceived().
+     * idlePipe() must not be called while this is true.
+     */
+    bool isPipeReading() const noexcept;
+
     /*!
      * Check the pipe for new messages and send them to msgReceived().
      */
@@ -144,6 +150,12 @@ public:
      */
     bool readNextLineAsString(const char*& value) const noexcept;
 
+    /*!
+     * Read the data of an "atom" message, after its index and size lines.
+     * @note: @a atom is only valid until the next read.
+     */
+    bool readNextLv2Atom(const uint32_t size, const LV2_Atom*& atom) const noexcept;
+
     // -------------------------------------------------------------------
     // write messages, must be locked before calling
 
@@ -220,12 +232,24 @@ protected:
 
     // -------------------------------------------------------------------
 
+    /*! @internal */
+    bool _readbuffer() const noexcept;
+
     /*! @internal */
     const char* _readline() const noexcept;
 
     /*! @internal */
     const char* _readlineblock(const uint32_t timeOutMilliseconds = 50) const noexcept;
 
+    /*! @internal */
+    bool _readbytesblock(void* const data, const std::size_t size, const uint32_t timeOutMilliseconds = 50) const noexcept;
+
+    /*! @internal */
+    void _writeFeaturesMessage() const noexcept;
+
+    /*! @internal */
+    void _handleFeaturesMessage() const noexcept;
+
     /*! @internal */
     bool _writeMsgBuffer(const char* const msg, const std::size_t size) const noexcept;
 
@@ -0,0 +1,599 @@
+/*
+ * Carla realtime thread pool
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_RT_THREAD_POOL_HPP_INCLUDED
+#define CARLA_RT_THREAD_POOL_HPP_INCLUDED
+
+#include "CarlaSemUtils.hpp"
+#include "CarlaThread.hpp"
+
+#ifndef CARLA_OS_WIN
+# include <sched.h>
+#endif
+
+#ifdef __SSE2_MATH__
+# include <xmmintrin.h>
+#endif
+
+// -----------------------------------------------------------------------
+// Job dependency graph
+//
+// Jobs are identified by their index, and dependencies must always point
+// from a lower to a higher index, so that running all jobs in index order
+// is a valid serial schedule.
+// The graph is built on a non-realtime thread, the pool only touches the
+// pre-allocated runtime counters.
+
+class CarlaRtJobGraph
+{
+public:
+    CarlaRtJobGraph() noexcept
+        : fNumJobs(0),
+          fNumDependencies(nullptr),
+          fSuccessorOffsets(nullptr),
+          fSuccessors(nullptr),
+          fPending(nullptr),
+          fReadyQueue(nullptr) {}
+
+    ~CarlaRtJobGraph() noexcept
+    {
+        clear();
+    }
+
+    /*
+     * Create the graph for 'numJobs' jobs.
+     * Each edge makes job 'edgesTo[i]' wait for job 'edgesFrom[i]'.
+     */
+    bool create(const uint numJobs, const uint* const edgesFrom, const uint* const edgesTo, const uint numEdges) noexcept
+    {
+        clear();
+
+        if (numJobs == 0)
+            return true;
+
+        try {
+            fNumDependencies  = new uint[numJobs];
+            fSuccessorOffsets = new uint[numJobs+1];
+            fSuccessors       = new uint[numEdges > 0 ? numEdges : 1];
+            fPending          = new int[numJobs];
+            fReadyQueue       = new int[numJobs];
+        } catch (...) {
+            clear();
+            return false;
+        }
+
+        carla_zeroStructs(fNumDependencies, numJobs);
+        carla_zeroStructs(fSuccessorOffsets, numJobs+1);
+
+        // count
+        for (uint i=0; i < numEdges; ++i)
+        {
+            CARLA_SAFE_ASSERT_CONTINUE(edgesFrom[i] < edgesTo[i]);
+            CARLA_SAFE_ASSERT_CONTINUE(edgesTo[i] < numJobs);
+
+            ++fNumDependencies[edgesTo[i]];
+            ++fSuccessorOffsets[edgesFrom[i]+1];
+        }
+
+        for (uint i=0; i < numJobs; ++i)
+            fSuccessorOffsets[i+1] += fSuccessorOffsets[i];
+
+        // fill, using pending as temporary write position
+        for (uint i=0; i < numJobs; ++i)
+            fPending[i] = static_cast<int>(fSuccessorOffsets[i]);
+
+        for (uint i=0; i < numEdges; ++i)
+        {
+            if (edgesFrom[i] >= edgesTo[i] || edgesTo[i] >= numJobs)
+                continue;
+
+            fSuccessors[fPending[edgesFrom[i]]++] = edgesTo[i];
+        }
+
+        fNumJobs = numJobs;
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        fNumJobs = 0;
+
+        if (fNumDependencies != nullptr)  { delete[] fNumDependencies;  fNumDependencies  = nullptr; }
+        if (fSuccessorOffsets != nullptr) { delete[] fSuccessorOffsets; fSuccessorOffsets = nullptr; }
+        if (fSuccessors != nullptr)       { delete[] fSuccessors;       fSuccessors       = nullptr; }
+        if (fPending != nullptr)          { delete[] fPending;          fPending          = nullptr; }
+        if (fReadyQueue != nullptr)       { delete[] fReadyQueue;       fReadyQueue       = nullptr; }
+    }
+
+    uint getNumJobs() const noexcept
+    {
+        return fNumJobs;
+    }
+
+private:
+    uint  fNumJobs;
+    uint* fNumDependencies;
+    uint* fSuccessorOffsets;
+    uint* fSuccessors;
+
+    // runtime data, reset on every run
+    volatile int* fPending;
+    volatile int* fReadyQueue;
+
+    friend class CarlaRtThreadPool;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaRtJobGraph)
+};
+
+// -----------------------------------------------------------------------
+// Realtime thread pool
+//
+// Runs the jobs of a CarlaRtJobGraph concurrently, using the calling thread
+// plus a fixed set of worker threads. The calling thread (usually the audio
+// one) takes part in the processing and only returns once all jobs are done.
+// Workers copy the scheduling policy and priority of the calling thread.
+//
+// Threads only busy-wait for a short while, since spinning at realtime
+// priority can starve the very thread that is running the job being waited on.
+// After that workers go back to sleep until new jobs are ready, and the
+// calling thread yields, or sleeps once all remaining jobs have been taken.
+
+class CarlaRtThreadPool
+{
+public:
+    class Callback
+    {
+    public:
+        virtual ~Callback() {}
+        virtual void runJob(const uint index) = 0;
+    };
+
+    CarlaRtThreadPool(const char* const name) noexcept
+        : fName(name),
+          fWorkers(nullptr),
+          fNumWorkers(0),
+          fGraph(nullptr),
+          fCallback(nullptr),
+          fRunning(0),
+          fActiveWorkers(0),
+          fReadIndex(0),
+          fWriteIndex(0),
+          fDoneCount(0),
+          fDoneSem(),
+          fDoneWaiting(0),
+          fSchedSerial(0),
+          fSchedPolicy(0),
+          fSchedPriority(0)
+    {
+        carla_sem_create2(fDoneSem);
+    }
+
+    ~CarlaRtThreadPool() noexcept
+    {
+        stop();
+        carla_sem_destroy2(fDoneSem);
+    }
+
+    /*
+     * Start 'numWorkers' threads, stopping any previous ones.
+     * Must not be called while processing.
+     */
+    void start(const uint numWorkers) noexcept
+    {
+        stop();
+
+        if (numWorkers == 0)
+            return;
+
+        try {
+            fWorkers = new Worker*[numWorkers];
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaRtThreadPool::start",);
+
+        char strBuf[0xff+1];
+        strBuf[0xff] = '\0';
+
+        for (uint i=0; i < numWorkers; ++i)
+        {
+            std::snprintf(strBuf, 0xff, "%s.%u", fName.buffer(), i+1);
+
+            Worker* worker = nullptr;
+
+            try {
+                worker = new Worker(this, strBuf);
+            } CARLA_SAFE_EXCEPTION_BREAK("CarlaRtThreadPool::start");
+
+            if (! worker->startThread())
+            {
+                delete worker;
+                break;
+            }
+
+            fWorkers[fNumWorkers++] = worker;
+        }
+    }
+
+    /*
+     * Stop all worker threads.
+     * Must not be called while processing.
+     */
+    void stop() noexcept
+    {
+        if (fWorkers == nullptr)
+            return;
+
+        for (uint i=0; i < fNumWorkers; ++i)
+            fWorkers[i]->signalThreadShouldExit();
+
+        for (uint i=0; i < fNumWorkers; ++i)
+        {
+            fWorkers[i]->wakeUp();
+            fWorkers[i]->stopThread(-1);
+            delete fWorkers[i];
+        }
+
+        delete[] fWorkers;
+        fWorkers    = nullptr;
+        fNumWorkers = 0;
+    }
+
+    uint getNumWorkers() const noexcept
+    {
+        return fNumWorkers;
+    }
+
+    /*
+     * Run all jobs of a graph, returning once they are all done.
+     * This function is realtime safe.
+     */
+    void process(CarlaRtJobGraph& graph, Callback* const callback) noexcept
+    {
+        const uint numJobs = graph.fNumJobs;
+
+        if (numJobs == 0)
+            return;
+
+        // nothing to share, use index order
+        if (fNumWorkers == 0 || numJobs == 1)
+        {
+            for (uint i=0; i < numJobs; ++i)
+                callback->runJob(i);
+            return;
+        }
+
+        updateScheduling();
+
+        fReadIndex  = 0;
+        fWriteIndex = 0;
+        fDoneCount  = 0;
+
+        for (uint i=0; i < numJobs; ++i)
+        {
+            graph.fPending[i]    = static_cast<int>(graph.fNumDependencies[i]);
+            graph.fReadyQueue[i] = -1;
+        }
+
+        fGraph    = &graph;
+        fCallback = callback;
+
+        for (uint i=0; i < numJobs; ++i)
+        {
+            if (graph.fNumDependencies[i] == 0)
+                pushReadyJob(i);
+        }
+
+        __sync_synchronize();
+        fRunning = 1;
+        __sync_synchronize();
+
+        for (uint i=0; i < fNumWorkers; ++i)
+            fWorkers[i]->wakeUp();
+
+        // help out until everything is done
+        uint spins = 0;
+
+        for (int job; static_cast<uint>(fDoneCount) < numJobs;)
+        {
+            if (popReadyJob(job))
+            {
+                runJob(job);
+                spins = 0;
+                continue;
+            }
+
+            // all jobs were taken, nothing left to help with
+            if (spins >= kMaxSpinCount && static_cast<uint>(fReadIndex) >= numJobs)
+            {
+                waitUntilDone(numJobs);
+                break;
+            }
+
+            backOff(spins);
+        }
+
+        fRunning = 0;
+        __sync_synchronize();
+
+        // make sure no worker is still looking at this run
+        for (uint spins2 = 0; fActiveWorkers != 0;)
+            backOff(spins2);
+
+        fGraph    = nullptr;
+        fCallback = nullptr;
+    }
+
+private:
+    // -------------------------------------------------------------------
+
+    class Worker : public CarlaThread
+    {
+    public:
+        Worker(CarlaRtThreadPool* const pool, const char* const name) noexcept
+            : CarlaThread(name),
+              kPool(pool),
+              fSem(),
+              fWaiting(0),
+              fSchedSerial(0)
+        {
+            carla_sem_create2(fSem);
+        }
+
+        ~Worker() noexcept override
+        {
+            carla_sem_destroy2(fSem);
+        }
+
+        bool wakeUp() noexcept
+        {
+            if (! __sync_bool_compare_and_swap(&fWaiting, 1, 0))
+                return false;
+
+            carla_sem_post(fSem, true);
+            return true;
+        }
+
+    protected:
+        void run() override
+        {
+#ifdef __SSE2_MATH__
+            // Set FTZ and DAZ flags, same as audio threads
+            _mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+
+            bool postPending = false;
+
+            for (; ! shouldThreadExit();)
+            {
+                if (! postPending)
+                    __sync_lock_test_and_set(&fWaiting, 1);
+
+                if (! carla_sem_timedwait(fSem, 100, true))
+                {
+                    // timed out, check if someone took our flag meanwhile
+                    postPending = ! __sync_bool_compare_and_swap(&fWaiting, 1, 0);
+                    continue;
+                }
+
+                postPending = false;
+
+                if (shouldThreadExit())
+                    break;
+
+                kPool->updateWorkerScheduling(fSchedSerial);
+                kPool->workerProcess();
+            }
+        }
+
+    private:
+        CarlaRtThreadPool* const kPool;
+        carla_sem_t fSem;
+        volatile int fWaiting;
+        int fSchedSerial;
+
+        CARLA_DECLARE_NON_COPY_CLASS(Worker)
+    };
+
+    // -------------------------------------------------------------------
+
+    // number of busy-wait iterations before backing off
+    static const uint kMaxSpinCount = 2000;
+
+    static void backOff(uint& spins) noexcept
+    {
+        if (spins < kMaxSpinCount)
+        {
+            ++spins;
+            carla_cpu_relax();
+            return;
+        }
+
+#ifdef CARLA_OS_WIN
+        ::SwitchToThread();
+#else
+        ::sched_yield();
+#endif
+    }
+
+    // called by the calling thread once all jobs have been taken
+    void waitUntilDone(const uint numJobs) noexcept
+    {
+        __sync_lock_test_and_set(&fDoneWaiting, 1);
+
+        while (static_cast<uint>(fDoneCount) < numJobs)
+        {
+            if (carla_sem_timedwait(fDoneSem, 10, true))
+                return;
+        }
+
+        // if we cannot take back the flag then the last job has posted (or is about to), consume it
+        if (! __sync_bool_compare_and_swap(&fDoneWaiting, 1, 0))
+            carla_sem_timedwait(fDoneSem, 1000, true);
+    }
+
+    void wakeUpOneWorker() noexcept
+    {
+        for (uint i=0; i < fNumWorkers; ++i)
+        {
+            if (fWorkers[i]->wakeUp())
+                break;
+        }
+    }
+
+    void pushReadyJob(const uint job) noexcept
+    {
+        const int index = __sync_fetch_and_add(&fWriteIndex, 1);
+        __sync_lock_test_and_set(&fGraph->fReadyQueue[index], static_cast<int>(job));
+    }
+
+    bool popReadyJob(int& job) noexcept
+    {
+        const int index = fReadIndex;
+
+        if (static_cast<uint>(index) >= fGraph->fNumJobs)
+            return false;
+
+        job = fGraph->fReadyQueue[index];
+
+        if (job < 0)
+            return false;
+
+        return __sync_bool_compare_and_swap(&fReadIndex, index, index+1);
+    }
+
+    void runJob(const int job) noexcept
+    {
+        CarlaRtJobGraph& graph(*fGraph);
+        const uint ujob = static_cast<uint>(job);
+
+        try {
+            fCallback->runJob(ujob);
+        } CARLA_SAFE_EXCEPTION("CarlaRtThreadPool::runJob");
+
+        for (uint i=graph.fSuccessorOffsets[ujob], end=graph.fSuccessorOffsets[ujob+1]; i < end; ++i)
+        {
+            const uint next = graph.fSuccessors[i];
+
+            if (__sync_sub_and_fetch(&graph.fPending[next], 1) == 0)
+            {
+                pushReadyJob(next);
+                wakeUpOneWorker();
+            }
+        }
+
+        if (static_cast<uint>(__sync_add_and_fetch(&fDoneCount, 1)) == graph.fNumJobs &&
+            __sync_bool_compare_and_swap(&fDoneWaiting, 1, 0))
+            carla_sem_post(fDoneSem, true);
+    }
+
+    void workerProcess() noexcept
+    {
+        __sync_add_and_fetch(&fActiveWorkers, 1);
+
+        if (fRunning != 0)
+        {
+            // keep going while there are jobs left to be taken, go back to sleep if none gets ready soon
+            uint spins = 0;
+
+            for (int job; static_cast<uint>(fReadIndex) < fGraph->fNumJobs;)
+            {
+                if (popReadyJob(job))
+                {
+                    runJob(job);
+                    spins = 0;
+                }
+                else if (++spins > kMaxSpinCount)
+                {
+                    break;
+                }
+                else
+                {
+                    carla_cpu_relax();
+                }
+            }
+        }
+
+        __sync_sub_and_fetch(&fActiveWorkers, 1);
+    }
+
+    // -------------------------------------------------------------------
+    // scheduling, copied from the thread calling process()
+
+    void updateScheduling() noexcept
+    {
+#ifndef CARLA_OS_WIN
+        int policy;
+        sched_param param;
+        carla_zeroStruct(param);
+
+        if (pthread_getschedparam(pthread_self(), &policy, &param) != 0)
+            return;
+        if (policy == fSchedPolicy && param.sched_priority == fSchedPriority)
+            return;
+
+        fSchedPolicy   = policy;
+        fSchedPriority = param.sched_priority;
+        __sync_add_and_fetch(&fSchedSerial, 1);
+#endif
+    }
+
+    void updateWorkerScheduling(int& workerSerial) noexcept
+    {
+#ifndef CARLA_OS_WIN
+        if (workerSerial == fSchedSerial)
+            return;
+
+        workerSerial = fSchedSerial;
+
+        sched_param param;
+        carla_zeroStruct(param);
+        param.sched_priority = fSchedPriority;
+
+        pthread_setschedparam(pthread_self(), fSchedPolicy, &param);
+#else
+        // unused
+        (void)workerSerial;
+#endif
+    }
+
+    // -------------------------------------------------------------------
+
+    const CarlaString fName;
+
+    Worker** fWorkers;
+    uint     fNumWorkers;
+
+    CarlaRtJobGraph* volatile fGraph;
+    Callback* volatile fCallback;
+
+    volatile int fRunning;
+    volatile int fActiveWorkers;
+    volatile int fReadIndex;
+    volatile int fWriteIndex;
+    volatile int fDoneCount;
+
+    carla_sem_t  fDoneSem;
+    volatile int fDoneWaiting;
+
+    volatile int fSchedSerial;
+    volatile int fSchedPolicy;
+    volatile int fSchedPriority;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaRtThreadPool)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // CARLA_RT_THREAD_POOL_HPP_INCLUDED
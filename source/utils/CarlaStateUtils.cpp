@@ -27,6 +27,7 @@
 #include <string>
 
 using water::MemoryOutputStream;
+using water::OutputStream;
 using water::String;
 using water::XmlElement;
 
@@ -197,12 +198,18 @@ CarlaStateSave::CarlaStateSave() noexcept
       balanceRight(1.0f),
       panning(0.0f),
       ctrlChannel(-1),
+      minSplitFrames(0),
 #endif
       currentProgramIndex(-1),
       currentProgramName(nullptr),
       currentMidiBank(-1),
       currentMidiProgram(-1),
       chunk(nullptr),
+      chunkFile(nullptr),
+      chunkFileOffset(0),
+      chunkFileSize(0),
+      rawChunk(nullptr),
+      rawChunkSize(0),
       parameters(),
       customData() {}
 
@@ -243,6 +250,16 @@ void CarlaStateSave::clear() noexcept
         delete[] chunk;
         chunk = nullptr;
     }
+    if (chunkFile != nullptr)
+    {
+        delete[] chunkFile;
+        chunkFile = nullptr;
+    }
+
+    chunkFileOffset = 0;
+    chunkFileSize   = 0;
+    rawChunk        = nullptr;
+    rawChunkSize    = 0;
 
     uniqueId = 0;
     options  = 0x0;
@@ -255,6 +272,7 @@ void CarlaStateSave::clear() noexcept
     balanceRight = 1.0f;
     panning      = 0.0f;
     ctrlChannel  = -1;
+    minSplitFrames = 0;
 #endif
 
     currentProgramIndex = -1;
@@ -360,6 +378,12 @@ bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
                             ctrlChannel = static_cast<int8_t>(value-1);
                     }
                 }
+                else if (tag.equalsIgnoreCase("minimumsplitframes") || tag.equalsIgnoreCase("minimum-split-frames"))
+                {
+                    const int value(text.getIntValue());
+                    if (value > 0)
+                        minSplitFrames = static_cast<uint32_t>(value);
+                }
                 else if (tag.equalsIgnoreCase("options"))
                 {
                     const int value(text.getHexValue32());
@@ -483,6 +507,20 @@ bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
                 {
                     chunk = carla_strdup(text.toRawUTF8());
                 }
+                else if (tag.equalsIgnoreCase("chunkfile") || tag.equalsIgnoreCase("chunk-file"))
+                {
+                    const int64_t offset(xmlData->getStringAttribute("Offset").getLargeIntValue());
+                    const int64_t size(xmlData->getStringAttribute("Size").getLargeIntValue());
+
+                    if (text.isNotEmpty() && offset >= 0 && size > 0)
+                    {
+                        chunkFile       = xmlSafeStringCharDup(text, false);
+                        chunkFileOffset = static_cast<uint64_t>(offset);
+                        chunkFileSize   = static_cast<uint64_t>(size);
+                    }
+                    else
+                        carla_stderr("Reading ChunkFile property failed, invalid data");
+                }
             }
         }
     }
@@ -493,8 +531,10 @@ bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
 // -----------------------------------------------------------------------
 // fillXmlStringFromStateSave
 
-void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
+bool CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content, OutputStream* const chunkStream, const char* const chunkFileName) const
 {
+    bool chunkWritten = true;
+
     {
         MemoryOutputStream infoXml;
 
@@ -568,6 +608,9 @@ void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
         else
             dataXml << "   <ControlChannel>" << int(ctrlChannel+1) << "</ControlChannel>\n";
 
+        if (minSplitFrames != 0)
+            dataXml << "   <MinimumSplitFrames>" << static_cast<int>(minSplitFrames) << "</MinimumSplitFrames>\n";
+
         dataXml << "   <Options>0x" << String::toHexString(static_cast<int>(options)) << "</Options>\n";
 
         content << dataXml;
@@ -662,7 +705,35 @@ void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
         content << customDataXml;
     }
 
-    if (chunk != nullptr && chunk[0] != '\0')
+    if (rawChunk != nullptr && rawChunkSize > 0 && chunkStream != nullptr && chunkFileName != nullptr)
+    {
+        const water::int64 offset(chunkStream->getPosition());
+
+        if (chunkStream->write(rawChunk, rawChunkSize))
+        {
+            content << "\n   <ChunkFile Offset='" << String(offset) << "' Size='" << String(static_cast<water::int64>(rawChunkSize)) << "'>";
+            content << xmlSafeString(chunkFileName, true);
+            content << "</ChunkFile>\n";
+        }
+        else
+        {
+            carla_stderr("Failed to write chunk to side-car file");
+            chunkWritten = false;
+        }
+    }
+    else if (rawChunk != nullptr && rawChunkSize > 0)
+    {
+        MemoryOutputStream chunkXml, chunkSplt;
+        const CarlaString chunkBase64(CarlaString::asBase64(rawChunk, rawChunkSize));
+        getNewLineSplittedString(chunkSplt, chunkBase64.buffer());
+
+        chunkXml << "\n   <Chunk>\n";
+        chunkXml << chunkSplt;
+        chunkXml << "\n   </Chunk>\n";
+
+        content << chunkXml;
+    }
+    else if (chunk != nullptr && chunk[0] != '\0')
     {
         MemoryOutputStream chunkXml, chunkSplt;
         getNewLineSplittedString(chunkSplt, chunk);
@@ -675,6 +746,8 @@ void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
     }
 
     content << "  </Data>\n";
+
+    return chunkWritten;
 }
 
 // -----------------------------------------------------------------------
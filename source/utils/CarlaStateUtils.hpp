@@ -78,6 +78,7 @@ struct CarlaStateSave {
     float  balanceRight;
     float  panning;
     int8_t ctrlChannel;
+    uint32_t minSplitFrames;
 #endif
 
     int32_t     currentProgramIndex;
@@ -86,6 +87,17 @@ struct CarlaStateSave {
     int32_t     currentMidiProgram;
     const char* chunk;
 
+    // chunk stored as raw binary in a side-car file, used instead of 'chunk' when loading.
+    // the filename is relative to the project file
+    const char* chunkFile;
+    uint64_t    chunkFileOffset;
+    uint64_t    chunkFileSize;
+
+    // raw chunk as returned by the plugin, used instead of 'chunk' when saving.
+    // owned by the plugin, only valid until its state is requested again
+    const void* rawChunk;
+    std::size_t rawChunkSize;
+
     ParameterList parameters;
     CustomDataList customData;
 
@@ -94,7 +106,16 @@ struct CarlaStateSave {
     void clear() noexcept;
 
     bool fillFromXmlElement(const water::XmlElement* const xmlElement);
-    void dumpToMemoryStream(water::MemoryOutputStream& stream) const;
+
+    /*
+     * Write the state as xml into @a stream.
+     * If @a chunkStream is set, a raw chunk is appended to it and referenced from the xml as @a chunkFile,
+     * otherwise the chunk is stored inside the xml as base64.
+     * Returns false if the chunk could not be written to @a chunkStream.
+     */
+    bool dumpToMemoryStream(water::MemoryOutputStream& stream,
+                            water::OutputStream* const chunkStream = nullptr,
+                            const char* const chunkFile = nullptr) const;
 
     CARLA_DECLARE_NON_COPY_STRUCT(CarlaStateSave)
 };
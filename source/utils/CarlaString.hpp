@@ -585,67 +585,44 @@ public:
             "abcdefghijklmnopqrstuvwxyz"
             "0123456789+/";
 
-        const std::size_t kTmpBufSize = std::min(carla_nextPowerOf2(static_cast<uint32_t>(dataSize/3)), 65536U);
+        CarlaString ret;
 
-        const uchar* bytesToEncode((const uchar*)data);
+        if (dataSize == 0)
+            return ret;
 
-        uint i=0, j=0;
-        uint charArray3[3], charArray4[4];
+        // encode in one go, appending in small blocks gets quadratic with big chunks
+        const std::size_t retLen = (dataSize + 2) / 3 * 4;
 
-        char strBuf[kTmpBufSize+1];
-        strBuf[kTmpBufSize] = '\0';
-        std::size_t strBufIndex = 0;
+        char* const retBuf = (char*)std::malloc(retLen+1);
+        CARLA_SAFE_ASSERT_RETURN(retBuf != nullptr, ret);
 
-        CarlaString ret;
+        const uchar* bytesToEncode((const uchar*)data);
+        char* outBuf(retBuf);
+        std::size_t s = 0;
 
-        for (std::size_t s=0; s<dataSize; ++s)
+        for (; s+3 <= dataSize; s += 3, bytesToEncode += 3)
         {
-            charArray3[i++] = *(bytesToEncode++);
-
-            if (i == 3)
-            {
-                charArray4[0] =  (charArray3[0] & 0xfc) >> 2;
-                charArray4[1] = ((charArray3[0] & 0x03) << 4) + ((charArray3[1] & 0xf0) >> 4);
-                charArray4[2] = ((charArray3[1] & 0x0f) << 2) + ((charArray3[2] & 0xc0) >> 6);
-                charArray4[3] =   charArray3[2] & 0x3f;
-
-                for (i=0; i<4; ++i)
-                    strBuf[strBufIndex++] = kBase64Chars[charArray4[i]];
-
-                if (strBufIndex >= kTmpBufSize-7)
-                {
-                    strBuf[strBufIndex] = '\0';
-                    strBufIndex = 0;
-                    ret += strBuf;
-                }
-
-                i = 0;
-            }
+            *outBuf++ = kBase64Chars[bytesToEncode[0] >> 2];
+            *outBuf++ = kBase64Chars[((bytesToEncode[0] & 0x03) << 4) | (bytesToEncode[1] >> 4)];
+            *outBuf++ = kBase64Chars[((bytesToEncode[1] & 0x0f) << 2) | (bytesToEncode[2] >> 6)];
+            *outBuf++ = kBase64Chars[bytesToEncode[2] & 0x3f];
         }
 
-        if (i != 0)
+        if (const std::size_t rest = dataSize - s)
         {
-            for (j=i; j<3; ++j)
-              charArray3[j] = '\0';
-
-            charArray4[0] =  (charArray3[0] & 0xfc) >> 2;
-            charArray4[1] = ((charArray3[0] & 0x03) << 4) + ((charArray3[1] & 0xf0) >> 4);
-            charArray4[2] = ((charArray3[1] & 0x0f) << 2) + ((charArray3[2] & 0xc0) >> 6);
-            charArray4[3] =   charArray3[2] & 0x3f;
+            const uint byte0 = bytesToEncode[0];
+            const uint byte1 = rest > 1 ? bytesToEncode[1] : 0;
 
-            for (j=0; j<4 && i<3 && j<i+1; ++j)
-                strBuf[strBufIndex++] = kBase64Chars[charArray4[j]];
-
-            for (; i++ < 3;)
-                strBuf[strBufIndex++] = '=';
+            *outBuf++ = kBase64Chars[byte0 >> 2];
+            *outBuf++ = kBase64Chars[((byte0 & 0x03) << 4) | (byte1 >> 4)];
+            *outBuf++ = rest > 1 ? kBase64Chars[(byte1 & 0x0f) << 2] : '=';
+            *outBuf++ = '=';
         }
 
-        if (strBufIndex != 0)
-        {
-            strBuf[strBufIndex] = '\0';
-            ret += strBuf;
-        }
+        *outBuf = '\0';
 
+        ret.fBuffer    = retBuf;
+        ret.fBufferLen = retLen;
         return ret;
     }
 
@@ -717,16 +694,23 @@ public:
 
     CarlaString& operator+=(const char* const strBuf) noexcept
     {
-        if (strBuf == nullptr)
+        if (strBuf == nullptr || strBuf[0] == '\0')
             return *this;
 
-        const std::size_t newBufSize = fBufferLen + std::strlen(strBuf) + 1;
-        char              newBuf[newBufSize];
+        const std::size_t strBufLen = std::strlen(strBuf);
 
-        std::strcpy(newBuf, fBuffer);
-        std::strcat(newBuf, strBuf);
+        // not on the stack, base64 chunks can be several MiB big
+        char* const newBuf = (char*)std::malloc(fBufferLen + strBufLen + 1);
+        CARLA_SAFE_ASSERT_RETURN(newBuf != nullptr, *this);
+
+        std::memcpy(newBuf, fBuffer, fBufferLen);
+        std::memcpy(newBuf + fBufferLen, strBuf, strBufLen + 1);
+
+        if (fBuffer != _null())
+            std::free(fBuffer);
 
-        _dup(newBuf, newBufSize-1);
+        fBuffer     = newBuf;
+        fBufferLen += strBufLen;
 
         return *this;
     }
@@ -0,0 +1,79 @@
+/*
+ * Carla time utils
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_TIME_UTILS_HPP_INCLUDED
+#define CARLA_TIME_UTILS_HPP_INCLUDED
+
+#include "CarlaUtils.hpp"
+
+#if defined(CARLA_OS_MAC)
+# include <mach/mach_time.h>
+#elif ! defined(CARLA_OS_WIN)
+# include <time.h>
+#endif
+
+// --------------------------------------------------------------------------------------------------------------------
+// carla_gettime_*
+
+/*
+ * Get a monotonic timestamp in nanoseconds.
+ * Only useful for measuring time differences, the starting point is unspecified.
+ * This function is realtime safe.
+ */
+static inline
+uint64_t carla_gettime_ns() noexcept
+{
+#if defined(CARLA_OS_WIN)
+    static LARGE_INTEGER frequency = { 0, 0 };
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        ::QueryPerformanceFrequency(&frequency);
+
+    ::QueryPerformanceCounter(&counter);
+
+    const uint64_t freq  = static_cast<uint64_t>(frequency.QuadPart);
+    const uint64_t count = static_cast<uint64_t>(counter.QuadPart);
+    return (count / freq) * 1000000000ULL + (count % freq) * 1000000000ULL / freq;
+#elif defined(CARLA_OS_MAC)
+    static mach_timebase_info_data_t timebase = { 0, 0 };
+
+    if (timebase.denom == 0)
+        ::mach_timebase_info(&timebase);
+
+    return ::mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+}
+
+/*
+ * Get a monotonic timestamp in microseconds.
+ * Only useful for measuring time differences, the starting point is unspecified.
+ * This function is realtime safe.
+ */
+static inline
+uint64_t carla_gettime_us() noexcept
+{
+    return carla_gettime_ns() / 1000;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+
+#endif // CARLA_TIME_UTILS_HPP_INCLUDED
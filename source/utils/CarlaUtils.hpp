@@ -291,6 +291,21 @@ void carla_msleep(const uint msecs) noexcept
     } CARLA_SAFE_EXCEPTION("carla_msleep");
 }
 
+/*
+ * Hint the CPU that we are busy-waiting.
+ */
+static inline
+void carla_cpu_relax() noexcept
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#else
+    __sync_synchronize();
+#endif
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // carla_setenv
 
@@ -0,0 +1,246 @@
+/*
+ * LV2 URID Map
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef LV2_URID_MAP_HPP_INCLUDED
+#define LV2_URID_MAP_HPP_INCLUDED
+
+#include "CarlaMutex.hpp"
+
+// -----------------------------------------------------------------------
+// URI <-> URID registry.
+//
+// URIDs are handed out in sequence starting at the id given in the constructor,
+// ids below it are reserved for URIs the caller maps by itself.
+// Both lookup directions are O(1) and lock-free, only adding new URIs takes a lock.
+// Entries are never removed, so returned strings stay valid for the lifetime of the map.
+
+class Lv2UridMap
+{
+public:
+    Lv2UridMap(const uint32_t firstId) noexcept
+        : kFirstId(firstId),
+          fNextId(firstId),
+          fMutex()
+    {
+        for (uint32_t i=0; i < kBucketCount; ++i)
+            fBuckets[i] = nullptr;
+
+        for (uint32_t i=0; i < kChunkCount; ++i)
+            fChunks[i] = nullptr;
+    }
+
+    ~Lv2UridMap() noexcept
+    {
+        for (uint32_t i=0; i < kBucketCount; ++i)
+        {
+            for (Node* node = fBuckets[i], *next; node != nullptr; node = next)
+            {
+                next = node->next;
+                delete[] node->uri;
+                delete node;
+            }
+        }
+
+        for (uint32_t i=0; i < kChunkCount; ++i)
+            delete[] fChunks[i];
+    }
+
+    // -------------------------------------------------------------------
+
+    /*
+     * Get the URID for @a uri, adding it if needed.
+     * Returns 0 on failure.
+     */
+    uint32_t map(const char* const uri) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', 0);
+
+        const uint32_t hash(getHash(uri));
+
+        if (const uint32_t urid = find(uri, hash))
+            return urid;
+
+        const CarlaMutexLocker cml(fMutex);
+
+        // someone else might have added it meanwhile
+        if (const uint32_t urid = find(uri, hash))
+            return urid;
+
+        const uint32_t urid(fNextId);
+
+        return add(urid, uri, hash) ? urid : 0;
+    }
+
+    /*
+     * Get the URID for @a uri without adding it.
+     * Returns 0 if not mapped.
+     */
+    uint32_t find(const char* const uri) const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', 0);
+
+        return find(uri, getHash(uri));
+    }
+
+    /*
+     * Get the URI for @a urid.
+     * Returns null if not mapped.
+     */
+    const char* unmap(const uint32_t urid) const noexcept
+    {
+        if (urid < kFirstId || urid >= fNextId)
+            return nullptr;
+
+        const uint32_t index(urid - kFirstId);
+        const char* const* const chunk(fChunks[index / kChunkSize]);
+
+        if (chunk == nullptr)
+            return nullptr;
+
+        return chunk[index % kChunkSize];
+    }
+
+    /*
+     * Add a mapping decided elsewhere, like the one of a remote process that shares ids with us.
+     * Returns false if @a uri or @a urid is already used for something else.
+     */
+    bool insert(const uint32_t urid, const char* const uri) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(urid >= kFirstId, false);
+        CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', false);
+
+        const uint32_t hash(getHash(uri));
+        const CarlaMutexLocker cml(fMutex);
+
+        if (const uint32_t oldUrid = find(uri, hash))
+            return oldUrid == urid;
+
+        if (unmap(urid) != nullptr)
+            return false;
+
+        return add(urid, uri, hash);
+    }
+
+    /*
+     * One past the highest URID in use.
+     * Useful to send new mappings to a remote process since the last call.
+     */
+    uint32_t getNextId() const noexcept
+    {
+        return fNextId;
+    }
+
+private:
+    static const uint32_t kBucketCount = 1024;
+    static const uint32_t kChunkSize   = 256;
+    static const uint32_t kChunkCount  = 256;
+
+    struct Node {
+        Node* volatile next;
+        uint32_t       hash;
+        uint32_t       urid;
+        const char*    uri;
+    };
+
+    const uint32_t kFirstId;
+    volatile uint32_t fNextId;
+
+    Node* volatile fBuckets[kBucketCount];
+    const char** volatile fChunks[kChunkCount];
+
+    CarlaMutex fMutex;
+
+    // -------------------------------------------------------------------
+
+    static uint32_t getHash(const char* uri) noexcept
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261U;
+
+        for (; *uri != '\0'; ++uri)
+        {
+            hash ^= static_cast<uint8_t>(*uri);
+            hash *= 16777619U;
+        }
+
+        return hash;
+    }
+
+    uint32_t find(const char* const uri, const uint32_t hash) const noexcept
+    {
+        for (const Node* node = fBuckets[hash % kBucketCount]; node != nullptr; node = node->next)
+        {
+            if (node->hash == hash && std::strcmp(node->uri, uri) == 0)
+                return node->urid;
+        }
+
+        return 0;
+    }
+
+    // must be called with fMutex locked
+    bool add(const uint32_t urid, const char* const uri, const uint32_t hash) noexcept
+    {
+        const uint32_t index(urid - kFirstId);
+        const uint32_t chunkIndex(index / kChunkSize);
+        CARLA_SAFE_ASSERT_RETURN(chunkIndex < kChunkCount, false);
+
+        Node* node;
+
+        try {
+            if (fChunks[chunkIndex] == nullptr)
+            {
+                const char** const chunk(new const char*[kChunkSize]);
+                carla_zeroPointers(chunk, kChunkSize);
+
+                __sync_synchronize();
+                fChunks[chunkIndex] = chunk;
+            }
+
+            node = new Node;
+        } CARLA_SAFE_EXCEPTION_RETURN("Lv2UridMap::add", false);
+
+        try {
+            node->uri = carla_strdup(uri);
+        } catch(...) {
+            delete node;
+            carla_safe_exception("Lv2UridMap::add", __FILE__, __LINE__);
+            return false;
+        }
+
+        node->hash = hash;
+        node->urid = urid;
+        node->next = fBuckets[hash % kBucketCount];
+
+        fChunks[chunkIndex][index % kChunkSize] = node->uri;
+
+        // make sure everything is in place before readers can see it
+        __sync_synchronize();
+
+        fBuckets[hash % kBucketCount] = node;
+
+        if (urid >= fNextId)
+            fNextId = urid + 1;
+
+        return true;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2UridMap)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // LV2_URID_MAP_HPP_INCLUDED
@@ -0,0 +1,484 @@
+/*
+ * LV2 Worker Pool
+ * Copyright (C) 2018 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef LV2_WORKER_POOL_HPP_INCLUDED
+#define LV2_WORKER_POOL_HPP_INCLUDED
+
+#include "CarlaMutex.hpp"
+#include "CarlaRingBuffer.hpp"
+#include "CarlaSemUtils.hpp"
+#include "CarlaThread.hpp"
+#include "LinkedList.hpp"
+
+#ifdef CARLA_OS_WIN
+# include <windows.h>
+#else
+# include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------
+// Lock-free queue of worker messages.
+//
+// There must be only 1 writer and 1 reader at a time, no locking is done.
+// Each message carries a timestamp of when it was queued, used for latency stats.
+
+class Lv2WorkerRingBuffer : public CarlaRingBufferControl<HeapBuffer>
+{
+public:
+    Lv2WorkerRingBuffer() noexcept
+        : fHeapBuffer(HeapBuffer_INIT)
+    {
+        carla_zeroStruct(fHeapBuffer);
+    }
+
+    ~Lv2WorkerRingBuffer() noexcept override
+    {
+        if (fHeapBuffer.buf == nullptr)
+            return;
+
+        delete[] fHeapBuffer.buf;
+        fHeapBuffer.buf = nullptr;
+    }
+
+    // -------------------------------------------------------------------
+
+    void createBuffer(const uint32_t size) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(fHeapBuffer.buf == nullptr,);
+        CARLA_SAFE_ASSERT_RETURN(size > 0,);
+
+        const uint32_t p2size(carla_nextPowerOf2(size));
+
+        try {
+            fHeapBuffer.buf = new uint8_t[p2size];
+        } CARLA_SAFE_EXCEPTION_RETURN("Lv2WorkerRingBuffer::createBuffer",);
+
+        fHeapBuffer.size = p2size;
+        setRingBuffer(&fHeapBuffer, true);
+    }
+
+    void deleteBuffer() noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(fHeapBuffer.buf != nullptr,);
+
+        setRingBuffer(nullptr, false);
+
+        delete[] fHeapBuffer.buf;
+        fHeapBuffer.buf  = nullptr;
+        fHeapBuffer.size = 0;
+    }
+
+    uint32_t getSize() const noexcept
+    {
+        return fHeapBuffer.size;
+    }
+
+    bool isReady() const noexcept
+    {
+        return fHeapBuffer.buf != nullptr;
+    }
+
+    // -------------------------------------------------------------------
+
+    // NOTE: writer side only
+    bool put(const uint32_t size, const void* const data, const uint64_t time) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(fHeapBuffer.buf != nullptr, false);
+        CARLA_SAFE_ASSERT_RETURN(size == 0 || data != nullptr, false);
+
+        const Header header = { size, time };
+
+        if (tryWrite(&header, sizeof(Header)) && size > 0)
+            tryWrite(data, size);
+
+        // message contents must be in place before the reader can see them
+        __sync_synchronize();
+
+        return commitWrite();
+    }
+
+    // NOTE: reader side only, 'data' must be able to hold getSize() bytes
+    bool get(uint32_t& size, uint64_t& time, void* const data) noexcept
+    {
+        if (! isDataAvailableForReading())
+            return false;
+
+        __sync_synchronize();
+
+        Header header;
+
+        if (! tryRead(&header, sizeof(Header)))
+            return false;
+
+        CARLA_SAFE_ASSERT_RETURN(header.size < fHeapBuffer.size, false);
+
+        if (header.size > 0 && ! tryRead(data, header.size))
+            return false;
+
+        size = header.size;
+        time = header.time;
+        return true;
+    }
+
+private:
+    struct Header {
+        uint32_t size;
+        uint64_t time;
+    };
+
+    HeapBuffer fHeapBuffer;
+
+    CARLA_PREVENT_VIRTUAL_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2WorkerRingBuffer)
+};
+
+// -----------------------------------------------------------------------
+// Pool of non-realtime threads running LV2 worker requests.
+//
+// Clients are registered while not processing, and call wakeUp() from the audio thread
+// after queueing work, which is realtime safe.
+// A client is only ever handled by 1 thread at a time, so its work() calls never overlap.
+
+class Lv2WorkerPool
+{
+public:
+    class Client
+    {
+    public:
+        Client() noexcept
+            : fBusy(0) {}
+
+        virtual ~Client() {}
+
+        // check if there are requests waiting, called from any pool thread
+        virtual bool hasPendingWork() const noexcept = 0;
+
+        // run all waiting requests, called from the pool thread that claimed this client
+        virtual void runPendingWork() noexcept = 0;
+
+    private:
+        volatile int fBusy;
+        friend class Lv2WorkerPool;
+
+        CARLA_DECLARE_NON_COPY_CLASS(Client)
+    };
+
+    Lv2WorkerPool() noexcept
+        : fMutex(),
+          fClients(),
+          fWorkers(nullptr),
+          fNumWorkers(0) {}
+
+    ~Lv2WorkerPool() noexcept
+    {
+        CARLA_SAFE_ASSERT(fClients.count() == 0);
+
+        Worker** workers = nullptr;
+        uint numWorkers  = 0;
+
+        detachWorkers(workers, numWorkers);
+        stopWorkers(workers, numWorkers);
+
+        fClients.clear();
+    }
+
+    // -------------------------------------------------------------------
+
+    /*
+     * Register a client, starting the pool threads if needed.
+     * Must not be called from the audio thread.
+     */
+    void addClient(Client* const client) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(client != nullptr,);
+
+        const CarlaMutexLocker cml(fMutex);
+
+        if (fClients.count() == 0)
+            start();
+
+        fClients.append(client);
+    }
+
+    /*
+     * Unregister a client, waiting for its current requests to finish.
+     * The pool threads are stopped when no clients remain.
+     * Must not be called from the audio thread.
+     */
+    void removeClient(Client* const client) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(client != nullptr,);
+
+        bool wasLastClient = false;
+
+        {
+            const CarlaMutexLocker cml(fMutex);
+
+            CARLA_SAFE_ASSERT_RETURN(fClients.removeOne(client),);
+
+            wasLastClient = fClients.count() == 0;
+        }
+
+        // a pool thread might have claimed this client before we removed it
+        for (; client->fBusy != 0;)
+            carla_msleep(1);
+
+        if (! wasLastClient)
+            return;
+
+        Worker** workers = nullptr;
+        uint numWorkers  = 0;
+
+        {
+            const CarlaMutexLocker cml(fMutex);
+
+            // someone might have been added meanwhile
+            if (fClients.count() == 0)
+                detachWorkers(workers, numWorkers);
+        }
+
+        // workers lock fMutex too, so they must be stopped without holding it
+        stopWorkers(workers, numWorkers);
+    }
+
+    /*
+     * Wake up an idle pool thread, if any.
+     * This function is realtime safe.
+     */
+    void wakeUp() noexcept
+    {
+        for (uint i=0; i < fNumWorkers; ++i)
+        {
+            if (fWorkers[i]->wakeUp())
+                return;
+        }
+    }
+
+private:
+    // -------------------------------------------------------------------
+
+    class Worker : public CarlaThread
+    {
+    public:
+        Worker(Lv2WorkerPool* const pool, const char* const name) noexcept
+            : CarlaThread(name),
+              kPool(pool),
+              fSem(),
+              fWaiting(0)
+        {
+            carla_sem_create2(fSem);
+        }
+
+        ~Worker() noexcept override
+        {
+            carla_sem_destroy2(fSem);
+        }
+
+        bool wakeUp() noexcept
+        {
+            if (! __sync_bool_compare_and_swap(&fWaiting, 1, 0))
+                return false;
+
+            carla_sem_post(fSem, true);
+            return true;
+        }
+
+    protected:
+        void run() override
+        {
+            bool postPending = false;
+
+            for (; ! shouldThreadExit();)
+            {
+                kPool->runPendingWork();
+
+                if (! postPending)
+                {
+                    __sync_lock_test_and_set(&fWaiting, 1);
+
+                    // something might have been queued before we were marked as waiting
+                    if (kPool->hasPendingWork() && __sync_bool_compare_and_swap(&fWaiting, 1, 0))
+                        continue;
+                }
+
+                if (! carla_sem_timedwait(fSem, 100, true))
+                {
+                    // timed out, check if someone took our flag meanwhile
+                    postPending = ! __sync_bool_compare_and_swap(&fWaiting, 1, 0);
+                    continue;
+                }
+
+                postPending = false;
+            }
+        }
+
+    private:
+        Lv2WorkerPool* const kPool;
+        carla_sem_t fSem;
+        volatile int fWaiting;
+
+        CARLA_DECLARE_NON_COPY_CLASS(Worker)
+    };
+
+    // -------------------------------------------------------------------
+
+    static const uint kMaxWorkers = 4;
+
+    CarlaMutex fMutex;
+    LinkedList<Client*> fClients;
+
+    Worker** fWorkers;
+    uint fNumWorkers;
+
+    // -------------------------------------------------------------------
+
+    static uint getWorkerCount() noexcept
+    {
+#ifdef CARLA_OS_WIN
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        const long numCpus = static_cast<long>(info.dwNumberOfProcessors);
+#else
+        const long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+        if (numCpus <= 1)
+            return 1;
+
+        return static_cast<uint>(std::min(numCpus, static_cast<long>(kMaxWorkers)));
+    }
+
+    // must be called with fMutex locked
+    void start() noexcept
+    {
+        // still running, last client was removed and a new one added right away
+        if (fWorkers != nullptr)
+            return;
+
+        const uint numWorkers = getWorkerCount();
+
+        try {
+            fWorkers = new Worker*[numWorkers];
+        } CARLA_SAFE_EXCEPTION_RETURN("Lv2WorkerPool::start",);
+
+        char strBuf[0xff+1];
+        strBuf[0xff] = '\0';
+
+        for (uint i=0; i < numWorkers; ++i)
+        {
+            std::snprintf(strBuf, 0xff, "Lv2Worker.%u", i+1);
+
+            Worker* worker = nullptr;
+
+            try {
+                worker = new Worker(this, strBuf);
+            } CARLA_SAFE_EXCEPTION_BREAK("Lv2WorkerPool::start");
+
+            if (! worker->startThread())
+            {
+                delete worker;
+                break;
+            }
+
+            fWorkers[fNumWorkers++] = worker;
+        }
+
+        // make sure the audio thread sees all workers at once
+        __sync_synchronize();
+    }
+
+    // must be called with fMutex locked
+    void detachWorkers(Worker**& workers, uint& numWorkers) noexcept
+    {
+        workers    = fWorkers;
+        numWorkers = fNumWorkers;
+
+        fWorkers    = nullptr;
+        fNumWorkers = 0;
+        __sync_synchronize();
+    }
+
+    // must be called with fMutex unlocked
+    static void stopWorkers(Worker** const workers, const uint numWorkers) noexcept
+    {
+        if (workers == nullptr)
+            return;
+
+        for (uint i=0; i < numWorkers; ++i)
+            workers[i]->signalThreadShouldExit();
+
+        for (uint i=0; i < numWorkers; ++i)
+        {
+            workers[i]->wakeUp();
+            workers[i]->stopThread(-1);
+            delete workers[i];
+        }
+
+        delete[] workers;
+    }
+
+    // -------------------------------------------------------------------
+
+    bool hasPendingWork() noexcept
+    {
+        const CarlaMutexLocker cml(fMutex);
+
+        for (LinkedList<Client*>::Itenerator it = fClients.begin2(); it.valid(); it.next())
+        {
+            Client* const client(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(client != nullptr);
+
+            if (client->fBusy == 0 && client->hasPendingWork())
+                return true;
+        }
+
+        return false;
+    }
+
+    Client* claimClient() noexcept
+    {
+        const CarlaMutexLocker cml(fMutex);
+
+        for (LinkedList<Client*>::Itenerator it = fClients.begin2(); it.valid(); it.next())
+        {
+            Client* const client(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(client != nullptr);
+
+            if (client->hasPendingWork() && __sync_bool_compare_and_swap(&client->fBusy, 0, 1))
+                return client;
+        }
+
+        return nullptr;
+    }
+
+    void runPendingWork() noexcept
+    {
+        // the client must not be touched after releasing it, it might be removed right away.
+        // anything queued meanwhile is found on the next claim.
+        for (Client* client; (client = claimClient()) != nullptr;)
+        {
+            client->runPendingWork();
+            __sync_lock_release(&client->fBusy);
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(Lv2WorkerPool)
+};
+
+// -----------------------------------------------------------------------
+
+#endif // LV2_WORKER_POOL_HPP_INCLUDED
@@ -1,6 +1,6 @@
 /*
  * High-level, real-time safe, templated, C++ doubly-linked list
- * Copyright (C) 2013-2014 Filipe Coelho <falktx@falktx.com>
+ * Copyright (C) 2013-2018 Filipe Coelho <falktx@falktx.com>
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License as
@@ -19,10 +19,7 @@
 #define RT_LINKED_LIST_HPP_INCLUDED
 
 #include "LinkedList.hpp"
-
-extern "C" {
-#include "rtmempool/rtmempool.h"
-}
+#include "CarlaMutex.hpp"
 
 // -----------------------------------------------------------------------
 // Realtime safe linkedlist
@@ -32,70 +29,293 @@ class RtLinkedList : public AbstractLinkedList<T>
 {
 public:
     // -------------------------------------------------------------------
-    // RtMemPool C++ class
+    // Lock-free fixed-size block pool
+    //
+    // Free blocks are kept in a lock-free stack, addressed by index so that a 32-bit tag can
+    // be packed next to the head for ABA protection.
+    // allocate_atomic() and deallocate() never lock and never touch the system allocator.
+    // New blocks are only created by refill() and allocate_sleepy(), which must not be called
+    // from the realtime thread. The pool never holds more than maxPreallocated blocks in total.
 
     class Pool
     {
     public:
+        struct Stats {
+            std::size_t total;     // blocks created so far
+            std::size_t used;      // blocks currently handed out
+            std::size_t highWater; // maximum number of blocks in use at once
+            std::size_t failed;    // number of failed atomic allocations
+        };
+
         Pool(const std::size_t minPreallocated, const std::size_t maxPreallocated) noexcept
             : kDataSize(sizeof(typename AbstractLinkedList<T>::Data)),
-              fHandle(nullptr)
+              kBlockSize(((kHeaderSize + kDataSize + kHeaderSize - 1) / kHeaderSize) * kHeaderSize),
+              fMinPreallocated(0),
+              fMaxPreallocated(0),
+              fHead(0),
+              fNextTable(nullptr),
+              fBlockTable(nullptr),
+              fBatches(nullptr),
+              fTotalCount(0),
+              fFreeCount(0),
+              fUsedCount(0),
+              fHighWater(0),
+              fFailedCount(0),
+              fRefillMutex()
         {
             resize(minPreallocated, maxPreallocated);
         }
 
         ~Pool() noexcept
         {
-            if (fHandle != nullptr)
-            {
-                rtsafe_memory_pool_destroy(fHandle);
-                fHandle = nullptr;
-            }
+            _destroy();
         }
 
         void* allocate_atomic() const noexcept
         {
-            return rtsafe_memory_pool_allocate_atomic(fHandle);
+            if (void* const dataPtr = _pop())
+                return dataPtr;
+
+            __sync_add_and_fetch(&fFailedCount, 1);
+            return nullptr;
         }
 
         void* allocate_sleepy() const noexcept
         {
-            return rtsafe_memory_pool_allocate_sleepy(fHandle);
+            const CarlaMutexLocker cml(fRefillMutex);
+
+            for (;;)
+            {
+                const bool canGrow = _refill();
+
+                if (void* const dataPtr = _pop())
+                    return dataPtr;
+
+                // someone else took the new blocks, or we ran out
+                if (! canGrow)
+                    return nullptr;
+            }
         }
 
         void deallocate(void* const dataPtr) const noexcept
         {
             CARLA_SAFE_ASSERT_RETURN(dataPtr != nullptr,);
 
-            rtsafe_memory_pool_deallocate(fHandle, dataPtr);
+            const uint32_t index = *(const uint32_t*)((const uint8_t*)dataPtr - kHeaderSize);
+            CARLA_SAFE_ASSERT_RETURN(index < fTotalCount,);
+            CARLA_SAFE_ASSERT_RETURN(fBlockTable[index] == (uint8_t*)dataPtr - kHeaderSize,);
+
+            _push(index);
+            __sync_sub_and_fetch(&fUsedCount, 1);
+        }
+
+        // Bring the number of free blocks back up to the minimum, never exceeding the maximum.
+        // Must not be called from the realtime thread.
+        void refill() const noexcept
+        {
+            const CarlaMutexLocker cml(fRefillMutex);
+            _refill();
         }
 
         void resize(const std::size_t minPreallocated, const std::size_t maxPreallocated) noexcept
         {
-            if (fHandle != nullptr)
+            _destroy();
+
+            CARLA_SAFE_ASSERT_RETURN(maxPreallocated > 0,);
+            CARLA_SAFE_ASSERT_RETURN(maxPreallocated < 0xffffffff,);
+
+            fMinPreallocated = static_cast<uint32_t>(minPreallocated);
+            fMaxPreallocated = static_cast<uint32_t>(maxPreallocated);
+
+            if (fMinPreallocated > fMaxPreallocated)
+                fMinPreallocated = fMaxPreallocated;
+
+            fNextTable  = (uint32_t*)std::calloc(fMaxPreallocated, sizeof(uint32_t));
+            fBlockTable = (uint8_t**)std::calloc(fMaxPreallocated, sizeof(uint8_t*));
+
+            if (fNextTable == nullptr || fBlockTable == nullptr)
             {
-                rtsafe_memory_pool_destroy(fHandle);
-                fHandle = nullptr;
+                carla_safe_assert("fNextTable != nullptr && fBlockTable != nullptr", __FILE__, __LINE__);
+                _destroy();
+                return;
             }
 
-            rtsafe_memory_pool_create(&fHandle, nullptr, kDataSize, minPreallocated, maxPreallocated);
-            CARLA_SAFE_ASSERT(fHandle != nullptr);
+            refill();
+        }
+
+        Stats getStats() const noexcept
+        {
+            Stats stats;
+            stats.total     = fTotalCount;
+            stats.used      = fUsedCount;
+            stats.highWater = fHighWater;
+            stats.failed    = fFailedCount;
+            return stats;
+        }
+
+        void resetHighWater() const noexcept
+        {
+            __sync_lock_test_and_set(&fHighWater, fUsedCount);
+            __sync_lock_test_and_set(&fFailedCount, 0);
         }
 
         bool operator==(const Pool& pool) const noexcept
         {
-            return (fHandle == pool.fHandle && kDataSize == pool.kDataSize);
+            return (this == &pool);
         }
 
         bool operator!=(const Pool& pool) const noexcept
         {
-            return (fHandle != pool.fHandle || kDataSize != pool.kDataSize);
+            return (this != &pool);
         }
 
     private:
+        // keeps the block index, sized to preserve malloc alignment for the data after it
+        static const std::size_t kHeaderSize = sizeof(void*)*2;
+
         const std::size_t kDataSize;
+        const std::size_t kBlockSize;
+
+        uint32_t fMinPreallocated;
+        uint32_t fMaxPreallocated;
+
+        // free stack head, low 32 bits are index+1 (0 means empty), high 32 bits are the ABA tag
+        mutable uint64_t fHead;
+
+        // per-block link to the next free block (index+1), and per-block memory
+        uint32_t* fNextTable;
+        uint8_t** fBlockTable;
+
+        // chain of malloc'ed block batches, only touched by non-RT code
+        mutable void* fBatches;
+
+        mutable uint32_t fTotalCount;
+        mutable uint32_t fFreeCount;
+        mutable uint32_t fUsedCount;
+        mutable uint32_t fHighWater;
+        mutable uint32_t fFailedCount;
+
+        mutable CarlaMutex fRefillMutex;
+
+        void* _pop() const noexcept
+        {
+            if (fNextTable == nullptr)
+                return nullptr;
+
+            uint64_t oldHead, newHead;
+            uint32_t index;
+
+            do {
+                oldHead = fHead;
+                index   = static_cast<uint32_t>(oldHead & 0xffffffff);
+
+                if (index == 0)
+                    return nullptr;
+
+                newHead = (((oldHead >> 32) + 1) << 32) | fNextTable[index-1];
+            }
+            while (! __sync_bool_compare_and_swap(&fHead, oldHead, newHead));
+
+            __sync_sub_and_fetch(&fFreeCount, 1);
 
-        mutable RtMemPool_Handle fHandle;
+            const uint32_t used = __sync_add_and_fetch(&fUsedCount, 1);
+
+            for (uint32_t highWater = fHighWater; used > highWater; highWater = fHighWater)
+            {
+                if (__sync_bool_compare_and_swap(&fHighWater, highWater, used))
+                    break;
+            }
+
+            return fBlockTable[index-1] + kHeaderSize;
+        }
+
+        void _push(const uint32_t index) const noexcept
+        {
+            uint64_t oldHead, newHead;
+
+            do {
+                oldHead = fHead;
+                fNextTable[index] = static_cast<uint32_t>(oldHead & 0xffffffff);
+                newHead = (((oldHead >> 32) + 1) << 32) | (index + 1);
+            }
+            while (! __sync_bool_compare_and_swap(&fHead, oldHead, newHead));
+
+            __sync_add_and_fetch(&fFreeCount, 1);
+        }
+
+        // returns false if the pool cannot grow any further; fRefillMutex must be locked
+        bool _refill() const noexcept
+        {
+            if (fNextTable == nullptr)
+                return false;
+
+            const uint32_t freeCount = fFreeCount;
+
+            if (freeCount >= fMinPreallocated && freeCount > 0)
+                return true;
+
+            uint32_t count = (fMinPreallocated > freeCount) ? fMinPreallocated - freeCount : 1;
+
+            if (count > fMaxPreallocated - fTotalCount)
+                count = fMaxPreallocated - fTotalCount;
+
+            if (count == 0)
+                return false;
+
+            uint8_t* const batch = (uint8_t*)std::malloc(kHeaderSize + kBlockSize * count);
+            CARLA_SAFE_ASSERT_RETURN(batch != nullptr, false);
+
+            *(void**)batch = fBatches;
+            fBatches = batch;
+
+            for (uint32_t i=0; i < count; ++i)
+            {
+                const uint32_t index = fTotalCount;
+                uint8_t* const block = batch + kHeaderSize + kBlockSize * i;
+
+                *(uint32_t*)block  = index;
+                fBlockTable[index] = block;
+
+                // publish the block before anyone can pop it
+                __sync_add_and_fetch(&fTotalCount, 1);
+                _push(index);
+            }
+
+            return true;
+        }
+
+        void _destroy() noexcept
+        {
+            if (fUsedCount != 0)
+                carla_stderr("RtLinkedList::Pool destroyed with %u blocks still in use", fUsedCount);
+
+            for (void* batch = fBatches; batch != nullptr;)
+            {
+                void* const next = *(void**)batch;
+                std::free(batch);
+                batch = next;
+            }
+
+            if (fNextTable != nullptr)
+            {
+                std::free(fNextTable);
+                fNextTable = nullptr;
+            }
+
+            if (fBlockTable != nullptr)
+            {
+                std::free(fBlockTable);
+                fBlockTable = nullptr;
+            }
+
+            fBatches     = nullptr;
+            fHead        = 0;
+            fTotalCount  = 0;
+            fFreeCount   = 0;
+            fUsedCount   = 0;
+            fHighWater   = 0;
+            fFailedCount = 0;
+        }
 
         CARLA_PREVENT_HEAP_ALLOCATION
         CARLA_DECLARE_NON_COPY_CLASS(Pool)